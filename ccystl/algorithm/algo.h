@@ -2107,7 +2107,8 @@ void unchecked_linear_insert(RandomIter last, const T& value) {
 template <class RandomIter>
 void unchecked_insertion_sort(RandomIter first, RandomIter last) {
     for (auto i = first; i != last; ++i) {
-        ccystl::unchecked_linear_insert(i, *i);
+        auto value = *i; // 先取出，*i 会在后移时被覆盖
+        ccystl::unchecked_linear_insert(i, value);
     }
 }
 
@@ -2178,8 +2179,8 @@ void intro_sort(RandomIter first, RandomIter last, Size depth_limit,
             return;
         }
         --depth_limit;
-        auto mid =
-            ccystl::median(*(first), *(first + (last - first) / 2), *(last - 1));
+        auto mid = ccystl::median(*(first), *(first + (last - first) / 2),
+                                  *(last - 1), comp);
         auto cut = ccystl::unchecked_partition(first, last, mid, comp);
         ccystl::intro_sort(cut, last, depth_limit, comp);
         last = cut;
@@ -2205,7 +2206,8 @@ template <class RandomIter, class Compared>
 void unchecked_insertion_sort(RandomIter first, RandomIter last,
                               Compared comp) {
     for (auto i = first; i != last; ++i) {
-        ccystl::unchecked_linear_insert(i, *i, comp);
+        auto value = *i; // 先取出，*i 会在后移时被覆盖
+        ccystl::unchecked_linear_insert(i, value, comp);
     }
 }
 
@@ -2247,6 +2249,38 @@ void sort(RandomIter first, RandomIter last, Compared comp) {
     }
 }
 
+/*****************************************************************************************/
+// stable_sort
+// 将[first, last)内的元素以递增的方式排序，等价元素保持原来的相对次序
+// 小区间用插入排序，其余对半递归排序后用 inplace_merge 合并，两者都是稳定的
+/*****************************************************************************************/
+constexpr static size_t kStableChunkSize = 32; // 稳定排序中直接插入排序的区间大小
+
+template <class RandomIter>
+void stable_sort(RandomIter first, RandomIter last) {
+    if (static_cast<size_t>(last - first) <= kStableChunkSize) {
+        ccystl::insertion_sort(first, last);
+        return;
+    }
+    auto middle = first + (last - first) / 2;
+    ccystl::stable_sort(first, middle);
+    ccystl::stable_sort(middle, last);
+    ccystl::inplace_merge(first, middle, last);
+}
+
+// 重载版本使用函数对象 comp 代替比较操作
+template <class RandomIter, class Compared>
+void stable_sort(RandomIter first, RandomIter last, Compared comp) {
+    if (static_cast<size_t>(last - first) <= kStableChunkSize) {
+        ccystl::insertion_sort(first, last, comp);
+        return;
+    }
+    auto middle = first + (last - first) / 2;
+    ccystl::stable_sort(first, middle, comp);
+    ccystl::stable_sort(middle, last, comp);
+    ccystl::inplace_merge(first, middle, last, comp);
+}
+
 /*****************************************************************************************/
 // nth_element
 // 对序列重排，使得所有小于第 n
@@ -2257,9 +2291,9 @@ void nth_element(RandomIter first, RandomIter nth, RandomIter last) {
     if (nth == last)
         return;
     while (last - first > 3) {
-        auto cut = ccystl::unchecked_partition(
-            first, last,
-            ccystl::median(*first, *(first + (last - first) / 2), *(last - 1)));
+        // 枢轴须先复制出来，分割过程中区间内的元素会被交换
+        auto mid = ccystl::median(*first, *(first + (last - first) / 2), *(last - 1));
+        auto cut = ccystl::unchecked_partition(first, last, mid);
         if (cut <= nth) // 如果 nth 位于右段
             first = cut; // 对右段进行分割
         else
@@ -2275,10 +2309,9 @@ void nth_element(RandomIter first, RandomIter nth, RandomIter last,
     if (nth == last)
         return;
     while (last - first > 3) {
-        auto cut = ccystl::unchecked_partition(
-            first, last,
-            ccystl::median(*first, *(first + (last - first) / 2), *(last - 1)),
-            comp);
+        auto mid = ccystl::median(*first, *(first + (last - first) / 2),
+                                  *(last - 1), comp);
+        auto cut = ccystl::unchecked_partition(first, last, mid, comp);
         if (cut <= nth) // 如果 nth 位于右段
             first = cut; // 对右段进行分割
         else
@@ -31,6 +31,26 @@ public:
     using size_type = size_t; ///< 大小类型
     using difference_type = ptrdiff_t; ///< 指针差值类型
 
+    /**
+     * @brief 将分配器重新绑定到另一种类型。
+     *
+     * 节点式容器通过 `rebind<node_type>::other` 得到分配节点所用的分配器。
+     *
+     * @tparam U 新的对象类型。
+     */
+    template <class U>
+    struct rebind {
+        using other = allocator<U>; ///< 绑定到 U 的分配器类型
+    };
+
+    constexpr allocator() noexcept = default;
+
+    /**
+     * @brief 由绑定到其他类型的分配器构造。分配器无状态，因此什么也不做。
+     */
+    template <class U>
+    constexpr allocator(const allocator<U>&) noexcept {}
+
 public:
     /**
      * @brief 分配单个对象的内存。
@@ -192,6 +212,18 @@ template <class T>
 void allocator<T>::destroy(T* first, T* last) {
     ccystl::destroy(first, last);
 }
+
+// 无状态分配器的所有实例都可以互相释放对方分配的内存
+
+template <class T, class U>
+constexpr bool operator==(const allocator<T>&, const allocator<U>&) noexcept {
+    return true;
+}
+
+template <class T, class U>
+constexpr bool operator!=(const allocator<T>&, const allocator<U>&) noexcept {
+    return false;
+}
 } // namespace ccystl
 
 #endif // CCYSTL_ALLOCATOR_H_
@@ -111,7 +111,7 @@ void destroy_cat(ForwardIter first, ForwardIter last, std::true_type) { }
 template <class ForwardIter>
 void destroy_cat(ForwardIter first, ForwardIter last, std::false_type) {
     for (; first != last; ++first) {
-        destroy(&*first);
+        destroy_one(&*first, std::false_type{});
     }
 }
 
@@ -0,0 +1,190 @@
+#ifndef CCYSTL_MALLOC_ALLOCATOR_H_
+#define CCYSTL_MALLOC_ALLOCATOR_H_
+
+/**
+ * @file malloc_allocator.h
+ * @brief 该头文件定义了基于 `std::malloc` / `std::realloc` / `std::free` 的分配器 `malloc_allocator`。
+ *
+ * 与 `ccystl::allocator` 不同，`malloc_allocator` 额外提供 `reallocate`，
+ * `vector`、`deque` 的 map 与 `basic_string` 在元素可平凡重定位时会用它原地扩容：
+ * 内存块之后仍有空闲空间时无需搬移数据；对于大块内存，glibc 的 `realloc` 会通过 `mremap`
+ * 重新映射页面而不是逐字节复制。
+ *
+ * 用法：
+ * @code
+ * ccystl::vector<ccystl::string, ccystl::malloc_allocator<ccystl::string>> v;
+ * @endcode
+ */
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "ccystl/allocator/construct.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+/**
+ * @brief 使用 C 运行时堆的内存分配器，支持 `realloc` 原地扩容。
+ *
+ * 只支持对齐要求不超过 `alignof(std::max_align_t)` 的类型。
+ *
+ * @tparam T 分配器管理的对象类型。
+ */
+template <class T>
+class malloc_allocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc_allocator does not support over-aligned types");
+
+public:
+    using value_type = T; ///< 对象类型
+    using pointer = T*; ///< 指针类型
+    using const_pointer = const T*; ///< 常量指针类型
+    using reference = T&; ///< 引用类型
+    using const_reference = const T&; ///< 常量引用类型
+    using size_type = size_t; ///< 大小类型
+    using difference_type = ptrdiff_t; ///< 指针差值类型
+
+    /**
+     * @brief 将分配器重新绑定到另一种类型。
+     *
+     * @tparam U 新的对象类型。
+     */
+    template <class U>
+    struct rebind {
+        using other = malloc_allocator<U>; ///< 绑定到 U 的分配器类型
+    };
+
+    constexpr malloc_allocator() noexcept = default;
+
+    /**
+     * @brief 由绑定到其他类型的分配器构造。分配器无状态，因此什么也不做。
+     */
+    template <class U>
+    constexpr malloc_allocator(const malloc_allocator<U>&) noexcept {}
+
+public:
+    /**
+     * @brief 分配单个对象的内存。
+     *
+     * @return T* 指向分配的内存的指针。
+     * @throw std::bad_alloc 分配失败时抛出。
+     */
+    static T* allocate() {
+        return allocate(1);
+    }
+
+    /**
+     * @brief 分配多个对象的内存。
+     *
+     * @param n 要分配的对象数量。
+     * @return T* 指向分配的内存的指针，如果 n 为 0 则返回 nullptr。
+     * @throw std::bad_alloc n 过大或分配失败时抛出。
+     */
+    static T* allocate(size_type n);
+
+    /**
+     * @brief 调整已分配内存的大小，必要时将内容按字节搬移到新的地址。
+     *
+     * 只能用于可平凡重定位的对象。失败时原内存保持不变。
+     *
+     * @param ptr 由本分配器分配的指针，可以为 nullptr。
+     * @param old_n 原有的对象数量。
+     * @param new_n 新的对象数量，为 0 时释放内存并返回 nullptr。
+     * @return T* 指向调整后的内存的指针。
+     * @throw std::bad_alloc new_n 过大或分配失败时抛出。
+     */
+    static T* reallocate(T* ptr, size_type old_n, size_type new_n);
+
+    /**
+     * @brief 释放单个对象的内存。
+     *
+     * @param ptr 指向要释放的内存的指针。
+     */
+    static void deallocate(T* ptr) {
+        std::free(ptr);
+    }
+
+    /**
+     * @brief 释放多个对象的内存。
+     *
+     * @param ptr 指向要释放的内存的指针。
+     * @param n 要释放的对象数量（未实际使用，仅作兼容）。
+     */
+    static void deallocate(T* ptr, size_type /*n*/) {
+        std::free(ptr);
+    }
+
+    /**
+     * @brief 在分配的内存上构造对象，并使用可变参数进行初始化。
+     *
+     * @tparam Args 用于构造对象的参数类型。
+     * @param ptr 指向要构造对象的内存的指针。
+     * @param args 用于初始化对象的参数。
+     */
+    template <class... Args>
+    static void construct(T* ptr, Args&&... args) {
+        ccystl::construct(ptr, ccystl::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 调用单个对象的析构函数。
+     *
+     * @param ptr 指向要销毁的对象的指针。
+     */
+    static void destroy(T* ptr) {
+        ccystl::destroy(ptr);
+    }
+
+    /**
+     * @brief 调用多个对象的析构函数。
+     *
+     * @param first 指向要销毁的第一个对象的指针。
+     * @param last 指向要销毁的最后一个对象之后的指针。
+     */
+    static void destroy(T* first, T* last) {
+        ccystl::destroy(first, last);
+    }
+};
+
+// 方法实现
+
+template <class T>
+T* malloc_allocator<T>::allocate(size_type n) {
+    if (n == 0)
+        return nullptr;
+    if (n > static_cast<size_type>(-1) / sizeof(T))
+        throw std::bad_alloc();
+    void* p = std::malloc(n * sizeof(T));
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return static_cast<T*>(p);
+}
+
+template <class T>
+T* malloc_allocator<T>::reallocate(T* ptr, size_type /*old_n*/, size_type new_n) {
+    if (new_n == 0) {
+        std::free(ptr);
+        return nullptr;
+    }
+    if (new_n > static_cast<size_type>(-1) / sizeof(T))
+        throw std::bad_alloc();
+    void* p = std::realloc(ptr, new_n * sizeof(T));
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return static_cast<T*>(p);
+}
+
+// 无状态分配器的所有实例都可以互相释放对方分配的内存
+
+template <class T, class U>
+constexpr bool operator==(const malloc_allocator<T>&, const malloc_allocator<U>&) noexcept {
+    return true;
+}
+
+template <class T, class U>
+constexpr bool operator!=(const malloc_allocator<T>&, const malloc_allocator<U>&) noexcept {
+    return false;
+}
+} // namespace ccystl
+
+#endif // CCYSTL_MALLOC_ALLOCATOR_H_
@@ -0,0 +1,728 @@
+#ifndef CCYSTL_MEMORY_RESOURCE_H_
+#define CCYSTL_MEMORY_RESOURCE_H_
+
+/**
+ * @file memory_resource.h
+ * @brief 该头文件定义了 `ccystl::pmr` 命名空间下的多态内存资源体系。
+ *
+ * 包含抽象基类 `memory_resource`、三种具体资源 `monotonic_buffer_resource`、
+ * `unsynchronized_pool_resource`、`synchronized_pool_resource`，
+ * 以及把内存资源适配为容器分配器的 `polymorphic_allocator`。
+ *
+ * 典型用法是为一次请求创建一个 `monotonic_buffer_resource`，请求内的所有容器都从它分配，
+ * 请求结束时整体释放，而不必逐个节点归还：
+ * @code
+ * ccystl::pmr::monotonic_buffer_resource arena;
+ * ccystl::pmr::vector<int> v(&arena);
+ * ccystl::pmr::map<int, int> m(&arena);
+ * // ...
+ * // arena 析构时一次性释放 v、m 使用的全部内存
+ * @endcode
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#include "ccystl/allocator/construct.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+namespace pmr {
+/**
+ * @brief 内存资源的抽象基类。
+ *
+ * 派生类通过重写 `do_allocate`、`do_deallocate`、`do_is_equal` 提供具体的分配策略。
+ */
+class memory_resource {
+public:
+    static constexpr size_t max_align = alignof(std::max_align_t); ///< 默认对齐
+
+    virtual ~memory_resource() = default;
+
+    /**
+     * @brief 分配内存。
+     *
+     * @param bytes 字节数。
+     * @param alignment 对齐要求，必须是 2 的幂。
+     * @return void* 指向分配的内存的指针。
+     */
+    [[nodiscard]] void* allocate(size_t bytes, size_t alignment = max_align) {
+        return do_allocate(bytes, alignment);
+    }
+
+    /**
+     * @brief 释放内存，bytes 与 alignment 必须与分配时一致。
+     *
+     * @param ptr 由 `allocate` 返回的指针。
+     * @param bytes 字节数。
+     * @param alignment 对齐要求。
+     */
+    void deallocate(void* ptr, size_t bytes, size_t alignment = max_align) {
+        do_deallocate(ptr, bytes, alignment);
+    }
+
+    /**
+     * @brief 判断两个资源能否互相释放对方分配的内存。
+     *
+     * @param other 另一个资源。
+     * @return bool 可以互相释放时返回 true。
+     */
+    [[nodiscard]] bool is_equal(const memory_resource& other) const noexcept {
+        return do_is_equal(other);
+    }
+
+private:
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+};
+
+inline bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept {
+    return &lhs == &rhs || lhs.is_equal(rhs);
+}
+
+inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+namespace detail {
+/**
+ * @brief 将 n 向上取整到 alignment 的倍数。
+ */
+constexpr size_t align_up(size_t n, size_t alignment) noexcept {
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief 使用 `::operator new` 的内存资源。
+ */
+class new_delete_resource_impl final : public memory_resource {
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (alignment > max_align)
+            return ::operator new(bytes, std::align_val_t(alignment));
+        return ::operator new(bytes);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        if (alignment > max_align)
+            ::operator delete(ptr, bytes, std::align_val_t(alignment));
+        else
+            ::operator delete(ptr, bytes);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/**
+ * @brief 任何分配都失败的内存资源。
+ */
+class null_memory_resource_impl final : public memory_resource {
+    void* do_allocate(size_t, size_t) override {
+        throw std::bad_alloc();
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+inline std::atomic<memory_resource*>& default_resource_slot() noexcept;
+} // namespace detail
+
+/**
+ * @brief 返回使用 `::operator new` / `::operator delete` 的全局内存资源。
+ */
+inline memory_resource* new_delete_resource() noexcept {
+    static detail::new_delete_resource_impl instance;
+    return &instance;
+}
+
+/**
+ * @brief 返回任何分配都抛出 `std::bad_alloc` 的全局内存资源。
+ *
+ * 常作为 `monotonic_buffer_resource` 的上游，用来保证只使用给定的缓冲区。
+ */
+inline memory_resource* null_memory_resource() noexcept {
+    static detail::null_memory_resource_impl instance;
+    return &instance;
+}
+
+inline std::atomic<memory_resource*>& detail::default_resource_slot() noexcept {
+    static std::atomic<memory_resource*> slot{new_delete_resource()};
+    return slot;
+}
+
+/**
+ * @brief 返回当前的默认内存资源。
+ */
+inline memory_resource* get_default_resource() noexcept {
+    return detail::default_resource_slot().load(std::memory_order_acquire);
+}
+
+/**
+ * @brief 设置默认内存资源。
+ *
+ * @param r 新的默认资源，为空时恢复为 `new_delete_resource()`。
+ * @return memory_resource* 之前的默认资源。
+ */
+inline memory_resource* set_default_resource(memory_resource* r) noexcept {
+    if (r == nullptr)
+        r = new_delete_resource();
+    return detail::default_resource_slot().exchange(r, std::memory_order_acq_rel);
+}
+
+/**
+ * @brief 单调增长的缓冲区资源。
+ *
+ * 从当前缓冲区中顺序切分内存，`deallocate` 不做任何事，
+ * 缓冲区用尽时向上游申请一个更大的缓冲区（几何增长）。
+ * 全部内存在 `release()` 或析构时一次性归还上游，适合生命周期一致的一组对象。
+ *
+ * 非线程安全。
+ */
+class monotonic_buffer_resource : public memory_resource {
+public:
+    monotonic_buffer_resource() noexcept
+        : monotonic_buffer_resource(get_default_resource()) {}
+
+    explicit monotonic_buffer_resource(memory_resource* upstream) noexcept
+        : upstream_(upstream), initial_buffer_(nullptr), initial_size_(0),
+          cur_(nullptr), avail_(0), next_size_(initial_chunk_size), chunks_(nullptr) {}
+
+    explicit monotonic_buffer_resource(size_t initial_size) noexcept
+        : monotonic_buffer_resource(initial_size, get_default_resource()) {}
+
+    monotonic_buffer_resource(size_t initial_size, memory_resource* upstream) noexcept
+        : monotonic_buffer_resource(upstream) {
+        next_size_ = initial_size < min_chunk_size ? min_chunk_size : initial_size;
+    }
+
+    /**
+     * @brief 以用户提供的缓冲区作为第一块内存，该缓冲区不会被释放。
+     *
+     * @param buffer 初始缓冲区。
+     * @param buffer_size 初始缓冲区的字节数。
+     */
+    monotonic_buffer_resource(void* buffer, size_t buffer_size) noexcept
+        : monotonic_buffer_resource(buffer, buffer_size, get_default_resource()) {}
+
+    monotonic_buffer_resource(void* buffer, size_t buffer_size, memory_resource* upstream) noexcept
+        : monotonic_buffer_resource(upstream) {
+        initial_buffer_ = static_cast<char*>(buffer);
+        initial_size_ = buffer_size;
+        cur_ = initial_buffer_;
+        avail_ = initial_size_;
+        next_size_ = buffer_size < min_chunk_size ? min_chunk_size : buffer_size * 2;
+    }
+
+    monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+    monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+    ~monotonic_buffer_resource() override {
+        release();
+    }
+
+    /**
+     * @brief 将所有向上游申请的内存归还，并重新从初始缓冲区开始分配。
+     */
+    void release() noexcept;
+
+    /**
+     * @brief 返回上游资源。
+     */
+    [[nodiscard]] memory_resource* upstream_resource() const noexcept {
+        return upstream_;
+    }
+
+private:
+    /**
+     * @brief 向上游申请的缓冲区头部，串联所有缓冲区以便统一释放。
+     */
+    struct chunk_header {
+        chunk_header* next;
+        size_t bytes;
+    };
+
+    static constexpr size_t initial_chunk_size = 1024;
+    static constexpr size_t min_chunk_size = 64;
+    static constexpr size_t header_size = detail::align_up(sizeof(chunk_header), max_align);
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void new_chunk(size_t bytes, size_t alignment);
+
+private:
+    memory_resource* upstream_; ///< 上游资源
+    char* initial_buffer_; ///< 用户提供的初始缓冲区
+    size_t initial_size_; ///< 初始缓冲区大小
+    char* cur_; ///< 当前缓冲区中下一个可用位置
+    size_t avail_; ///< 当前缓冲区剩余字节数
+    size_t next_size_; ///< 下一次向上游申请的缓冲区大小
+    chunk_header* chunks_; ///< 向上游申请的缓冲区链表
+};
+
+inline void monotonic_buffer_resource::release() noexcept {
+    while (chunks_ != nullptr) {
+        chunk_header* next = chunks_->next;
+        upstream_->deallocate(chunks_, chunks_->bytes, max_align);
+        chunks_ = next;
+    }
+    cur_ = initial_buffer_;
+    avail_ = initial_size_;
+}
+
+inline void* monotonic_buffer_resource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0)
+        bytes = 1;
+    auto addr = reinterpret_cast<uintptr_t>(cur_);
+    size_t pad = detail::align_up(addr, alignment) - addr;
+    if (cur_ == nullptr || pad + bytes > avail_) {
+        new_chunk(bytes, alignment);
+        addr = reinterpret_cast<uintptr_t>(cur_);
+        pad = detail::align_up(addr, alignment) - addr;
+    }
+    char* result = cur_ + pad;
+    cur_ = result + bytes;
+    avail_ -= pad + bytes;
+    return result;
+}
+
+inline void monotonic_buffer_resource::new_chunk(size_t bytes, size_t alignment) {
+    // 保证新缓冲区在最坏的对齐填充下也能容纳本次请求
+    const size_t need = header_size + bytes + (alignment > max_align ? alignment : 0);
+    size_t size = next_size_;
+    while (size < need)
+        size *= 2;
+    auto chunk = static_cast<chunk_header*>(upstream_->allocate(size, max_align));
+    chunk->next = chunks_;
+    chunk->bytes = size;
+    chunks_ = chunk;
+    cur_ = reinterpret_cast<char*>(chunk) + header_size;
+    avail_ = size - header_size;
+    next_size_ = size * 2;
+}
+
+/**
+ * @brief 内存池资源的配置项。
+ */
+struct pool_options {
+    size_t max_blocks_per_chunk = 0; ///< 每个 chunk 最多包含的块数，0 表示使用缺省值
+    size_t largest_required_pool_block = 0; ///< 由池负责的最大块大小，0 表示使用缺省值
+};
+
+/**
+ * @brief 非线程安全的内存池资源。
+ *
+ * 按 2 的幂划分尺寸级别，每个级别维护一条侵入式空闲链表，空闲链表为空时向上游申请一个
+ * chunk 并整体切分，chunk 中的块数随申请次数几何增长。超过 `largest_required_pool_block`
+ * 或对齐要求超过 `max_align` 的请求直接转发给上游。
+ *
+ * 释放的块回到对应的空闲链表中复用；`release()` 或析构时把所有内存一次性归还上游。
+ */
+class unsynchronized_pool_resource : public memory_resource {
+public:
+    unsynchronized_pool_resource()
+        : unsynchronized_pool_resource(pool_options(), get_default_resource()) {}
+
+    explicit unsynchronized_pool_resource(memory_resource* upstream)
+        : unsynchronized_pool_resource(pool_options(), upstream) {}
+
+    explicit unsynchronized_pool_resource(const pool_options& opts)
+        : unsynchronized_pool_resource(opts, get_default_resource()) {}
+
+    unsynchronized_pool_resource(const pool_options& opts, memory_resource* upstream);
+
+    unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+    unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+
+    ~unsynchronized_pool_resource() override {
+        release();
+    }
+
+    /**
+     * @brief 将所有内存归还上游。
+     */
+    void release() noexcept;
+
+    /**
+     * @brief 返回上游资源。
+     */
+    [[nodiscard]] memory_resource* upstream_resource() const noexcept {
+        return upstream_;
+    }
+
+    /**
+     * @brief 返回实际生效的配置项。
+     */
+    [[nodiscard]] pool_options options() const noexcept {
+        return options_;
+    }
+
+private:
+    static constexpr size_t min_block_size = 8;
+    static constexpr size_t max_pool_count = 16; // 8B ~ 256KB
+    static constexpr size_t default_largest_block = 4096;
+    static constexpr size_t default_max_blocks = 1024;
+    static constexpr size_t first_chunk_blocks = 8;
+
+    struct free_block {
+        free_block* next;
+    };
+
+    struct chunk_header {
+        chunk_header* next;
+        size_t bytes;
+    };
+
+    /**
+     * @brief 直接向上游申请的大块内存的头部，组成双向链表以支持 O(1) 释放。
+     */
+    struct large_header {
+        large_header* prev;
+        large_header* next;
+        void* base;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    /**
+     * @brief 单个尺寸级别的池。
+     */
+    struct pool {
+        free_block* free_list = nullptr;
+        chunk_header* chunks = nullptr;
+        size_t next_blocks = first_chunk_blocks;
+    };
+
+    static constexpr size_t chunk_header_size = detail::align_up(sizeof(chunk_header), max_align);
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    size_t pool_index(size_t bytes) const noexcept;
+    void refill(size_t index);
+    void* allocate_large(size_t bytes, size_t alignment);
+    void deallocate_large(void* ptr) noexcept;
+
+private:
+    memory_resource* upstream_; ///< 上游资源
+    pool_options options_; ///< 配置项
+    size_t pool_count_; ///< 尺寸级别数
+    pool pools_[max_pool_count]; ///< 各尺寸级别的池
+    large_header* large_; ///< 大块内存链表
+};
+
+inline unsynchronized_pool_resource::unsynchronized_pool_resource(const pool_options& opts,
+                                                                  memory_resource* upstream)
+    : upstream_(upstream), options_(opts), pool_count_(0), large_(nullptr) {
+    if (options_.max_blocks_per_chunk == 0)
+        options_.max_blocks_per_chunk = default_max_blocks;
+    if (options_.largest_required_pool_block == 0)
+        options_.largest_required_pool_block = default_largest_block;
+    size_t block = min_block_size;
+    pool_count_ = 1;
+    while (block < options_.largest_required_pool_block && pool_count_ < max_pool_count) {
+        block <<= 1;
+        ++pool_count_;
+    }
+    options_.largest_required_pool_block = block;
+}
+
+inline void unsynchronized_pool_resource::release() noexcept {
+    for (size_t i = 0; i < pool_count_; ++i) {
+        auto& p = pools_[i];
+        while (p.chunks != nullptr) {
+            chunk_header* next = p.chunks->next;
+            upstream_->deallocate(p.chunks, p.chunks->bytes, max_align);
+            p.chunks = next;
+        }
+        p.free_list = nullptr;
+        p.next_blocks = first_chunk_blocks;
+    }
+    while (large_ != nullptr) {
+        large_header* next = large_->next;
+        upstream_->deallocate(large_->base, large_->bytes, large_->alignment);
+        large_ = next;
+    }
+}
+
+inline size_t unsynchronized_pool_resource::pool_index(size_t bytes) const noexcept {
+    size_t index = 0;
+    size_t block = min_block_size;
+    while (block < bytes) {
+        block <<= 1;
+        ++index;
+    }
+    return index;
+}
+
+inline void* unsynchronized_pool_resource::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes > options_.largest_required_pool_block || alignment > max_align)
+        return allocate_large(bytes, alignment);
+    const size_t index = pool_index(bytes < alignment ? alignment : bytes);
+    auto& p = pools_[index];
+    if (p.free_list == nullptr)
+        refill(index);
+    free_block* block = p.free_list;
+    p.free_list = block->next;
+    return block;
+}
+
+inline void unsynchronized_pool_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    if (ptr == nullptr)
+        return;
+    if (bytes > options_.largest_required_pool_block || alignment > max_align) {
+        deallocate_large(ptr);
+        return;
+    }
+    auto& p = pools_[pool_index(bytes < alignment ? alignment : bytes)];
+    auto block = static_cast<free_block*>(ptr);
+    block->next = p.free_list;
+    p.free_list = block;
+}
+
+inline void unsynchronized_pool_resource::refill(size_t index) {
+    auto& p = pools_[index];
+    const size_t block_size = min_block_size << index;
+    size_t count = p.next_blocks;
+    const size_t bytes = chunk_header_size + block_size * count;
+    auto chunk = static_cast<chunk_header*>(upstream_->allocate(bytes, max_align));
+    chunk->next = p.chunks;
+    chunk->bytes = bytes;
+    p.chunks = chunk;
+    if (p.next_blocks < options_.max_blocks_per_chunk)
+        p.next_blocks = p.next_blocks * 2 > options_.max_blocks_per_chunk
+                            ? options_.max_blocks_per_chunk
+                            : p.next_blocks * 2;
+
+    // 按地址顺序串联，使连续分配得到的块在内存中相邻
+    char* first = reinterpret_cast<char*>(chunk) + chunk_header_size;
+    free_block* head = p.free_list;
+    for (; count > 0; --count) {
+        auto block = reinterpret_cast<free_block*>(first + (count - 1) * block_size);
+        block->next = head;
+        head = block;
+    }
+    p.free_list = head;
+}
+
+inline void* unsynchronized_pool_resource::allocate_large(size_t bytes, size_t alignment) {
+    if (alignment < max_align)
+        alignment = max_align;
+    const size_t offset = detail::align_up(sizeof(large_header), alignment);
+    const size_t total = offset + bytes;
+    void* base = upstream_->allocate(total, alignment);
+    auto result = static_cast<char*>(base) + offset;
+    auto header = reinterpret_cast<large_header*>(result - sizeof(large_header));
+    header->prev = nullptr;
+    header->next = large_;
+    header->base = base;
+    header->bytes = total;
+    header->alignment = alignment;
+    if (large_ != nullptr)
+        large_->prev = header;
+    large_ = header;
+    return result;
+}
+
+inline void unsynchronized_pool_resource::deallocate_large(void* ptr) noexcept {
+    auto header = reinterpret_cast<large_header*>(static_cast<char*>(ptr) - sizeof(large_header));
+    if (header->prev != nullptr)
+        header->prev->next = header->next;
+    else
+        large_ = header->next;
+    if (header->next != nullptr)
+        header->next->prev = header->prev;
+    upstream_->deallocate(header->base, header->bytes, header->alignment);
+}
+
+/**
+ * @brief 线程安全的内存池资源。
+ *
+ * 策略与 `unsynchronized_pool_resource` 相同，所有操作由互斥锁保护。
+ */
+class synchronized_pool_resource : public memory_resource {
+public:
+    synchronized_pool_resource() = default;
+
+    explicit synchronized_pool_resource(memory_resource* upstream)
+        : impl_(upstream) {}
+
+    explicit synchronized_pool_resource(const pool_options& opts)
+        : impl_(opts) {}
+
+    synchronized_pool_resource(const pool_options& opts, memory_resource* upstream)
+        : impl_(opts, upstream) {}
+
+    synchronized_pool_resource(const synchronized_pool_resource&) = delete;
+    synchronized_pool_resource& operator=(const synchronized_pool_resource&) = delete;
+
+    /**
+     * @brief 将所有内存归还上游。
+     */
+    void release() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        impl_.release();
+    }
+
+    /**
+     * @brief 返回上游资源。
+     */
+    [[nodiscard]] memory_resource* upstream_resource() const noexcept {
+        return impl_.upstream_resource();
+    }
+
+    /**
+     * @brief 返回实际生效的配置项。
+     */
+    [[nodiscard]] pool_options options() const noexcept {
+        return impl_.options();
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return impl_.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> guard(mutex_);
+        impl_.deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    std::mutex mutex_; ///< 保护 impl_ 的互斥锁
+    unsynchronized_pool_resource impl_; ///< 实际的池
+};
+
+/**
+ * @brief 以 `memory_resource` 为后端的有状态分配器。
+ *
+ * 接口与 `ccystl::allocator` 一致，但各方法都是成员函数，分配请求转发给构造时绑定的内存资源。
+ * 容器保存分配器对象，因此同一类型的容器可以使用不同的内存资源。
+ *
+ * @tparam T 分配器管理的对象类型。
+ */
+template <class T>
+class polymorphic_allocator {
+public:
+    using value_type = T; ///< 对象类型
+    using pointer = T*; ///< 指针类型
+    using const_pointer = const T*; ///< 常量指针类型
+    using reference = T&; ///< 引用类型
+    using const_reference = const T&; ///< 常量引用类型
+    using size_type = size_t; ///< 大小类型
+    using difference_type = ptrdiff_t; ///< 指针差值类型
+
+    /**
+     * @brief 将分配器重新绑定到另一种类型，绑定后仍使用同一个内存资源。
+     *
+     * @tparam U 新的对象类型。
+     */
+    template <class U>
+    struct rebind {
+        using other = polymorphic_allocator<U>; ///< 绑定到 U 的分配器类型
+    };
+
+public:
+    /**
+     * @brief 使用默认内存资源构造。
+     */
+    polymorphic_allocator() noexcept
+        : resource_(get_default_resource()) {}
+
+    /**
+     * @brief 使用指定的内存资源构造，允许由 `memory_resource*` 隐式转换。
+     *
+     * @param r 内存资源，不能为空。
+     */
+    polymorphic_allocator(memory_resource* r) noexcept
+        : resource_(r) {}
+
+    template <class U>
+    polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+        : resource_(other.resource()) {}
+
+    polymorphic_allocator(const polymorphic_allocator&) = default;
+    polymorphic_allocator& operator=(const polymorphic_allocator&) = default;
+
+    T* allocate() {
+        return allocate(1);
+    }
+
+    T* allocate(size_type n) {
+        if (n == 0)
+            return nullptr;
+        if (n > static_cast<size_type>(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+        return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr) {
+        deallocate(ptr, 1);
+    }
+
+    void deallocate(T* ptr, size_type n) {
+        if (ptr == nullptr)
+            return;
+        resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    template <class... Args>
+    void construct(T* ptr, Args&&... args) {
+        ccystl::construct(ptr, ccystl::forward<Args>(args)...);
+    }
+
+    void destroy(T* ptr) {
+        ccystl::destroy(ptr);
+    }
+
+    void destroy(T* first, T* last) {
+        ccystl::destroy(first, last);
+    }
+
+    /**
+     * @brief 返回绑定的内存资源。
+     */
+    [[nodiscard]] memory_resource* resource() const noexcept {
+        return resource_;
+    }
+
+private:
+    memory_resource* resource_; ///< 绑定的内存资源
+};
+
+template <class T, class U>
+bool operator==(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) noexcept {
+    return *lhs.resource() == *rhs.resource();
+}
+
+template <class T, class U>
+bool operator!=(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+} // namespace pmr
+} // namespace ccystl
+
+#endif // CCYSTL_MEMORY_RESOURCE_H_
@@ -0,0 +1,422 @@
+#ifndef CCYSTL_POOL_ALLOCATOR_H_
+#define CCYSTL_POOL_ALLOCATOR_H_
+
+/**
+ * @file pool_allocator.h
+ * @brief 该头文件定义了按尺寸分级的节点内存池 `node_pool` 与节点分配器 `pool_allocator`。
+ *
+ * `rb_tree`、`hashtable`、`list` 等节点式容器每次只申请一个节点。`pool_allocator`
+ * 从大块内存（chunk）中切出固定大小的块，并用侵入式空闲链表回收，
+ * 避免逐个节点调用 `::operator new`，同时让相邻插入的节点在内存中相邻。
+ *
+ * 用法：将 `pool_allocator` 作为容器的分配器参数传入，例如
+ * @code
+ * ccystl::map<int, int, ccystl::less<int>, ccystl::pool_allocator<ccystl::pair<const int, int>>> m;
+ * @endcode
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+
+#include "ccystl/allocator/construct.h"
+#include "ccystl/utils/utils.h"
+
+/**
+ * @def CCYSTL_POOL_CHUNK_SIZE
+ * @brief 内存池每次向系统申请的 chunk 大小（字节），可在包含本头文件前自行定义。
+ */
+#ifndef CCYSTL_POOL_CHUNK_SIZE
+#define CCYSTL_POOL_CHUNK_SIZE (64 * 1024)
+#endif // !CCYSTL_POOL_CHUNK_SIZE
+
+/**
+ * @def CCYSTL_POOL_MAX_BYTES
+ * @brief 由内存池负责的最大块大小（字节），超过此大小的对象直接使用 `::operator new`。
+ */
+#ifndef CCYSTL_POOL_MAX_BYTES
+#define CCYSTL_POOL_MAX_BYTES 512
+#endif // !CCYSTL_POOL_MAX_BYTES
+
+namespace ccystl {
+/**
+ * @brief 内存池中块的对齐粒度，也是尺寸分级的步长。
+ *
+ * 取 8 字节而不是 `alignof(std::max_align_t)`，使 40 字节的红黑树节点不会被填充到 48 字节；
+ * 对齐要求更高的类型不经过内存池。
+ */
+static constexpr size_t pool_align = 8;
+
+/**
+ * @brief 将字节数向上取整到 `pool_align` 的倍数，得到所属的尺寸级别。
+ *
+ * @param bytes 请求的字节数。
+ * @return size_t 对应尺寸级别的块大小。
+ */
+constexpr size_t pool_round_up(size_t bytes) noexcept {
+    return (bytes + pool_align - 1) & ~(pool_align - 1);
+}
+
+/**
+ * @brief 固定块大小的内存池。
+ *
+ * 每个 `node_pool` 只服务一种块大小。空闲块通过块内存本身串成单链表（侵入式空闲链表），
+ * 空闲链表为空时再向系统申请一个 chunk 并整体切分。chunk 在池的生命周期内不会归还，
+ * 被释放的块只会回到空闲链表中等待复用。
+ *
+ * 所有操作由一个自旋锁保护，可以在多线程中共享同一个池。
+ */
+class node_pool {
+public:
+    /**
+     * @brief 构造函数。
+     *
+     * @param block_size 块大小，会被向上取整到 `pool_align` 的倍数。
+     */
+    explicit node_pool(size_t block_size) noexcept;
+
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    /**
+     * @brief 析构函数，将所有 chunk 归还给系统。
+     */
+    ~node_pool();
+
+    /**
+     * @brief 从池中取出一个块。
+     *
+     * @return void* 指向块的指针。
+     * @throw std::bad_alloc 向系统申请 chunk 失败时抛出。
+     */
+    void* allocate();
+
+    /**
+     * @brief 将块归还到池中。
+     *
+     * @param ptr 由同一个池的 `allocate` 返回的指针。
+     */
+    void deallocate(void* ptr) noexcept;
+
+    /**
+     * @brief 返回块大小。
+     *
+     * @return size_t 块大小（字节）。
+     */
+    [[nodiscard]] size_t block_size() const noexcept {
+        return block_size_;
+    }
+
+    /**
+     * @brief 返回已向系统申请的 chunk 总字节数。
+     *
+     * @return size_t 池占用的内存字节数。
+     */
+    [[nodiscard]] size_t reserved_bytes() const noexcept {
+        return chunk_count_ * chunk_bytes_;
+    }
+
+private:
+    /**
+     * @brief 空闲块，复用块本身的内存保存链表指针。
+     */
+    struct free_block {
+        free_block* next;
+    };
+
+    /**
+     * @brief chunk 头部，串联所有已申请的 chunk 以便析构时释放。
+     */
+    struct chunk_header {
+        chunk_header* next;
+    };
+
+    static constexpr size_t chunk_header_size = alignof(std::max_align_t);
+
+    /**
+     * @brief 申请一个新的 chunk 并切分到空闲链表中。
+     */
+    void refill();
+
+    void lock() noexcept;
+    void unlock() noexcept;
+
+private:
+    size_t block_size_; ///< 块大小
+    size_t chunk_bytes_; ///< 每个 chunk 的字节数
+    size_t chunk_count_; ///< 已申请的 chunk 个数
+    free_block* free_list_; ///< 空闲链表头
+    chunk_header* chunks_; ///< chunk 链表头
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT; ///< 自旋锁
+};
+
+// 方法实现
+
+inline node_pool::node_pool(size_t block_size) noexcept
+    : block_size_(pool_round_up(block_size < sizeof(free_block) ? sizeof(free_block) : block_size)),
+      chunk_count_(0),
+      free_list_(nullptr),
+      chunks_(nullptr) {
+    // 一个 chunk 至少要能切出 32 个块
+    const size_t min_bytes = chunk_header_size + block_size_ * 32;
+    chunk_bytes_ = min_bytes > CCYSTL_POOL_CHUNK_SIZE ? min_bytes : CCYSTL_POOL_CHUNK_SIZE;
+}
+
+inline node_pool::~node_pool() {
+    while (chunks_ != nullptr) {
+        chunk_header* next = chunks_->next;
+        ::operator delete(chunks_);
+        chunks_ = next;
+    }
+}
+
+inline void* node_pool::allocate() {
+    lock();
+    if (free_list_ == nullptr) {
+        try {
+            refill();
+        }
+        catch (...) {
+            unlock();
+            throw;
+        }
+    }
+    free_block* block = free_list_;
+    free_list_ = block->next;
+    unlock();
+    return block;
+}
+
+inline void node_pool::deallocate(void* ptr) noexcept {
+    if (ptr == nullptr)
+        return;
+    auto block = static_cast<free_block*>(ptr);
+    lock();
+    block->next = free_list_;
+    free_list_ = block;
+    unlock();
+}
+
+inline void node_pool::refill() {
+    auto chunk = static_cast<chunk_header*>(::operator new(chunk_bytes_));
+    chunk->next = chunks_;
+    chunks_ = chunk;
+    ++chunk_count_;
+
+    // 按地址顺序串联，使连续分配得到的块在内存中相邻
+    char* first = reinterpret_cast<char*>(chunk) + chunk_header_size;
+    const size_t count = (chunk_bytes_ - chunk_header_size) / block_size_;
+    free_block* head = nullptr;
+    for (size_t i = count; i > 0; --i) {
+        auto block = reinterpret_cast<free_block*>(first + (i - 1) * block_size_);
+        block->next = head;
+        head = block;
+    }
+    free_list_ = head;
+}
+
+inline void node_pool::lock() noexcept {
+    while (lock_.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+inline void node_pool::unlock() noexcept {
+    lock_.clear(std::memory_order_release);
+}
+
+/**
+ * @brief 获取块大小为 `BlockSize` 的全局内存池。
+ *
+ * 同一尺寸级别的所有类型共享一个池。池对象在首次使用时创建且从不析构，
+ * 以保证静态存储期的容器在程序退出阶段析构时池仍然可用。
+ *
+ * @tparam BlockSize 块大小，必须是 `pool_align` 的倍数。
+ * @return node_pool& 对应尺寸级别的内存池。
+ */
+template <size_t BlockSize>
+node_pool& node_pool_instance() {
+    static_assert(BlockSize % pool_align == 0, "BlockSize must be a multiple of pool_align");
+    static node_pool* pool = new node_pool(BlockSize);
+    return *pool;
+}
+
+/**
+ * @brief 节点分配器，单个对象的分配由尺寸分级内存池负责。
+ *
+ * 接口与 `ccystl::allocator` 一致。`allocate()` / `allocate(1)` 从 `sizeof(T)`
+ * 所在尺寸级别的 `node_pool` 中取块；批量分配或超过 `CCYSTL_POOL_MAX_BYTES`
+ * 的对象仍使用 `::operator new`。
+ *
+ * @tparam T 分配器管理的对象类型。
+ */
+template <class T>
+class pool_allocator {
+public:
+    using value_type = T; ///< 对象类型
+    using pointer = T*; ///< 指针类型
+    using const_pointer = const T*; ///< 常量指针类型
+    using reference = T&; ///< 引用类型
+    using const_reference = const T&; ///< 常量引用类型
+    using size_type = size_t; ///< 大小类型
+    using difference_type = ptrdiff_t; ///< 指针差值类型
+
+    /**
+     * @brief 将分配器重新绑定到另一种类型。
+     *
+     * @tparam U 新的对象类型。
+     */
+    template <class U>
+    struct rebind {
+        using other = pool_allocator<U>; ///< 绑定到 U 的分配器类型
+    };
+
+    constexpr pool_allocator() noexcept = default;
+
+    /**
+     * @brief 由绑定到其他类型的分配器构造。分配器无状态，因此什么也不做。
+     */
+    template <class U>
+    constexpr pool_allocator(const pool_allocator<U>&) noexcept {}
+
+    /**
+     * @brief 类型 T 是否由内存池负责分配。
+     */
+    static constexpr bool use_pool = sizeof(T) <= CCYSTL_POOL_MAX_BYTES && alignof(T) <= pool_align;
+
+public:
+    /**
+     * @brief 分配单个对象的内存。
+     *
+     * @return T* 指向分配的内存的指针。
+     */
+    static T* allocate();
+
+    /**
+     * @brief 分配多个对象的内存，n 为 1 时从内存池中分配。
+     *
+     * @param n 要分配的对象数量。
+     * @return T* 指向分配的内存的指针，如果 n 为 0 则返回 nullptr。
+     */
+    static T* allocate(size_type n);
+
+    /**
+     * @brief 释放单个对象的内存。
+     *
+     * @param ptr 指向要释放的内存的指针。
+     */
+    static void deallocate(T* ptr);
+
+    /**
+     * @brief 释放多个对象的内存，n 必须与分配时一致。
+     *
+     * @param ptr 指向要释放的内存的指针。
+     * @param n 要释放的对象数量。
+     */
+    static void deallocate(T* ptr, size_type n);
+
+    /**
+     * @brief 在分配的内存上构造对象，并使用可变参数进行初始化。
+     *
+     * @tparam Args 用于构造对象的参数类型。
+     * @param ptr 指向要构造对象的内存的指针。
+     * @param args 用于初始化对象的参数。
+     */
+    template <class... Args>
+    static void construct(T* ptr, Args&&... args);
+
+    /**
+     * @brief 调用单个对象的析构函数。
+     *
+     * @param ptr 指向要销毁的对象的指针。
+     */
+    static void destroy(T* ptr);
+
+    /**
+     * @brief 调用多个对象的析构函数。
+     *
+     * @param first 指向要销毁的第一个对象的指针。
+     * @param last 指向要销毁的最后一个对象之后的指针。
+     */
+    static void destroy(T* first, T* last);
+
+    /**
+     * @brief 返回类型 T 所在尺寸级别的内存池。
+     *
+     * @return node_pool& 对应的内存池。
+     */
+    static node_pool& pool() {
+        return node_pool_instance<pool_round_up(sizeof(T))>();
+    }
+};
+
+// 方法实现
+
+template <class T>
+T* pool_allocator<T>::allocate() {
+    if constexpr (use_pool)
+        return static_cast<T*>(pool().allocate());
+    else
+        return static_cast<T*>(::operator new(sizeof(T)));
+}
+
+template <class T>
+T* pool_allocator<T>::allocate(size_type n) {
+    if (n == 0)
+        return nullptr;
+    if (n == 1)
+        return allocate();
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+}
+
+template <class T>
+void pool_allocator<T>::deallocate(T* ptr) {
+    if (ptr == nullptr)
+        return;
+    if constexpr (use_pool)
+        pool().deallocate(ptr);
+    else
+        ::operator delete(ptr);
+}
+
+template <class T>
+void pool_allocator<T>::deallocate(T* ptr, size_type n) {
+    if (ptr == nullptr)
+        return;
+    if (n == 1)
+        deallocate(ptr);
+    else
+        ::operator delete(ptr);
+}
+
+template <class T>
+template <class... Args>
+void pool_allocator<T>::construct(T* ptr, Args&&... args) {
+    ccystl::construct(ptr, ccystl::forward<Args>(args)...);
+}
+
+template <class T>
+void pool_allocator<T>::destroy(T* ptr) {
+    ccystl::destroy(ptr);
+}
+
+template <class T>
+void pool_allocator<T>::destroy(T* first, T* last) {
+    ccystl::destroy(first, last);
+}
+
+// 无状态分配器的所有实例都可以互相释放对方分配的内存
+
+template <class T, class U>
+constexpr bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {
+    return true;
+}
+
+template <class T, class U>
+constexpr bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) noexcept {
+    return false;
+}
+} // namespace ccystl
+
+#endif // CCYSTL_POOL_ALLOCATOR_H_
@@ -0,0 +1,472 @@
+#ifndef CCYSTL_THREAD_CACHE_ALLOCATOR_H_
+#define CCYSTL_THREAD_CACHE_ALLOCATOR_H_
+
+/**
+ * @file thread_cache_allocator.h
+ * @brief 该头文件定义了线程本地缓存堆 `thread_heap` 与分配器 `thread_cache_allocator`。
+ *
+ * 每个线程拥有一个 `thread_heap`，按尺寸级别缓存小块内存，本线程的分配与释放不需要任何同步。
+ * 块总是从对齐到 `CCYSTL_THREAD_CACHE_SPAN_SIZE` 的 span 中切出，span 头部记录所属的堆，
+ * 因此释放时只需将指针按 span 大小向下对齐即可找到所属的堆：
+ * - 所属堆就是当前线程的堆时，块直接回到本地空闲链表；
+ * - 否则块被无锁地压入所属堆的远程释放链表，由所属线程在下次缓存耗尽时整体取回。
+ *
+ * 线程退出时其堆不会被销毁，而是放入全局的待领养列表，由之后创建的线程接管，
+ * 仍在其他线程中存活的块因此始终有合法的归属。
+ *
+ * 用法：将 `thread_cache_allocator` 作为容器的分配器参数传入，例如
+ * @code
+ * ccystl::vector<int, ccystl::thread_cache_allocator<int>> v;
+ * @endcode
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#include "ccystl/allocator/construct.h"
+#include "ccystl/utils/utils.h"
+
+/**
+ * @def CCYSTL_THREAD_CACHE_SPAN_SIZE
+ * @brief 线程堆每次向系统申请的 span 大小（字节），必须是 2 的幂，可在包含本头文件前自行定义。
+ */
+#ifndef CCYSTL_THREAD_CACHE_SPAN_SIZE
+#define CCYSTL_THREAD_CACHE_SPAN_SIZE (64 * 1024)
+#endif // !CCYSTL_THREAD_CACHE_SPAN_SIZE
+
+/**
+ * @def CCYSTL_THREAD_CACHE_MAX_BYTES
+ * @brief 由线程缓存负责的最大块大小（字节），超过此大小的请求直接使用 `::operator new`。
+ */
+#ifndef CCYSTL_THREAD_CACHE_MAX_BYTES
+#define CCYSTL_THREAD_CACHE_MAX_BYTES 256
+#endif // !CCYSTL_THREAD_CACHE_MAX_BYTES
+
+namespace ccystl {
+/**
+ * @brief 线程缓存中块的对齐粒度，也是尺寸分级的步长。
+ */
+static constexpr size_t thread_cache_align = alignof(std::max_align_t);
+
+/**
+ * @brief 线程缓存的尺寸级别个数。
+ */
+static constexpr size_t thread_cache_class_count =
+    (CCYSTL_THREAD_CACHE_MAX_BYTES + thread_cache_align - 1) / thread_cache_align;
+
+static_assert((CCYSTL_THREAD_CACHE_SPAN_SIZE & (CCYSTL_THREAD_CACHE_SPAN_SIZE - 1)) == 0,
+              "CCYSTL_THREAD_CACHE_SPAN_SIZE must be a power of two");
+
+/**
+ * @brief 判断大小为 bytes、对齐为 align 的请求是否由线程缓存负责。
+ *
+ * @param bytes 请求的字节数。
+ * @param align 请求的对齐要求。
+ * @return bool 由线程缓存负责时返回 true。
+ */
+constexpr bool thread_cache_eligible(size_t bytes, size_t align) noexcept {
+    return bytes != 0 && bytes <= CCYSTL_THREAD_CACHE_MAX_BYTES && align <= thread_cache_align;
+}
+
+/**
+ * @brief 线程本地缓存堆。
+ *
+ * 每个尺寸级别维护一个只由所属线程访问的本地空闲链表；其他线程释放的块经由
+ * 一个无锁栈 `remote_free_` 交还。远程释放方只做压栈（CAS），所属线程一次性
+ * `exchange` 取走整个栈，单消费者的取法不存在 ABA 问题。
+ *
+ * span 在堆的生命周期内不会归还，堆本身也从不销毁：线程退出时堆进入待领养列表，
+ * 新线程优先领养已有的堆，因此堆的数量不超过同时存活的线程数的峰值。
+ */
+class thread_heap {
+public:
+    thread_heap() noexcept;
+
+    thread_heap(const thread_heap&) = delete;
+    thread_heap& operator=(const thread_heap&) = delete;
+
+    /**
+     * @brief 返回当前线程的堆，首次调用时领养或创建一个。
+     *
+     * @return thread_heap& 当前线程的堆。
+     */
+    static thread_heap& local();
+
+    /**
+     * @brief 从当前线程的堆中分配一个 bytes 字节的块。
+     *
+     * @param bytes 请求的字节数，需满足 `thread_cache_eligible`。
+     * @return void* 指向块的指针。
+     * @throw std::bad_alloc 向系统申请 span 失败时抛出。
+     */
+    static void* allocate(size_t bytes) {
+        return local().allocate_class(class_index(bytes));
+    }
+
+    /**
+     * @brief 释放一个由 `allocate` 返回的块，可以在任意线程中调用。
+     *
+     * @param ptr 指向块的指针。
+     */
+    static void deallocate(void* ptr) noexcept;
+
+    /**
+     * @brief 返回该堆已向系统申请的 span 总字节数。
+     *
+     * @return size_t 堆占用的内存字节数。
+     */
+    [[nodiscard]] size_t reserved_bytes() const noexcept {
+        return span_count_ * CCYSTL_THREAD_CACHE_SPAN_SIZE;
+    }
+
+private:
+    /**
+     * @brief 空闲块，复用块本身的内存保存链表指针。
+     */
+    struct free_block {
+        free_block* next;
+    };
+
+    /**
+     * @brief span 头部，记录所属的堆与尺寸级别。
+     */
+    struct span_header {
+        thread_heap* owner;
+        size_t class_index;
+    };
+
+    static constexpr size_t span_header_size =
+        (sizeof(span_header) + thread_cache_align - 1) & ~(thread_cache_align - 1);
+
+    /**
+     * @brief 将字节数映射到尺寸级别下标。
+     */
+    static constexpr size_t class_index(size_t bytes) noexcept {
+        return (bytes - 1) / thread_cache_align;
+    }
+
+    /**
+     * @brief 由块指针找到其所在 span 的头部。
+     */
+    static span_header* span_of(void* ptr) noexcept {
+        const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+        return reinterpret_cast<span_header*>(addr & ~std::uintptr_t(CCYSTL_THREAD_CACHE_SPAN_SIZE - 1));
+    }
+
+    void* allocate_class(size_t index);
+
+    /**
+     * @brief 将远程释放链表中的块全部取回到本地空闲链表。
+     *
+     * @return bool 取回了至少一个块时返回 true。
+     */
+    bool drain_remote() noexcept;
+
+    /**
+     * @brief 为尺寸级别 index 申请一个新的 span 并切分到本地空闲链表中。
+     */
+    void refill(size_t index);
+
+    /**
+     * @brief 由其他线程调用，将块压入本堆的远程释放链表。
+     */
+    void push_remote(free_block* block) noexcept;
+
+    static thread_heap* acquire();
+    static void abandon(thread_heap* heap) noexcept;
+
+    /**
+     * @brief 线程退出时将堆放入待领养列表。
+     */
+    struct releaser {
+        ~releaser();
+    };
+
+    static thread_heap*& tls_heap() noexcept {
+        static thread_local thread_heap* heap = nullptr;
+        return heap;
+    }
+
+    static std::mutex& abandoned_mutex() noexcept {
+        static std::mutex m;
+        return m;
+    }
+
+    static thread_heap*& abandoned_list() noexcept {
+        static thread_heap* head = nullptr;
+        return head;
+    }
+
+private:
+    free_block* free_[thread_cache_class_count]; ///< 各尺寸级别的本地空闲链表
+    std::atomic<free_block*> remote_free_; ///< 其他线程释放的块
+    size_t span_count_; ///< 已申请的 span 个数
+    thread_heap* next_abandoned_; ///< 待领养列表中的下一个堆
+};
+
+// 方法实现
+
+inline thread_heap::thread_heap() noexcept
+    : remote_free_(nullptr),
+      span_count_(0),
+      next_abandoned_(nullptr) {
+    for (auto& head : free_)
+        head = nullptr;
+}
+
+inline thread_heap::releaser::~releaser() {
+    thread_heap*& heap = tls_heap();
+    abandon(heap);
+    heap = nullptr;
+}
+
+inline thread_heap& thread_heap::local() {
+    thread_heap*& heap = tls_heap();
+    if (heap == nullptr) {
+        heap = acquire();
+        // 首次访问 thread_local 的 releaser 会注册其析构函数；
+        // 若线程退出阶段（releaser 已析构）再次分配，该堆不再归还，只占用一个堆对象
+        static thread_local releaser r;
+        (void)r;
+    }
+    return *heap;
+}
+
+inline thread_heap* thread_heap::acquire() {
+    {
+        std::lock_guard<std::mutex> guard(abandoned_mutex());
+        thread_heap*& head = abandoned_list();
+        if (head != nullptr) {
+            thread_heap* heap = head;
+            head = heap->next_abandoned_;
+            heap->next_abandoned_ = nullptr;
+            return heap;
+        }
+    }
+    return new thread_heap();
+}
+
+inline void thread_heap::abandon(thread_heap* heap) noexcept {
+    if (heap == nullptr)
+        return;
+    std::lock_guard<std::mutex> guard(abandoned_mutex());
+    thread_heap*& head = abandoned_list();
+    heap->next_abandoned_ = head;
+    head = heap;
+}
+
+inline void* thread_heap::allocate_class(size_t index) {
+    if (free_[index] == nullptr && !(drain_remote() && free_[index] != nullptr))
+        refill(index);
+    free_block* block = free_[index];
+    free_[index] = block->next;
+    return block;
+}
+
+inline void thread_heap::deallocate(void* ptr) noexcept {
+    if (ptr == nullptr)
+        return;
+    auto block = static_cast<free_block*>(ptr);
+    span_header* span = span_of(ptr);
+    thread_heap* owner = span->owner;
+    if (owner == tls_heap()) {
+        block->next = owner->free_[span->class_index];
+        owner->free_[span->class_index] = block;
+    }
+    else {
+        owner->push_remote(block);
+    }
+}
+
+inline void thread_heap::push_remote(free_block* block) noexcept {
+    free_block* head = remote_free_.load(std::memory_order_relaxed);
+    do {
+        block->next = head;
+    } while (!remote_free_.compare_exchange_weak(head, block, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+}
+
+inline bool thread_heap::drain_remote() noexcept {
+    if (remote_free_.load(std::memory_order_relaxed) == nullptr)
+        return false;
+    free_block* block = remote_free_.exchange(nullptr, std::memory_order_acquire);
+    const bool drained = block != nullptr;
+    while (block != nullptr) {
+        free_block* next = block->next;
+        const size_t index = span_of(block)->class_index;
+        block->next = free_[index];
+        free_[index] = block;
+        block = next;
+    }
+    return drained;
+}
+
+inline void thread_heap::refill(size_t index) {
+    void* mem = ::operator new(CCYSTL_THREAD_CACHE_SPAN_SIZE,
+                               std::align_val_t(CCYSTL_THREAD_CACHE_SPAN_SIZE));
+    auto span = static_cast<span_header*>(mem);
+    span->owner = this;
+    span->class_index = index;
+    ++span_count_;
+
+    // 按地址顺序串联，使连续分配得到的块在内存中相邻
+    const size_t block_size = (index + 1) * thread_cache_align;
+    char* first = static_cast<char*>(mem) + span_header_size;
+    const size_t count = (CCYSTL_THREAD_CACHE_SPAN_SIZE - span_header_size) / block_size;
+    free_block* head = free_[index];
+    for (size_t i = count; i > 0; --i) {
+        auto block = reinterpret_cast<free_block*>(first + (i - 1) * block_size);
+        block->next = head;
+        head = block;
+    }
+    free_[index] = head;
+}
+
+/**
+ * @brief 线程本地缓存分配器。
+ *
+ * 接口与 `ccystl::allocator` 一致。`allocate(n)` 请求的 `n * sizeof(T)` 字节不超过
+ * `CCYSTL_THREAD_CACHE_MAX_BYTES` 且对齐要求不超过 `thread_cache_align` 时，
+ * 由当前线程的 `thread_heap` 分配；否则使用 `::operator new`。
+ * 块可以在任意线程中释放，跨线程释放的块会无锁地交还给分配它的线程。
+ *
+ * @tparam T 分配器管理的对象类型。
+ */
+template <class T>
+class thread_cache_allocator {
+public:
+    using value_type = T; ///< 对象类型
+    using pointer = T*; ///< 指针类型
+    using const_pointer = const T*; ///< 常量指针类型
+    using reference = T&; ///< 引用类型
+    using const_reference = const T&; ///< 常量引用类型
+    using size_type = size_t; ///< 大小类型
+    using difference_type = ptrdiff_t; ///< 指针差值类型
+
+    /**
+     * @brief 将分配器重新绑定到另一种类型。
+     *
+     * @tparam U 新的对象类型。
+     */
+    template <class U>
+    struct rebind {
+        using other = thread_cache_allocator<U>; ///< 绑定到 U 的分配器类型
+    };
+
+    constexpr thread_cache_allocator() noexcept = default;
+
+    /**
+     * @brief 由绑定到其他类型的分配器构造。分配器无状态，因此什么也不做。
+     */
+    template <class U>
+    constexpr thread_cache_allocator(const thread_cache_allocator<U>&) noexcept {}
+
+public:
+    /**
+     * @brief 分配单个对象的内存。
+     *
+     * @return T* 指向分配的内存的指针。
+     */
+    static T* allocate() {
+        return allocate(1);
+    }
+
+    /**
+     * @brief 分配多个对象的内存。
+     *
+     * @param n 要分配的对象数量。
+     * @return T* 指向分配的内存的指针，如果 n 为 0 则返回 nullptr。
+     * @throw std::bad_alloc n 过大或申请内存失败时抛出。
+     */
+    static T* allocate(size_type n);
+
+    /**
+     * @brief 释放单个对象的内存。
+     *
+     * @param ptr 指向要释放的内存的指针。
+     */
+    static void deallocate(T* ptr) {
+        deallocate(ptr, 1);
+    }
+
+    /**
+     * @brief 释放多个对象的内存，n 必须与分配时一致。
+     *
+     * @param ptr 指向要释放的内存的指针。
+     * @param n 要释放的对象数量。
+     */
+    static void deallocate(T* ptr, size_type n);
+
+    /**
+     * @brief 在分配的内存上构造对象，并使用可变参数进行初始化。
+     *
+     * @tparam Args 用于构造对象的参数类型。
+     * @param ptr 指向要构造对象的内存的指针。
+     * @param args 用于初始化对象的参数。
+     */
+    template <class... Args>
+    static void construct(T* ptr, Args&&... args) {
+        ccystl::construct(ptr, ccystl::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 调用单个对象的析构函数。
+     *
+     * @param ptr 指向要销毁的对象的指针。
+     */
+    static void destroy(T* ptr) {
+        ccystl::destroy(ptr);
+    }
+
+    /**
+     * @brief 调用多个对象的析构函数。
+     *
+     * @param first 指向要销毁的第一个对象的指针。
+     * @param last 指向要销毁的最后一个对象之后的指针。
+     */
+    static void destroy(T* first, T* last) {
+        ccystl::destroy(first, last);
+    }
+};
+
+// 方法实现
+
+template <class T>
+T* thread_cache_allocator<T>::allocate(size_type n) {
+    if (n == 0)
+        return nullptr;
+    if (n > static_cast<size_type>(-1) / sizeof(T))
+        throw std::bad_alloc();
+    const size_t bytes = n * sizeof(T);
+    if (thread_cache_eligible(bytes, alignof(T)))
+        return static_cast<T*>(thread_heap::allocate(bytes));
+    return static_cast<T*>(::operator new(bytes));
+}
+
+template <class T>
+void thread_cache_allocator<T>::deallocate(T* ptr, size_type n) {
+    if (ptr == nullptr)
+        return;
+    if (thread_cache_eligible(n * sizeof(T), alignof(T)))
+        thread_heap::deallocate(ptr);
+    else
+        ::operator delete(ptr);
+}
+
+// 无状态分配器的所有实例都可以互相释放对方分配的内存
+
+template <class T, class U>
+constexpr bool operator==(const thread_cache_allocator<T>&, const thread_cache_allocator<U>&) noexcept {
+    return true;
+}
+
+template <class T, class U>
+constexpr bool operator!=(const thread_cache_allocator<T>&, const thread_cache_allocator<U>&) noexcept {
+    return false;
+}
+} // namespace ccystl
+
+#endif // CCYSTL_THREAD_CACHE_ALLOCATOR_H_
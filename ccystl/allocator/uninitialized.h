@@ -8,6 +8,8 @@
  * 提供了多种模板函数用于在未初始化的内存区域内构造对象，包括拷贝构造、填充构造和移动构造等。
  */
 
+#include <cstring>
+
 #include "ccystl/algorithm/algobase.h"
 #include "ccystl/iterator/iterator.h"
 #include "ccystl/utils/utils.h"
@@ -39,8 +41,9 @@ ForwardIter unchecked_uninit_copy(InputIter first, InputIter last, ForwardIter r
         }
     }
     catch (...) {
-        for (; result != cur; --cur)
-            ccystl::destroy(&*cur);
+        for (; result != cur; ++result)
+            ccystl::destroy(&*result);
+        throw;
     }
     return cur;
 }
@@ -79,8 +82,9 @@ ForwardIter unchecked_uninit_copy_n(InputIter first, Size n, ForwardIter result,
         }
     }
     catch (...) {
-        for (; result != cur; --cur)
-            ccystl::destroy(&*cur);
+        for (; result != cur; ++result)
+            ccystl::destroy(&*result);
+        throw;
     }
     return cur;
 }
@@ -119,6 +123,7 @@ void unchecked_uninit_fill(ForwardIter first, ForwardIter last, const T& value,
     catch (...) {
         for (; first != cur; ++first)
             ccystl::destroy(&*first);
+        throw;
     }
 }
 
@@ -158,6 +163,7 @@ ForwardIter unchecked_uninit_fill_n(ForwardIter first, Size n, const T& value, s
     catch (...) {
         for (; first != cur; ++first)
             ccystl::destroy(&*first);
+        throw;
     }
     return cur;
 }
@@ -196,6 +202,7 @@ ForwardIter unchecked_uninit_move(InputIter first, InputIter last, ForwardIter r
     }
     catch (...) {
         ccystl::destroy(result, cur);
+        throw;
     }
     return cur;
 }
@@ -247,6 +254,69 @@ ForwardIter uninitialized_move_n(InputIter first, Size n, ForwardIter result) {
                                            std::is_trivially_move_assignable<typename iterator_traits<
                                                InputIter>::value_type>{});
 }
+/**
+ * @brief 将对象重定位到未初始化的内存区域内。
+ *
+ * 重定位即在目标处移动构造对象并析构源对象，完成后 `[first, last)` 成为未初始化的内存。
+ * 对满足 `is_trivially_relocatable` 的类型，整个区间直接按字节 `memmove`，
+ * 此时源区间与目标区间允许重叠；其余类型逐个移动构造，源区间与目标区间不能重叠。
+ *
+ * 若移动构造抛出异常，已构造的目标对象会被析构，源对象全部保留（部分可能处于被移动后的状态）。
+ *
+ * @tparam T 对象类型。
+ * @param first 源范围的起始指针。
+ * @param last 源范围的结束指针。
+ * @param result 目标未初始化空间的起始指针。
+ * @return T* 重定位结束的位置。
+ */
+template <class T>
+T* unchecked_uninit_relocate(T* first, T* last, T* result, std::true_type) noexcept {
+    const auto n = static_cast<size_t>(last - first);
+    if (n != 0)
+        std::memmove(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+    return result + n;
+}
+
+template <class T>
+T* unchecked_uninit_relocate(T* first, T* last, T* result, std::false_type) {
+    T* cur = result;
+    try {
+        for (T* src = first; src != last; ++src, ++cur) {
+            ccystl::construct(cur, ccystl::move(*src));
+        }
+    }
+    catch (...) {
+        ccystl::destroy(result, cur);
+        throw;
+    }
+    ccystl::destroy(first, last);
+    return cur;
+}
+
+template <class T>
+T* uninitialized_relocate(T* first, T* last, T* result) {
+    return ccystl::unchecked_uninit_relocate(first, last, result,
+                                             std::bool_constant<is_trivially_relocatable_v<T>>{});
+}
+
+/**
+ * @brief 判断分配器是否提供原地扩容接口 `reallocate(ptr, old_n, new_n)`。
+ *
+ * 提供该接口的分配器（如 `malloc_allocator`）可以用 `realloc` 调整一块内存的大小，
+ * 容器只会对可平凡重定位的元素使用它，因为内存块可能被按字节搬移到新的地址。
+ *
+ * @tparam Alloc 分配器类型。
+ */
+template <class Alloc, class = void>
+struct allocator_has_reallocate : std::false_type { };
+
+template <class Alloc>
+struct allocator_has_reallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+                                           std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>>
+    : std::true_type { };
+
+template <class Alloc>
+inline constexpr bool allocator_has_reallocate_v = allocator_has_reallocate<Alloc>::value;
 } // namespace ccystl
 
 #endif // CCYSTL_UNINITIALIZED_H_
@@ -0,0 +1,784 @@
+#ifndef CCYSTL_BTREE_MAP_H_
+#define CCYSTL_BTREE_MAP_H_
+
+// 这个头文件包含两个模板类 btree_map 和 btree_multimap
+// btree_map      : 映射，接口与 map 相同，底层使用 B+ 树，键值不允许重复
+// btree_multimap : 映射，接口与 multimap 相同，底层使用 B+ 树，键值允许重复
+
+// notes:
+//
+// 与 map / multimap 的区别：
+//   * 元素连续存放在叶节点中，查找与顺序遍历的缓存命中率远高于 rb_tree
+//   * 插入与删除会使所有迭代器、指针和引用失效，erase 返回指向下一个元素的迭代器
+//   * 没有节点句柄，不提供 extract / merge
+//
+// 异常保证：
+// ccystl::btree_map<Key, T> / ccystl::btree_multimap<Key, T> 满足基本异常保证，对以下等函数做强异常安全保证：
+//   * emplace
+//   * emplace_hint
+//   * insert
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/internal/btree.h"
+
+namespace ccystl {
+// 模板类 btree_map，键值不允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 ccystl::less
+// 参数四代表分配器类型，缺省使用 ccystl::allocator，可传入 ccystl::pool_allocator 使用节点内存池
+template <class Key, class T, class Compare = ccystl::less<Key>,
+          class Alloc = ccystl::allocator<ccystl::pair<const Key, T>>>
+class btree_map {
+public:
+    // btree_map 的嵌套型别定义
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef ccystl::pair<const Key, T> value_type;
+    typedef Compare key_compare;
+
+    // 定义一个 functor，用来进行元素比较
+    class value_compare : public binary_function<value_type, value_type, bool> {
+        friend class btree_map;
+
+    private:
+        Compare comp;
+        explicit value_compare(Compare c) : comp(c) { }
+
+    public:
+        bool operator()(const value_type& lhs, const value_type& rhs) const {
+            return comp(lhs.first, rhs.first); // 比较键值的大小
+        }
+    };
+
+private:
+    // 以 ccystl::btree 作为底层机制
+    typedef ccystl::btree<value_type, key_compare, Alloc> base_type;
+    base_type tree_;
+
+public:
+    // 使用 btree 的型别
+    typedef typename base_type::pointer pointer;
+    typedef typename base_type::const_pointer const_pointer;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::const_reference const_reference;
+    typedef typename base_type::iterator iterator;
+    typedef typename base_type::const_iterator const_iterator;
+    typedef typename base_type::reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type size_type;
+    typedef typename base_type::difference_type difference_type;
+    typedef typename base_type::allocator_type allocator_type;
+
+public:
+    // 构造、复制、移动、赋值函数
+
+    btree_map() = default;
+
+    explicit btree_map(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit btree_map(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
+    template <class InputIterator>
+    btree_map(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(first, last);
+    }
+
+    btree_map(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(ilist.begin(), ilist.end());
+    }
+
+    btree_map(const btree_map& rhs)
+        : tree_(rhs.tree_) { }
+
+    btree_map(const btree_map& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
+    btree_map(btree_map&& rhs) noexcept
+        : tree_(ccystl::move(rhs.tree_)) { }
+
+    btree_map& operator=(const btree_map& rhs) = default;
+
+    btree_map& operator=(btree_map&& rhs) noexcept {
+        tree_ = ccystl::move(rhs.tree_);
+        return *this;
+    }
+
+    btree_map& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    // 相关接口
+
+    key_compare key_comp() const {
+        return tree_.key_comp();
+    }
+
+    value_compare value_comp() const {
+        return value_compare(tree_.key_comp());
+    }
+
+    allocator_type get_allocator() const {
+        return tree_.get_allocator();
+    }
+
+    // 迭代器相关
+
+    iterator begin() noexcept {
+        return tree_.begin();
+    }
+
+    const_iterator begin() const noexcept {
+        return tree_.begin();
+    }
+
+    iterator end() noexcept {
+        return tree_.end();
+    }
+
+    const_iterator end() const noexcept {
+        return tree_.end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关
+    [[nodiscard]] bool empty() const noexcept {
+        return tree_.empty();
+    }
+
+    size_type size() const noexcept {
+        return tree_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return tree_.max_size();
+    }
+
+    // 访问元素相关
+
+    // 若键值不存在，at 会抛出一个异常
+    mapped_type& at(const key_type& key) {
+        iterator it = lower_bound(key);
+        // it->first >= key
+        THROW_OUT_OF_RANGE_IF(it == end() || key_comp()(it->first, key),
+                              "btree_map<Key, T> no such element exists");
+        return it->second;
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        const_iterator it = lower_bound(key);
+        // it->first >= key
+        THROW_OUT_OF_RANGE_IF(it == end() || key_comp()(it->first, key),
+                              "btree_map<Key, T> no such element exists");
+        return it->second;
+    }
+
+    mapped_type& operator[](const key_type& key) {
+        iterator it = lower_bound(key);
+        // it->first >= key
+        if (it == end() || key_comp()(key, it->first))
+            it = emplace_hint(it, key, T{});
+        return it->second;
+    }
+
+    mapped_type& operator[](key_type&& key) {
+        iterator it = lower_bound(key);
+        // it->first >= key
+        if (it == end() || key_comp()(key, it->first))
+            it = emplace_hint(it, ccystl::move(key), T{});
+        return it->second;
+    }
+
+    // 插入删除相关
+
+    template <class... Args>
+    pair<iterator, bool> emplace(Args&&... args) {
+        return tree_.emplace_unique(ccystl::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args&&... args) {
+        return tree_.emplace_unique_use_hint(hint, ccystl::forward<Args>(args)...);
+    }
+
+    pair<iterator, bool> insert(const value_type& value) {
+        return tree_.insert_unique(value);
+    }
+
+    pair<iterator, bool> insert(value_type&& value) {
+        return tree_.insert_unique(ccystl::move(value));
+    }
+
+    iterator insert(iterator hint, const value_type& value) {
+        return tree_.insert_unique(hint, value);
+    }
+
+    iterator insert(iterator hint, value_type&& value) {
+        return tree_.insert_unique(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_unique(first, last);
+    }
+
+    // 返回指向下一个元素的迭代器，其余迭代器全部失效
+    iterator erase(const_iterator position) {
+        return tree_.erase(position);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase_unique(key);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() {
+        tree_.clear();
+    }
+
+    // btree_map 相关操作
+
+    iterator find(const key_type& key) {
+        return tree_.find(key);
+    }
+
+    const_iterator find(const key_type& key) const {
+        return tree_.find(key);
+    }
+
+    size_type count(const key_type& key) const {
+        return tree_.count_unique(key);
+    }
+
+    iterator lower_bound(const key_type& key) {
+        return tree_.lower_bound(key);
+    }
+
+    const_iterator lower_bound(const key_type& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    iterator upper_bound(const key_type& key) {
+        return tree_.upper_bound(key);
+    }
+
+    const_iterator upper_bound(const key_type& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range_unique(key);
+    }
+
+    pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range_unique(key);
+    }
+
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_unique(key);
+    }
+
+    void swap(btree_map& rhs) noexcept {
+        tree_.swap(rhs.tree_);
+    }
+
+public:
+    friend bool operator==(const btree_map& lhs, const btree_map& rhs) {
+        return lhs.tree_ == rhs.tree_;
+    }
+
+    friend bool operator<(const btree_map& lhs, const btree_map& rhs) {
+        return lhs.tree_ < rhs.tree_;
+    }
+};
+
+// 重载比较操作符
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const btree_map<Key, T, Compare, Alloc>& lhs, const btree_map<Key, T, Compare, Alloc>& rhs) {
+    return lhs == rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<(const btree_map<Key, T, Compare, Alloc>& lhs, const btree_map<Key, T, Compare, Alloc>& rhs) {
+    return lhs < rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const btree_map<Key, T, Compare, Alloc>& lhs, const btree_map<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>(const btree_map<Key, T, Compare, Alloc>& lhs, const btree_map<Key, T, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const btree_map<Key, T, Compare, Alloc>& lhs, const btree_map<Key, T, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const btree_map<Key, T, Compare, Alloc>& lhs, const btree_map<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class Key, class T, class Compare, class Alloc>
+void swap(btree_map<Key, T, Compare, Alloc>& lhs, btree_map<Key, T, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+// 模板类 btree_multimap，键值允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 ccystl::less
+// 参数四代表分配器类型，缺省使用 ccystl::allocator，可传入 ccystl::pool_allocator 使用节点内存池
+template <class Key, class T, class Compare = ccystl::less<Key>,
+          class Alloc = ccystl::allocator<ccystl::pair<const Key, T>>>
+class btree_multimap {
+public:
+    // btree_multimap 的型别定义
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef ccystl::pair<const Key, T> value_type;
+    typedef Compare key_compare;
+
+    // 定义一个 functor，用来进行元素比较
+    class value_compare : public binary_function<value_type, value_type, bool> {
+        friend class btree_multimap;
+
+    private:
+        Compare comp;
+        explicit value_compare(Compare c) : comp(c) { }
+
+    public:
+        bool operator()(const value_type& lhs, const value_type& rhs) const {
+            return comp(lhs.first, rhs.first);
+        }
+    };
+
+private:
+    // 用 ccystl::btree 作为底层机制
+    typedef ccystl::btree<value_type, key_compare, Alloc> base_type;
+    base_type tree_;
+
+public:
+    // 使用 btree 的型别
+    typedef typename base_type::pointer pointer;
+    typedef typename base_type::const_pointer const_pointer;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::const_reference const_reference;
+    typedef typename base_type::iterator iterator;
+    typedef typename base_type::const_iterator const_iterator;
+    typedef typename base_type::reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type size_type;
+    typedef typename base_type::difference_type difference_type;
+    typedef typename base_type::allocator_type allocator_type;
+
+public:
+    // 构造、复制、移动函数
+
+    btree_multimap() = default;
+
+    explicit btree_multimap(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit btree_multimap(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
+    template <class InputIterator>
+    btree_multimap(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(first, last);
+    }
+
+    btree_multimap(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(ilist.begin(), ilist.end());
+    }
+
+    btree_multimap(const btree_multimap& rhs)
+        : tree_(rhs.tree_) { }
+
+    btree_multimap(const btree_multimap& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
+    btree_multimap(btree_multimap&& rhs) noexcept
+        : tree_(ccystl::move(rhs.tree_)) { }
+
+    btree_multimap& operator=(const btree_multimap& rhs) = default;
+
+    btree_multimap& operator=(btree_multimap&& rhs) noexcept {
+        tree_ = ccystl::move(rhs.tree_);
+        return *this;
+    }
+
+    btree_multimap& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_multi(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    // 相关接口
+
+    key_compare key_comp() const {
+        return tree_.key_comp();
+    }
+
+    value_compare value_comp() const {
+        return value_compare(tree_.key_comp());
+    }
+
+    allocator_type get_allocator() const {
+        return tree_.get_allocator();
+    }
+
+    // 迭代器相关
+
+    iterator begin() noexcept {
+        return tree_.begin();
+    }
+
+    const_iterator begin() const noexcept {
+        return tree_.begin();
+    }
+
+    iterator end() noexcept {
+        return tree_.end();
+    }
+
+    const_iterator end() const noexcept {
+        return tree_.end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关
+    [[nodiscard]] bool empty() const noexcept {
+        return tree_.empty();
+    }
+
+    size_type size() const noexcept {
+        return tree_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return tree_.max_size();
+    }
+
+    // 插入删除操作
+
+    template <class... Args>
+    iterator emplace(Args&&... args) {
+        return tree_.emplace_multi(ccystl::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args&&... args) {
+        return tree_.emplace_multi_use_hint(hint, ccystl::forward<Args>(args)...);
+    }
+
+    iterator insert(const value_type& value) {
+        return tree_.insert_multi(value);
+    }
+
+    iterator insert(value_type&& value) {
+        return tree_.insert_multi(ccystl::move(value));
+    }
+
+    iterator insert(iterator hint, const value_type& value) {
+        return tree_.insert_multi(hint, value);
+    }
+
+    iterator insert(iterator hint, value_type&& value) {
+        return tree_.insert_multi(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_multi(first, last);
+    }
+
+    // 返回指向下一个元素的迭代器，其余迭代器全部失效
+    iterator erase(const_iterator position) {
+        return tree_.erase(position);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase_multi(key);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() {
+        tree_.clear();
+    }
+
+    // btree_multimap 相关操作
+
+    iterator find(const key_type& key) {
+        return tree_.find(key);
+    }
+
+    const_iterator find(const key_type& key) const {
+        return tree_.find(key);
+    }
+
+    size_type count(const key_type& key) const {
+        return tree_.count_multi(key);
+    }
+
+    iterator lower_bound(const key_type& key) {
+        return tree_.lower_bound(key);
+    }
+
+    const_iterator lower_bound(const key_type& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    iterator upper_bound(const key_type& key) {
+        return tree_.upper_bound(key);
+    }
+
+    const_iterator upper_bound(const key_type& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    void swap(btree_multimap& rhs) noexcept {
+        tree_.swap(rhs.tree_);
+    }
+
+public:
+    friend bool operator==(const btree_multimap& lhs, const btree_multimap& rhs) {
+        return lhs.tree_ == rhs.tree_;
+    }
+
+    friend bool operator<(const btree_multimap& lhs, const btree_multimap& rhs) {
+        return lhs.tree_ < rhs.tree_;
+    }
+};
+
+// 重载比较操作符
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const btree_multimap<Key, T, Compare, Alloc>& lhs, const btree_multimap<Key, T, Compare, Alloc>& rhs) {
+    return lhs == rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<(const btree_multimap<Key, T, Compare, Alloc>& lhs, const btree_multimap<Key, T, Compare, Alloc>& rhs) {
+    return lhs < rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const btree_multimap<Key, T, Compare, Alloc>& lhs, const btree_multimap<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>(const btree_multimap<Key, T, Compare, Alloc>& lhs, const btree_multimap<Key, T, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const btree_multimap<Key, T, Compare, Alloc>& lhs, const btree_multimap<Key, T, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const btree_multimap<Key, T, Compare, Alloc>& lhs, const btree_multimap<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class Key, class T, class Compare, class Alloc>
+void swap(btree_multimap<Key, T, Compare, Alloc>& lhs, btree_multimap<Key, T, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+namespace pmr {
+// 使用多态内存资源的 btree_map
+template <class Key, class T, class Compare = ccystl::less<Key>>
+using btree_map = ccystl::btree_map<Key, T, Compare, polymorphic_allocator<ccystl::pair<const Key, T>>>;
+
+// 使用多态内存资源的 btree_multimap
+template <class Key, class T, class Compare = ccystl::less<Key>>
+using btree_multimap = ccystl::btree_multimap<Key, T, Compare, polymorphic_allocator<ccystl::pair<const Key, T>>>;
+} // namespace pmr
+} // namespace ccystl
+#endif // !CCYSTL_BTREE_MAP_H_
@@ -0,0 +1,858 @@
+#ifndef CCYSTL_FLAT_MAP_H_
+#define CCYSTL_FLAT_MAP_H_
+
+// 这个头文件包含两个模板类 flat_map 和 flat_multimap
+// flat_map      : 映射，接口与 map 相同，底层使用有序向量，键值不允许重复
+// flat_multimap : 映射，接口与 multimap 相同，底层使用有序向量，键值允许重复
+
+// notes:
+//
+// 与 map / multimap 的区别：
+//   * 键值与实值分别连续存放在两个 vector 中，查找与顺序遍历按内存带宽进行，没有指针追逐
+//   * value_type 为 pair<Key, T>，迭代器解引用得到 pair<const Key&, T&>，operator-> 返回代理对象
+//   * 单个插入、删除为 O(n)，并使所有迭代器、指针和引用失效；erase 返回指向下一个元素的迭代器
+//   * 成批构造与 insert(first, last) 排序一次后合并，可以用 sorted_unique / sorted_equivalent 跳过排序
+//   * 没有节点句柄，不提供 extract / merge
+//
+// 异常保证：
+// ccystl::flat_map<Key, T> / ccystl::flat_multimap<Key, T> 满足基本异常保证，对以下等函数做强异常安全保证：
+//   * emplace
+//   * emplace_hint
+//   * insert（单个元素）
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/internal/flat_tree.h"
+
+namespace ccystl {
+// 模板类 flat_map，键值不允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 ccystl::less
+// 参数四代表分配器类型，缺省使用 ccystl::allocator
+template <class Key, class T, class Compare = ccystl::less<Key>,
+          class Alloc = ccystl::allocator<ccystl::pair<Key, T>>>
+class flat_map {
+public:
+    // flat_map 的嵌套型别定义
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef ccystl::pair<Key, T> value_type;
+    typedef Compare key_compare;
+
+    // 定义一个 functor，用来进行元素比较
+    class value_compare : public binary_function<value_type, value_type, bool> {
+        friend class flat_map;
+
+    private:
+        Compare comp;
+        explicit value_compare(Compare c) : comp(c) { }
+
+    public:
+        bool operator()(const value_type& lhs, const value_type& rhs) const {
+            return comp(lhs.first, rhs.first); // 比较键值的大小
+        }
+    };
+
+private:
+    // 以 ccystl::flat_tree 作为底层机制
+    typedef ccystl::flat_tree<key_type, mapped_type, key_compare, Alloc> base_type;
+    base_type tree_;
+
+public:
+    // 使用 flat_tree 的型别
+    typedef typename base_type::pointer pointer;
+    typedef typename base_type::const_pointer const_pointer;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::const_reference const_reference;
+    typedef typename base_type::iterator iterator;
+    typedef typename base_type::const_iterator const_iterator;
+    typedef typename base_type::reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type size_type;
+    typedef typename base_type::difference_type difference_type;
+    typedef typename base_type::allocator_type allocator_type;
+    typedef typename base_type::key_container key_container;
+    typedef typename base_type::mapped_container mapped_container;
+
+public:
+    // 构造、复制、移动、赋值函数
+
+    flat_map() = default;
+
+    explicit flat_map(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit flat_map(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
+    template <class InputIterator>
+    flat_map(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(first, last);
+    }
+
+    // 范围已按键值升序排列且没有重复的键值时不再排序
+    template <class InputIterator>
+    flat_map(sorted_unique_t, InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(sorted_unique_t(), first, last);
+    }
+
+    flat_map(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(ilist.begin(), ilist.end());
+    }
+
+    flat_map(const flat_map& rhs)
+        : tree_(rhs.tree_) { }
+
+    flat_map(const flat_map& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
+    flat_map(flat_map&& rhs) noexcept
+        : tree_(ccystl::move(rhs.tree_)) { }
+
+    flat_map& operator=(const flat_map& rhs) = default;
+
+    flat_map& operator=(flat_map&& rhs) noexcept {
+        tree_ = ccystl::move(rhs.tree_);
+        return *this;
+    }
+
+    flat_map& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    // 相关接口
+
+    key_compare key_comp() const {
+        return tree_.key_comp();
+    }
+
+    value_compare value_comp() const {
+        return value_compare(tree_.key_comp());
+    }
+
+    allocator_type get_allocator() const {
+        return tree_.get_allocator();
+    }
+
+    // 迭代器相关
+
+    iterator begin() noexcept {
+        return tree_.begin();
+    }
+
+    const_iterator begin() const noexcept {
+        return tree_.begin();
+    }
+
+    iterator end() noexcept {
+        return tree_.end();
+    }
+
+    const_iterator end() const noexcept {
+        return tree_.end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关
+    [[nodiscard]] bool empty() const noexcept {
+        return tree_.empty();
+    }
+
+    size_type size() const noexcept {
+        return tree_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return tree_.max_size();
+    }
+
+    size_type capacity() const noexcept {
+        return tree_.capacity();
+    }
+
+    void reserve(size_type n) {
+        tree_.reserve(n);
+    }
+
+    void shrink_to_fit() {
+        tree_.shrink_to_fit();
+    }
+
+    // 底层数组
+
+    const key_container& keys() const noexcept {
+        return tree_.keys();
+    }
+
+    const mapped_container& values() const noexcept {
+        return tree_.values();
+    }
+
+    // 访问元素相关
+
+    // 若键值不存在，at 会抛出一个异常
+    mapped_type& at(const key_type& key) {
+        iterator it = lower_bound(key);
+        // it->first >= key
+        THROW_OUT_OF_RANGE_IF(it == end() || key_comp()(it->first, key),
+                              "flat_map<Key, T> no such element exists");
+        return it->second;
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        const_iterator it = lower_bound(key);
+        // it->first >= key
+        THROW_OUT_OF_RANGE_IF(it == end() || key_comp()(it->first, key),
+                              "flat_map<Key, T> no such element exists");
+        return it->second;
+    }
+
+    mapped_type& operator[](const key_type& key) {
+        iterator it = lower_bound(key);
+        // it->first >= key
+        if (it == end() || key_comp()(key, it->first))
+            it = emplace_hint(it, key, T{});
+        return it->second;
+    }
+
+    mapped_type& operator[](key_type&& key) {
+        iterator it = lower_bound(key);
+        // it->first >= key
+        if (it == end() || key_comp()(key, it->first))
+            it = emplace_hint(it, ccystl::move(key), T{});
+        return it->second;
+    }
+
+    // 插入删除相关
+
+    template <class... Args>
+    pair<iterator, bool> emplace(Args&&... args) {
+        return tree_.emplace_unique(ccystl::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args&&... args) {
+        return tree_.emplace_unique_use_hint(hint, ccystl::forward<Args>(args)...);
+    }
+
+    pair<iterator, bool> insert(const value_type& value) {
+        return tree_.insert_unique(value);
+    }
+
+    pair<iterator, bool> insert(value_type&& value) {
+        return tree_.insert_unique(ccystl::move(value));
+    }
+
+    iterator insert(iterator hint, const value_type& value) {
+        return tree_.insert_unique(hint, value);
+    }
+
+    iterator insert(iterator hint, value_type&& value) {
+        return tree_.insert_unique(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_unique(first, last);
+    }
+
+    template <class InputIterator>
+    void insert(sorted_unique_t, InputIterator first, InputIterator last) {
+        tree_.insert_unique(sorted_unique_t(), first, last);
+    }
+
+    // 返回指向下一个元素的迭代器，其余迭代器全部失效
+    iterator erase(const_iterator position) {
+        return tree_.erase(position);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase_unique(key);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() {
+        tree_.clear();
+    }
+
+    // flat_map 相关操作
+
+    iterator find(const key_type& key) {
+        return tree_.find(key);
+    }
+
+    const_iterator find(const key_type& key) const {
+        return tree_.find(key);
+    }
+
+    size_type count(const key_type& key) const {
+        return tree_.count_unique(key);
+    }
+
+    iterator lower_bound(const key_type& key) {
+        return tree_.lower_bound(key);
+    }
+
+    const_iterator lower_bound(const key_type& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    iterator upper_bound(const key_type& key) {
+        return tree_.upper_bound(key);
+    }
+
+    const_iterator upper_bound(const key_type& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range_unique(key);
+    }
+
+    pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range_unique(key);
+    }
+
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_unique(key);
+    }
+
+    void swap(flat_map& rhs) noexcept {
+        tree_.swap(rhs.tree_);
+    }
+
+public:
+    friend bool operator==(const flat_map& lhs, const flat_map& rhs) {
+        return lhs.tree_ == rhs.tree_;
+    }
+
+    friend bool operator<(const flat_map& lhs, const flat_map& rhs) {
+        return lhs.tree_ < rhs.tree_;
+    }
+};
+
+// 重载比较操作符
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs) {
+    return lhs == rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs) {
+    return lhs < rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const flat_map<Key, T, Compare, Alloc>& lhs, const flat_map<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class Key, class T, class Compare, class Alloc>
+void swap(flat_map<Key, T, Compare, Alloc>& lhs, flat_map<Key, T, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+// 模板类 flat_multimap，键值允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 ccystl::less
+// 参数四代表分配器类型，缺省使用 ccystl::allocator
+template <class Key, class T, class Compare = ccystl::less<Key>,
+          class Alloc = ccystl::allocator<ccystl::pair<Key, T>>>
+class flat_multimap {
+public:
+    // flat_multimap 的型别定义
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef ccystl::pair<Key, T> value_type;
+    typedef Compare key_compare;
+
+    // 定义一个 functor，用来进行元素比较
+    class value_compare : public binary_function<value_type, value_type, bool> {
+        friend class flat_multimap;
+
+    private:
+        Compare comp;
+        explicit value_compare(Compare c) : comp(c) { }
+
+    public:
+        bool operator()(const value_type& lhs, const value_type& rhs) const {
+            return comp(lhs.first, rhs.first);
+        }
+    };
+
+private:
+    // 用 ccystl::flat_tree 作为底层机制
+    typedef ccystl::flat_tree<key_type, mapped_type, key_compare, Alloc> base_type;
+    base_type tree_;
+
+public:
+    // 使用 flat_tree 的型别
+    typedef typename base_type::pointer pointer;
+    typedef typename base_type::const_pointer const_pointer;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::const_reference const_reference;
+    typedef typename base_type::iterator iterator;
+    typedef typename base_type::const_iterator const_iterator;
+    typedef typename base_type::reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type size_type;
+    typedef typename base_type::difference_type difference_type;
+    typedef typename base_type::allocator_type allocator_type;
+    typedef typename base_type::key_container key_container;
+    typedef typename base_type::mapped_container mapped_container;
+
+public:
+    // 构造、复制、移动函数
+
+    flat_multimap() = default;
+
+    explicit flat_multimap(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit flat_multimap(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
+    template <class InputIterator>
+    flat_multimap(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(first, last);
+    }
+
+    // 范围已按键值升序排列时不再排序
+    template <class InputIterator>
+    flat_multimap(sorted_equivalent_t, InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
+    flat_multimap(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(ilist.begin(), ilist.end());
+    }
+
+    flat_multimap(const flat_multimap& rhs)
+        : tree_(rhs.tree_) { }
+
+    flat_multimap(const flat_multimap& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
+    flat_multimap(flat_multimap&& rhs) noexcept
+        : tree_(ccystl::move(rhs.tree_)) { }
+
+    flat_multimap& operator=(const flat_multimap& rhs) = default;
+
+    flat_multimap& operator=(flat_multimap&& rhs) noexcept {
+        tree_ = ccystl::move(rhs.tree_);
+        return *this;
+    }
+
+    flat_multimap& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_multi(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    // 相关接口
+
+    key_compare key_comp() const {
+        return tree_.key_comp();
+    }
+
+    value_compare value_comp() const {
+        return value_compare(tree_.key_comp());
+    }
+
+    allocator_type get_allocator() const {
+        return tree_.get_allocator();
+    }
+
+    // 迭代器相关
+
+    iterator begin() noexcept {
+        return tree_.begin();
+    }
+
+    const_iterator begin() const noexcept {
+        return tree_.begin();
+    }
+
+    iterator end() noexcept {
+        return tree_.end();
+    }
+
+    const_iterator end() const noexcept {
+        return tree_.end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关
+    [[nodiscard]] bool empty() const noexcept {
+        return tree_.empty();
+    }
+
+    size_type size() const noexcept {
+        return tree_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return tree_.max_size();
+    }
+
+    size_type capacity() const noexcept {
+        return tree_.capacity();
+    }
+
+    void reserve(size_type n) {
+        tree_.reserve(n);
+    }
+
+    void shrink_to_fit() {
+        tree_.shrink_to_fit();
+    }
+
+    // 底层数组
+
+    const key_container& keys() const noexcept {
+        return tree_.keys();
+    }
+
+    const mapped_container& values() const noexcept {
+        return tree_.values();
+    }
+
+    // 插入删除操作
+
+    template <class... Args>
+    iterator emplace(Args&&... args) {
+        return tree_.emplace_multi(ccystl::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args&&... args) {
+        return tree_.emplace_multi_use_hint(hint, ccystl::forward<Args>(args)...);
+    }
+
+    iterator insert(const value_type& value) {
+        return tree_.insert_multi(value);
+    }
+
+    iterator insert(value_type&& value) {
+        return tree_.insert_multi(ccystl::move(value));
+    }
+
+    iterator insert(iterator hint, const value_type& value) {
+        return tree_.insert_multi(hint, value);
+    }
+
+    iterator insert(iterator hint, value_type&& value) {
+        return tree_.insert_multi(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_multi(first, last);
+    }
+
+    template <class InputIterator>
+    void insert(sorted_equivalent_t, InputIterator first, InputIterator last) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
+    // 返回指向下一个元素的迭代器，其余迭代器全部失效
+    iterator erase(const_iterator position) {
+        return tree_.erase(position);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase_multi(key);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() {
+        tree_.clear();
+    }
+
+    // flat_multimap 相关操作
+
+    iterator find(const key_type& key) {
+        return tree_.find(key);
+    }
+
+    const_iterator find(const key_type& key) const {
+        return tree_.find(key);
+    }
+
+    size_type count(const key_type& key) const {
+        return tree_.count_multi(key);
+    }
+
+    iterator lower_bound(const key_type& key) {
+        return tree_.lower_bound(key);
+    }
+
+    const_iterator lower_bound(const key_type& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    iterator upper_bound(const key_type& key) {
+        return tree_.upper_bound(key);
+    }
+
+    const_iterator upper_bound(const key_type& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    void swap(flat_multimap& rhs) noexcept {
+        tree_.swap(rhs.tree_);
+    }
+
+public:
+    friend bool operator==(const flat_multimap& lhs, const flat_multimap& rhs) {
+        return lhs.tree_ == rhs.tree_;
+    }
+
+    friend bool operator<(const flat_multimap& lhs, const flat_multimap& rhs) {
+        return lhs.tree_ < rhs.tree_;
+    }
+};
+
+// 重载比较操作符
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const flat_multimap<Key, T, Compare, Alloc>& lhs, const flat_multimap<Key, T, Compare, Alloc>& rhs) {
+    return lhs == rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<(const flat_multimap<Key, T, Compare, Alloc>& lhs, const flat_multimap<Key, T, Compare, Alloc>& rhs) {
+    return lhs < rhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const flat_multimap<Key, T, Compare, Alloc>& lhs, const flat_multimap<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>(const flat_multimap<Key, T, Compare, Alloc>& lhs, const flat_multimap<Key, T, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const flat_multimap<Key, T, Compare, Alloc>& lhs, const flat_multimap<Key, T, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const flat_multimap<Key, T, Compare, Alloc>& lhs, const flat_multimap<Key, T, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class Key, class T, class Compare, class Alloc>
+void swap(flat_multimap<Key, T, Compare, Alloc>& lhs, flat_multimap<Key, T, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+namespace pmr {
+// 使用多态内存资源的 flat_map
+template <class Key, class T, class Compare = ccystl::less<Key>>
+using flat_map = ccystl::flat_map<Key, T, Compare, polymorphic_allocator<ccystl::pair<Key, T>>>;
+
+// 使用多态内存资源的 flat_multimap
+template <class Key, class T, class Compare = ccystl::less<Key>>
+using flat_multimap = ccystl::flat_multimap<Key, T, Compare, polymorphic_allocator<ccystl::pair<Key, T>>>;
+} // namespace pmr
+} // namespace ccystl
+#endif // !CCYSTL_FLAT_MAP_H_
@@ -0,0 +1,779 @@
+#ifndef CCYSTL_FLAT_SET_H_
+#define CCYSTL_FLAT_SET_H_
+
+// 这个头文件包含两个模板类 flat_set 和 flat_multiset
+// flat_set      : 集合，接口与 set 相同，底层使用有序向量，键值不允许重复
+// flat_multiset : 集合，接口与 multiset 相同，底层使用有序向量，键值允许重复
+
+// notes:
+//
+// 与 set / multiset 的区别：
+//   * 键值连续存放在一个 vector 中，查找与顺序遍历按内存带宽进行，没有指针追逐
+//   * 单个插入、删除为 O(n)，并使所有迭代器、指针和引用失效；erase 返回指向下一个元素的迭代器
+//   * 成批构造与 insert(first, last) 排序一次后用 inplace_merge 合并，
+//     可以用 sorted_unique / sorted_equivalent 跳过排序
+//   * 没有节点句柄，不提供 extract / merge
+//
+// 异常保证：
+// ccystl::flat_set<Key> / ccystl::flat_multiset<Key> 满足基本异常保证，对以下等函数做强异常安全保证：
+//   * emplace
+//   * emplace_hint
+//   * insert（单个元素）
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/internal/flat_tree.h"
+
+namespace ccystl {
+// 模板类 flat_set，键值不允许重复
+// 参数一代表键值类型，参数二代表键值比较方式，缺省使用 ccystl::less
+// 参数三代表分配器类型，缺省使用 ccystl::allocator
+template <class Key, class Compare = ccystl::less<Key>, class Alloc = ccystl::allocator<Key>>
+class flat_set {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+
+private:
+    // 以 ccystl::flat_tree 作为底层机制
+    typedef ccystl::flat_tree<key_type, void, key_compare, Alloc> base_type;
+    base_type tree_;
+
+public:
+    // 使用 flat_tree 定义的型别
+    typedef typename base_type::const_pointer pointer;
+    typedef typename base_type::const_pointer const_pointer;
+    typedef typename base_type::const_reference reference;
+    typedef typename base_type::const_reference const_reference;
+    typedef typename base_type::const_iterator iterator;
+    typedef typename base_type::const_iterator const_iterator;
+    typedef typename base_type::const_reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type size_type;
+    typedef typename base_type::difference_type difference_type;
+    typedef typename base_type::allocator_type allocator_type;
+    typedef typename base_type::key_container key_container;
+
+public:
+    // 构造、复制、移动函数
+    flat_set() = default;
+
+    explicit flat_set(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit flat_set(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
+    template <class InputIterator>
+    flat_set(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(first, last);
+    }
+
+    // 范围已按键值升序排列且没有重复的键值时不再排序
+    template <class InputIterator>
+    flat_set(sorted_unique_t, InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(sorted_unique_t(), first, last);
+    }
+
+    flat_set(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(ilist.begin(), ilist.end());
+    }
+
+    flat_set(const flat_set& rhs)
+        : tree_(rhs.tree_) { }
+
+    flat_set(const flat_set& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
+    flat_set(flat_set&& rhs) noexcept
+        : tree_(ccystl::move(rhs.tree_)) { }
+
+    flat_set& operator=(const flat_set& rhs) = default;
+
+    flat_set& operator=(flat_set&& rhs)  noexcept {
+        tree_ = ccystl::move(rhs.tree_);
+        return *this;
+    }
+
+    flat_set& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    // 相关接口
+
+    key_compare key_comp() const {
+        return tree_.key_comp();
+    }
+
+    value_compare value_comp() const {
+        return tree_.key_comp();
+    }
+
+    allocator_type get_allocator() const {
+        return tree_.get_allocator();
+    }
+
+    // 迭代器相关
+
+    iterator begin() noexcept {
+        return tree_.begin();
+    }
+
+    const_iterator begin() const noexcept {
+        return tree_.begin();
+    }
+
+    iterator end() noexcept {
+        return tree_.end();
+    }
+
+    const_iterator end() const noexcept {
+        return tree_.end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关
+    [[nodiscard]] bool empty() const noexcept {
+        return tree_.empty();
+    }
+
+    size_type size() const noexcept {
+        return tree_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return tree_.max_size();
+    }
+
+    size_type capacity() const noexcept {
+        return tree_.capacity();
+    }
+
+    void reserve(size_type n) {
+        tree_.reserve(n);
+    }
+
+    void shrink_to_fit() {
+        tree_.shrink_to_fit();
+    }
+
+    // 底层数组
+
+    const key_container& keys() const noexcept {
+        return tree_.keys();
+    }
+
+    // 插入删除操作
+
+    template <class... Args>
+    pair<iterator, bool> emplace(Args&&... args) {
+        return tree_.emplace_unique(ccystl::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args&&... args) {
+        return tree_.emplace_unique_use_hint(hint, ccystl::forward<Args>(args)...);
+    }
+
+    pair<iterator, bool> insert(const value_type& value) {
+        return tree_.insert_unique(value);
+    }
+
+    pair<iterator, bool> insert(value_type&& value) {
+        return tree_.insert_unique(ccystl::move(value));
+    }
+
+    iterator insert(iterator hint, const value_type& value) {
+        return tree_.insert_unique(hint, value);
+    }
+
+    iterator insert(iterator hint, value_type&& value) {
+        return tree_.insert_unique(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_unique(first, last);
+    }
+
+    template <class InputIterator>
+    void insert(sorted_unique_t, InputIterator first, InputIterator last) {
+        tree_.insert_unique(sorted_unique_t(), first, last);
+    }
+
+    // 返回指向下一个元素的迭代器，其余迭代器全部失效
+    iterator erase(const_iterator position) {
+        return tree_.erase(position);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase_unique(key);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() {
+        tree_.clear();
+    }
+
+    // flat_set 相关操作
+
+    iterator find(const key_type& key) {
+        return tree_.find(key);
+    }
+
+    const_iterator find(const key_type& key) const {
+        return tree_.find(key);
+    }
+
+    size_type count(const key_type& key) const {
+        return tree_.count_unique(key);
+    }
+
+    iterator lower_bound(const key_type& key) {
+        return tree_.lower_bound(key);
+    }
+
+    const_iterator lower_bound(const key_type& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    iterator upper_bound(const key_type& key) {
+        return tree_.upper_bound(key);
+    }
+
+    const_iterator upper_bound(const key_type& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range_unique(key);
+    }
+
+    pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range_unique(key);
+    }
+
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_unique(key);
+    }
+
+    void swap(flat_set& rhs) noexcept {
+        tree_.swap(rhs.tree_);
+    }
+
+public:
+    friend bool operator==(const flat_set& lhs, const flat_set& rhs) {
+        return lhs.tree_ == rhs.tree_;
+    }
+
+    friend bool operator<(const flat_set& lhs, const flat_set& rhs) {
+        return lhs.tree_ < rhs.tree_;
+    }
+};
+
+// 重载比较操作符
+template <class Key, class Compare, class Alloc>
+bool operator==(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs) {
+    return lhs == rhs;
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator<(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs) {
+    return lhs < rhs;
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator!=(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator>(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator<=(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator>=(const flat_set<Key, Compare, Alloc>& lhs, const flat_set<Key, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class Key, class Compare, class Alloc>
+void swap(flat_set<Key, Compare, Alloc>& lhs, flat_set<Key, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+// 模板类 flat_multiset，键值允许重复
+// 参数一代表键值类型，参数二代表键值比较方式，缺省使用 ccystl::less
+// 参数三代表分配器类型，缺省使用 ccystl::allocator
+template <class Key, class Compare = ccystl::less<Key>, class Alloc = ccystl::allocator<Key>>
+class flat_multiset {
+public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+
+private:
+    // 以 ccystl::flat_tree 作为底层机制
+    typedef ccystl::flat_tree<key_type, void, key_compare, Alloc> base_type;
+    base_type tree_; // 以 flat_tree 表现 flat_multiset
+
+public:
+    // 使用 flat_tree 定义的型别
+    typedef typename base_type::const_pointer pointer;
+    typedef typename base_type::const_pointer const_pointer;
+    typedef typename base_type::const_reference reference;
+    typedef typename base_type::const_reference const_reference;
+    typedef typename base_type::const_iterator iterator;
+    typedef typename base_type::const_iterator const_iterator;
+    typedef typename base_type::const_reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type size_type;
+    typedef typename base_type::difference_type difference_type;
+    typedef typename base_type::allocator_type allocator_type;
+    typedef typename base_type::key_container key_container;
+
+public:
+    // 构造、复制、移动函数
+    flat_multiset() = default;
+
+    explicit flat_multiset(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit flat_multiset(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
+    template <class InputIterator>
+    flat_multiset(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(first, last);
+    }
+
+    // 范围已按键值升序排列时不再排序
+    template <class InputIterator>
+    flat_multiset(sorted_equivalent_t, InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
+    flat_multiset(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(ilist.begin(), ilist.end());
+    }
+
+    flat_multiset(const flat_multiset& rhs)
+        : tree_(rhs.tree_) { }
+
+    flat_multiset(const flat_multiset& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
+    flat_multiset(flat_multiset&& rhs) noexcept
+        : tree_(ccystl::move(rhs.tree_)) { }
+
+    flat_multiset& operator=(const flat_multiset& rhs) = default;
+
+    flat_multiset& operator=(flat_multiset&& rhs)  noexcept {
+        tree_ = ccystl::move(rhs.tree_);
+        return *this;
+    }
+
+    flat_multiset& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_multi(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    // 相关接口
+
+    key_compare key_comp() const {
+        return tree_.key_comp();
+    }
+
+    value_compare value_comp() const {
+        return tree_.key_comp();
+    }
+
+    allocator_type get_allocator() const {
+        return tree_.get_allocator();
+    }
+
+    // 迭代器相关
+
+    iterator begin() noexcept {
+        return tree_.begin();
+    }
+
+    const_iterator begin() const noexcept {
+        return tree_.begin();
+    }
+
+    iterator end() noexcept {
+        return tree_.end();
+    }
+
+    const_iterator end() const noexcept {
+        return tree_.end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关
+    [[nodiscard]] bool empty() const noexcept {
+        return tree_.empty();
+    }
+
+    size_type size() const noexcept {
+        return tree_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return tree_.max_size();
+    }
+
+    size_type capacity() const noexcept {
+        return tree_.capacity();
+    }
+
+    void reserve(size_type n) {
+        tree_.reserve(n);
+    }
+
+    void shrink_to_fit() {
+        tree_.shrink_to_fit();
+    }
+
+    // 底层数组
+
+    const key_container& keys() const noexcept {
+        return tree_.keys();
+    }
+
+    // 插入删除操作
+
+    template <class... Args>
+    iterator emplace(Args&&... args) {
+        return tree_.emplace_multi(ccystl::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    iterator emplace_hint(iterator hint, Args&&... args) {
+        return tree_.emplace_multi_use_hint(hint, ccystl::forward<Args>(args)...);
+    }
+
+    iterator insert(const value_type& value) {
+        return tree_.insert_multi(value);
+    }
+
+    iterator insert(value_type&& value) {
+        return tree_.insert_multi(ccystl::move(value));
+    }
+
+    iterator insert(iterator hint, const value_type& value) {
+        return tree_.insert_multi(hint, value);
+    }
+
+    iterator insert(iterator hint, value_type&& value) {
+        return tree_.insert_multi(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_multi(first, last);
+    }
+
+    template <class InputIterator>
+    void insert(sorted_equivalent_t, InputIterator first, InputIterator last) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
+    // 返回指向下一个元素的迭代器，其余迭代器全部失效
+    iterator erase(const_iterator position) {
+        return tree_.erase(position);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase_multi(key);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() {
+        tree_.clear();
+    }
+
+    // flat_multiset 相关操作
+
+    iterator find(const key_type& key) {
+        return tree_.find(key);
+    }
+
+    const_iterator find(const key_type& key) const {
+        return tree_.find(key);
+    }
+
+    size_type count(const key_type& key) const {
+        return tree_.count_multi(key);
+    }
+
+    iterator lower_bound(const key_type& key) {
+        return tree_.lower_bound(key);
+    }
+
+    const_iterator lower_bound(const key_type& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    iterator upper_bound(const key_type& key) {
+        return tree_.upper_bound(key);
+    }
+
+    const_iterator upper_bound(const key_type& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    void swap(flat_multiset& rhs) noexcept {
+        tree_.swap(rhs.tree_);
+    }
+
+public:
+    friend bool operator==(const flat_multiset& lhs, const flat_multiset& rhs) {
+        return lhs.tree_ == rhs.tree_;
+    }
+
+    friend bool operator<(const flat_multiset& lhs, const flat_multiset& rhs) {
+        return lhs.tree_ < rhs.tree_;
+    }
+};
+
+// 重载比较操作符
+template <class Key, class Compare, class Alloc>
+bool operator==(const flat_multiset<Key, Compare, Alloc>& lhs, const flat_multiset<Key, Compare, Alloc>& rhs) {
+    return lhs == rhs;
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator<(const flat_multiset<Key, Compare, Alloc>& lhs, const flat_multiset<Key, Compare, Alloc>& rhs) {
+    return lhs < rhs;
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator!=(const flat_multiset<Key, Compare, Alloc>& lhs, const flat_multiset<Key, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator>(const flat_multiset<Key, Compare, Alloc>& lhs, const flat_multiset<Key, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator<=(const flat_multiset<Key, Compare, Alloc>& lhs, const flat_multiset<Key, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class Key, class Compare, class Alloc>
+bool operator>=(const flat_multiset<Key, Compare, Alloc>& lhs, const flat_multiset<Key, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class Key, class Compare, class Alloc>
+void swap(flat_multiset<Key, Compare, Alloc>& lhs, flat_multiset<Key, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+namespace pmr {
+// 使用多态内存资源的 flat_set
+template <class Key, class Compare = ccystl::less<Key>>
+using flat_set = ccystl::flat_set<Key, Compare, polymorphic_allocator<Key>>;
+
+// 使用多态内存资源的 flat_multiset
+template <class Key, class Compare = ccystl::less<Key>>
+using flat_multiset = ccystl::flat_multiset<Key, Compare, polymorphic_allocator<Key>>;
+} // namespace pmr
+} // namespace ccystl
+#endif // !CCYSTL_FLAT_SET_H_
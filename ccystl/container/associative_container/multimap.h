@@ -16,9 +16,16 @@
 #include "ccystl/functor/functional.h"
 
 namespace ccystl {
+// forward declaration
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+class map;
+
 // 模板类 multimap，键值允许重复
 // 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 ccystl::less
-template <class Key, class T, class Compare = ccystl::less<Key>>
+// 参数四代表分配器类型，缺省使用 ccystl::allocator，可传入 ccystl::pool_allocator 使用节点内存池
+// 参数五为 true 时底层 rb_tree 记录子树大小，另外提供 rank、select 等顺序统计接口，一般通过 ranked_multimap 使用
+template <class Key, class T, class Compare = ccystl::less<Key>,
+          class Alloc = ccystl::allocator<ccystl::pair<const Key, T>>, bool CountSubtree = false>
 class multimap {
 public:
     // multimap 的型别定义
@@ -43,12 +50,18 @@ public:
 
 private:
     // 用 ccystl::rb_tree 作为底层机制
-    typedef ccystl::rb_tree<value_type, key_compare> base_type;
+    typedef ccystl::rb_tree<value_type, key_compare, Alloc, CountSubtree> base_type;
     base_type tree_;
 
+    // merge 需要访问同类容器的底层 rb_tree
+    template <class, class, class, class, bool>
+    friend class map;
+    template <class, class, class, class, bool>
+    friend class multimap;
+
 public:
     // 使用 rb_tree 的型别
-    typedef typename base_type::node_type node_type;
+    typedef typename base_type::node_handle_type node_type;
     typedef typename base_type::pointer pointer;
     typedef typename base_type::const_pointer const_pointer;
     typedef typename base_type::reference reference;
@@ -66,20 +79,36 @@ public:
 
     multimap() = default;
 
+    explicit multimap(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit multimap(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
     template <class InputIterator>
-    multimap(InputIterator first, InputIterator last)
-        : tree_() {
+    multimap(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
         tree_.insert_multi(first, last);
     }
 
-    multimap(std::initializer_list<value_type> ilist)
-        : tree_() {
+    // 范围已按键值升序排列时不再检查，以 O(n) 直接建树
+    template <class InputIterator>
+    multimap(sorted_equivalent_t, InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
+    multimap(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
         tree_.insert_multi(ilist.begin(), ilist.end());
     }
 
     multimap(const multimap& rhs)
         : tree_(rhs.tree_) { }
 
+    multimap(const multimap& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
     multimap(multimap&& rhs) noexcept
         : tree_(ccystl::move(rhs.tree_)) { }
 
@@ -206,6 +235,11 @@ public:
         tree_.insert_multi(first, last);
     }
 
+    template <class InputIterator>
+    void insert(sorted_equivalent_t, InputIterator first, InputIterator last) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
     void erase(iterator position) {
         tree_.erase(position);
     }
@@ -222,6 +256,44 @@ public:
         tree_.clear();
     }
 
+    // 节点句柄：在容器之间移动元素时只摘下、挂上节点，不重新分配
+
+    node_type extract(const_iterator position) {
+        return tree_.extract(position);
+    }
+
+    node_type extract(const key_type& key) {
+        return tree_.extract(key);
+    }
+
+    iterator insert(node_type&& nh) {
+        return tree_.insert_multi(ccystl::move(nh));
+    }
+
+    iterator insert(const_iterator hint, node_type&& nh) {
+        return tree_.insert_multi(hint, ccystl::move(nh));
+    }
+
+    template <class Compare2>
+    void merge(map<Key, T, Compare2, Alloc, CountSubtree>& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(map<Key, T, Compare2, Alloc, CountSubtree>&& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(multimap<Key, T, Compare2, Alloc, CountSubtree>& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(multimap<Key, T, Compare2, Alloc, CountSubtree>&& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
     // multimap 相关操作
 
     iterator find(const key_type& key) {
@@ -262,6 +334,102 @@ public:
         return tree_.equal_range_multi(key);
     }
 
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    // 顺序统计，只有 CountSubtree 为 true（即 ranked_multimap）时可用，均为 O(log n)
+
+    // 键值小于 key 的元素个数
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    size_type rank(const key_type& key) const {
+        return tree_.rank(key);
+    }
+
+    template <class K, bool B = CountSubtree, std::enable_if_t<B, int> = 0,
+              enable_if_transparent_t<K, Compare> = 0>
+    size_type rank(const K& key) const {
+        return tree_.rank(key);
+    }
+
+    // 下标为 k 的元素（从 0 开始），k 不小于 size() 时返回 end()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    iterator select(size_type k) {
+        return tree_.select(k);
+    }
+
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    const_iterator select(size_type k) const {
+        return tree_.select(k);
+    }
+
+    // 迭代器所指元素的下标，end() 的下标为 size()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    size_type index_of(const_iterator position) const {
+        return tree_.index_of(position);
+    }
+
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return tree_.distance(first, last);
+    }
+
+    // 令 position 前进 n 个位置（n 可以为负），越过两端时停在 end()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    void advance(iterator& position, difference_type n) const {
+        tree_.advance(position, n);
+    }
+
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    void advance(const_iterator& position, difference_type n) const {
+        tree_.advance(position, n);
+    }
+
     void swap(multimap& rhs) noexcept {
         tree_.swap(rhs.tree_);
     }
@@ -277,41 +445,47 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class T, class Compare>
-bool operator==(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs) {
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+bool operator==(const multimap<Key, T, Compare, Alloc, CountSubtree>& lhs, const multimap<Key, T, Compare, Alloc, CountSubtree>& rhs) {
     return lhs == rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs) {
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+bool operator<(const multimap<Key, T, Compare, Alloc, CountSubtree>& lhs, const multimap<Key, T, Compare, Alloc, CountSubtree>& rhs) {
     return lhs < rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator!=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs) {
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+bool operator!=(const multimap<Key, T, Compare, Alloc, CountSubtree>& lhs, const multimap<Key, T, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs == rhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs) {
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+bool operator>(const multimap<Key, T, Compare, Alloc, CountSubtree>& lhs, const multimap<Key, T, Compare, Alloc, CountSubtree>& rhs) {
     return rhs < lhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs) {
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+bool operator<=(const multimap<Key, T, Compare, Alloc, CountSubtree>& lhs, const multimap<Key, T, Compare, Alloc, CountSubtree>& rhs) {
     return !(rhs < lhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs) {
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+bool operator>=(const multimap<Key, T, Compare, Alloc, CountSubtree>& lhs, const multimap<Key, T, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs < rhs);
 }
 
 // 重载 ccystl 的 swap
-template <class Key, class T, class Compare>
-void swap(multimap<Key, T, Compare>& lhs, multimap<Key, T, Compare>& rhs) noexcept {
+template <class Key, class T, class Compare, class Alloc, bool CountSubtree>
+void swap(multimap<Key, T, Compare, Alloc, CountSubtree>& lhs, multimap<Key, T, Compare, Alloc, CountSubtree>& rhs) noexcept {
     lhs.swap(rhs);
 }
+
+namespace pmr {
+// 使用多态内存资源的 multimap
+template <class Key, class T, class Compare = ccystl::less<Key>>
+using multimap = ccystl::multimap<Key, T, Compare, polymorphic_allocator<ccystl::pair<const Key, T>>>;
+} // namespace pmr
 }
 
 #endif
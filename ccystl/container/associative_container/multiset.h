@@ -15,9 +15,15 @@
 #include "ccystl/internal/rb_tree.h"
 
 namespace ccystl {
+// forward declaration
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+class set;
+
 // 模板类 multiset，键值允许重复
 // 参数一代表键值类型，参数二代表键值比较方式，缺省使用 ccystl::less
-template <class Key, class Compare = ccystl::less<Key>>
+// 参数三代表分配器类型，缺省使用 ccystl::allocator，可传入 ccystl::pool_allocator 使用节点内存池
+// 参数四为 true 时底层 rb_tree 记录子树大小，另外提供 rank、select 等顺序统计接口，一般通过 ranked_multiset 使用
+template <class Key, class Compare = ccystl::less<Key>, class Alloc = ccystl::allocator<Key>, bool CountSubtree = false>
 class multiset {
 public:
     typedef Key key_type;
@@ -27,12 +33,18 @@ public:
 
 private:
     // 以 ccystl::rb_tree 作为底层机制
-    typedef ccystl::rb_tree<value_type, key_compare> base_type;
+    typedef ccystl::rb_tree<value_type, key_compare, Alloc, CountSubtree> base_type;
     base_type tree_; // 以 rb_tree 表现 multiset
 
+    // merge 需要访问同类容器的底层 rb_tree
+    template <class, class, class, bool>
+    friend class set;
+    template <class, class, class, bool>
+    friend class multiset;
+
 public:
     // 使用 rb_tree 定义的型别
-    typedef typename base_type::node_type node_type;
+    typedef typename base_type::node_handle_type node_type;
     typedef typename base_type::const_pointer pointer;
     typedef typename base_type::const_pointer const_pointer;
     typedef typename base_type::const_reference reference;
@@ -49,20 +61,36 @@ public:
     // 构造、复制、移动函数
     multiset() = default;
 
+    explicit multiset(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit multiset(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
     template <class InputIterator>
-    multiset(InputIterator first, InputIterator last)
-        : tree_() {
+    multiset(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
         tree_.insert_multi(first, last);
     }
 
-    multiset(std::initializer_list<value_type> ilist)
-        : tree_() {
+    // 范围已按键值升序排列时不再检查，以 O(n) 直接建树
+    template <class InputIterator>
+    multiset(sorted_equivalent_t, InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
+    multiset(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
         tree_.insert_multi(ilist.begin(), ilist.end());
     }
 
     multiset(const multiset& rhs)
         : tree_(rhs.tree_) { }
 
+    multiset(const multiset& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
     multiset(multiset&& rhs) noexcept
         : tree_(ccystl::move(rhs.tree_)) { }
 
@@ -189,6 +217,11 @@ public:
         tree_.insert_multi(first, last);
     }
 
+    template <class InputIterator>
+    void insert(sorted_equivalent_t, InputIterator first, InputIterator last) {
+        tree_.insert_multi(sorted_equivalent_t(), first, last);
+    }
+
     void erase(iterator position) {
         tree_.erase(position);
     }
@@ -205,6 +238,44 @@ public:
         tree_.clear();
     }
 
+    // 节点句柄：在容器之间移动元素时只摘下、挂上节点，不重新分配
+
+    node_type extract(const_iterator position) {
+        return tree_.extract(position);
+    }
+
+    node_type extract(const key_type& key) {
+        return tree_.extract(key);
+    }
+
+    iterator insert(node_type&& nh) {
+        return tree_.insert_multi(ccystl::move(nh));
+    }
+
+    iterator insert(const_iterator hint, node_type&& nh) {
+        return tree_.insert_multi(hint, ccystl::move(nh));
+    }
+
+    template <class Compare2>
+    void merge(set<Key, Compare2, Alloc, CountSubtree>& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(set<Key, Compare2, Alloc, CountSubtree>&& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(multiset<Key, Compare2, Alloc, CountSubtree>& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(multiset<Key, Compare2, Alloc, CountSubtree>&& source) {
+        tree_.merge_multi(source.tree_);
+    }
+
     // multiset 相关操作
 
     iterator find(const key_type& key) {
@@ -245,6 +316,92 @@ public:
         return tree_.equal_range_multi(key);
     }
 
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_multi(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_multi(key);
+    }
+
+    // 顺序统计，只有 CountSubtree 为 true（即 ranked_multiset）时可用，均为 O(log n)
+
+    // 键值小于 key 的元素个数
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    size_type rank(const key_type& key) const {
+        return tree_.rank(key);
+    }
+
+    template <class K, bool B = CountSubtree, std::enable_if_t<B, int> = 0,
+              enable_if_transparent_t<K, Compare> = 0>
+    size_type rank(const K& key) const {
+        return tree_.rank(key);
+    }
+
+    // 下标为 k 的元素（从 0 开始），k 不小于 size() 时返回 end()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    iterator select(size_type k) const {
+        return tree_.select(k);
+    }
+
+    // 迭代器所指元素的下标，end() 的下标为 size()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    size_type index_of(const_iterator position) const {
+        return tree_.index_of(position);
+    }
+
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return tree_.distance(first, last);
+    }
+
+    // 令 position 前进 n 个位置（n 可以为负），越过两端时停在 end()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    void advance(iterator& position, difference_type n) const {
+        tree_.advance(position, n);
+    }
+
     void swap(multiset& rhs) noexcept {
         tree_.swap(rhs.tree_);
     }
@@ -260,40 +417,46 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class Compare>
-bool operator==(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator==(const multiset<Key, Compare, Alloc, CountSubtree>& lhs, const multiset<Key, Compare, Alloc, CountSubtree>& rhs) {
     return lhs == rhs;
 }
 
-template <class Key, class Compare>
-bool operator<(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator<(const multiset<Key, Compare, Alloc, CountSubtree>& lhs, const multiset<Key, Compare, Alloc, CountSubtree>& rhs) {
     return lhs < rhs;
 }
 
-template <class Key, class Compare>
-bool operator!=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator!=(const multiset<Key, Compare, Alloc, CountSubtree>& lhs, const multiset<Key, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs == rhs);
 }
 
-template <class Key, class Compare>
-bool operator>(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator>(const multiset<Key, Compare, Alloc, CountSubtree>& lhs, const multiset<Key, Compare, Alloc, CountSubtree>& rhs) {
     return rhs < lhs;
 }
 
-template <class Key, class Compare>
-bool operator<=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator<=(const multiset<Key, Compare, Alloc, CountSubtree>& lhs, const multiset<Key, Compare, Alloc, CountSubtree>& rhs) {
     return !(rhs < lhs);
 }
 
-template <class Key, class Compare>
-bool operator>=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator>=(const multiset<Key, Compare, Alloc, CountSubtree>& lhs, const multiset<Key, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs < rhs);
 }
 
 // 重载 ccystl 的 swap
-template <class Key, class Compare>
-void swap(multiset<Key, Compare>& lhs, multiset<Key, Compare>& rhs) noexcept {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+void swap(multiset<Key, Compare, Alloc, CountSubtree>& lhs, multiset<Key, Compare, Alloc, CountSubtree>& rhs) noexcept {
     lhs.swap(rhs);
 }
+
+namespace pmr {
+// 使用多态内存资源的 multiset
+template <class Key, class Compare = ccystl::less<Key>>
+using multiset = ccystl::multiset<Key, Compare, polymorphic_allocator<Key>>;
+} // namespace pmr
 } // namespace ccystl
 #endif // !CCYSTL_MULTISET_H_
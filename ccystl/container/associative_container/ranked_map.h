@@ -0,0 +1,42 @@
+#ifndef CCYSTL_RANKED_MAP_H_
+#define CCYSTL_RANKED_MAP_H_
+
+// 这个头文件包含两个模板别名 ranked_map 和 ranked_multimap
+// ranked_map      : 映射，接口与 map 相同，另外支持按下标访问，键值不允许重复
+// ranked_multimap : 映射，接口与 multimap 相同，另外支持按下标访问，键值允许重复
+
+// notes:
+//
+// 与 map / multimap 的区别：
+//   * 底层的 rb_tree 在每个节点中记录子树大小（顺序统计树），每个节点多占一个 size_t
+//   * rank、select、index_of、distance、advance 均为 O(log n)，multimap 的 count 也降为 O(log n)
+//   * 插入与删除时沿路径维护子树大小，仍为 O(log n)
+//   * 节点句柄与 map / multimap 的不通用，merge 只接受 ranked_map / ranked_multimap
+//
+// 其余接口与异常保证见 map.h、multimap.h
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/container/associative_container/map.h"
+#include "ccystl/container/associative_container/multimap.h"
+
+namespace ccystl {
+// 模板别名 ranked_map，即 CountSubtree 为 true 的 map
+template <class Key, class T, class Compare = ccystl::less<Key>,
+          class Alloc = ccystl::allocator<ccystl::pair<const Key, T>>>
+using ranked_map = ccystl::map<Key, T, Compare, Alloc, true>;
+
+// 模板别名 ranked_multimap，即 CountSubtree 为 true 的 multimap
+template <class Key, class T, class Compare = ccystl::less<Key>,
+          class Alloc = ccystl::allocator<ccystl::pair<const Key, T>>>
+using ranked_multimap = ccystl::multimap<Key, T, Compare, Alloc, true>;
+
+namespace pmr {
+// 使用多态内存资源的 ranked_map
+template <class Key, class T, class Compare = ccystl::less<Key>>
+using ranked_map = ccystl::ranked_map<Key, T, Compare, polymorphic_allocator<ccystl::pair<const Key, T>>>;
+// 使用多态内存资源的 ranked_multimap
+template <class Key, class T, class Compare = ccystl::less<Key>>
+using ranked_multimap = ccystl::ranked_multimap<Key, T, Compare, polymorphic_allocator<ccystl::pair<const Key, T>>>;
+} // namespace pmr
+} // namespace ccystl
+#endif // !CCYSTL_RANKED_MAP_H_
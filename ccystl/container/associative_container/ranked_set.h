@@ -0,0 +1,40 @@
+#ifndef CCYSTL_RANKED_SET_H_
+#define CCYSTL_RANKED_SET_H_
+
+// 这个头文件包含两个模板别名 ranked_set 和 ranked_multiset
+// ranked_set      : 集合，接口与 set 相同，另外支持按下标访问，键值不允许重复
+// ranked_multiset : 集合，接口与 multiset 相同，另外支持按下标访问，键值允许重复
+
+// notes:
+//
+// 与 set / multiset 的区别：
+//   * 底层的 rb_tree 在每个节点中记录子树大小（顺序统计树），每个节点多占一个 size_t
+//   * rank、select、index_of、distance、advance 均为 O(log n)，multiset 的 count 也降为 O(log n)
+//   * 插入与删除时沿路径维护子树大小，仍为 O(log n)
+//   * 节点句柄与 set / multiset 的不通用，merge 只接受 ranked_set / ranked_multiset
+//
+// 其余接口与异常保证见 set.h、multiset.h
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/container/associative_container/set.h"
+#include "ccystl/container/associative_container/multiset.h"
+
+namespace ccystl {
+// 模板别名 ranked_set，即 CountSubtree 为 true 的 set
+template <class Key, class Compare = ccystl::less<Key>, class Alloc = ccystl::allocator<Key>>
+using ranked_set = ccystl::set<Key, Compare, Alloc, true>;
+
+// 模板别名 ranked_multiset，即 CountSubtree 为 true 的 multiset
+template <class Key, class Compare = ccystl::less<Key>, class Alloc = ccystl::allocator<Key>>
+using ranked_multiset = ccystl::multiset<Key, Compare, Alloc, true>;
+
+namespace pmr {
+// 使用多态内存资源的 ranked_set
+template <class Key, class Compare = ccystl::less<Key>>
+using ranked_set = ccystl::ranked_set<Key, Compare, polymorphic_allocator<Key>>;
+// 使用多态内存资源的 ranked_multiset
+template <class Key, class Compare = ccystl::less<Key>>
+using ranked_multiset = ccystl::ranked_multiset<Key, Compare, polymorphic_allocator<Key>>;
+} // namespace pmr
+} // namespace ccystl
+#endif // !CCYSTL_RANKED_SET_H_
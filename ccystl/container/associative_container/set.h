@@ -11,13 +11,23 @@
 //   * emplace
 //   * emplace_hint
 //   * insert
+//
+// 集合运算 union_with / intersection_with / difference_with 缺省在调用者的线程上计算，
+// 传入 rb_tree_parallel_policy（见 ccystl/internal/rb_tree_parallel.h）时才会在多个线程上同时调用比较器；
+// 比较器可能抛出异常（调用运算符不是 noexcept）时改用线性归并，抛出异常时两个容器都不变
 
 #include "ccystl/internal/rb_tree.h"
 
 namespace ccystl {
+// forward declaration
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+class multiset;
+
 // 模板类 set，键值不允许重复
 // 参数一代表键值类型，参数二代表键值比较方式，缺省使用 ccystl::less
-template <class Key, class Compare = ccystl::less<Key>>
+// 参数三代表分配器类型，缺省使用 ccystl::allocator，可传入 ccystl::pool_allocator 使用节点内存池
+// 参数四为 true 时底层 rb_tree 记录子树大小，另外提供 rank、select 等顺序统计接口，一般通过 ranked_set 使用
+template <class Key, class Compare = ccystl::less<Key>, class Alloc = ccystl::allocator<Key>, bool CountSubtree = false>
 class set {
 public:
     typedef Key key_type;
@@ -27,12 +37,18 @@ public:
 
 private:
     // 以 ccystl::rb_tree 作为底层机制
-    typedef ccystl::rb_tree<value_type, key_compare> base_type;
+    typedef ccystl::rb_tree<value_type, key_compare, Alloc, CountSubtree> base_type;
     base_type tree_;
 
+    // merge 需要访问同类容器的底层 rb_tree
+    template <class, class, class, bool>
+    friend class set;
+    template <class, class, class, bool>
+    friend class multiset;
+
 public:
     // 使用 rb_tree 定义的型别
-    typedef typename base_type::node_type node_type;
+    typedef typename base_type::node_handle_type node_type;
     typedef typename base_type::const_pointer pointer;
     typedef typename base_type::const_pointer const_pointer;
     typedef typename base_type::const_reference reference;
@@ -44,25 +60,42 @@ public:
     typedef typename base_type::size_type size_type;
     typedef typename base_type::difference_type difference_type;
     typedef typename base_type::allocator_type allocator_type;
+    typedef ccystl::node_insert_return<iterator, node_type> insert_return_type;
 
 public:
     // 构造、复制、移动函数
     set() = default;
 
+    explicit set(const allocator_type& alloc)
+        : tree_(alloc) { }
+
+    explicit set(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : tree_(comp, alloc) { }
+
     template <class InputIterator>
-    set(InputIterator first, InputIterator last)
-        : tree_() {
+    set(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
         tree_.insert_unique(first, last);
     }
 
-    set(std::initializer_list<value_type> ilist)
-        : tree_() {
+    // 范围已按键值升序排列且没有重复的键值时不再检查，以 O(n) 直接建树
+    template <class InputIterator>
+    set(sorted_unique_t, InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
+        tree_.insert_unique(sorted_unique_t(), first, last);
+    }
+
+    set(std::initializer_list<value_type> ilist, const allocator_type& alloc = allocator_type())
+        : tree_(alloc) {
         tree_.insert_unique(ilist.begin(), ilist.end());
     }
 
     set(const set& rhs)
         : tree_(rhs.tree_) { }
 
+    set(const set& rhs, const allocator_type& alloc)
+        : tree_(rhs.tree_, alloc) { }
+
     set(set&& rhs) noexcept
         : tree_(ccystl::move(rhs.tree_)) { }
 
@@ -189,6 +222,11 @@ public:
         tree_.insert_unique(first, last);
     }
 
+    template <class InputIterator>
+    void insert(sorted_unique_t, InputIterator first, InputIterator last) {
+        tree_.insert_unique(sorted_unique_t(), first, last);
+    }
+
     void erase(iterator position) {
         tree_.erase(position);
     }
@@ -205,6 +243,79 @@ public:
         tree_.clear();
     }
 
+    // 节点句柄：在容器之间移动元素时只摘下、挂上节点，不重新分配
+
+    node_type extract(const_iterator position) {
+        return tree_.extract(position);
+    }
+
+    node_type extract(const key_type& key) {
+        return tree_.extract(key);
+    }
+
+    insert_return_type insert(node_type&& nh) {
+        auto res = tree_.insert_unique(ccystl::move(nh));
+        return insert_return_type{res.position, res.inserted, ccystl::move(res.node)};
+    }
+
+    iterator insert(const_iterator hint, node_type&& nh) {
+        return tree_.insert_unique(hint, ccystl::move(nh));
+    }
+
+    template <class Compare2>
+    void merge(set<Key, Compare2, Alloc, CountSubtree>& source) {
+        tree_.merge_unique(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(set<Key, Compare2, Alloc, CountSubtree>&& source) {
+        tree_.merge_unique(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(multiset<Key, Compare2, Alloc, CountSubtree>& source) {
+        tree_.merge_unique(source.tree_);
+    }
+
+    template <class Compare2>
+    void merge(multiset<Key, Compare2, Alloc, CountSubtree>&& source) {
+        tree_.merge_unique(source.tree_);
+    }
+
+    // 集合运算，基于 join 的红黑树算法，不分配节点：rhs 的元素或移入本容器或被释放，完成后 rhs 为空
+    // 两者分别有 m <= n 个元素时代价为 O(m log(n/m + 1))，policy 为 rb_tree_parallel_policy 时较大的子问题并行计算
+    // 键值相同时保留本容器的元素；两者的分配器必须相等
+
+    template <class Policy = rb_tree_sequential_policy>
+    void union_with(set& rhs, const Policy& policy = Policy()) {
+        tree_.union_unique(rhs.tree_, policy);
+    }
+
+    template <class Policy = rb_tree_sequential_policy>
+    void union_with(set&& rhs, const Policy& policy = Policy()) {
+        tree_.union_unique(rhs.tree_, policy);
+    }
+
+    template <class Policy = rb_tree_sequential_policy>
+    void intersection_with(set& rhs, const Policy& policy = Policy()) {
+        tree_.intersection_unique(rhs.tree_, policy);
+    }
+
+    template <class Policy = rb_tree_sequential_policy>
+    void intersection_with(set&& rhs, const Policy& policy = Policy()) {
+        tree_.intersection_unique(rhs.tree_, policy);
+    }
+
+    template <class Policy = rb_tree_sequential_policy>
+    void difference_with(set& rhs, const Policy& policy = Policy()) {
+        tree_.difference_unique(rhs.tree_, policy);
+    }
+
+    template <class Policy = rb_tree_sequential_policy>
+    void difference_with(set&& rhs, const Policy& policy = Policy()) {
+        tree_.difference_unique(rhs.tree_, policy);
+    }
+
     // set 相关操作
 
     iterator find(const key_type& key) {
@@ -245,6 +356,92 @@ public:
         return tree_.equal_range_unique(key);
     }
 
+    // 异构查找：比较器透明时（如 ccystl::less<>），可以直接用与 key_type 可比较的其他类型查找，不构造临时键值
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator find(const K& key) {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator find(const K& key) const {
+        return tree_.find(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    size_type count(const K& key) const {
+        return tree_.count_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator lower_bound(const K& key) {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator lower_bound(const K& key) const {
+        return tree_.lower_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    iterator upper_bound(const K& key) {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    const_iterator upper_bound(const K& key) const {
+        return tree_.upper_bound(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<iterator, iterator>
+    equal_range(const K& key) {
+        return tree_.equal_range_unique(key);
+    }
+
+    template <class K, enable_if_transparent_t<K, Compare> = 0>
+    pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        return tree_.equal_range_unique(key);
+    }
+
+    // 顺序统计，只有 CountSubtree 为 true（即 ranked_set）时可用，均为 O(log n)
+
+    // 键值小于 key 的元素个数
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    size_type rank(const key_type& key) const {
+        return tree_.rank(key);
+    }
+
+    template <class K, bool B = CountSubtree, std::enable_if_t<B, int> = 0,
+              enable_if_transparent_t<K, Compare> = 0>
+    size_type rank(const K& key) const {
+        return tree_.rank(key);
+    }
+
+    // 下标为 k 的元素（从 0 开始），k 不小于 size() 时返回 end()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    iterator select(size_type k) const {
+        return tree_.select(k);
+    }
+
+    // 迭代器所指元素的下标，end() 的下标为 size()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    size_type index_of(const_iterator position) const {
+        return tree_.index_of(position);
+    }
+
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return tree_.distance(first, last);
+    }
+
+    // 令 position 前进 n 个位置（n 可以为负），越过两端时停在 end()
+    template <bool B = CountSubtree, std::enable_if_t<B, int> = 0>
+    void advance(iterator& position, difference_type n) const {
+        tree_.advance(position, n);
+    }
+
     void swap(set& rhs) noexcept {
         tree_.swap(rhs.tree_);
     }
@@ -260,40 +457,46 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class Compare>
-bool operator==(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator==(const set<Key, Compare, Alloc, CountSubtree>& lhs, const set<Key, Compare, Alloc, CountSubtree>& rhs) {
     return lhs == rhs;
 }
 
-template <class Key, class Compare>
-bool operator<(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator<(const set<Key, Compare, Alloc, CountSubtree>& lhs, const set<Key, Compare, Alloc, CountSubtree>& rhs) {
     return lhs < rhs;
 }
 
-template <class Key, class Compare>
-bool operator!=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator!=(const set<Key, Compare, Alloc, CountSubtree>& lhs, const set<Key, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs == rhs);
 }
 
-template <class Key, class Compare>
-bool operator>(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator>(const set<Key, Compare, Alloc, CountSubtree>& lhs, const set<Key, Compare, Alloc, CountSubtree>& rhs) {
     return rhs < lhs;
 }
 
-template <class Key, class Compare>
-bool operator<=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator<=(const set<Key, Compare, Alloc, CountSubtree>& lhs, const set<Key, Compare, Alloc, CountSubtree>& rhs) {
     return !(rhs < lhs);
 }
 
-template <class Key, class Compare>
-bool operator>=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs) {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+bool operator>=(const set<Key, Compare, Alloc, CountSubtree>& lhs, const set<Key, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs < rhs);
 }
 
 // 重载 ccystl 的 swap
-template <class Key, class Compare>
-void swap(set<Key, Compare>& lhs, set<Key, Compare>& rhs) noexcept {
+template <class Key, class Compare, class Alloc, bool CountSubtree>
+void swap(set<Key, Compare, Alloc, CountSubtree>& lhs, set<Key, Compare, Alloc, CountSubtree>& rhs) noexcept {
     lhs.swap(rhs);
 }
+
+namespace pmr {
+// 使用多态内存资源的 set
+template <class Key, class Compare = ccystl::less<Key>>
+using set = ccystl::set<Key, Compare, polymorphic_allocator<Key>>;
+} // namespace pmr
 } // namespace ccystl
 #endif // !CCYSTL_SET_H_
@@ -10,5 +10,12 @@ using string = basic_string<char>;
 using wstring = basic_string<wchar_t>;
 using u16string = basic_string<char16_t>;
 using u32string = basic_string<char32_t>;
+
+namespace pmr {
+using string = pmr::basic_string<char>;
+using wstring = pmr::basic_string<wchar_t>;
+using u16string = pmr::basic_string<char16_t>;
+using u32string = pmr::basic_string<char32_t>;
+} // namespace pmr
 }
 #endif // !CCYSTL_ASTRING_H_
@@ -8,6 +8,7 @@
 #include "ccystl/allocator/allocator.h"
 
 #include "ccystl/allocator/memory.h"
+#include "ccystl/allocator/memory_resource.h"
 #include "ccystl/functor/functional.h"
 #include "ccystl/iterator/iterator.h"
 #include "ccystl/utils/except_def.h"
@@ -68,6 +69,7 @@ struct char_traits {
 };
 
 // Partialized. char_traits<char>
+// 空字符串不持有 buffer，长度为 0 时不调用 mem* 函数，以免传入空指针
 template <>
 struct char_traits<char> {
     typedef char char_type;
@@ -77,19 +79,27 @@ struct char_traits<char> {
     }
 
     static int compare(const char_type* s1, const char_type* s2, size_t n) noexcept {
+        if (n == 0)
+            return 0;
         return std::memcmp(s1, s2, n);
     }
 
     static char_type* copy(char_type* dst, const char_type* src, size_t n) noexcept {
         CCYSTL_DEBUG(src + n <= dst || dst + n <= src);
+        if (n == 0)
+            return dst;
         return static_cast<char_type*>(std::memcpy(dst, src, n));
     }
 
     static char_type* move(char_type* dst, const char_type* src, size_t n) noexcept {
+        if (n == 0)
+            return dst;
         return static_cast<char_type*>(std::memmove(dst, src, n));
     }
 
     static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept {
+        if (count == 0)
+            return dst;
         return static_cast<char_type*>(std::memset(dst, ch, count));
     }
 };
@@ -104,19 +114,27 @@ struct char_traits<wchar_t> {
     }
 
     static int compare(const char_type* s1, const char_type* s2, size_t n) noexcept {
+        if (n == 0)
+            return 0;
         return std::wmemcmp(s1, s2, n);
     }
 
     static char_type* copy(char_type* dst, const char_type* src, size_t n) noexcept {
         CCYSTL_DEBUG(src + n <= dst || dst + n <= src);
+        if (n == 0)
+            return dst;
         return static_cast<char_type*>(std::wmemcpy(dst, src, n));
     }
 
     static char_type* move(char_type* dst, const char_type* src, size_t n) noexcept {
+        if (n == 0)
+            return dst;
         return static_cast<char_type*>(std::wmemmove(dst, src, n));
     }
 
     static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept {
+        if (count == 0)
+            return dst;
         return static_cast<char_type*>(std::wmemset(dst, ch, count));
     }
 };
@@ -227,19 +245,21 @@ struct char_traits<char32_t> {
     }
 };
 
-// 初始化 basic_string 尝试分配的最小 buffer 大小，可能被忽略
+// 非空 basic_string 第一次分配 buffer 时的最小容量，空字符串不分配 buffer
 #define STRING_INIT_SIZE 32
 
 // 模板类 basic_string
 // 参数一代表字符类型，参数二代表萃取字符类型的方式，缺省使用 ccystl::char_traits
-template <class CharType, class CharTraits = ccystl::char_traits<CharType>>
+// 参数三代表分配器类型，缺省使用 ccystl::allocator
+template <class CharType, class CharTraits = ccystl::char_traits<CharType>,
+          class Alloc = ccystl::allocator<CharType>>
 class basic_string {
 public:
     typedef CharTraits traits_type;
     typedef CharTraits char_traits;
 
-    typedef allocator<CharType> allocator_type;
-    typedef ccystl::allocator<CharType> data_allocator;
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<CharType>::other data_allocator;
 
     typedef typename allocator_type::value_type value_type;
     typedef typename allocator_type::pointer pointer;
@@ -254,8 +274,8 @@ public:
     typedef ccystl::reverse_iterator<iterator> reverse_iterator;
     typedef ccystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
-    static allocator_type get_allocator() {
-        return allocator_type();
+    allocator_type get_allocator() const {
+        return allocator_type(alloc_);
     }
 
     static_assert(std::is_pod_v<CharType>, "Character type of basic_string must be a POD");
@@ -268,62 +288,75 @@ public:
     static constexpr size_type npos = static_cast<size_type>(-1);
 
 private:
-    iterator buffer_; // 储存字符串的起始位置
-    size_type size_; // 大小
-    size_type cap_; // 容量
+    // 空字符串不持有 buffer，直到第一次写入时才分配；
+    // buffer 总是比 cap_ 多分配一个字符，用于存放 c_str() 的结尾空字符
+    iterator buffer_ = nullptr; // 储存字符串的起始位置
+    size_type size_ = 0; // 大小
+    size_type cap_ = 0; // 容量
+    [[no_unique_address]] data_allocator alloc_; // 分配器
 
 public:
     // 构造、复制、移动、析构函数
 
-    basic_string() noexcept {
-        try_init();
+    basic_string() noexcept = default;
+
+    explicit basic_string(const allocator_type& alloc) noexcept
+        : alloc_(alloc) {
     }
 
-    basic_string(size_type n, value_type ch)
-        : buffer_(nullptr), size_(0), cap_(0) {
+    basic_string(size_type n, value_type ch, const allocator_type& alloc = allocator_type())
+        : buffer_(nullptr), size_(0), cap_(0), alloc_(alloc) {
         fill_init(n, ch);
     }
 
-    basic_string(const basic_string& other, size_type pos)
-        : buffer_(nullptr), size_(0), cap_(0) {
+    basic_string(const basic_string& other, size_type pos,
+                 const allocator_type& alloc = allocator_type())
+        : buffer_(nullptr), size_(0), cap_(0), alloc_(alloc) {
         init_from(other.buffer_, pos, other.size_ - pos);
     }
 
-    basic_string(const basic_string& other, size_type pos, size_type count)
-        : buffer_(nullptr), size_(0), cap_(0) {
+    basic_string(const basic_string& other, size_type pos, size_type count,
+                 const allocator_type& alloc = allocator_type())
+        : buffer_(nullptr), size_(0), cap_(0), alloc_(alloc) {
         init_from(other.buffer_, pos, count);
     }
 
-    explicit basic_string(const_pointer str)
-        : buffer_(nullptr), size_(0), cap_(0) {
+    explicit basic_string(const_pointer str, const allocator_type& alloc = allocator_type())
+        : buffer_(nullptr), size_(0), cap_(0), alloc_(alloc) {
         init_from(str, 0, char_traits::length(str));
     }
 
-    basic_string(const_pointer str, size_type count)
-        : buffer_(nullptr), size_(0), cap_(0) {
+    basic_string(const_pointer str, size_type count, const allocator_type& alloc = allocator_type())
+        : buffer_(nullptr), size_(0), cap_(0), alloc_(alloc) {
         init_from(str, 0, count);
     }
 
     template <class Iter, std::enable_if_t<
                   is_input_iterator<Iter>::value, int>  = 0>
-    basic_string(Iter first, Iter last) {
+    basic_string(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
         copy_init(first, last, iterator_category(first));
     }
 
     basic_string(const basic_string& rhs)
-        : buffer_(nullptr), size_(0), cap_(0) {
+        : buffer_(nullptr), size_(0), cap_(0), alloc_(rhs.alloc_) {
+        init_from(rhs.buffer_, 0, rhs.size_);
+    }
+
+    basic_string(const basic_string& rhs, const allocator_type& alloc)
+        : buffer_(nullptr), size_(0), cap_(0), alloc_(alloc) {
         init_from(rhs.buffer_, 0, rhs.size_);
     }
 
     basic_string(basic_string&& rhs) noexcept
-        : buffer_(rhs.buffer_), size_(rhs.size_), cap_(rhs.cap_) {
+        : buffer_(rhs.buffer_), size_(rhs.size_), cap_(rhs.cap_), alloc_(rhs.alloc_) {
         rhs.buffer_ = nullptr;
         rhs.size_ = 0;
         rhs.cap_ = 0;
     }
 
     basic_string& operator=(const basic_string& rhs);
-    basic_string& operator=(basic_string&& rhs) noexcept;
+    basic_string& operator=(basic_string&& rhs) noexcept(std::is_empty_v<data_allocator>);
 
     basic_string& operator=(const_pointer str);
     basic_string& operator=(value_type ch);
@@ -535,7 +568,7 @@ public:
     // substr
     basic_string substr(size_type index, size_type count = npos) {
         count = ccystl::min(count, size_ - index);
-        return basic_string(buffer_ + index, buffer_ + index + count);
+        return basic_string(buffer_ + index, buffer_ + index + count, get_allocator());
     }
 
     // replace
@@ -675,8 +708,6 @@ private:
     // helper functions
 
     // init / destroy
-    void try_init() noexcept;
-
     void fill_init(size_type n, value_type ch);
 
     template <class Iter>
@@ -688,6 +719,15 @@ private:
 
     void destroy_buffer();
 
+    // 分配与释放可容纳 cap 个字符（另加结尾空字符）的 buffer
+    pointer allocate_buffer(size_type cap) {
+        return alloc_.allocate(cap + 1);
+    }
+
+    void deallocate_buffer(pointer buffer, size_type cap) {
+        alloc_.deallocate(buffer, cap + 1);
+    }
+
     // get raw pointer
     const_pointer to_raw_pointer() const;
 
@@ -708,6 +748,8 @@ private:
     basic_string& replace_copy(const_iterator first, const_iterator last, Iter first2, Iter last2);
 
     // reallocate
+    size_type get_new_cap(size_type need) const;
+    void relocate_buffer(size_type new_cap);
     void reallocate(size_type need);
     iterator reallocate_and_fill(iterator pos, size_type n, value_type ch);
     iterator reallocate_and_copy(iterator pos, const_iterator first, const_iterator last);
@@ -716,22 +758,30 @@ private:
 /*****************************************************************************************/
 
 // 复制赋值操作符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 operator=(const basic_string& rhs) {
     if (this != &rhs) {
-        basic_string tmp(rhs);
+        basic_string tmp(rhs, get_allocator());
         swap(tmp);
     }
     return *this;
 }
 
 // 移动赋值操作符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
-operator=(basic_string&& rhs) noexcept {
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
+operator=(basic_string&& rhs) noexcept(std::is_empty_v<data_allocator>) {
+    if (this == &rhs)
+        return *this;
+    if (!(alloc_ == rhs.alloc_)) {
+        // 分配器不随移动赋值传播，只能复制字符
+        basic_string tmp(rhs, get_allocator());
+        swap(tmp);
+        return *this;
+    }
     destroy_buffer();
     buffer_ = rhs.buffer_;
     size_ = rhs.size_;
@@ -743,16 +793,16 @@ operator=(basic_string&& rhs) noexcept {
 }
 
 // 用一个字符串赋值
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 operator=(const_pointer str) {
     const size_type len = char_traits::length(str);
     if (cap_ < len) {
-        auto new_buffer = data_allocator::allocate(len + 1);
-        data_allocator::deallocate(buffer_);
+        auto new_buffer = allocate_buffer(len);
+        deallocate_buffer(buffer_, cap_);
         buffer_ = new_buffer;
-        cap_ = len + 1;
+        cap_ = len;
     }
     char_traits::copy(buffer_, str, len);
     size_ = len;
@@ -760,15 +810,15 @@ operator=(const_pointer str) {
 }
 
 // 用一个字符赋值
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 operator=(value_type ch) {
     if (cap_ < 1) {
-        auto new_buffer = data_allocator::allocate(2);
-        data_allocator::deallocate(buffer_);
+        auto new_buffer = allocate_buffer(1);
+        deallocate_buffer(buffer_, cap_);
         buffer_ = new_buffer;
-        cap_ = 2;
+        cap_ = 1;
     }
     *buffer_ = ch;
     size_ = 1;
@@ -776,22 +826,19 @@ operator=(value_type ch) {
 }
 
 // 预留储存空间
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reserve(size_type n) {
     if (cap_ < n) {
         THROW_LENGTH_ERROR_IF(n > max_size(), "n can not larger than max_size()"
                               "in basic_string<Char,Traits>::reserve(n)");
-        auto new_buffer = data_allocator::allocate(n);
-        char_traits::move(new_buffer, buffer_, size_);
-        buffer_ = new_buffer;
-        cap_ = n;
+        relocate_buffer(n);
     }
 }
 
 // 减少不用的空间
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 shrink_to_fit() {
     if (size_ != cap_) {
         reinsert(size_);
@@ -799,9 +846,9 @@ shrink_to_fit() {
 }
 
 // 在 pos 处插入一个元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 insert(const_iterator pos, value_type ch) {
     auto r = const_cast<iterator>(pos);
     if (size_ == cap_) {
@@ -814,9 +861,9 @@ insert(const_iterator pos, value_type ch) {
 }
 
 // 在 pos 处插入 n 个元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 insert(const_iterator pos, size_type count, value_type ch) {
     auto r = const_cast<iterator>(pos);
     if (count == 0)
@@ -836,10 +883,10 @@ insert(const_iterator pos, size_type count, value_type ch) {
 }
 
 // 在 pos 处插入 [first, last) 内的元素
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 insert(const_iterator pos, Iter first, Iter last) {
     auto r = const_cast<iterator>(pos);
     const size_type len = ccystl::distance(first, last);
@@ -860,9 +907,9 @@ insert(const_iterator pos, Iter first, Iter last) {
 }
 
 // 在末尾添加 count 个 ch
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 append(size_type count, value_type ch) {
     THROW_LENGTH_ERROR_IF(size_ > max_size() - count,
                           "basic_string<Char, Tratis>'s size too big");
@@ -875,9 +922,9 @@ append(size_type count, value_type ch) {
 }
 
 // 在末尾添加 [str[pos] str[pos+count]) 一段
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 append(const basic_string& str, size_type pos, size_type count) {
     THROW_LENGTH_ERROR_IF(size_ > max_size() - count,
                           "basic_string<Char, Tratis>'s size too big");
@@ -892,9 +939,9 @@ append(const basic_string& str, size_type pos, size_type count) {
 }
 
 // 在末尾添加 [s, s+count) 一段
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 append(const_pointer s, size_type count) {
     THROW_LENGTH_ERROR_IF(size_ > max_size() - count,
                           "basic_string<Char, Tratis>'s size too big");
@@ -907,9 +954,9 @@ append(const_pointer s, size_type count) {
 }
 
 // 删除 pos 处的元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 erase(const_iterator pos) {
     ccystl_DEBUG(pos != end());
     auto r = const_cast<iterator>(pos);
@@ -919,9 +966,9 @@ erase(const_iterator pos) {
 }
 
 // 删除 [first, last) 的元素
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 erase(const_iterator first, const_iterator last) {
     if (first == begin() && last == end()) {
         clear();
@@ -935,8 +982,8 @@ erase(const_iterator first, const_iterator last) {
 }
 
 // 重置容器大小
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 resize(size_type count, value_type ch) {
     if (count < size_) {
         erase(buffer_ + count, buffer_ + size_);
@@ -947,23 +994,23 @@ resize(size_type count, value_type ch) {
 }
 
 // 比较两个 basic_string，小于返回 -1，大于返回 1，等于返回 0
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(const basic_string& other) const {
     return compare_cstr(buffer_, size_, other.buffer_, other.size_);
 }
 
 // 从 pos1 下标开始的 count1 个字符跟另一个 basic_string 比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const basic_string& other) const {
     auto n1 = ccystl::min(count1, size_ - pos1);
     return compare_cstr(buffer_ + pos1, n1, other.buffer_, other.size_);
 }
 
 // 从 pos1 下标开始的 count1 个字符跟另一个 basic_string 下标 pos2 开始的 count2 个字符比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const basic_string& other,
         size_type pos2, size_type count2) const {
     auto n1 = ccystl::min(count1, size_ - pos1);
@@ -972,16 +1019,16 @@ compare(size_type pos1, size_type count1, const basic_string& other,
 }
 
 // 跟一个字符串比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(const_pointer s) const {
     auto n2 = char_traits::length(s);
     return compare_cstr(buffer_, size_, s, n2);
 }
 
 // 从下标 pos1 开始的 count1 个字符跟另一个字符串比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const_pointer s) const {
     auto n1 = ccystl::min(count1, size_ - pos1);
     auto n2 = char_traits::length(s);
@@ -989,16 +1036,16 @@ compare(size_type pos1, size_type count1, const_pointer s) const {
 }
 
 // 从下标 pos1 开始的 count1 个字符跟另一个字符串的前 count2 个字符比较
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare(size_type pos1, size_type count1, const_pointer s, size_type count2) const {
     auto n1 = ccystl::min(count1, size_ - pos1);
     return compare_cstr(buffer_, n1, s, count2);
 }
 
 // 反转 basic_string
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reverse() noexcept {
     for (auto i = begin(), j = end(); i < j;) {
         ccystl::iter_swap(i++, --j);
@@ -1006,20 +1053,21 @@ reverse() noexcept {
 }
 
 // 交换两个 basic_string
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 swap(basic_string& rhs) noexcept {
     if (this != &rhs) {
         ccystl::swap(buffer_, rhs.buffer_);
         ccystl::swap(size_, rhs.size_);
         ccystl::swap(cap_, rhs.cap_);
+        ccystl::swap(alloc_, rhs.alloc_);
     }
 }
 
 // 从下标 pos 开始查找字符为 ch 的元素，若找到返回其下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(value_type ch, size_type pos) const noexcept {
     for (auto i = pos; i < size_; ++i) {
         if (*(buffer_ + i) == ch)
@@ -1029,9 +1077,9 @@ find(value_type ch, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找字符串 str，若找到返回起始位置的下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(const_pointer str, size_type pos) const noexcept {
     const auto len = char_traits::length(str);
     if (len == 0)
@@ -1054,9 +1102,9 @@ find(const_pointer str, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找字符串 str 的前 count 个字符，若找到返回起始位置的下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(const_pointer str, size_type pos, size_type count) const noexcept {
     if (count == 0)
         return pos;
@@ -1078,9 +1126,9 @@ find(const_pointer str, size_type pos, size_type count) const noexcept {
 }
 
 // 从下标 pos 开始查找字符串 str，若找到返回起始位置的下标，否则返回 npos
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find(const basic_string& str, size_type pos) const noexcept {
     const size_type count = str.size_;
     if (count == 0)
@@ -1103,9 +1151,9 @@ find(const basic_string& str, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始反向查找值为 ch 的元素，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(value_type ch, size_type pos) const noexcept {
     if (pos >= size_)
         pos = size_ - 1;
@@ -1117,9 +1165,9 @@ rfind(value_type ch, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始反向查找字符串 str，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(const_pointer str, size_type pos) const noexcept {
     if (pos >= size_)
         pos = size_ - 1;
@@ -1154,9 +1202,9 @@ rfind(const_pointer str, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始反向查找字符串 str 前 count 个字符，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(const_pointer str, size_type pos, size_type count) const noexcept {
     if (count == 0)
         return pos;
@@ -1179,9 +1227,9 @@ rfind(const_pointer str, size_type pos, size_type count) const noexcept {
 }
 
 // 从下标 pos 开始反向查找字符串 str，与 find 类似
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 rfind(const basic_string& str, size_type pos) const noexcept {
     const size_type count = str.size_;
     if (pos >= size_)
@@ -1205,9 +1253,9 @@ rfind(const basic_string& str, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找 ch 出现的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(value_type ch, size_type pos) const noexcept {
     for (auto i = pos; i < size_; ++i) {
         if (*(buffer_ + i) == ch)
@@ -1217,9 +1265,9 @@ find_first_of(value_type ch, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找字符串 s 其中的一个字符出现的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(const_pointer s, size_type pos) const noexcept {
     const size_type len = char_traits::length(s);
     for (auto i = pos; i < size_; ++i) {
@@ -1233,9 +1281,9 @@ find_first_of(const_pointer s, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找字符串 s
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(const_pointer s, size_type pos, size_type count) const noexcept {
     for (auto i = pos; i < size_; ++i) {
         value_type ch = *(buffer_ + i);
@@ -1248,9 +1296,9 @@ find_first_of(const_pointer s, size_type pos, size_type count) const noexcept {
 }
 
 // 从下标 pos 开始查找字符串 str 其中一个字符出现的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_of(const basic_string& str, size_type pos) const noexcept {
     for (auto i = pos; i < size_; ++i) {
         value_type ch = *(buffer_ + i);
@@ -1263,9 +1311,9 @@ find_first_of(const basic_string& str, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与 ch 不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(value_type ch, size_type pos) const noexcept {
     for (auto i = pos; i < size_; ++i) {
         if (*(buffer_ + i) != ch)
@@ -1275,9 +1323,9 @@ find_first_not_of(value_type ch, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与字符串 s 其中一个字符不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(const_pointer s, size_type pos) const noexcept {
     const size_type len = char_traits::length(s);
     for (auto i = pos; i < size_; ++i) {
@@ -1291,9 +1339,9 @@ find_first_not_of(const_pointer s, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与字符串 s 前 count 个字符中不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(const_pointer s, size_type pos, size_type count) const noexcept {
     for (auto i = pos; i < size_; ++i) {
         value_type ch = *(buffer_ + i);
@@ -1306,9 +1354,9 @@ find_first_not_of(const_pointer s, size_type pos, size_type count) const noexcep
 }
 
 // 从下标 pos 开始查找与字符串 str 的字符中不相等的第一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_first_not_of(const basic_string& str, size_type pos) const noexcept {
     for (auto i = pos; i < size_; ++i) {
         value_type ch = *(buffer_ + i);
@@ -1321,9 +1369,9 @@ find_first_not_of(const basic_string& str, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与 ch 相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(value_type ch, size_type pos) const noexcept {
     for (auto i = size_ - 1; i >= pos; --i) {
         if (*(buffer_ + i) == ch)
@@ -1333,9 +1381,9 @@ find_last_of(value_type ch, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与字符串 s 其中一个字符相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(const_pointer s, size_type pos) const noexcept {
     const size_type len = char_traits::length(s);
     for (auto i = size_ - 1; i >= pos; --i) {
@@ -1349,9 +1397,9 @@ find_last_of(const_pointer s, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与字符串 s 前 count 个字符中相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(const_pointer s, size_type pos, size_type count) const noexcept {
     for (auto i = size_ - 1; i >= pos; --i) {
         value_type ch = *(buffer_ + i);
@@ -1364,9 +1412,9 @@ find_last_of(const_pointer s, size_type pos, size_type count) const noexcept {
 }
 
 // 从下标 pos 开始查找与字符串 str 字符中相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_of(const basic_string& str, size_type pos) const noexcept {
     for (auto i = size_ - 1; i >= pos; --i) {
         value_type ch = *(buffer_ + i);
@@ -1379,9 +1427,9 @@ find_last_of(const basic_string& str, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与 ch 字符不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(value_type ch, size_type pos) const noexcept {
     for (auto i = size_ - 1; i >= pos; --i) {
         if (*(buffer_ + i) != ch)
@@ -1391,9 +1439,9 @@ find_last_not_of(value_type ch, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与字符串 s 的字符中不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(const_pointer s, size_type pos) const noexcept {
     const size_type len = char_traits::length(s);
     for (auto i = size_ - 1; i >= pos; --i) {
@@ -1407,9 +1455,9 @@ find_last_not_of(const_pointer s, size_type pos) const noexcept {
 }
 
 // 从下标 pos 开始查找与字符串 s 前 count 个字符中不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(const_pointer s, size_type pos, size_type count) const noexcept {
     for (auto i = size_ - 1; i >= pos; --i) {
         value_type ch = *(buffer_ + i);
@@ -1422,9 +1470,9 @@ find_last_not_of(const_pointer s, size_type pos, size_type count) const noexcept
 }
 
 // 从下标 pos 开始查找与字符串 str 字符中不相等的最后一个位置
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 find_last_not_of(const basic_string& str, size_type pos) const noexcept {
     for (auto i = size_ - 1; i >= pos; --i) {
         value_type ch = *(buffer_ + i);
@@ -1437,9 +1485,9 @@ find_last_not_of(const basic_string& str, size_type pos) const noexcept {
 }
 
 // 返回从下标 pos 开始字符为 ch 的元素出现的次数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::size_type
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
 count(value_type ch, size_type pos) const noexcept {
     size_type n = 0;
     for (auto i = pos; i < size_; ++i) {
@@ -1452,43 +1500,30 @@ count(value_type ch, size_type pos) const noexcept {
 /*****************************************************************************************/
 // helper function
 
-// 尝试初始化一段 buffer，若分配失败则忽略，不会抛出异常
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
-try_init() noexcept {
-    try {
-        buffer_ = data_allocator::allocate(static_cast<size_type>(STRING_INIT_SIZE));
-        size_ = 0;
-        cap_ = 0;
-    }
-    catch (...) {
-        buffer_ = nullptr;
-        size_ = 0;
-        cap_ = 0;
-        // no throw
-    }
-}
-
 // fill_init 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 fill_init(size_type n, value_type ch) {
-    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), n + 1);
-    buffer_ = data_allocator::allocate(init_size);
+    if (n == 0)
+        return;
+    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), n);
+    buffer_ = allocate_buffer(init_size);
     char_traits::fill(buffer_, ch, n);
     size_ = n;
     cap_ = init_size;
 }
 
 // copy_init 函数
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-void basic_string<CharType, CharTraits>::
+void basic_string<CharType, CharTraits, Alloc>::
 copy_init(Iter first, Iter last, ccystl::input_iterator_tag) {
     size_type n = ccystl::distance(first, last);
-    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), n + 1);
+    if (n == 0)
+        return;
+    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), n);
     try {
-        buffer_ = data_allocator::allocate(init_size);
+        buffer_ = allocate_buffer(init_size);
         size_ = n;
         cap_ = init_size;
     }
@@ -1502,14 +1537,16 @@ copy_init(Iter first, Iter last, ccystl::input_iterator_tag) {
         append(*first);
 }
 
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-void basic_string<CharType, CharTraits>::
+void basic_string<CharType, CharTraits, Alloc>::
 copy_init(Iter first, Iter last, ccystl::forward_iterator_tag) {
     const size_type n = ccystl::distance(first, last);
-    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), n + 1);
+    if (n == 0)
+        return;
+    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), n);
     try {
-        buffer_ = data_allocator::allocate(init_size);
+        buffer_ = allocate_buffer(init_size);
         size_ = n;
         cap_ = init_size;
         ccystl::uninitialized_copy(first, last, buffer_);
@@ -1523,22 +1560,24 @@ copy_init(Iter first, Iter last, ccystl::forward_iterator_tag) {
 }
 
 // init_from 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 init_from(const_pointer src, size_type pos, size_type count) {
-    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), count + 1);
-    buffer_ = data_allocator::allocate(init_size);
+    if (count == 0)
+        return;
+    const auto init_size = ccystl::max(static_cast<size_type>(STRING_INIT_SIZE), count);
+    buffer_ = allocate_buffer(init_size);
     char_traits::copy(buffer_, src + pos, count);
     size_ = count;
     cap_ = init_size;
 }
 
 // destroy_buffer 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 destroy_buffer() {
     if (buffer_ != nullptr) {
-        data_allocator::deallocate(buffer_, cap_);
+        deallocate_buffer(buffer_, cap_);
         buffer_ = nullptr;
         size_ = 0;
         cap_ = 0;
@@ -1546,35 +1585,48 @@ destroy_buffer() {
 }
 
 // to_raw_pointer 函数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::const_pointer
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::const_pointer
+basic_string<CharType, CharTraits, Alloc>::
 to_raw_pointer() const {
+    if (buffer_ == nullptr) {
+        static const value_type empty = value_type();
+        return &empty;
+    }
     *(buffer_ + size_) = value_type();
     return buffer_;
 }
 
 // reinsert 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reinsert(size_type size) {
-    auto new_buffer = data_allocator::allocate(size);
-    try {
-        char_traits::move(new_buffer, buffer_, size);
+    relocate_buffer(size);
+    size_ = size;
+}
+
+// relocate_buffer 函数
+// 将内容搬移到容量为 new_cap 的新空间，分配器支持时使用 realloc 原地扩容
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
+relocate_buffer(size_type new_cap) {
+    if constexpr (allocator_has_reallocate_v<data_allocator>) {
+        buffer_ = alloc_.reallocate(buffer_, cap_ + 1, new_cap + 1);
     }
-    catch (...) {
-        data_allocator::deallocate(new_buffer);
+    else {
+        auto new_buffer = allocate_buffer(new_cap);
+        ccystl::uninitialized_relocate(buffer_, buffer_ + size_, new_buffer);
+        deallocate_buffer(buffer_, cap_);
+        buffer_ = new_buffer;
     }
-    buffer_ = new_buffer;
-    size_ = size;
-    cap_ = size;
+    cap_ = new_cap;
 }
 
 // append_range，末尾追加一段 [first, last) 内的字符
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 append_range(Iter first, Iter last) {
     const size_type n = ccystl::distance(first, last);
     THROW_LENGTH_ERROR_IF(size_ > max_size() - n,
@@ -1587,8 +1639,8 @@ append_range(Iter first, Iter last) {
     return *this;
 }
 
-template <class CharType, class CharTraits>
-int basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+int basic_string<CharType, CharTraits, Alloc>::
 compare_cstr(const_pointer s1, size_type n1, const_pointer s2, size_type n2) const {
     auto rlen = ccystl::min(n1, n2);
     auto res = char_traits::compare(s1, s2, rlen);
@@ -1599,9 +1651,9 @@ compare_cstr(const_pointer s1, size_type n1, const_pointer s2, size_type n2) con
 }
 
 // 把 first 开始的 count1 个字符替换成 str 开始的 count2 个字符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 replace_cstr(const_iterator first, size_type count1, const_pointer str, size_type count2) {
     if (static_cast<size_type>(cend() - first) < count1) {
         count1 = cend() - first;
@@ -1628,9 +1680,9 @@ replace_cstr(const_iterator first, size_type count1, const_pointer str, size_typ
 }
 
 // 把 first 开始的 count1 个字符替换成 count2 个 ch 字符
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 replace_fill(const_iterator first, size_type count1, size_type count2, value_type ch) {
     if (static_cast<size_type>(cend() - first) < count1) {
         count1 = cend() - first;
@@ -1657,10 +1709,10 @@ replace_fill(const_iterator first, size_type count1, size_type count2, value_typ
 }
 
 // 把 [first, last) 的字符替换成 [first2, last2)
-template <class CharType, class CharTraits>
+template <class CharType, class CharTraits, class Alloc>
 template <class Iter>
-basic_string<CharType, CharTraits>&
-basic_string<CharType, CharTraits>::
+basic_string<CharType, CharTraits, Alloc>&
+basic_string<CharType, CharTraits, Alloc>::
 replace_copy(const_iterator first, const_iterator last, Iter first2, Iter last2) {
     size_type len1 = last - first;
     size_type len2 = last2 - first2;
@@ -1685,31 +1737,36 @@ replace_copy(const_iterator first, const_iterator last, Iter first2, Iter last2)
     return *this;
 }
 
+// get_new_cap 函数
+// 至少增加 need 个字符的容量并按 1.5 倍扩容，第一次分配时至少为 STRING_INIT_SIZE
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::size_type
+basic_string<CharType, CharTraits, Alloc>::
+get_new_cap(size_type need) const {
+    return ccystl::max(ccystl::max(cap_ + need, cap_ + (cap_ >> 1)),
+                       static_cast<size_type>(STRING_INIT_SIZE));
+}
+
 // reallocate 函数
-template <class CharType, class CharTraits>
-void basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+void basic_string<CharType, CharTraits, Alloc>::
 reallocate(size_type need) {
-    const auto new_cap = ccystl::max(cap_ + need, cap_ + (cap_ >> 1));
-    auto new_buffer = data_allocator::allocate(new_cap);
-    char_traits::move(new_buffer, buffer_, size_);
-    data_allocator::deallocate(buffer_);
-    buffer_ = new_buffer;
-    cap_ = new_cap;
+    relocate_buffer(get_new_cap(need));
 }
 
 // reallocate_and_fill 函数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 reallocate_and_fill(iterator pos, size_type n, value_type ch) {
     const auto r = pos - buffer_;
     const auto old_cap = cap_;
-    const auto new_cap = ccystl::max(old_cap + n, old_cap + (old_cap >> 1));
-    auto new_buffer = data_allocator::allocate(new_cap);
+    const auto new_cap = get_new_cap(n);
+    auto new_buffer = allocate_buffer(new_cap);
     auto e1 = char_traits::move(new_buffer, buffer_, r) + r;
     auto e2 = char_traits::fill(e1, ch, n) + n;
     char_traits::move(e2, buffer_ + r, size_ - r);
-    data_allocator::deallocate(buffer_, old_cap);
+    deallocate_buffer(buffer_, old_cap);
     buffer_ = new_buffer;
     size_ += n;
     cap_ = new_cap;
@@ -1717,19 +1774,19 @@ reallocate_and_fill(iterator pos, size_type n, value_type ch) {
 }
 
 // reallocate_and_copy 函数
-template <class CharType, class CharTraits>
-typename basic_string<CharType, CharTraits>::iterator
-basic_string<CharType, CharTraits>::
+template <class CharType, class CharTraits, class Alloc>
+typename basic_string<CharType, CharTraits, Alloc>::iterator
+basic_string<CharType, CharTraits, Alloc>::
 reallocate_and_copy(iterator pos, const_iterator first, const_iterator last) {
     const auto r = pos - buffer_;
     const auto old_cap = cap_;
     const size_type n = ccystl::distance(first, last);
-    const auto new_cap = ccystl::max(old_cap + n, old_cap + (old_cap >> 1));
-    auto new_buffer = data_allocator::allocate(new_cap);
+    const auto new_cap = get_new_cap(n);
+    auto new_buffer = allocate_buffer(new_cap);
     auto e1 = char_traits::move(new_buffer, buffer_, r) + r;
-    auto e2 = ccystl::uninitialized_copy_n(first, n, e1) + n;
+    auto e2 = ccystl::uninitialized_copy_n(first, n, e1);
     char_traits::move(e2, buffer_ + r, size_ - r);
-    data_allocator::deallocate(buffer_, old_cap);
+    deallocate_buffer(buffer_, old_cap);
     buffer_ = new_buffer;
     size_ += n;
     cap_ = new_cap;
@@ -1740,157 +1797,166 @@ reallocate_and_copy(iterator pos, const_iterator first, const_iterator last) {
 // 重载全局操作符
 
 // 重载 operator+
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs,
-          const basic_string<CharType, CharTraits>& rhs) {
-    basic_string<CharType, CharTraits> tmp(lhs);
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs,
+          const basic_string<CharType, CharTraits, Alloc>& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(lhs);
     tmp.append(rhs);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const CharType* lhs, const basic_string<CharType, CharTraits>& rhs) {
-    basic_string<CharType, CharTraits> tmp(lhs);
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const CharType* lhs, const basic_string<CharType, CharTraits, Alloc>& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(lhs);
     tmp.append(rhs);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(CharType ch, const basic_string<CharType, CharTraits>& rhs) {
-    basic_string<CharType, CharTraits> tmp(1, ch);
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(CharType ch, const basic_string<CharType, CharTraits, Alloc>& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(1, ch);
     tmp.append(rhs);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs, const CharType* rhs) {
-    basic_string<CharType, CharTraits> tmp(lhs);
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs, const CharType* rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(lhs);
     tmp.append(rhs);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs, CharType ch) {
-    basic_string<CharType, CharTraits> tmp(lhs);
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs, CharType ch) {
+    basic_string<CharType, CharTraits, Alloc> tmp(lhs);
     tmp.append(1, ch);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs,
-          const basic_string<CharType, CharTraits>& rhs) {
-    basic_string<CharType, CharTraits> tmp(ccystl::move(lhs));
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs,
+          const basic_string<CharType, CharTraits, Alloc>& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(ccystl::move(lhs));
     tmp.append(rhs);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const basic_string<CharType, CharTraits>& lhs,
-          basic_string<CharType, CharTraits>&& rhs) {
-    basic_string<CharType, CharTraits> tmp(ccystl::move(rhs));
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const basic_string<CharType, CharTraits, Alloc>& lhs,
+          basic_string<CharType, CharTraits, Alloc>&& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(ccystl::move(rhs));
     tmp.insert(tmp.begin(), lhs.begin(), lhs.end());
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs,
-          basic_string<CharType, CharTraits>&& rhs) {
-    basic_string<CharType, CharTraits> tmp(ccystl::move(lhs));
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs,
+          basic_string<CharType, CharTraits, Alloc>&& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(ccystl::move(lhs));
     tmp.append(rhs);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(const CharType* lhs, basic_string<CharType, CharTraits>&& rhs) {
-    basic_string<CharType, CharTraits> tmp(ccystl::move(rhs));
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(const CharType* lhs, basic_string<CharType, CharTraits, Alloc>&& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(ccystl::move(rhs));
     tmp.insert(tmp.begin(), lhs, lhs + char_traits<CharType>::length(lhs));
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(CharType ch, basic_string<CharType, CharTraits>&& rhs) {
-    basic_string<CharType, CharTraits> tmp(ccystl::move(rhs));
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(CharType ch, basic_string<CharType, CharTraits, Alloc>&& rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(ccystl::move(rhs));
     tmp.insert(tmp.begin(), ch);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs, const CharType* rhs) {
-    basic_string<CharType, CharTraits> tmp(ccystl::move(lhs));
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs, const CharType* rhs) {
+    basic_string<CharType, CharTraits, Alloc> tmp(ccystl::move(lhs));
     tmp.append(rhs);
     return tmp;
 }
 
-template <class CharType, class CharTraits>
-basic_string<CharType, CharTraits>
-operator+(basic_string<CharType, CharTraits>&& lhs, CharType ch) {
-    basic_string<CharType, CharTraits> tmp(ccystl::move(lhs));
+template <class CharType, class CharTraits, class Alloc>
+basic_string<CharType, CharTraits, Alloc>
+operator+(basic_string<CharType, CharTraits, Alloc>&& lhs, CharType ch) {
+    basic_string<CharType, CharTraits, Alloc> tmp(ccystl::move(lhs));
     tmp.append(1, ch);
     return tmp;
 }
 
 // 重载比较操作符
-template <class CharType, class CharTraits>
-bool operator==(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs) {
+template <class CharType, class CharTraits, class Alloc>
+bool operator==(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs) {
     return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator!=(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs) {
+template <class CharType, class CharTraits, class Alloc>
+bool operator!=(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs) {
     return lhs.size() != rhs.size() || lhs.compare(rhs) != 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator<(const basic_string<CharType, CharTraits>& lhs,
-               const basic_string<CharType, CharTraits>& rhs) {
+template <class CharType, class CharTraits, class Alloc>
+bool operator<(const basic_string<CharType, CharTraits, Alloc>& lhs,
+               const basic_string<CharType, CharTraits, Alloc>& rhs) {
     return lhs.compare(rhs) < 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator<=(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs) {
+template <class CharType, class CharTraits, class Alloc>
+bool operator<=(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs) {
     return lhs.compare(rhs) <= 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator>(const basic_string<CharType, CharTraits>& lhs,
-               const basic_string<CharType, CharTraits>& rhs) {
+template <class CharType, class CharTraits, class Alloc>
+bool operator>(const basic_string<CharType, CharTraits, Alloc>& lhs,
+               const basic_string<CharType, CharTraits, Alloc>& rhs) {
     return lhs.compare(rhs) > 0;
 }
 
-template <class CharType, class CharTraits>
-bool operator>=(const basic_string<CharType, CharTraits>& lhs,
-                const basic_string<CharType, CharTraits>& rhs) {
+template <class CharType, class CharTraits, class Alloc>
+bool operator>=(const basic_string<CharType, CharTraits, Alloc>& lhs,
+                const basic_string<CharType, CharTraits, Alloc>& rhs) {
     return lhs.compare(rhs) >= 0;
 }
 
 // 重载 ccystl 的 swap
-template <class CharType, class CharTraits>
-void swap(basic_string<CharType, CharTraits>& lhs,
-          basic_string<CharType, CharTraits>& rhs) noexcept {
+template <class CharType, class CharTraits, class Alloc>
+void swap(basic_string<CharType, CharTraits, Alloc>& lhs,
+          basic_string<CharType, CharTraits, Alloc>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
 // 特化 ccystl::hash
-template <class CharType, class CharTraits>
-struct hash<basic_string<CharType, CharTraits>> {
-    size_t operator()(const basic_string<CharType, CharTraits>& str) {
-        return bitwise_hash(static_cast<const unsigned char*>(str.c_str()),
-                            str.size() * sizeof(CharType));
+template <class CharType, class CharTraits, class Alloc>
+struct hash<basic_string<CharType, CharTraits, Alloc>> {
+    size_t operator()(const basic_string<CharType, CharTraits, Alloc>& str) const noexcept {
+        return static_cast<size_t>(hash_bytes(str.data(), str.size() * sizeof(CharType)));
     }
 };
+
+// basic_string 没有短字符串优化，只持有指向堆内存的指针，分配器可平凡重定位时它也可以
+template <class CharType, class CharTraits, class Alloc>
+struct is_trivially_relocatable<basic_string<CharType, CharTraits, Alloc>> : is_trivially_relocatable<Alloc> { };
+
+namespace pmr {
+// 使用多态内存资源的 basic_string
+template <class CharType, class CharTraits = ccystl::char_traits<CharType>>
+using basic_string = ccystl::basic_string<CharType, CharTraits, polymorphic_allocator<CharType>>;
+} // namespace pmr
 } // namespace ccystl
 #endif // !CCYSTL_BASIC_STRING_H_
@@ -18,7 +18,9 @@
 #include <initializer_list>
 
 #include "ccystl/iterator/iterator.h"
+#include "ccystl/allocator/allocator.h"
 #include "ccystl/allocator/memory.h"
+#include "ccystl/allocator/memory_resource.h"
 #include "ccystl/utils/utils.h"
 #include "ccystl/utils/except_def.h"
 
@@ -185,14 +187,14 @@ namespace ccystl {
     };
 
     // 模板类 deque
-    // 模板参数代表数据类型
-    template <class T>
+    // 模板参数 T 代表数据类型，Alloc 代表分配器类型，缺省使用 ccystl::allocator
+    template <class T, class Alloc = ccystl::allocator<T>>
     class deque {
     public:
         // deque 的型别定义
-        typedef ccystl::allocator<T>                      allocator_type;
-        typedef ccystl::allocator<T>                      data_allocator;
-        typedef ccystl::allocator<T*>                     map_allocator;
+        typedef Alloc                                                   allocator_type;
+        typedef typename Alloc::template rebind<T>::other               data_allocator;
+        typedef typename Alloc::template rebind<T*>::other              map_allocator;
 
         typedef typename allocator_type::value_type      value_type;
         typedef typename allocator_type::pointer         pointer;
@@ -209,50 +211,72 @@ namespace ccystl {
         typedef ccystl::reverse_iterator<iterator>        reverse_iterator;
         typedef ccystl::reverse_iterator<const_iterator>  const_reverse_iterator;
 
-        allocator_type get_allocator() { return allocator_type(); }
+        allocator_type get_allocator() const { return allocator_type(data_alloc_); }
 
         static const size_type buffer_size = deque_buf_size<T>::value;
 
     private:
         // 用以下四个数据来表现一个 deque
-        iterator       begin_;     // 指向第一个节点
-        iterator       end_;       // 指向最后一个结点
-        map_pointer    map_;       // 指向一块 map，map 中的每个元素都是一个指针，指向一个缓冲区
-        size_type      map_size_;  // map 内指针的数目
+        // 空 deque 不持有 map 与缓冲区，map_ 为空，直到第一次插入时才分配
+        iterator       begin_;         // 指向第一个节点
+        iterator       end_;           // 指向最后一个结点
+        map_pointer    map_ = nullptr; // 指向一块 map，map 中的每个元素都是一个指针，指向一个缓冲区
+        size_type      map_size_ = 0;  // map 内指针的数目
+        [[no_unique_address]] data_allocator data_alloc_;  // 缓冲区分配器
+        [[no_unique_address]] map_allocator  map_alloc_;   // map 分配器
 
     public:
         // 构造、复制、移动、析构函数
 
-        deque() {
-            fill_init(0, value_type());
+        deque() noexcept = default;
+
+        explicit deque(const allocator_type& alloc) noexcept
+            :data_alloc_(alloc), map_alloc_(alloc) {
         }
 
-        explicit deque(size_type n) {
+        explicit deque(size_type n, const allocator_type& alloc = allocator_type())
+            :data_alloc_(alloc), map_alloc_(alloc) {
             fill_init(n, value_type());
         }
 
-        deque(size_type n, const value_type& value) {
+        deque(size_type n, const value_type& value,
+              const allocator_type& alloc = allocator_type())
+            :data_alloc_(alloc), map_alloc_(alloc) {
             fill_init(n, value);
         }
 
         template <class IIter, typename std::enable_if<
             ccystl::is_input_iterator<IIter>::value, int>::type = 0>
-        deque(IIter first, IIter last) {
+        deque(IIter first, IIter last, const allocator_type& alloc = allocator_type())
+            :data_alloc_(alloc), map_alloc_(alloc) {
             copy_init(first, last, iterator_category(first));
         }
 
-        deque(std::initializer_list<value_type> ilist) {
+        deque(std::initializer_list<value_type> ilist,
+              const allocator_type& alloc = allocator_type())
+            :data_alloc_(alloc), map_alloc_(alloc) {
             copy_init(ilist.begin(), ilist.end(), ccystl::forward_iterator_tag());
         }
 
-        deque(const deque& rhs) {
+        deque(const deque& rhs)
+            :data_alloc_(rhs.data_alloc_), map_alloc_(rhs.map_alloc_) {
+            copy_init(rhs.begin(), rhs.end(), ccystl::forward_iterator_tag());
+        }
+
+        deque(const deque& rhs, const allocator_type& alloc)
+            :data_alloc_(alloc), map_alloc_(alloc) {
             copy_init(rhs.begin(), rhs.end(), ccystl::forward_iterator_tag());
         }
+
         deque(deque&& rhs) noexcept
             :begin_(ccystl::move(rhs.begin_)),
             end_(ccystl::move(rhs.end_)),
             map_(rhs.map_),
-            map_size_(rhs.map_size_) {
+            map_size_(rhs.map_size_),
+            data_alloc_(rhs.data_alloc_),
+            map_alloc_(rhs.map_alloc_) {
+            rhs.begin_ = iterator();
+            rhs.end_ = iterator();
             rhs.map_ = nullptr;
             rhs.map_size_ = 0;
         }
@@ -261,7 +285,7 @@ namespace ccystl {
         deque& operator=(deque&& rhs);
 
         deque& operator=(std::initializer_list<value_type> ilist) {
-            deque tmp(ilist);
+            deque tmp(ilist, get_allocator());
             swap(tmp);
             return *this;
         }
@@ -269,9 +293,9 @@ namespace ccystl {
         ~deque() {
             if (map_ != nullptr) {
                 clear();
-                data_allocator::deallocate(*begin_.node, buffer_size);
+                data_alloc_.deallocate(*begin_.node, buffer_size);
                 *begin_.node = nullptr;
-                map_allocator::deallocate(map_, map_size_);
+                map_alloc_.deallocate(map_, map_size_);
                 map_ = nullptr;
             }
         }
@@ -460,6 +484,7 @@ namespace ccystl {
 
         // reallocate
         void        require_capacity(size_type n, bool front);
+        map_pointer relocate_map(size_type need, bool front);
         void        reallocate_map_at_front(size_type need);
         void        reallocate_map_at_back(size_type need);
 
@@ -468,8 +493,8 @@ namespace ccystl {
     /*****************************************************************************************/
 
     // 复制赋值运算符
-    template <class T>
-    deque<T>& deque<T>::operator=(const deque& rhs) {
+    template <class T, class Alloc>
+    deque<T, Alloc>& deque<T, Alloc>::operator=(const deque& rhs) {
         if (this != &rhs) {
             const auto len = size();
             if (len >= rhs.size()) {
@@ -485,21 +510,28 @@ namespace ccystl {
     }
 
     // 移动赋值运算符
-    template <class T>
-    deque<T>& deque<T>::operator=(deque&& rhs) {
+    // 分配器不随移动赋值传播：两者的分配器不相等时，逐个移动元素
+    template <class T, class Alloc>
+    deque<T, Alloc>& deque<T, Alloc>::operator=(deque&& rhs) {
+        if (this == &rhs)
+            return *this;
         clear();
-        begin_ = ccystl::move(rhs.begin_);
-        end_ = ccystl::move(rhs.end_);
-        map_ = rhs.map_;
-        map_size_ = rhs.map_size_;
-        rhs.map_ = nullptr;
-        rhs.map_size_ = 0;
+        if (data_alloc_ == rhs.data_alloc_) {
+            // 经由临时对象交换，rhs 不会接手本容器原有的 map
+            deque tmp(ccystl::move(rhs));
+            swap(tmp);
+        }
+        else {
+            for (auto it = rhs.begin_; it != rhs.end_; ++it)
+                emplace_back(ccystl::move(*it));
+            rhs.clear();
+        }
         return *this;
     }
 
     // 重置容器大小
-    template <class T>
-    void deque<T>::resize(size_type new_size, const value_type& value) {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::resize(size_type new_size, const value_type& value) {
         const auto len = size();
         if (new_size < len) {
             erase(begin_ + new_size, end_);
@@ -510,32 +542,34 @@ namespace ccystl {
     }
 
     // 减小容器容量
-    template <class T>
-    void deque<T>::shrink_to_fit() noexcept {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::shrink_to_fit() noexcept {
+        if (map_ == nullptr)
+            return;
         // 至少会留下头部缓冲区
         for (auto cur = map_; cur < begin_.node; ++cur) {
-            data_allocator::deallocate(*cur, buffer_size);
+            data_alloc_.deallocate(*cur, buffer_size);
             *cur = nullptr;
         }
         for (auto cur = end_.node + 1; cur < map_ + map_size_; ++cur) {
-            data_allocator::deallocate(*cur, buffer_size);
+            data_alloc_.deallocate(*cur, buffer_size);
             *cur = nullptr;
         }
     }
 
     // 在头部就地构建元素
-    template <class T>
+    template <class T, class Alloc>
     template <class ...Args>
-    void deque<T>::emplace_front(Args&& ...args) {
+    void deque<T, Alloc>::emplace_front(Args&& ...args) {
         if (begin_.cur != begin_.first) {
-            data_allocator::construct(begin_.cur - 1, ccystl::forward<Args>(args)...);
+            data_alloc_.construct(begin_.cur - 1, ccystl::forward<Args>(args)...);
             --begin_.cur;
         }
         else {
             require_capacity(1, true);
             try {
                 --begin_;
-                data_allocator::construct(begin_.cur, ccystl::forward<Args>(args)...);
+                data_alloc_.construct(begin_.cur, ccystl::forward<Args>(args)...);
             }
             catch (...) {
                 ++begin_;
@@ -545,24 +579,24 @@ namespace ccystl {
     }
 
     // 在尾部就地构建元素
-    template <class T>
+    template <class T, class Alloc>
     template <class ...Args>
-    void deque<T>::emplace_back(Args&& ...args) {
-        if (end_.cur != end_.last - 1) {
-            data_allocator::construct(end_.cur, ccystl::forward<Args>(args)...);
+    void deque<T, Alloc>::emplace_back(Args&& ...args) {
+        if (end_.last - end_.cur > 1) {
+            data_alloc_.construct(end_.cur, ccystl::forward<Args>(args)...);
             ++end_.cur;
         }
         else {
             require_capacity(1, false);
-            data_allocator::construct(end_.cur, ccystl::forward<Args>(args)...);
+            data_alloc_.construct(end_.cur, ccystl::forward<Args>(args)...);
             ++end_;
         }
     }
 
     // 在 pos 位置就地构建元素
-    template <class T>
+    template <class T, class Alloc>
     template <class ...Args>
-    typename deque<T>::iterator deque<T>::emplace(iterator pos, Args&& ...args) {
+    typename deque<T, Alloc>::iterator deque<T, Alloc>::emplace(iterator pos, Args&& ...args) {
         if (pos.cur == begin_.cur) {
             emplace_front(ccystl::forward<Args>(args)...);
             return begin_;
@@ -575,17 +609,17 @@ namespace ccystl {
     }
 
     // 在头部插入元素
-    template <class T>
-    void deque<T>::push_front(const value_type& value) {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::push_front(const value_type& value) {
         if (begin_.cur != begin_.first) {
-            data_allocator::construct(begin_.cur - 1, value);
+            data_alloc_.construct(begin_.cur - 1, value);
             --begin_.cur;
         }
         else {
             require_capacity(1, true);
             try {
                 --begin_;
-                data_allocator::construct(begin_.cur, value);
+                data_alloc_.construct(begin_.cur, value);
             }
             catch (...) {
                 ++begin_;
@@ -595,53 +629,53 @@ namespace ccystl {
     }
 
     // 在尾部插入元素
-    template <class T>
-    void deque<T>::push_back(const value_type& value) {
-        if (end_.cur != end_.last - 1) {
-            data_allocator::construct(end_.cur, value);
+    template <class T, class Alloc>
+    void deque<T, Alloc>::push_back(const value_type& value) {
+        if (end_.last - end_.cur > 1) {
+            data_alloc_.construct(end_.cur, value);
             ++end_.cur;
         }
         else {
             require_capacity(1, false);
-            data_allocator::construct(end_.cur, value);
+            data_alloc_.construct(end_.cur, value);
             ++end_;
         }
     }
 
     // 弹出头部元素
-    template <class T>
-    void deque<T>::pop_front() {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::pop_front() {
         ccystl_DEBUG(!empty());
         if (begin_.cur != begin_.last - 1) {
-            data_allocator::destroy(begin_.cur);
+            data_alloc_.destroy(begin_.cur);
             ++begin_.cur;
         }
         else {
-            data_allocator::destroy(begin_.cur);
+            data_alloc_.destroy(begin_.cur);
             ++begin_;
             destroy_buffer(begin_.node - 1, begin_.node - 1);
         }
     }
 
     // 弹出尾部元素
-    template <class T>
-    void deque<T>::pop_back() {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::pop_back() {
         ccystl_DEBUG(!empty());
         if (end_.cur != end_.first) {
             --end_.cur;
-            data_allocator::destroy(end_.cur);
+            data_alloc_.destroy(end_.cur);
         }
         else {
             --end_;
-            data_allocator::destroy(end_.cur);
+            data_alloc_.destroy(end_.cur);
             destroy_buffer(end_.node + 1, end_.node + 1);
         }
     }
 
     // 在 position 处插入元素
-    template <class T>
-    typename deque<T>::iterator
-        deque<T>::insert(iterator position, const value_type& value) {
+    template <class T, class Alloc>
+    typename deque<T, Alloc>::iterator
+        deque<T, Alloc>::insert(iterator position, const value_type& value) {
         if (position.cur == begin_.cur) {
             push_front(value);
             return begin_;
@@ -657,9 +691,9 @@ namespace ccystl {
         }
     }
 
-    template <class T>
-    typename deque<T>::iterator
-        deque<T>::insert(iterator position, value_type&& value) {
+    template <class T, class Alloc>
+    typename deque<T, Alloc>::iterator
+        deque<T, Alloc>::insert(iterator position, value_type&& value) {
         if (position.cur == begin_.cur) {
             emplace_front(ccystl::move(value));
             return begin_;
@@ -676,8 +710,8 @@ namespace ccystl {
     }
 
     // 在 position 位置插入 n 个元素
-    template <class T>
-    void deque<T>::insert(iterator position, size_type n, const value_type& value) {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::insert(iterator position, size_type n, const value_type& value) {
         if (position.cur == begin_.cur) {
             require_capacity(n, true);
             auto new_begin = begin_ - n;
@@ -696,9 +730,9 @@ namespace ccystl {
     }
 
     // 删除 position 处的元素
-    template <class T>
-    typename deque<T>::iterator
-        deque<T>::erase(iterator position) {
+    template <class T, class Alloc>
+    typename deque<T, Alloc>::iterator
+        deque<T, Alloc>::erase(iterator position) {
         auto next = position;
         ++next;
         const size_type elems_before = position - begin_;
@@ -714,9 +748,9 @@ namespace ccystl {
     }
 
     // 删除[first, last)上的元素
-    template <class T>
-    typename deque<T>::iterator
-        deque<T>::erase(iterator first, iterator last) {
+    template <class T, class Alloc>
+    typename deque<T, Alloc>::iterator
+        deque<T, Alloc>::erase(iterator first, iterator last) {
         if (first == begin_ && last == end_) {
             clear();
             return end_;
@@ -727,13 +761,13 @@ namespace ccystl {
             if (elems_before < ((size() - len) / 2)) {
                 ccystl::copy_backward(begin_, first, last);
                 auto new_begin = begin_ + len;
-                data_allocator::destroy(begin_.cur, new_begin.cur);
+                data_alloc_.destroy(begin_.cur, new_begin.cur);
                 begin_ = new_begin;
             }
             else {
                 ccystl::copy(last, end_, first);
                 auto new_end = end_ - len;
-                data_allocator::destroy(new_end.cur, end_.cur);
+                data_alloc_.destroy(new_end.cur, end_.cur);
                 end_ = new_end;
             }
             return begin_ + elems_before;
@@ -741,11 +775,13 @@ namespace ccystl {
     }
 
     // 清空 deque
-    template <class T>
-    void deque<T>::clear() {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::clear() {
+        if (map_ == nullptr)
+            return;
         // clear 会保留头部的缓冲区
         for (map_pointer cur = begin_.node + 1; cur < end_.node; ++cur) {
-            data_allocator::destroy(*cur, *cur + buffer_size);
+            data_alloc_.destroy(*cur, *cur + buffer_size);
         }
         if (begin_.node != end_.node) { // 有两个以上的缓冲区
             ccystl::destroy(begin_.cur, begin_.last);
@@ -754,48 +790,50 @@ namespace ccystl {
         else {
             ccystl::destroy(begin_.cur, end_.cur);
         }
-        shrink_to_fit();
         end_ = begin_;
+        shrink_to_fit();
     }
 
     // 交换两个 deque
-    template <class T>
-    void deque<T>::swap(deque& rhs) noexcept {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::swap(deque& rhs) noexcept {
         if (this != &rhs) {
             ccystl::swap(begin_, rhs.begin_);
             ccystl::swap(end_, rhs.end_);
             ccystl::swap(map_, rhs.map_);
             ccystl::swap(map_size_, rhs.map_size_);
+            ccystl::swap(data_alloc_, rhs.data_alloc_);
+            ccystl::swap(map_alloc_, rhs.map_alloc_);
         }
     }
 
     /*****************************************************************************************/
     // helper function
 
-    template <class T>
-    typename deque<T>::map_pointer
-        deque<T>::create_map(size_type size) {
+    template <class T, class Alloc>
+    typename deque<T, Alloc>::map_pointer
+        deque<T, Alloc>::create_map(size_type size) {
         map_pointer mp = nullptr;
-        mp = map_allocator::allocate(size);
+        mp = map_alloc_.allocate(size);
         for (size_type i = 0; i < size; ++i)
             *(mp + i) = nullptr;
         return mp;
     }
 
     // create_buffer 函数
-    template <class T>
-    void deque<T>::
+    template <class T, class Alloc>
+    void deque<T, Alloc>::
         create_buffer(map_pointer nstart, map_pointer nfinish) {
         map_pointer cur;
         try {
             for (cur = nstart; cur <= nfinish; ++cur) {
-                *cur = data_allocator::allocate(buffer_size);
+                *cur = data_alloc_.allocate(buffer_size);
             }
         }
         catch (...) {
             while (cur != nstart) {
                 --cur;
-                data_allocator::deallocate(*cur, buffer_size);
+                data_alloc_.deallocate(*cur, buffer_size);
                 *cur = nullptr;
             }
             throw;
@@ -803,18 +841,18 @@ namespace ccystl {
     }
 
     // destroy_buffer 函数
-    template <class T>
-    void deque<T>::
+    template <class T, class Alloc>
+    void deque<T, Alloc>::
         destroy_buffer(map_pointer nstart, map_pointer nfinish) {
         for (map_pointer n = nstart; n <= nfinish; ++n) {
-            data_allocator::deallocate(*n, buffer_size);
+            data_alloc_.deallocate(*n, buffer_size);
             *n = nullptr;
         }
     }
 
     // map_init 函数
-    template <class T>
-    void deque<T>::
+    template <class T, class Alloc>
+    void deque<T, Alloc>::
         map_init(size_type nElem) {
         const size_type nNode = nElem / buffer_size + 1;  // 需要分配的缓冲区个数
         map_size_ = ccystl::max(static_cast<size_type>(DEQUE_MAP_INIT_SIZE), nNode + 2);
@@ -834,7 +872,7 @@ namespace ccystl {
             create_buffer(nstart, nfinish);
         }
         catch (...) {
-            map_allocator::deallocate(map_, map_size_);
+            map_alloc_.deallocate(map_, map_size_);
             map_ = nullptr;
             map_size_ = 0;
             throw;
@@ -846,34 +884,37 @@ namespace ccystl {
     }
 
     // fill_init 函数
-    template <class T>
-    void deque<T>::
+    template <class T, class Alloc>
+    void deque<T, Alloc>::
         fill_init(size_type n, const value_type& value) {
+        if (n == 0)
+            return;
         map_init(n);
-        if (n != 0) {
-            for (auto cur = begin_.node; cur < end_.node; ++cur) {
-                ccystl::uninitialized_fill(*cur, *cur + buffer_size, value);
-            }
-            ccystl::uninitialized_fill(end_.first, end_.cur, value);
+        for (auto cur = begin_.node; cur < end_.node; ++cur) {
+            ccystl::uninitialized_fill(*cur, *cur + buffer_size, value);
         }
+        ccystl::uninitialized_fill(end_.first, end_.cur, value);
     }
 
     // copy_init 函数
-    template <class T>
+    template <class T, class Alloc>
     template <class IIter>
-    void deque<T>::
+    void deque<T, Alloc>::
         copy_init(IIter first, IIter last, input_iterator_tag) {
         const size_type n = ccystl::distance(first, last);
-        map_init(n);
+        if (n != 0)
+            map_init(n);
         for (; first != last; ++first)
             emplace_back(*first);
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class FIter>
-    void deque<T>::
+    void deque<T, Alloc>::
         copy_init(FIter first, FIter last, forward_iterator_tag) {
         const size_type n = ccystl::distance(first, last);
+        if (n == 0)
+            return;
         map_init(n);
         for (auto cur = begin_.node; cur < end_.node; ++cur) {
             auto next = first;
@@ -885,8 +926,8 @@ namespace ccystl {
     }
 
     // fill_assign 函数
-    template <class T>
-    void deque<T>::
+    template <class T, class Alloc>
+    void deque<T, Alloc>::
         fill_assign(size_type n, const value_type& value) {
         if (n > size()) {
             ccystl::fill(begin(), end(), value);
@@ -899,9 +940,9 @@ namespace ccystl {
     }
 
     // copy_assign 函数
-    template <class T>
+    template <class T, class Alloc>
     template <class IIter>
-    void deque<T>::
+    void deque<T, Alloc>::
         copy_assign(IIter first, IIter last, input_iterator_tag) {
         auto first1 = begin();
         auto last1 = end();
@@ -916,9 +957,9 @@ namespace ccystl {
         }
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class FIter>
-    void deque<T>::
+    void deque<T, Alloc>::
         copy_assign(FIter first, FIter last, forward_iterator_tag) {
         const size_type len1 = size();
         const size_type len2 = ccystl::distance(first, last);
@@ -934,10 +975,10 @@ namespace ccystl {
     }
 
     // insert_aux 函数
-    template <class T>
+    template <class T, class Alloc>
     template <class... Args>
-    typename deque<T>::iterator
-        deque<T>::
+    typename deque<T, Alloc>::iterator
+        deque<T, Alloc>::
         insert_aux(iterator position, Args&& ...args) {
         const size_type elems_before = position - begin_;
         value_type value_copy = value_type(ccystl::forward<Args>(args)...);
@@ -966,8 +1007,8 @@ namespace ccystl {
     }
 
     // fill_insert 函数
-    template <class T>
-    void deque<T>::
+    template <class T, class Alloc>
+    void deque<T, Alloc>::
         fill_insert(iterator position, size_type n, const value_type& value) {
         const size_type elems_before = position - begin_;
         const size_type len = size();
@@ -1030,9 +1071,9 @@ namespace ccystl {
     }
 
     // copy_insert
-    template <class T>
+    template <class T, class Alloc>
     template <class FIter>
-    void deque<T>::
+    void deque<T, Alloc>::
         copy_insert(iterator position, FIter first, FIter last, size_type n) {
         const size_type elems_before = position - begin_;
         auto len = size();
@@ -1098,9 +1139,9 @@ namespace ccystl {
     }
 
     // insert_dispatch 函数
-    template <class T>
+    template <class T, class Alloc>
     template <class IIter>
-    void deque<T>::
+    void deque<T, Alloc>::
         insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag) {
         if (last <= first)  return;
         const size_type n = ccystl::distance(first, last);
@@ -1118,9 +1159,9 @@ namespace ccystl {
         }
     }
 
-    template <class T>
+    template <class T, class Alloc>
     template <class FIter>
-    void deque<T>::
+    void deque<T, Alloc>::
         insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag) {
         if (last <= first)  return;
         const size_type n = ccystl::distance(first, last);
@@ -1156,8 +1197,13 @@ namespace ccystl {
     }
 
     // require_capacity 函数
-    template <class T>
-    void deque<T>::require_capacity(size_type n, bool front) {
+    template <class T, class Alloc>
+    void deque<T, Alloc>::require_capacity(size_type n, bool front) {
+        if (map_ == nullptr) {
+            if (n == 0)
+                return;
+            map_init(0); // 第一次插入时才建立 map 与首个缓冲区
+        }
         if (front && (static_cast<size_type>(begin_.cur - begin_.first) < n)) {
             const size_type need_buffer = (n - (begin_.cur - begin_.first)) / buffer_size + 1;
             if (need_buffer > static_cast<size_type>(begin_.node - map_)) {
@@ -1176,95 +1222,112 @@ namespace ccystl {
         }
     }
 
-    // reallocate_map_at_front 函数
-    template <class T>
-    void deque<T>::reallocate_map_at_front(size_type need_buffer) {
-        const size_type new_map_size = ccystl::max(map_size_ << 1,
-            map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
-        map_pointer new_map = create_map(new_map_size);
+    // relocate_map 函数
+    // 为在前端（front 为 true）或后端新增 need_buffer 个缓冲区腾出 map 空间，
+    // 返回已有节点在 map 中的新起始位置，并同步更新 begin_ 与 end_ 的节点指针
+    template <class T, class Alloc>
+    typename deque<T, Alloc>::map_pointer
+        deque<T, Alloc>::relocate_map(size_type need_buffer, bool front) {
         const size_type old_buffer = end_.node - begin_.node + 1;
         const size_type new_buffer = old_buffer + need_buffer;
+        const size_type shift = front ? need_buffer : 0;
+        map_pointer new_start;
+        if (map_size_ > 2 * new_buffer) {
+            // map 中有一半以上是空位，只需将已用的节点居中，不必重新分配
+            new_start = map_ + (map_size_ - new_buffer) / 2 + shift;
+            ccystl::uninitialized_relocate(begin_.node, end_.node + 1, new_start);
+        }
+        else {
+            const size_type new_map_size = ccystl::max(map_size_ << 1,
+                map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
+            const size_type offset = (new_map_size - new_buffer) / 2 + shift;
+            if constexpr (allocator_has_reallocate_v<map_allocator>) {
+                // 原地扩容后再在新的 map 中搬移节点
+                const size_type old_offset = begin_.node - map_;
+                map_ = map_alloc_.reallocate(map_, map_size_, new_map_size);
+                ccystl::uninitialized_relocate(map_ + old_offset, map_ + old_offset + old_buffer,
+                                               map_ + offset);
+            }
+            else {
+                map_pointer new_map = create_map(new_map_size);
+                ccystl::uninitialized_relocate(begin_.node, end_.node + 1, new_map + offset);
+                map_alloc_.deallocate(map_, map_size_);
+                map_ = new_map;
+            }
+            map_size_ = new_map_size;
+            new_start = map_ + offset;
+        }
+        // 节点之外的位置置空
+        ccystl::fill(map_, new_start, nullptr);
+        ccystl::fill(new_start + old_buffer, map_ + map_size_, nullptr);
+        begin_ = iterator(begin_.cur, new_start);
+        end_ = iterator(end_.cur, new_start + old_buffer - 1);
+        return new_start;
+    }
 
-        // 另新的 map 中的指针指向原来的 buffer，并开辟新的 buffer
-        auto begin = new_map + (new_map_size - new_buffer) / 2;
-        auto mid = begin + need_buffer;
-        auto end = mid + old_buffer;
-        create_buffer(begin, mid - 1);
-        for (auto begin1 = mid, begin2 = begin_.node; begin1 != end; ++begin1, ++begin2)
-            *begin1 = *begin2;
-
-        // 更新数据
-        map_allocator::deallocate(map_, map_size_);
-        map_ = new_map;
-        map_size_ = new_map_size;
-        begin_ = iterator(*mid + (begin_.cur - begin_.first), mid);
-        end_ = iterator(*(end - 1) + (end_.cur - end_.first), end - 1);
+    // reallocate_map_at_front 函数
+    template <class T, class Alloc>
+    void deque<T, Alloc>::reallocate_map_at_front(size_type need_buffer) {
+        auto mid = relocate_map(need_buffer, true);
+        create_buffer(mid - need_buffer, mid - 1);
     }
 
     // reallocate_map_at_back 函数
-    template <class T>
-    void deque<T>::reallocate_map_at_back(size_type need_buffer) {
-        const size_type new_map_size = ccystl::max(map_size_ << 1,
-            map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
-        map_pointer new_map = create_map(new_map_size);
-        const size_type old_buffer = end_.node - begin_.node + 1;
-        const size_type new_buffer = old_buffer + need_buffer;
-
-        // 另新的 map 中的指针指向原来的 buffer，并开辟新的 buffer
-        auto begin = new_map + ((new_map_size - new_buffer) / 2);
-        auto mid = begin + old_buffer;
-        auto end = mid + need_buffer;
-        for (auto begin1 = begin, begin2 = begin_.node; begin1 != mid; ++begin1, ++begin2)
-            *begin1 = *begin2;
-        create_buffer(mid, end - 1);
-
-        // 更新数据
-        map_allocator::deallocate(map_, map_size_);
-        map_ = new_map;
-        map_size_ = new_map_size;
-        begin_ = iterator(*begin + (begin_.cur - begin_.first), begin);
-        end_ = iterator(*(mid - 1) + (end_.cur - end_.first), mid - 1);
+    template <class T, class Alloc>
+    void deque<T, Alloc>::reallocate_map_at_back(size_type need_buffer) {
+        auto mid = relocate_map(need_buffer, false) + (end_.node - begin_.node + 1);
+        create_buffer(mid, mid + need_buffer - 1);
     }
 
     // 重载比较操作符
-    template <class T>
-    bool operator==(const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc>
+    bool operator==(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
         return lhs.size() == rhs.size() &&
             ccystl::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
-    template <class T>
-    bool operator<(const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc>
+    bool operator<(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
         return ccystl::lexicographical_compare(
             lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template <class T>
-    bool operator!=(const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc>
+    bool operator!=(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
         return !(lhs == rhs);
     }
 
-    template <class T>
-    bool operator>(const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc>
+    bool operator>(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
         return rhs < lhs;
     }
 
-    template <class T>
-    bool operator<=(const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc>
+    bool operator<=(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
         return !(rhs < lhs);
     }
 
-    template <class T>
-    bool operator>=(const deque<T>& lhs, const deque<T>& rhs) {
+    template <class T, class Alloc>
+    bool operator>=(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
         return !(lhs < rhs);
     }
 
     // 重载 ccystl 的 swap
-    template <class T>
-    void swap(deque<T>& lhs, deque<T>& rhs) {
+    template <class T, class Alloc>
+    void swap(deque<T, Alloc>& lhs, deque<T, Alloc>& rhs) {
         lhs.swap(rhs);
     }
 
+    // deque 的迭代器只指向堆上的 map 与缓冲区，分配器可平凡重定位时 deque 也可以
+    template <class T, class Alloc>
+    struct is_trivially_relocatable<deque<T, Alloc>> : is_trivially_relocatable<Alloc> { };
+
+    namespace pmr {
+    // 使用多态内存资源的 deque
+    template <class T>
+    using deque = ccystl::deque<T, polymorphic_allocator<T>>;
+    } // namespace pmr
+
 } // namespace ccystl
 #endif // !CCYSTL_DEQUE_H_
 
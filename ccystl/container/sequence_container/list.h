@@ -18,7 +18,9 @@
 #include <initializer_list>
 
 #include "ccystl/iterator/iterator.h"
+#include "ccystl/allocator/allocator.h"
 #include "ccystl/allocator/memory.h"
+#include "ccystl/allocator/memory_resource.h"
 #include "ccystl/functor/functional.h"
 #include "ccystl/utils/utils.h"
 #include "ccystl/utils/except_def.h"
@@ -219,15 +221,15 @@ struct list_const_iterator : public iterator<bidirectional_iterator_tag, T> {
 };
 
 // 模板类: list
-// 模板参数 T 代表数据类型
-template <class T>
+// 模板参数 T 代表数据类型，Alloc 代表分配器类型，缺省使用 ccystl::allocator
+// splice / merge 要求两个 list 的分配器相等
+template <class T, class Alloc = ccystl::allocator<T>>
 class list {
 public:
     // list 的嵌套型别定义
-    typedef ccystl::allocator<T> allocator_type;
-    typedef ccystl::allocator<T> data_allocator;
-    typedef ccystl::allocator<list_node_base<T>> base_allocator;
-    typedef ccystl::allocator<list_node<T>> node_allocator;
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
+    typedef typename Alloc::template rebind<list_node<T>>::other node_allocator;
 
     typedef typename allocator_type::value_type value_type;
     typedef typename allocator_type::pointer pointer;
@@ -245,46 +247,66 @@ public:
     typedef typename node_traits<T>::base_ptr base_ptr;
     typedef typename node_traits<T>::node_ptr node_ptr;
 
-    allocator_type get_allocator() {
-        return node_allocator();
+    allocator_type get_allocator() const {
+        return allocator_type(node_alloc_);
     }
 
 private:
-    base_ptr node_; // 指向末尾节点
-    size_type size_; // 大小
+    list_node_base<T> sentinel_; // 末尾的哨兵节点，内嵌于容器中因而无需分配
+    size_type size_ = 0; // 大小
+    [[no_unique_address]] node_allocator node_alloc_; // 节点分配器，数据分配器由它转换得到
+
+    base_ptr end_node() const noexcept {
+        return const_cast<base_ptr>(&sentinel_);
+    }
 
 public:
     // 构造、复制、移动、析构函数
-    list() {
-        fill_init(0, value_type());
+    list() noexcept {
+        sentinel_.unlink();
     }
 
-    explicit list(size_type n) {
+    explicit list(const allocator_type& alloc) noexcept
+        : node_alloc_(alloc) {
+        sentinel_.unlink();
+    }
+
+    explicit list(size_type n, const allocator_type& alloc = allocator_type())
+        : node_alloc_(alloc) {
         fill_init(n, value_type());
     }
 
-    list(size_type n, const T& value) {
+    list(size_type n, const T& value, const allocator_type& alloc = allocator_type())
+        : node_alloc_(alloc) {
         fill_init(n, value);
     }
 
     template <class Iter, typename std::enable_if<
                   ccystl::is_input_iterator<Iter>::value, int>::type = 0>
-    list(Iter first, Iter last) {
+    list(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+        : node_alloc_(alloc) {
         copy_init(first, last);
     }
 
-    list(std::initializer_list<T> ilist) {
+    list(std::initializer_list<T> ilist, const allocator_type& alloc = allocator_type())
+        : node_alloc_(alloc) {
         copy_init(ilist.begin(), ilist.end());
     }
 
-    list(const list& rhs) {
+    list(const list& rhs)
+        : node_alloc_(rhs.node_alloc_) {
+        copy_init(rhs.cbegin(), rhs.cend());
+    }
+
+    list(const list& rhs, const allocator_type& alloc)
+        : node_alloc_(alloc) {
         copy_init(rhs.cbegin(), rhs.cend());
     }
 
     list(list&& rhs) noexcept
-        : node_(rhs.node_), size_(rhs.size_) {
-        rhs.node_ = nullptr;
-        rhs.size_ = 0;
+        : node_alloc_(rhs.node_alloc_) {
+        sentinel_.unlink();
+        splice(end(), rhs);
     }
 
     list& operator=(const list& rhs) {
@@ -294,43 +316,48 @@ public:
         return *this;
     }
 
-    list& operator=(list&& rhs) noexcept {
+    // 分配器不随移动赋值传播：分配器不相等时不能直接接管节点，改为逐个移动元素
+    list& operator=(list&& rhs) noexcept(std::is_empty_v<node_allocator>) {
+        if (this == &rhs)
+            return *this;
         clear();
-        splice(end(), rhs);
+        if (node_alloc_ == rhs.node_alloc_) {
+            splice(end(), rhs);
+        }
+        else {
+            for (auto& value : rhs)
+                emplace_back(ccystl::move(value));
+            rhs.clear();
+        }
         return *this;
     }
 
     list& operator=(std::initializer_list<T> ilist) {
-        list tmp(ilist.begin(), ilist.end());
+        list tmp(ilist.begin(), ilist.end(), get_allocator());
         swap(tmp);
         return *this;
     }
 
     ~list() {
-        if (node_) {
-            clear();
-            base_allocator::deallocate(node_);
-            node_ = nullptr;
-            size_ = 0;
-        }
+        clear();
     }
 
 public:
     // 迭代器相关操作
     iterator begin() noexcept {
-        return node_->next;
+        return end_node()->next;
     }
 
     const_iterator begin() const noexcept {
-        return node_->next;
+        return end_node()->next;
     }
 
     iterator end() noexcept {
-        return node_;
+        return end_node();
     }
 
     const_iterator end() const noexcept {
-        return node_;
+        return end_node();
     }
 
     reverse_iterator rbegin() noexcept {
@@ -367,7 +394,7 @@ public:
 
     // 容量相关操作
     bool empty() const noexcept {
-        return node_->next == node_;
+        return end_node()->next == end_node();
     }
 
     size_type size() const noexcept {
@@ -501,7 +528,7 @@ public:
 
     void pop_front() {
         ccystl_DEBUG(!empty());
-        auto n = node_->next;
+        auto n = end_node()->next;
         unlink_nodes(n, n);
         destroy_node(n->as_node());
         --size_;
@@ -509,7 +536,7 @@ public:
 
     void pop_back() {
         ccystl_DEBUG(!empty());
-        auto n = node_->prev;
+        auto n = end_node()->prev;
         unlink_nodes(n, n);
         destroy_node(n->as_node());
         --size_;
@@ -531,8 +558,13 @@ public:
     void resize(size_type new_size, const value_type& value);
 
     void swap(list& rhs) noexcept {
-        ccystl::swap(node_, rhs.node_);
+        // 哨兵节点内嵌于容器中，交换其前后指针后需要让首尾节点重新指回各自的哨兵
+        ccystl::swap(sentinel_.prev, rhs.sentinel_.prev);
+        ccystl::swap(sentinel_.next, rhs.sentinel_.next);
         ccystl::swap(size_, rhs.size_);
+        relink_sentinel();
+        rhs.relink_sentinel();
+        ccystl::swap(node_alloc_, rhs.node_alloc_);
     }
 
     // list 相关操作
@@ -584,6 +616,7 @@ private:
     void destroy_node(node_ptr p);
 
     // initialize
+    void relink_sentinel() noexcept;
     void fill_init(size_type n, const value_type& value);
     template <class Iter>
     void copy_init(Iter first, Iter last);
@@ -613,9 +646,9 @@ private:
 /*****************************************************************************************/
 
 // 删除 pos 处的元素
-template <class T>
-typename list<T>::iterator
-list<T>::erase(const_iterator pos) {
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator
+list<T, Alloc>::erase(const_iterator pos) {
     ccystl_DEBUG(pos != cend());
     auto n = pos.node_;
     auto next = n->next;
@@ -626,9 +659,9 @@ list<T>::erase(const_iterator pos) {
 }
 
 // 删除 [first, last) 内的元素
-template <class T>
-typename list<T>::iterator
-list<T>::erase(const_iterator first, const_iterator last) {
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator
+list<T, Alloc>::erase(const_iterator first, const_iterator last) {
     if (first != last) {
         unlink_nodes(first.node_, last.node_->prev);
         while (first != last) {
@@ -642,21 +675,21 @@ list<T>::erase(const_iterator first, const_iterator last) {
 }
 
 // 清空 list
-template <class T>
-void list<T>::clear() {
+template <class T, class Alloc>
+void list<T, Alloc>::clear() {
     if (size_ != 0) {
-        auto cur = node_->next;
-        for (base_ptr next = cur->next; cur != node_; cur = next, next = cur->next) {
+        auto cur = end_node()->next;
+        for (base_ptr next = cur->next; cur != end_node(); cur = next, next = cur->next) {
             destroy_node(cur->as_node());
         }
-        node_->unlink();
+        end_node()->unlink();
         size_ = 0;
     }
 }
 
 // 重置容器大小
-template <class T>
-void list<T>::resize(size_type new_size, const value_type& value) {
+template <class T, class Alloc>
+void list<T, Alloc>::resize(size_type new_size, const value_type& value) {
     auto i = begin();
     size_type len = 0;
     while (i != end() && len < new_size) {
@@ -664,22 +697,22 @@ void list<T>::resize(size_type new_size, const value_type& value) {
         ++len;
     }
     if (len == new_size) {
-        erase(i, node_);
+        erase(i, end_node());
     }
     else {
-        insert(node_, new_size - len, value);
+        insert(end_node(), new_size - len, value);
     }
 }
 
 // 将 list x 接合于 pos 之前
-template <class T>
-void list<T>::splice(const_iterator pos, list& x) {
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& x) {
     ccystl_DEBUG(this != &x);
     if (!x.empty()) {
         THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
 
-        auto f = x.node_->next;
-        auto l = x.node_->prev;
+        auto f = x.sentinel_.next;
+        auto l = x.sentinel_.prev;
 
         x.unlink_nodes(f, l);
         link_nodes(pos.node_, f, l);
@@ -690,8 +723,8 @@ void list<T>::splice(const_iterator pos, list& x) {
 }
 
 // 将 it 所指的节点接合于 pos 之前
-template <class T>
-void list<T>::splice(const_iterator pos, list& x, const_iterator it) {
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& x, const_iterator it) {
     if (pos.node_ != it.node_ && pos.node_ != it.node_->next) {
         THROW_LENGTH_ERROR_IF(size_ > max_size() - 1, "list<T>'s size too big");
 
@@ -706,8 +739,8 @@ void list<T>::splice(const_iterator pos, list& x, const_iterator it) {
 }
 
 // 将 list x 的 [first, last) 内的节点接合于 pos 之前
-template <class T>
-void list<T>::splice(const_iterator pos, list& x, const_iterator first, const_iterator last) {
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& x, const_iterator first, const_iterator last) {
     if (first != last && this != &x) {
         size_type n = ccystl::distance(first, last);
         THROW_LENGTH_ERROR_IF(size_ > max_size() - n, "list<T>'s size too big");
@@ -723,9 +756,9 @@ void list<T>::splice(const_iterator pos, list& x, const_iterator first, const_it
 }
 
 // 将另一元操作 pred 为 true 的所有元素移除
-template <class T>
+template <class T, class Alloc>
 template <class UnaryPredicate>
-void list<T>::remove_if(UnaryPredicate pred) {
+void list<T, Alloc>::remove_if(UnaryPredicate pred) {
     auto f = begin();
     auto l = end();
     for (auto next = f; f != l; f = next) {
@@ -737,9 +770,9 @@ void list<T>::remove_if(UnaryPredicate pred) {
 }
 
 // 移除 list 中满足 pred 为 true 重复元素
-template <class T>
+template <class T, class Alloc>
 template <class BinaryPredicate>
-void list<T>::unique(BinaryPredicate pred) {
+void list<T, Alloc>::unique(BinaryPredicate pred) {
     auto i = begin();
     auto e = end();
     auto j = i;
@@ -757,9 +790,9 @@ void list<T>::unique(BinaryPredicate pred) {
 }
 
 // 与另一个 list 合并，按照 comp 为 true 的顺序
-template <class T>
+template <class T, class Alloc>
 template <class Compare>
-void list<T>::merge(list& x, Compare comp) {
+void list<T, Alloc>::merge(list& x, Compare comp) {
     if (this != &x) {
         THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
 
@@ -801,8 +834,8 @@ void list<T>::merge(list& x, Compare comp) {
 }
 
 // 将 list 反转
-template <class T>
-void list<T>::reverse() {
+template <class T, class Alloc>
+void list<T, Alloc>::reverse() {
     if (size_ <= 1) {
         return;
     }
@@ -819,35 +852,46 @@ void list<T>::reverse() {
 // helper function
 
 // 创建结点
-template <class T>
+template <class T, class Alloc>
 template <class... Args>
-typename list<T>::node_ptr
-list<T>::create_node(Args&&... args) {
-    node_ptr p = node_allocator::allocate(1);
+typename list<T, Alloc>::node_ptr
+list<T, Alloc>::create_node(Args&&... args) {
+    node_ptr p = node_alloc_.allocate(1);
     try {
-        data_allocator::construct(ccystl::address_of(p->value), ccystl::forward<Args>(args)...);
+        data_allocator(node_alloc_).construct(ccystl::address_of(p->value), ccystl::forward<Args>(args)...);
         p->prev = nullptr;
         p->next = nullptr;
     }
     catch (...) {
-        node_allocator::deallocate(p);
+        node_alloc_.deallocate(p);
         throw;
     }
     return p;
 }
 
 // 销毁结点
-template <class T>
-void list<T>::destroy_node(node_ptr p) {
-    data_allocator::destroy(ccystl::address_of(p->value));
-    node_allocator::deallocate(p);
+template <class T, class Alloc>
+void list<T, Alloc>::destroy_node(node_ptr p) {
+    data_allocator(node_alloc_).destroy(ccystl::address_of(p->value));
+    node_alloc_.deallocate(p);
+}
+
+// 交换哨兵节点的前后指针后修正首尾节点的链接
+template <class T, class Alloc>
+void list<T, Alloc>::relink_sentinel() noexcept {
+    if (size_ == 0) {
+        sentinel_.unlink();
+    }
+    else {
+        sentinel_.next->prev = end_node();
+        sentinel_.prev->next = end_node();
+    }
 }
 
 // 用 n 个元素初始化容器
-template <class T>
-void list<T>::fill_init(size_type n, const value_type& value) {
-    node_ = base_allocator::allocate(1);
-    node_->unlink();
+template <class T, class Alloc>
+void list<T, Alloc>::fill_init(size_type n, const value_type& value) {
+    end_node()->unlink();
     size_ = n;
     try {
         for (; n > 0; --n) {
@@ -857,18 +901,15 @@ void list<T>::fill_init(size_type n, const value_type& value) {
     }
     catch (...) {
         clear();
-        base_allocator::deallocate(node_);
-        node_ = nullptr;
         throw;
     }
 }
 
 // 以 [first, last) 初始化容器
-template <class T>
+template <class T, class Alloc>
 template <class Iter>
-void list<T>::copy_init(Iter first, Iter last) {
-    node_ = base_allocator::allocate(1);
-    node_->unlink();
+void list<T, Alloc>::copy_init(Iter first, Iter last) {
+    end_node()->unlink();
     size_type n = ccystl::distance(first, last);
     size_ = n;
     try {
@@ -879,20 +920,18 @@ void list<T>::copy_init(Iter first, Iter last) {
     }
     catch (...) {
         clear();
-        base_allocator::deallocate(node_);
-        node_ = nullptr;
         throw;
     }
 }
 
 // 在 pos 处连接一个节点
-template <class T>
-typename list<T>::iterator
-list<T>::link_iter_node(const_iterator pos, base_ptr link_node) {
-    if (pos == node_->next) {
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator
+list<T, Alloc>::link_iter_node(const_iterator pos, base_ptr link_node) {
+    if (pos == end_node()->next) {
         link_nodes_at_front(link_node, link_node);
     }
-    else if (pos == node_) {
+    else if (pos == end_node()) {
         link_nodes_at_back(link_node, link_node);
     }
     else {
@@ -902,8 +941,8 @@ list<T>::link_iter_node(const_iterator pos, base_ptr link_node) {
 }
 
 // 在 pos 处连接 [first, last] 的结点
-template <class T>
-void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last) {
+template <class T, class Alloc>
+void list<T, Alloc>::link_nodes(base_ptr pos, base_ptr first, base_ptr last) {
     pos->prev->next = first;
     first->prev = pos->prev;
     pos->prev = last;
@@ -911,33 +950,33 @@ void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last) {
 }
 
 // 在头部连接 [first, last] 结点
-template <class T>
-void list<T>::link_nodes_at_front(base_ptr first, base_ptr last) {
-    first->prev = node_;
-    last->next = node_->next;
+template <class T, class Alloc>
+void list<T, Alloc>::link_nodes_at_front(base_ptr first, base_ptr last) {
+    first->prev = end_node();
+    last->next = end_node()->next;
     last->next->prev = last;
-    node_->next = first;
+    end_node()->next = first;
 }
 
 // 在尾部连接 [first, last] 结点
-template <class T>
-void list<T>::link_nodes_at_back(base_ptr first, base_ptr last) {
-    last->next = node_;
-    first->prev = node_->prev;
+template <class T, class Alloc>
+void list<T, Alloc>::link_nodes_at_back(base_ptr first, base_ptr last) {
+    last->next = end_node();
+    first->prev = end_node()->prev;
     first->prev->next = first;
-    node_->prev = last;
+    end_node()->prev = last;
 }
 
 // 容器与 [first, last] 结点断开连接
-template <class T>
-void list<T>::unlink_nodes(base_ptr first, base_ptr last) {
+template <class T, class Alloc>
+void list<T, Alloc>::unlink_nodes(base_ptr first, base_ptr last) {
     first->prev->next = last->next;
     last->next->prev = first->prev;
 }
 
 // 用 n 个元素为容器赋值
-template <class T>
-void list<T>::fill_assign(size_type n, const value_type& value) {
+template <class T, class Alloc>
+void list<T, Alloc>::fill_assign(size_type n, const value_type& value) {
     auto i = begin();
     auto e = end();
     for (; n > 0 && i != e; --n, ++i) {
@@ -952,9 +991,9 @@ void list<T>::fill_assign(size_type n, const value_type& value) {
 }
 
 // 复制[f2, l2)为容器赋值
-template <class T>
+template <class T, class Alloc>
 template <class Iter>
-void list<T>::copy_assign(Iter f2, Iter l2) {
+void list<T, Alloc>::copy_assign(Iter f2, Iter l2) {
     auto f1 = begin();
     auto l1 = end();
     for (; f1 != l1 && f2 != l2; ++f1, ++f2) {
@@ -969,9 +1008,9 @@ void list<T>::copy_assign(Iter f2, Iter l2) {
 }
 
 // 在 pos 处插入 n 个元素
-template <class T>
-typename list<T>::iterator
-list<T>::fill_insert(const_iterator pos, size_type n, const value_type& value) {
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator
+list<T, Alloc>::fill_insert(const_iterator pos, size_type n, const value_type& value) {
     iterator r(pos.node_);
     if (n != 0) {
         const auto add_size = n;
@@ -1005,10 +1044,10 @@ list<T>::fill_insert(const_iterator pos, size_type n, const value_type& value) {
 }
 
 // 在 pos 处插入 [first, last) 的元素
-template <class T>
+template <class T, class Alloc>
 template <class Iter>
-typename list<T>::iterator
-list<T>::copy_insert(const_iterator pos, size_type n, Iter first) {
+typename list<T, Alloc>::iterator
+list<T, Alloc>::copy_insert(const_iterator pos, size_type n, Iter first) {
     iterator r(pos.node_);
     if (n != 0) {
         const auto add_size = n;
@@ -1041,10 +1080,10 @@ list<T>::copy_insert(const_iterator pos, size_type n, Iter first) {
 }
 
 // 对 list 进行归并排序，返回一个迭代器指向区间最小元素的位置
-template <class T>
+template <class T, class Alloc>
 template <class Compared>
-typename list<T>::iterator
-list<T>::list_sort(iterator f1, iterator l2, size_type n, Compared comp) {
+typename list<T, Alloc>::iterator
+list<T, Alloc>::list_sort(iterator f1, iterator l2, size_type n, Compared comp) {
     if (n < 2)
         return f1;
 
@@ -1108,8 +1147,8 @@ list<T>::list_sort(iterator f1, iterator l2, size_type n, Compared comp) {
 }
 
 // 重载比较操作符
-template <class T>
-bool operator==(const list<T>& lhs, const list<T>& rhs) {
+template <class T, class Alloc>
+bool operator==(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs) {
     auto f1 = lhs.cbegin();
     auto f2 = rhs.cbegin();
     auto l1 = lhs.cend();
@@ -1118,35 +1157,41 @@ bool operator==(const list<T>& lhs, const list<T>& rhs) {
     return f1 == l1 && f2 == l2;
 }
 
-template <class T>
-bool operator<(const list<T>& lhs, const list<T>& rhs) {
+template <class T, class Alloc>
+bool operator<(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs) {
     return ccystl::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
 }
 
-template <class T>
-bool operator!=(const list<T>& lhs, const list<T>& rhs) {
+template <class T, class Alloc>
+bool operator!=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs) {
     return !(lhs == rhs);
 }
 
-template <class T>
-bool operator>(const list<T>& lhs, const list<T>& rhs) {
+template <class T, class Alloc>
+bool operator>(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs) {
     return rhs < lhs;
 }
 
-template <class T>
-bool operator<=(const list<T>& lhs, const list<T>& rhs) {
+template <class T, class Alloc>
+bool operator<=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs) {
     return !(rhs < lhs);
 }
 
-template <class T>
-bool operator>=(const list<T>& lhs, const list<T>& rhs) {
+template <class T, class Alloc>
+bool operator>=(const list<T, Alloc>& lhs, const list<T, Alloc>& rhs) {
     return !(lhs < rhs);
 }
 
 // 重载 ccystl 的 swap
-template <class T>
-void swap(list<T>& lhs, list<T>& rhs) noexcept {
+template <class T, class Alloc>
+void swap(list<T, Alloc>& lhs, list<T, Alloc>& rhs) noexcept {
     lhs.swap(rhs);
 }
+
+namespace pmr {
+// 使用多态内存资源的 list
+template <class T>
+using list = ccystl::list<T, polymorphic_allocator<T>>;
+} // namespace pmr
 } // namespace ccystl
 #endif // !CCYSTL_LIST_H_
@@ -0,0 +1,818 @@
+#ifndef CCYSTL_SMALL_VECTOR_H_
+#define CCYSTL_SMALL_VECTOR_H_
+
+// 这个头文件包含一个模板类 small_vector
+// small_vector : 带内联存储的向量
+
+// notes:
+//
+// small_vector<T, N> 的接口与 ccystl::vector<T> 一致。前 N 个元素保存在对象内部的
+// 内联缓冲区中，默认构造与元素个数不超过 N 时都不会向分配器申请内存；超过 N 时
+// 才将元素重定位到堆上，之后按 1.5 倍扩容。shrink_to_fit 在元素个数不超过 N 时
+// 会把元素搬回内联缓冲区。
+//
+// 元素的复制、移动、填充都经过 algobase.h / uninitialized.h，平凡类型走 memmove 路径。
+//
+// 由于迭代器可能指向对象内部，small_vector 的移动与交换会使迭代器失效，
+// 它也不是可平凡重定位的类型。
+//
+// 异常保证：
+// ccystl::small_vector<T, N>
+// 满足基本异常保证，并对以下函数做强异常安全保证：
+//   * emplace_back
+//   * push_back
+// 当 std::is_nothrow_move_constructible<T>::value == true
+// 时，以下函数也满足强异常保证：
+//   * reserve
+//   * insert
+
+#include <initializer_list>
+
+#include "ccystl/algorithm/algo.h"
+#include "ccystl/allocator/allocator.h"
+#include "ccystl/allocator/memory.h"
+#include "ccystl/allocator/memory_resource.h"
+#include "ccystl/iterator/iterator.h"
+#include "ccystl/utils/except_def.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+#ifdef max
+#pragma message("#undefing marco max")
+#undef max
+#endif // max
+
+#ifdef min
+#pragma message("#undefing marco min")
+#undef min
+#endif // min
+
+// 模板类: small_vector
+// 模板参数 T 代表类型，N 代表内联存储的元素个数，Alloc 代表溢出到堆上时使用的分配器
+template <class T, size_t N, class Alloc = ccystl::allocator<T>>
+class small_vector {
+    static_assert(!std::is_same_v<bool, T>,
+                  "small_vector<bool> is abandoned in ccystl");
+
+public:
+    // small_vector 的嵌套型别定义
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
+
+    typedef typename allocator_type::value_type value_type;
+    typedef typename allocator_type::pointer pointer;
+    typedef typename allocator_type::const_pointer const_pointer;
+    typedef typename allocator_type::reference reference;
+    typedef typename allocator_type::const_reference const_reference;
+    typedef typename allocator_type::size_type size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef value_type* iterator;
+    typedef const value_type* const_iterator;
+    typedef reverse_iterator<iterator> reverse_iterator;
+    typedef ccystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    // 内联存储可容纳的元素个数
+    static constexpr size_type inline_capacity = N;
+
+    allocator_type get_allocator() const {
+        return allocator_type(alloc_);
+    }
+
+private:
+    iterator begin_; // 表示目前使用空间的头部
+    iterator end_; // 表示目前使用空间的尾部
+    iterator cap_; // 表示目前储存空间的尾部
+    [[no_unique_address]] data_allocator alloc_; // 分配器，无状态时不占空间
+    alignas(T) unsigned char buf_[(N == 0 ? 1 : N) * sizeof(T)]; // 内联缓冲区
+
+public:
+    // 构造、复制、移动、析构函数
+    small_vector() noexcept {
+        reset_inline();
+    }
+
+    explicit small_vector(const allocator_type& alloc) noexcept
+        : alloc_(alloc) {
+        reset_inline();
+    }
+
+    explicit small_vector(size_type n, const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
+        reset_inline();
+        fill_insert(end_, n, value_type());
+    }
+
+    small_vector(size_type n, const value_type& value,
+                 const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
+        reset_inline();
+        fill_insert(end_, n, value);
+    }
+
+    template <class Iter,
+              std::enable_if_t<is_input_iterator<Iter>::value, int>  = 0>
+    small_vector(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
+        ccystl_DEBUG(!(last < first));
+        reset_inline();
+        copy_assign(first, last, iterator_category(first));
+    }
+
+    small_vector(const small_vector& rhs)
+        : alloc_(rhs.alloc_) {
+        reset_inline();
+        copy_assign(rhs.begin_, rhs.end_, ccystl::forward_iterator_tag{});
+    }
+
+    small_vector(const small_vector& rhs, const allocator_type& alloc)
+        : alloc_(alloc) {
+        reset_inline();
+        copy_assign(rhs.begin_, rhs.end_, ccystl::forward_iterator_tag{});
+    }
+
+    small_vector(small_vector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : alloc_(ccystl::move(rhs.alloc_)) {
+        reset_inline();
+        move_from(rhs);
+    }
+
+    small_vector(std::initializer_list<value_type> ilist,
+                 const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
+        reset_inline();
+        copy_assign(ilist.begin(), ilist.end(), ccystl::forward_iterator_tag{});
+    }
+
+    small_vector& operator=(const small_vector& rhs) {
+        if (this != &rhs)
+            copy_assign(rhs.begin_, rhs.end_, ccystl::forward_iterator_tag{});
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& rhs);
+
+    small_vector& operator=(std::initializer_list<value_type> ilist) {
+        copy_assign(ilist.begin(), ilist.end(), ccystl::forward_iterator_tag{});
+        return *this;
+    }
+
+    ~small_vector() {
+        alloc_.destroy(begin_, end_);
+        release_heap();
+    }
+
+public:
+    // 迭代器相关操作
+    iterator begin() noexcept {
+        return begin_;
+    }
+
+    const_iterator begin() const noexcept {
+        return begin_;
+    }
+
+    iterator end() noexcept {
+        return end_;
+    }
+
+    const_iterator end() const noexcept {
+        return end_;
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关操作
+    [[nodiscard]] bool empty() const noexcept {
+        return begin_ == end_;
+    }
+
+    size_type size() const noexcept {
+        return static_cast<size_type>(end_ - begin_);
+    }
+
+    static size_type max_size() noexcept {
+        return static_cast<size_type>(-1) / sizeof(T);
+    }
+
+    size_type capacity() const noexcept {
+        return static_cast<size_type>(cap_ - begin_);
+    }
+
+    // 元素是否保存在内联缓冲区中
+    bool is_inline() const noexcept {
+        return begin_ == inline_begin();
+    }
+
+    void reserve(size_type n);
+    void shrink_to_fit();
+
+    // 访问元素相关操作
+    reference operator[](size_type n) {
+        ccystl_DEBUG(n < size());
+        return *(begin_ + n);
+    }
+
+    const_reference operator[](size_type n) const {
+        ccystl_DEBUG(n < size());
+        return *(begin_ + n);
+    }
+
+    reference at(size_type n) {
+        THROW_OUT_OF_RANGE_IF(!(n < size()),
+                              "small_vector<T, N>::at() subscript out of range");
+        return (*this)[n];
+    }
+
+    const_reference at(size_type n) const {
+        THROW_OUT_OF_RANGE_IF(!(n < size()),
+                              "small_vector<T, N>::at() subscript out of range");
+        return (*this)[n];
+    }
+
+    reference front() {
+        ccystl_DEBUG(!empty());
+        return *begin_;
+    }
+
+    const_reference front() const {
+        ccystl_DEBUG(!empty());
+        return *begin_;
+    }
+
+    reference back() {
+        ccystl_DEBUG(!empty());
+        return *(end_ - 1);
+    }
+
+    const_reference back() const {
+        ccystl_DEBUG(!empty());
+        return *(end_ - 1);
+    }
+
+    pointer data() noexcept {
+        return begin_;
+    }
+
+    const_pointer data() const noexcept {
+        return begin_;
+    }
+
+    // 修改容器相关操作
+
+    // assign
+
+    void assign(size_type n, const value_type& value) {
+        clear();
+        fill_insert(end_, n, value);
+    }
+
+    template <class Iter,
+              std::enable_if_t<is_input_iterator<Iter>::value, int>  = 0>
+    void assign(Iter first, Iter last) {
+        ccystl_DEBUG(!(last < first));
+        copy_assign(first, last, iterator_category(first));
+    }
+
+    void assign(std::initializer_list<value_type> il) {
+        copy_assign(il.begin(), il.end(), ccystl::forward_iterator_tag{});
+    }
+
+    // emplace / emplace_back
+
+    template <class... Args>
+    iterator emplace(const_iterator pos, Args&&... args);
+
+    template <class... Args>
+    reference emplace_back(Args&&... args);
+
+    // push_back / pop_back
+
+    void push_back(const value_type& value) {
+        emplace_back(value);
+    }
+
+    void push_back(value_type&& value) {
+        emplace_back(ccystl::move(value));
+    }
+
+    void pop_back() {
+        ccystl_DEBUG(!empty());
+        --end_;
+        alloc_.destroy(end_);
+    }
+
+    // insert
+
+    iterator insert(const_iterator pos, const value_type& value) {
+        return emplace(pos, value);
+    }
+
+    iterator insert(const_iterator pos, value_type&& value) {
+        return emplace(pos, ccystl::move(value));
+    }
+
+    iterator insert(const_iterator pos, size_type n, const value_type& value) {
+        ccystl_DEBUG(pos >= begin() && pos <= end());
+        return fill_insert(const_cast<iterator>(pos), n, value);
+    }
+
+    template <class Iter,
+              std::enable_if_t<is_input_iterator<Iter>::value, int>  = 0>
+    iterator insert(const_iterator pos, Iter first, Iter last) {
+        ccystl_DEBUG(pos >= begin() && pos <= end() && !(last < first));
+        return copy_insert(const_cast<iterator>(pos), first, last, iterator_category(first));
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<value_type> ilist) {
+        return insert(pos, ilist.begin(), ilist.end());
+    }
+
+    // erase / clear
+    iterator erase(const_iterator pos) {
+        ccystl_DEBUG(pos >= begin() && pos < end());
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last);
+
+    void clear() noexcept {
+        alloc_.destroy(begin_, end_);
+        end_ = begin_;
+    }
+
+    // resize / reverse
+    void resize(size_type new_size) {
+        return resize(new_size, value_type());
+    }
+
+    void resize(size_type new_size, const value_type& value);
+
+    void reverse() {
+        ccystl::reverse(begin(), end());
+    }
+
+    // swap
+    void swap(small_vector& rhs);
+
+private:
+    // helper functions
+
+    iterator inline_begin() noexcept {
+        return reinterpret_cast<iterator>(buf_);
+    }
+
+    const_iterator inline_begin() const noexcept {
+        return reinterpret_cast<const_iterator>(buf_);
+    }
+
+    // 指向空的内联缓冲区
+    void reset_inline() noexcept {
+        begin_ = end_ = inline_begin();
+        cap_ = begin_ + N;
+    }
+
+    // 释放堆上的空间（元素需已析构或已重定位）
+    void release_heap() noexcept {
+        if (!is_inline())
+            alloc_.deallocate(begin_, capacity());
+    }
+
+    void move_from(small_vector& rhs);
+
+    // calculate the growth size
+    size_type get_new_cap(size_type add_size) const;
+
+    // 将元素重定位到容量为 new_cap 的新空间
+    void relocate_to(size_type new_cap);
+
+    // 在 pos 处腾出 n 个未初始化的位置并返回其起始位置，construct_gap 负责构造这 n 个元素
+    template <class Construct>
+    iterator make_gap(iterator pos, size_type n, Construct construct_gap);
+
+    // assign
+
+    template <class IIter>
+    void copy_assign(IIter first, IIter last, input_iterator_tag);
+
+    template <class FIter>
+    void copy_assign(FIter first, FIter last, forward_iterator_tag);
+
+    // insert
+
+    iterator fill_insert(iterator pos, size_type n, const value_type& value);
+
+    template <class IIter>
+    iterator copy_insert(iterator pos, IIter first, IIter last, input_iterator_tag);
+
+    template <class FIter>
+    iterator copy_insert(iterator pos, FIter first, FIter last, forward_iterator_tag);
+};
+
+/*****************************************************************************************/
+
+// 移动赋值操作符
+// 分配器不随移动赋值传播：两者的分配器不相等或 rhs 使用内联存储时，逐个移动元素
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(small_vector&& rhs) {
+    if (this == &rhs)
+        return *this;
+    clear();
+    if (!rhs.is_inline() && alloc_ == rhs.alloc_) {
+        release_heap();
+        reset_inline();
+        move_from(rhs);
+        return *this;
+    }
+    reserve(rhs.size());
+    end_ = ccystl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+    rhs.clear();
+    return *this;
+}
+
+// 预留空间大小，当原容量小于要求大小时，才会重新分配
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::reserve(size_type n) {
+    if (capacity() < n) {
+        THROW_LENGTH_ERROR_IF(
+            n > max_size(),
+            "n can not larger than max_size() in small_vector<T, N>::reserve(n)");
+        relocate_to(n);
+    }
+}
+
+// 放弃多余的容量，元素个数不超过 N 时搬回内联缓冲区
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::shrink_to_fit() {
+    if (is_inline() || end_ == cap_)
+        return;
+    if (size() <= N) {
+        const auto old_begin = begin_;
+        const auto old_end = end_;
+        const auto old_cap = capacity();
+        ccystl::uninitialized_relocate(old_begin, old_end, inline_begin());
+        begin_ = inline_begin();
+        end_ = begin_ + (old_end - old_begin);
+        cap_ = begin_ + N;
+        alloc_.deallocate(old_begin, old_cap);
+    }
+    else {
+        relocate_to(size());
+    }
+}
+
+// 在 pos 位置就地构造元素
+template <class T, size_t N, class Alloc>
+template <class... Args>
+typename small_vector<T, N, Alloc>::iterator
+small_vector<T, N, Alloc>::emplace(const_iterator pos, Args&&... args) {
+    ccystl_DEBUG(pos >= begin() && pos <= end());
+    auto xpos = const_cast<iterator>(pos);
+    if (xpos == end_) {
+        const size_type n = xpos - begin_;
+        emplace_back(ccystl::forward<Args>(args)...);
+        return begin_ + n;
+    }
+    if (end_ != cap_) {
+        value_type tmp(ccystl::forward<Args>(args)...); // args 可能引用容器内的元素
+        alloc_.construct(end_, ccystl::move(*(end_ - 1)));
+        ++end_;
+        ccystl::move_backward(xpos, end_ - 2, end_ - 1);
+        *xpos = ccystl::move(tmp);
+        return xpos;
+    }
+    return make_gap(xpos, 1, [&](iterator gap) {
+        alloc_.construct(gap, ccystl::forward<Args>(args)...);
+    });
+}
+
+// 在尾部就地构造元素
+template <class T, size_t N, class Alloc>
+template <class... Args>
+typename small_vector<T, N, Alloc>::reference
+small_vector<T, N, Alloc>::emplace_back(Args&&... args) {
+    if (end_ != cap_) {
+        alloc_.construct(end_, ccystl::forward<Args>(args)...);
+        ++end_;
+    }
+    else {
+        make_gap(end_, 1, [&](iterator gap) {
+            alloc_.construct(gap, ccystl::forward<Args>(args)...);
+        });
+    }
+    return *(end_ - 1);
+}
+
+// 删除[first, last)上的元素
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::iterator
+small_vector<T, N, Alloc>::erase(const_iterator first, const_iterator last) {
+    ccystl_DEBUG(first >= begin() && last <= end() && !(last < first));
+    iterator r = begin_ + (first - begin());
+    auto new_end = ccystl::move(r + (last - first), end_, r);
+    alloc_.destroy(new_end, end_);
+    end_ = new_end;
+    return r;
+}
+
+// 重置容器大小
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::resize(size_type new_size, const value_type& value) {
+    if (new_size < size()) {
+        erase(begin() + new_size, end());
+    }
+    else {
+        fill_insert(end_, new_size - size(), value);
+    }
+}
+
+// 与另一个 small_vector 交换
+// 两者都在堆上且分配器相等时只交换指针，否则逐个移动元素，分配器不交换
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::swap(small_vector& rhs) {
+    if (this == &rhs)
+        return;
+    if (!is_inline() && !rhs.is_inline() && alloc_ == rhs.alloc_) {
+        ccystl::swap(begin_, rhs.begin_);
+        ccystl::swap(end_, rhs.end_);
+        ccystl::swap(cap_, rhs.cap_);
+        return;
+    }
+    small_vector tmp(ccystl::move(*this));
+    *this = ccystl::move(rhs);
+    rhs = ccystl::move(tmp);
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 接管 rhs 的元素，调用前本容器为空且指向内联缓冲区
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::move_from(small_vector& rhs) {
+    if (!rhs.is_inline()) {
+        begin_ = rhs.begin_;
+        end_ = rhs.end_;
+        cap_ = rhs.cap_;
+        rhs.reset_inline();
+    }
+    else {
+        end_ = ccystl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+        rhs.clear();
+    }
+}
+
+// get_new_cap 函数
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::size_type
+small_vector<T, N, Alloc>::get_new_cap(size_type add_size) const {
+    const auto old_size = capacity();
+    THROW_LENGTH_ERROR_IF(old_size > max_size() - add_size,
+                          "small_vector<T, N>'s size too big");
+    if (old_size > max_size() - old_size / 2) {
+        return old_size + add_size;
+    }
+    return ccystl::max(old_size + old_size / 2, size() + add_size);
+}
+
+// relocate_to 函数
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::relocate_to(size_type new_cap) {
+    const auto old_size = size();
+    auto new_begin = alloc_.allocate(new_cap);
+    try {
+        ccystl::uninitialized_relocate(begin_, end_, new_begin);
+    }
+    catch (...) {
+        alloc_.deallocate(new_begin, new_cap);
+        throw;
+    }
+    release_heap();
+    begin_ = new_begin;
+    end_ = new_begin + old_size;
+    cap_ = new_begin + new_cap;
+}
+
+// make_gap 函数
+// 先在新空间中构造新元素（其参数可能引用旧元素），成功后再重定位旧元素
+template <class T, size_t N, class Alloc>
+template <class Construct>
+typename small_vector<T, N, Alloc>::iterator
+small_vector<T, N, Alloc>::make_gap(iterator pos, size_type n, Construct construct_gap) {
+    const size_type before = pos - begin_;
+    const size_type old_size = size();
+    const size_type new_cap = get_new_cap(n);
+    auto new_begin = alloc_.allocate(new_cap);
+    try {
+        construct_gap(new_begin + before);
+    }
+    catch (...) {
+        alloc_.deallocate(new_begin, new_cap);
+        throw;
+    }
+    try {
+        ccystl::uninitialized_relocate(begin_, pos, new_begin);
+        try {
+            ccystl::uninitialized_relocate(pos, end_, new_begin + before + n);
+        }
+        catch (...) {
+            // 前半部分已经搬走，将其搬回原处以保持原容器完整
+            ccystl::uninitialized_relocate(new_begin, new_begin + before, begin_);
+            throw;
+        }
+    }
+    catch (...) {
+        alloc_.destroy(new_begin + before, new_begin + before + n);
+        alloc_.deallocate(new_begin, new_cap);
+        throw;
+    }
+    release_heap();
+    begin_ = new_begin;
+    end_ = new_begin + old_size + n;
+    cap_ = new_begin + new_cap;
+    return begin_ + before;
+}
+
+// 用 [first, last) 为容器赋值
+template <class T, size_t N, class Alloc>
+template <class IIter>
+void small_vector<T, N, Alloc>::copy_assign(IIter first, IIter last, input_iterator_tag) {
+    auto cur = begin_;
+    for (; first != last && cur != end_; ++first, ++cur) {
+        *cur = *first;
+    }
+    if (first == last) {
+        erase(cur, end_);
+    }
+    else {
+        for (; first != last; ++first)
+            emplace_back(*first);
+    }
+}
+
+template <class T, size_t N, class Alloc>
+template <class FIter>
+void small_vector<T, N, Alloc>::copy_assign(FIter first, FIter last, forward_iterator_tag) {
+    const size_type len = ccystl::distance(first, last);
+    if (len > capacity()) {
+        clear();
+        relocate_to(len);
+        end_ = ccystl::uninitialized_copy(first, last, begin_);
+    }
+    else if (size() >= len) {
+        auto new_end = ccystl::copy(first, last, begin_);
+        alloc_.destroy(new_end, end_);
+        end_ = new_end;
+    }
+    else {
+        auto mid = first;
+        ccystl::advance(mid, size());
+        ccystl::copy(first, mid, begin_);
+        end_ = ccystl::uninitialized_copy(mid, last, end_);
+    }
+}
+
+// fill_insert 函数
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::iterator
+small_vector<T, N, Alloc>::fill_insert(iterator pos, size_type n, const value_type& value) {
+    if (n == 0)
+        return pos;
+    if (static_cast<size_type>(cap_ - end_) < n) {
+        return make_gap(pos, n, [&](iterator gap) {
+            ccystl::uninitialized_fill_n(gap, n, value);
+        });
+    }
+    const value_type value_copy = value; // 避免被覆盖
+    const size_type after_elems = end_ - pos;
+    auto old_end = end_;
+    if (after_elems > n) {
+        end_ = ccystl::uninitialized_move(end_ - n, end_, end_);
+        ccystl::move_backward(pos, old_end - n, old_end);
+        ccystl::fill_n(pos, n, value_copy);
+    }
+    else {
+        end_ = ccystl::uninitialized_fill_n(end_, n - after_elems, value_copy);
+        end_ = ccystl::uninitialized_move(pos, old_end, end_);
+        ccystl::fill_n(pos, after_elems, value_copy);
+    }
+    return pos;
+}
+
+// copy_insert 函数
+template <class T, size_t N, class Alloc>
+template <class IIter>
+typename small_vector<T, N, Alloc>::iterator
+small_vector<T, N, Alloc>::copy_insert(iterator pos, IIter first, IIter last, input_iterator_tag) {
+    const size_type xpos = pos - begin_;
+    for (; first != last; ++first, ++pos)
+        pos = emplace(pos, *first);
+    return begin_ + xpos;
+}
+
+template <class T, size_t N, class Alloc>
+template <class FIter>
+typename small_vector<T, N, Alloc>::iterator
+small_vector<T, N, Alloc>::copy_insert(iterator pos, FIter first, FIter last, forward_iterator_tag) {
+    const size_type n = ccystl::distance(first, last);
+    if (n == 0)
+        return pos;
+    if (static_cast<size_type>(cap_ - end_) < n) {
+        return make_gap(pos, n, [&](iterator gap) {
+            ccystl::uninitialized_copy(first, last, gap);
+        });
+    }
+    const size_type after_elems = end_ - pos;
+    auto old_end = end_;
+    if (after_elems > n) {
+        end_ = ccystl::uninitialized_move(end_ - n, end_, end_);
+        ccystl::move_backward(pos, old_end - n, old_end);
+        ccystl::copy(first, last, pos);
+    }
+    else {
+        auto mid = first;
+        ccystl::advance(mid, after_elems);
+        end_ = ccystl::uninitialized_copy(mid, last, end_);
+        end_ = ccystl::uninitialized_move(pos, old_end, end_);
+        ccystl::copy(first, mid, pos);
+    }
+    return pos;
+}
+
+/*****************************************************************************************/
+// 重载比较操作符
+
+template <class T, size_t N, class Alloc>
+bool operator==(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs) {
+    return lhs.size() == rhs.size() &&
+        ccystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, size_t N, class Alloc>
+bool operator<(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs) {
+    return ccystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
+                                           rhs.end());
+}
+
+template <class T, size_t N, class Alloc>
+bool operator!=(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class T, size_t N, class Alloc>
+bool operator>(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class T, size_t N, class Alloc>
+bool operator<=(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class T, size_t N, class Alloc>
+bool operator>=(const small_vector<T, N, Alloc>& lhs, const small_vector<T, N, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class T, size_t N, class Alloc>
+void swap(small_vector<T, N, Alloc>& lhs, small_vector<T, N, Alloc>& rhs) {
+    lhs.swap(rhs);
+}
+
+namespace pmr {
+// 使用多态内存资源的 small_vector
+template <class T, size_t N>
+using small_vector = ccystl::small_vector<T, N, polymorphic_allocator<T>>;
+} // namespace pmr
+} // namespace ccystl
+#endif // CCYSTL_SMALL_VECTOR_H_
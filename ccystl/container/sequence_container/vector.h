@@ -21,7 +21,9 @@
 #include <initializer_list>
 
 #include "ccystl/algorithm/algo.h"
+#include "ccystl/allocator/allocator.h"
 #include "ccystl/allocator/memory.h"
+#include "ccystl/allocator/memory_resource.h"
 #include "ccystl/iterator/iterator.h"
 #include "ccystl/utils/except_def.h"
 #include "ccystl/utils/utils.h"
@@ -38,16 +40,17 @@ namespace ccystl {
 #endif // min
 
 // 模板类: vector
-// 模板参数 T 代表类型
-template <class T>
+// 模板参数 T 代表类型，Alloc 代表分配器类型，缺省使用 ccystl::allocator
+// 分配器以成员的形式保存，可以是有状态的（如 ccystl::pmr::polymorphic_allocator）
+template <class T, class Alloc = ccystl::allocator<T>>
 class vector {
     static_assert(!std::is_same_v<bool, T>,
                   "vector<bool> is abandoned in ccystl");
 
 public:
     // vector 的嵌套型别定义
-    typedef allocator<T> allocator_type;
-    typedef allocator<T> data_allocator;
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
 
     typedef typename allocator_type::value_type value_type;
     typedef typename allocator_type::pointer pointer;
@@ -62,56 +65,73 @@ public:
     typedef reverse_iterator<iterator> reverse_iterator;
     typedef ccystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
-    static allocator_type get_allocator() {
-        return data_allocator();
+    allocator_type get_allocator() const {
+        return allocator_type(alloc_);
     }
 
 private:
-    iterator begin_; // 表示目前使用空间的头部
-    iterator end_; // 表示目前使用空间的尾部
-    iterator cap_; // 表示目前储存空间的尾部
+    // 空容器不持有任何空间，三个指针均为空，直到第一次插入时才分配
+    iterator begin_ = nullptr; // 表示目前使用空间的头部
+    iterator end_ = nullptr; // 表示目前使用空间的尾部
+    iterator cap_ = nullptr; // 表示目前储存空间的尾部
+    [[no_unique_address]] data_allocator alloc_; // 分配器，无状态时不占空间
 
 public:
     // 构造、复制、移动、析构函数
-    vector() noexcept {
-        try_init();
+    vector() noexcept = default;
+
+    explicit vector(const allocator_type& alloc) noexcept
+        : alloc_(alloc) {
     }
 
-    explicit vector(size_type n) {
+    explicit vector(size_type n, const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
         fill_init(n, value_type());
     }
 
-    vector(size_type n, const value_type& value) {
+    vector(size_type n, const value_type& value,
+           const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
         fill_init(n, value);
     }
 
     template <class Iter,
               std::enable_if_t<is_input_iterator<Iter>::value, int>  = 0>
-    vector(Iter first, Iter last) {
+    vector(Iter first, Iter last, const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
         ccystl_DEBUG(!(last < first));
         range_init(first, last);
     }
 
-    vector(const vector& rhs) {
+    vector(const vector& rhs)
+        : alloc_(rhs.alloc_) {
+        range_init(rhs.begin_, rhs.end_);
+    }
+
+    vector(const vector& rhs, const allocator_type& alloc)
+        : alloc_(alloc) {
         range_init(rhs.begin_, rhs.end_);
     }
 
     vector(vector&& rhs) noexcept
-        : begin_(rhs.begin_), end_(rhs.end_), cap_(rhs.cap_) {
+        : begin_(rhs.begin_), end_(rhs.end_), cap_(rhs.cap_),
+          alloc_(ccystl::move(rhs.alloc_)) {
         rhs.begin_ = nullptr;
         rhs.end_ = nullptr;
         rhs.cap_ = nullptr;
     }
 
-    vector(std::initializer_list<value_type> ilist) {
+    vector(std::initializer_list<value_type> ilist,
+           const allocator_type& alloc = allocator_type())
+        : alloc_(alloc) {
         range_init(ilist.begin(), ilist.end());
     }
 
     vector& operator=(const vector& rhs);
-    vector& operator=(vector&& rhs) noexcept;
+    vector& operator=(vector&& rhs) noexcept(std::is_empty_v<data_allocator>);
 
     vector& operator=(std::initializer_list<value_type> ilist) {
-        vector tmp(ilist.begin(), ilist.end());
+        vector tmp(ilist.begin(), ilist.end(), alloc_);
         swap(tmp);
         return *this;
     }
@@ -326,8 +346,6 @@ private:
     // helper functions
 
     // initialize / destroy
-    void try_init() noexcept;
-
     void init_space(size_type size, size_type cap);
 
     void fill_init(size_type n, const value_type& value);
@@ -351,6 +369,9 @@ private:
 
     // reallocate
 
+    void relocate_storage(size_type new_cap);
+    template <class... Args>
+    void relocate_emplace(iterator pos, Args&&... args);
     template <class... Args>
     void reallocate_emplace(iterator pos, Args&&... args);
     void reallocate_insert(iterator pos, const value_type& value);
@@ -369,31 +390,41 @@ private:
 /*****************************************************************************************/
 
 // 复制赋值操作符
-template <class T>
-vector<T>& vector<T>::operator=(const vector& rhs) {
+template <class T, class Alloc>
+vector<T, Alloc>& vector<T, Alloc>::operator=(const vector& rhs) {
     if (this != &rhs) {
         const auto len = rhs.size();
         if (len > capacity()) {
-            vector tmp(rhs.begin(), rhs.end());
+            vector tmp(rhs.begin(), rhs.end(), alloc_);
             swap(tmp);
         }
         else if (size() >= len) {
             auto i = ccystl::copy(rhs.begin(), rhs.end(), begin());
-            data_allocator::destroy(i, end_);
+            alloc_.destroy(i, end_);
             end_ = begin_ + len;
         }
         else {
             ccystl::copy(rhs.begin(), rhs.begin() + size(), begin_);
             ccystl::uninitialized_copy(rhs.begin() + size(), rhs.end(), end_);
-            cap_ = end_ = begin_ + len;
+            end_ = begin_ + len;
         }
     }
     return *this;
 }
 
 // 移动赋值操作符
-template <class T>
-vector<T>& vector<T>::operator=(vector&& rhs) noexcept {
+// 分配器不随移动赋值传播：两者的分配器不相等时，逐个移动元素到本容器自己的空间
+template <class T, class Alloc>
+vector<T, Alloc>& vector<T, Alloc>::operator=(vector&& rhs) noexcept(std::is_empty_v<data_allocator>) {
+    if (this == &rhs)
+        return *this;
+    if (!(alloc_ == rhs.alloc_)) {
+        clear();
+        reserve(rhs.size());
+        end_ = ccystl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+        rhs.clear();
+        return *this;
+    }
     destroy_and_recover(begin_, end_, cap_ - begin_);
     begin_ = rhs.begin_;
     end_ = rhs.end_;
@@ -405,46 +436,40 @@ vector<T>& vector<T>::operator=(vector&& rhs) noexcept {
 }
 
 // 预留空间大小，当原容量小于要求大小时，才会重新分配
-template <class T>
-void vector<T>::reserve(size_type n) {
+template <class T, class Alloc>
+void vector<T, Alloc>::reserve(size_type n) {
     if (capacity() < n) {
         THROW_LENGTH_ERROR_IF(
             n > max_size(),
             "n can not larger than max_size() in vector<T>::reserve(n)");
-        const auto old_size = size();
-        auto tmp = data_allocator::allocate(n);
-        ccystl::uninitialized_move(begin_, end_, tmp);
-        data_allocator::deallocate(begin_, cap_ - begin_);
-        begin_ = tmp;
-        end_ = tmp + old_size;
-        cap_ = begin_ + n;
+        relocate_storage(n);
     }
 }
 
 // 放弃多余的容量
-template <class T>
-void vector<T>::shrink_to_fit() {
+template <class T, class Alloc>
+void vector<T, Alloc>::shrink_to_fit() {
     if (end_ < cap_) {
         reinsert(size());
     }
 }
 
 // 在 pos 位置就地构造元素，避免额外的复制或移动开销
-template <class T>
+template <class T, class Alloc>
 template <class... Args>
-typename vector<T>::iterator vector<T>::emplace(const_iterator pos,
+typename vector<T, Alloc>::iterator vector<T, Alloc>::emplace(const_iterator pos,
                                                 Args&&... args) {
     ccystl_DEBUG(pos >= begin() && pos <= end());
     auto xpos = const_cast<iterator>(pos);
     const size_type n = xpos - begin_;
     if (end_ != cap_ && xpos == end_) {
-        data_allocator::construct(ccystl::address_of(*end_),
+        alloc_.construct(ccystl::address_of(*end_),
                                   ccystl::forward<Args>(args)...);
         ++end_;
     }
     else if (end_ != cap_) {
         auto new_end = end_;
-        data_allocator::construct(ccystl::address_of(*end_), *(end_ - 1));
+        alloc_.construct(ccystl::address_of(*end_), *(end_ - 1));
         ++new_end;
         ccystl::copy_backward(xpos, end_ - 1, end_);
         *xpos = value_type(ccystl::forward<Args>(args)...);
@@ -457,11 +482,11 @@ typename vector<T>::iterator vector<T>::emplace(const_iterator pos,
 }
 
 // 在尾部就地构造元素，避免额外的复制或移动开销
-template <class T>
+template <class T, class Alloc>
 template <class... Args>
-void vector<T>::emplace_back(Args&&... args) {
+void vector<T, Alloc>::emplace_back(Args&&... args) {
     if (end_ < cap_) {
-        data_allocator::construct(ccystl::address_of(*end_),
+        alloc_.construct(ccystl::address_of(*end_),
                                   ccystl::forward<Args>(args)...);
         ++end_;
     }
@@ -471,10 +496,10 @@ void vector<T>::emplace_back(Args&&... args) {
 }
 
 // 在尾部插入元素
-template <class T>
-void vector<T>::push_back(const value_type& value) {
+template <class T, class Alloc>
+void vector<T, Alloc>::push_back(const value_type& value) {
     if (end_ != cap_) {
-        data_allocator::construct(ccystl::address_of(*end_), value);
+        alloc_.construct(ccystl::address_of(*end_), value);
         ++end_;
     }
     else {
@@ -483,27 +508,27 @@ void vector<T>::push_back(const value_type& value) {
 }
 
 // 弹出尾部元素
-template <class T>
-void vector<T>::pop_back() {
+template <class T, class Alloc>
+void vector<T, Alloc>::pop_back() {
     CCYSTL_DEBUG(!empty());
-    data_allocator::destroy(end_ - 1);
+    alloc_.destroy(end_ - 1);
     --end_;
 }
 
 // 在 pos 处插入元素
-template <class T>
-typename vector<T>::iterator vector<T>::insert(const_iterator pos,
+template <class T, class Alloc>
+typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos,
                                                const value_type& value) {
     ccystl_DEBUG(pos >= begin() && pos <= end());
     auto xpos = const_cast<iterator>(pos);
     const size_type n = pos - begin_;
     if (end_ != cap_ && xpos == end_) {
-        data_allocator::construct(ccystl::address_of(*end_), value);
+        alloc_.construct(ccystl::address_of(*end_), value);
         ++end_;
     }
     else if (end_ != cap_) {
         auto new_end = end_;
-        data_allocator::construct(ccystl::address_of(*end_), *(end_ - 1));
+        alloc_.construct(ccystl::address_of(*end_), *(end_ - 1));
         ++new_end;
         auto value_copy = value; // 避免元素因以下复制操作而被改变
         ccystl::copy_backward(xpos, end_ - 1, end_);
@@ -517,31 +542,31 @@ typename vector<T>::iterator vector<T>::insert(const_iterator pos,
 }
 
 // 删除 pos 位置上的元素
-template <class T>
-typename vector<T>::iterator vector<T>::erase(const_iterator pos) {
+template <class T, class Alloc>
+typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(const_iterator pos) {
     ccystl_DEBUG(pos >= begin() && pos < end());
     iterator xpos = begin_ + (pos - begin());
     ccystl::move(xpos + 1, end_, xpos);
-    data_allocator::destroy(end_ - 1);
+    alloc_.destroy(end_ - 1);
     --end_;
     return xpos;
 }
 
 // 删除[first, last)上的元素
-template <class T>
-typename vector<T>::iterator vector<T>::erase(const_iterator first,
+template <class T, class Alloc>
+typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(const_iterator first,
                                               const_iterator last) {
     CCYSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
     const auto n = first - begin();
     iterator r = begin_ + (first - begin());
-    data_allocator::destroy(ccystl::move(r + (last - first), end_, r), end_);
+    alloc_.destroy(ccystl::move(r + (last - first), end_, r), end_);
     end_ = end_ - (last - first);
     return begin_ + n;
 }
 
 // 重置容器大小
-template <class T>
-void vector<T>::resize(size_type new_size, const value_type& value) {
+template <class T, class Alloc>
+void vector<T, Alloc>::resize(size_type new_size, const value_type& value) {
     if (new_size < size()) {
         erase(begin() + new_size, end());
     }
@@ -551,38 +576,24 @@ void vector<T>::resize(size_type new_size, const value_type& value) {
 }
 
 // 与另一个 vector 交换
-template <class T>
-void vector<T>::swap(vector<T>& rhs) noexcept {
+template <class T, class Alloc>
+void vector<T, Alloc>::swap(vector<T, Alloc>& rhs) noexcept {
     if (this != &rhs) {
         ccystl::swap(begin_, rhs.begin_);
         ccystl::swap(end_, rhs.end_);
         ccystl::swap(cap_, rhs.cap_);
+        ccystl::swap(alloc_, rhs.alloc_);
     }
 }
 
 /*****************************************************************************************/
 // helper function
 
-// try_init 函数，若分配失败则忽略，不抛出异常
-template <class T>
-void vector<T>::try_init() noexcept {
-    try {
-        begin_ = data_allocator::allocate(16);
-        end_ = begin_;
-        cap_ = begin_ + 16;
-    }
-    catch (...) {
-        begin_ = nullptr;
-        end_ = nullptr;
-        cap_ = nullptr;
-    }
-}
-
 // init_space 函数
-template <class T>
-void vector<T>::init_space(size_type size, size_type cap) {
+template <class T, class Alloc>
+void vector<T, Alloc>::init_space(size_type size, size_type cap) {
     try {
-        begin_ = data_allocator::allocate(cap);
+        begin_ = alloc_.allocate(cap);
         end_ = begin_ + size;
         cap_ = begin_ + cap;
     }
@@ -595,34 +606,38 @@ void vector<T>::init_space(size_type size, size_type cap) {
 }
 
 // fill_init 函数
-template <class T>
-void vector<T>::fill_init(size_type n, const value_type& value) {
+template <class T, class Alloc>
+void vector<T, Alloc>::fill_init(size_type n, const value_type& value) {
+    if (n == 0)
+        return;
     const size_type init_size = ccystl::max(static_cast<size_type>(16), n);
     init_space(n, init_size);
     ccystl::uninitialized_fill_n(begin_, n, value);
 }
 
 // range_init 函数
-template <class T>
+template <class T, class Alloc>
 template <class Iter>
-void vector<T>::range_init(Iter first, Iter last) {
+void vector<T, Alloc>::range_init(Iter first, Iter last) {
     const size_type len = ccystl::distance(first, last);
+    if (len == 0)
+        return;
     const size_type init_size = ccystl::max(len, static_cast<size_type>(16));
     init_space(len, init_size);
     ccystl::uninitialized_copy(first, last, begin_);
 }
 
 // destroy_and_recover 函数
-template <class T>
-void vector<T>::destroy_and_recover(iterator first, iterator last,
+template <class T, class Alloc>
+void vector<T, Alloc>::destroy_and_recover(iterator first, iterator last,
                                     size_type n) {
-    data_allocator::destroy(first, last);
-    data_allocator::deallocate(first, n);
+    alloc_.destroy(first, last);
+    alloc_.deallocate(first, n);
 }
 
 // get_new_cap 函数
-template <class T>
-typename vector<T>::size_type vector<T>::get_new_cap(size_type add_size) {
+template <class T, class Alloc>
+typename vector<T, Alloc>::size_type vector<T, Alloc>::get_new_cap(size_type add_size) {
     const auto old_size = capacity();
     THROW_LENGTH_ERROR_IF(old_size > max_size() - add_size,
                           "vector<T>'s size too big");
@@ -639,10 +654,10 @@ typename vector<T>::size_type vector<T>::get_new_cap(size_type add_size) {
 }
 
 // fill_assign 函数
-template <class T>
-void vector<T>::fill_assign(size_type n, const value_type& value) {
+template <class T, class Alloc>
+void vector<T, Alloc>::fill_assign(size_type n, const value_type& value) {
     if (n > capacity()) {
-        vector tmp(n, value);
+        vector tmp(n, value, alloc_);
         swap(tmp);
     }
     else if (n > size()) {
@@ -655,9 +670,9 @@ void vector<T>::fill_assign(size_type n, const value_type& value) {
 }
 
 // copy_assign 函数
-template <class T>
+template <class T, class Alloc>
 template <class IIter>
-void vector<T>::copy_assign(IIter first, IIter last, input_iterator_tag) {
+void vector<T, Alloc>::copy_assign(IIter first, IIter last, input_iterator_tag) {
     auto cur = begin_;
     for (; first != last && cur != end_; ++first, ++cur) {
         *cur = *first;
@@ -671,17 +686,17 @@ void vector<T>::copy_assign(IIter first, IIter last, input_iterator_tag) {
 }
 
 // 用 [first, last) 为容器赋值
-template <class T>
+template <class T, class Alloc>
 template <class FIter>
-void vector<T>::copy_assign(FIter first, FIter last, forward_iterator_tag) {
+void vector<T, Alloc>::copy_assign(FIter first, FIter last, forward_iterator_tag) {
     const size_type len = ccystl::distance(first, last);
     if (len > capacity()) {
-        vector tmp(first, last);
+        vector tmp(first, last, alloc_);
         swap(tmp);
     }
     else if (size() >= len) {
         auto new_end = ccystl::copy(first, last, begin_);
-        data_allocator::destroy(new_end, end_);
+        alloc_.destroy(new_end, end_);
         end_ = new_end;
     }
     else {
@@ -693,22 +708,84 @@ void vector<T>::copy_assign(FIter first, FIter last, forward_iterator_tag) {
     }
 }
 
+// 将元素重定位到容量为 new_cap 的新空间，new_cap 不小于 size()
+template <class T, class Alloc>
+void vector<T, Alloc>::relocate_storage(size_type new_cap) {
+    const auto old_size = size();
+    if constexpr (is_trivially_relocatable_v<T> && allocator_has_reallocate_v<data_allocator>) {
+        // 分配器支持时原地扩容，大块内存由 realloc 重新映射页面而不是复制
+        begin_ = alloc_.reallocate(begin_, capacity(), new_cap);
+        end_ = begin_ + old_size;
+        cap_ = begin_ + new_cap;
+        return;
+    }
+    auto new_begin = alloc_.allocate(new_cap);
+    try {
+        ccystl::uninitialized_relocate(begin_, end_, new_begin);
+    }
+    catch (...) {
+        alloc_.deallocate(new_begin, new_cap);
+        throw;
+    }
+    alloc_.deallocate(begin_, cap_ - begin_);
+    begin_ = new_begin;
+    end_ = new_begin + old_size;
+    cap_ = new_begin + new_cap;
+}
+
+// 可平凡重定位的元素扩容时按字节搬移，先构造新元素以保证强异常安全
+template <class T, class Alloc>
+template <class... Args>
+void vector<T, Alloc>::relocate_emplace(iterator pos, Args&&... args) {
+    const auto new_size = get_new_cap(1);
+    const size_type before = pos - begin_;
+    const size_type old_size = size();
+    if constexpr (allocator_has_reallocate_v<data_allocator>) {
+        if (pos == end_) {
+            // args 可能引用容器内的元素，先构造出新元素再原地扩容
+            value_type tmp(ccystl::forward<Args>(args)...);
+            relocate_storage(new_size);
+            alloc_.construct(end_, ccystl::move(tmp));
+            ++end_;
+            return;
+        }
+    }
+    auto new_begin = alloc_.allocate(new_size);
+    try {
+        alloc_.construct(new_begin + before, ccystl::forward<Args>(args)...);
+    }
+    catch (...) {
+        alloc_.deallocate(new_begin, new_size);
+        throw;
+    }
+    ccystl::uninitialized_relocate(begin_, pos, new_begin);
+    ccystl::uninitialized_relocate(pos, end_, new_begin + before + 1);
+    alloc_.deallocate(begin_, cap_ - begin_);
+    begin_ = new_begin;
+    end_ = new_begin + old_size + 1;
+    cap_ = new_begin + new_size;
+}
+
 // 重新分配空间并在 pos 处就地构造元素
-template <class T>
+template <class T, class Alloc>
 template <class... Args>
-void vector<T>::reallocate_emplace(iterator pos, Args&&... args) {
+void vector<T, Alloc>::reallocate_emplace(iterator pos, Args&&... args) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        relocate_emplace(pos, ccystl::forward<Args>(args)...);
+        return;
+    }
     const auto new_size = get_new_cap(1);
-    auto new_begin = data_allocator::allocate(new_size);
+    auto new_begin = alloc_.allocate(new_size);
     auto new_end = new_begin;
     try {
         new_end = ccystl::uninitialized_move(begin_, pos, new_begin);
-        data_allocator::construct(ccystl::address_of(*new_end),
+        alloc_.construct(ccystl::address_of(*new_end),
                                   ccystl::forward<Args>(args)...);
         ++new_end;
         new_end = ccystl::uninitialized_move(pos, end_, new_end);
     }
     catch (...) {
-        data_allocator::deallocate(new_begin, new_size);
+        alloc_.deallocate(new_begin, new_size);
         throw;
     }
     destroy_and_recover(begin_, end_, cap_ - begin_);
@@ -718,20 +795,24 @@ void vector<T>::reallocate_emplace(iterator pos, Args&&... args) {
 }
 
 // 重新分配空间并在 pos 处插入元素
-template <class T>
-void vector<T>::reallocate_insert(iterator pos, const value_type& value) {
+template <class T, class Alloc>
+void vector<T, Alloc>::reallocate_insert(iterator pos, const value_type& value) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        relocate_emplace(pos, value);
+        return;
+    }
     const auto new_size = get_new_cap(1);
-    auto new_begin = data_allocator::allocate(new_size);
+    auto new_begin = alloc_.allocate(new_size);
     auto new_end = new_begin;
     const value_type& value_copy = value;
     try {
         new_end = ccystl::uninitialized_move(begin_, pos, new_begin);
-        data_allocator::construct(ccystl::address_of(*new_end), value_copy);
+        alloc_.construct(ccystl::address_of(*new_end), value_copy);
         ++new_end;
         new_end = ccystl::uninitialized_move(pos, end_, new_end);
     }
     catch (...) {
-        data_allocator::deallocate(new_begin, new_size);
+        alloc_.deallocate(new_begin, new_size);
         throw;
     }
     destroy_and_recover(begin_, end_, cap_ - begin_);
@@ -741,8 +822,8 @@ void vector<T>::reallocate_insert(iterator pos, const value_type& value) {
 }
 
 // fill_insert 函数
-template <class T>
-typename vector<T>::iterator vector<T>::fill_insert(iterator pos, size_type n,
+template <class T, class Alloc>
+typename vector<T, Alloc>::iterator vector<T, Alloc>::fill_insert(iterator pos, size_type n,
                                                     const value_type& value) {
     if (n == 0)
         return pos;
@@ -757,29 +838,44 @@ typename vector<T>::iterator vector<T>::fill_insert(iterator pos, size_type n,
             ccystl::uninitialized_copy(end_ - n, end_, end_);
             end_ += n;
             ccystl::move_backward(pos, old_end - n, old_end);
-            ccystl::uninitialized_fill_n(pos, n, value_copy);
+            ccystl::fill_n(pos, n, value_copy);
         }
         else {
             end_ = ccystl::uninitialized_fill_n(end_, n - after_elems, value_copy);
             end_ = ccystl::uninitialized_move(pos, old_end, end_);
-            ccystl::uninitialized_fill_n(pos, after_elems, value_copy);
+            ccystl::fill_n(pos, after_elems, value_copy);
         }
     }
     else {
         // 如果备用空间不足
         const auto new_size = get_new_cap(n);
-        auto new_begin = data_allocator::allocate(new_size);
+        auto new_begin = alloc_.allocate(new_size);
         auto new_end = new_begin;
-        try {
-            new_end = ccystl::uninitialized_move(begin_, pos, new_begin);
-            new_end = ccystl::uninitialized_fill_n(new_end, n, value);
-            new_end = ccystl::uninitialized_move(pos, end_, new_end);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            // 先填充新元素，旧元素随后按字节搬移，不会失败
+            try {
+                ccystl::uninitialized_fill_n(new_begin + xpos, n, value_copy);
+            }
+            catch (...) {
+                alloc_.deallocate(new_begin, new_size);
+                throw;
+            }
+            ccystl::uninitialized_relocate(begin_, pos, new_begin);
+            new_end = ccystl::uninitialized_relocate(pos, end_, new_begin + xpos + n);
+            alloc_.deallocate(begin_, cap_ - begin_);
         }
-        catch (...) {
-            destroy_and_recover(new_begin, new_end, new_size);
-            throw;
+        else {
+            try {
+                new_end = ccystl::uninitialized_move(begin_, pos, new_begin);
+                new_end = ccystl::uninitialized_fill_n(new_end, n, value);
+                new_end = ccystl::uninitialized_move(pos, end_, new_end);
+            }
+            catch (...) {
+                destroy_and_recover(new_begin, new_end, new_size);
+                throw;
+            }
+            destroy_and_recover(begin_, end_, cap_ - begin_);
         }
-        data_allocator::deallocate(begin_, cap_ - begin_);
         begin_ = new_begin;
         end_ = new_end;
         cap_ = begin_ + new_size;
@@ -788,9 +884,9 @@ typename vector<T>::iterator vector<T>::fill_insert(iterator pos, size_type n,
 }
 
 // copy_insert 函数
-template <class T>
+template <class T, class Alloc>
 template <class IIter>
-void vector<T>::copy_insert(iterator pos, IIter first, IIter last) {
+void vector<T, Alloc>::copy_insert(iterator pos, IIter first, IIter last) {
     if (first == last)
         return;
     const auto n = ccystl::distance(first, last);
@@ -801,31 +897,47 @@ void vector<T>::copy_insert(iterator pos, IIter first, IIter last) {
         if (after_elems > n) {
             end_ = ccystl::uninitialized_copy(end_ - n, end_, end_);
             ccystl::move_backward(pos, old_end - n, old_end);
-            ccystl::uninitialized_copy(first, last, pos);
+            ccystl::copy(first, last, pos);
         }
         else {
             auto mid = first;
             ccystl::advance(mid, after_elems);
             end_ = ccystl::uninitialized_copy(mid, last, end_);
             end_ = ccystl::uninitialized_move(pos, old_end, end_);
-            ccystl::uninitialized_copy(first, mid, pos);
+            ccystl::copy(first, mid, pos);
         }
     }
     else {
         // 备用空间不足
         const auto new_size = get_new_cap(n);
-        auto new_begin = data_allocator::allocate(new_size);
+        auto new_begin = alloc_.allocate(new_size);
         auto new_end = new_begin;
-        try {
-            new_end = ccystl::uninitialized_move(begin_, pos, new_begin);
-            new_end = ccystl::uninitialized_copy(first, last, new_end);
-            new_end = ccystl::uninitialized_move(pos, end_, new_end);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            // 先复制新元素（[first, last) 可能来自容器自身），旧元素随后按字节搬移
+            const auto before = pos - begin_;
+            try {
+                ccystl::uninitialized_copy(first, last, new_begin + before);
+            }
+            catch (...) {
+                alloc_.deallocate(new_begin, new_size);
+                throw;
+            }
+            ccystl::uninitialized_relocate(begin_, pos, new_begin);
+            new_end = ccystl::uninitialized_relocate(pos, end_, new_begin + before + n);
+            alloc_.deallocate(begin_, cap_ - begin_);
         }
-        catch (...) {
-            destroy_and_recover(new_begin, new_end, new_size);
-            throw;
+        else {
+            try {
+                new_end = ccystl::uninitialized_move(begin_, pos, new_begin);
+                new_end = ccystl::uninitialized_copy(first, last, new_end);
+                new_end = ccystl::uninitialized_move(pos, end_, new_end);
+            }
+            catch (...) {
+                destroy_and_recover(new_begin, new_end, new_size);
+                throw;
+            }
+            destroy_and_recover(begin_, end_, cap_ - begin_);
         }
-        data_allocator::deallocate(begin_, cap_ - begin_);
         begin_ = new_begin;
         end_ = new_end;
         cap_ = begin_ + new_size;
@@ -833,61 +945,60 @@ void vector<T>::copy_insert(iterator pos, IIter first, IIter last) {
 }
 
 // reinsert 函数
-template <class T>
-void vector<T>::reinsert(size_type size) {
-    auto new_begin = data_allocator::allocate(size);
-    try {
-        ccystl::uninitialized_move(begin_, end_, new_begin);
-    }
-    catch (...) {
-        data_allocator::deallocate(new_begin, size);
-        throw;
-    }
-    data_allocator::deallocate(begin_, cap_ - begin_);
-    begin_ = new_begin;
-    end_ = begin_ + size;
-    cap_ = begin_ + size;
+template <class T, class Alloc>
+void vector<T, Alloc>::reinsert(size_type size) {
+    relocate_storage(size);
 }
 
 /*****************************************************************************************/
 // 重载比较操作符
 
-template <class T>
-bool operator==(const vector<T>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc>
+bool operator==(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return lhs.size() == rhs.size() &&
         ccystl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T>
-bool operator<(const vector<T>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc>
+bool operator<(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return ccystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
                                            rhs.end());
 }
 
-template <class T>
-bool operator!=(const vector<T>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc>
+bool operator!=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return !(lhs == rhs);
 }
 
-template <class T>
-bool operator>(const vector<T>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc>
+bool operator>(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return rhs < lhs;
 }
 
-template <class T>
-bool operator<=(const vector<T>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc>
+bool operator<=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return !(rhs < lhs);
 }
 
-template <class T>
-bool operator>=(const vector<T>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc>
+bool operator>=(const vector<T, Alloc>& lhs, const vector<T, Alloc>& rhs) {
     return !(lhs < rhs);
 }
 
 // 重载 ccystl 的 swap
-template <class T>
-void swap(vector<T>& lhs, vector<T>& rhs) noexcept {
+template <class T, class Alloc>
+void swap(vector<T, Alloc>& lhs, vector<T, Alloc>& rhs) noexcept {
     lhs.swap(rhs);
 }
+
+// vector 只持有指向堆内存的指针，分配器可平凡重定位时 vector 也可以
+template <class T, class Alloc>
+struct is_trivially_relocatable<vector<T, Alloc>> : is_trivially_relocatable<Alloc> { };
+
+namespace pmr {
+// 使用多态内存资源的 vector
+template <class T>
+using vector = ccystl::vector<T, polymorphic_allocator<T>>;
+} // namespace pmr
 } // namespace ccystl
 #endif // CCYSTL_VECTOR_H_
@@ -0,0 +1,268 @@
+#ifndef CCYSTL_BLOOM_FILTER_H_
+#define CCYSTL_BLOOM_FILTER_H_
+
+// 这个头文件包含模板类 bloom_filter
+// 分块的布隆过滤器（blocked Bloom filter），判断一个键值“一定不在”或“可能在”集合中
+//
+// 设计：
+//   * 位数组分为 512 位（64 字节，一条缓存行）的块，按 64 字节对齐
+//   * 哈希值的高 32 位选择块，低 32 位分别乘以 8 个奇数常数后取高 6 位，
+//     在块内 8 个 64 位字中各置一位（split block Bloom filter）
+//   * 插入与查询都只访问一条缓存行，8 个字的运算互不依赖，编译器可以向量化
+//   * 每个键值约 12 位时假阳性率约 0.4%
+//
+// notes:
+//
+// 不支持删除；不会漏报，假阳性率随插入个数超过 capacity 而上升
+// 哈希值先经 hash_mix 打散，因此可以直接使用恒等映射的整数哈希函数
+
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+#include "ccystl/allocator/allocator.h"
+#include "ccystl/functor/functional.h"
+#include "ccystl/utils/except_def.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+
+    // 过滤器的一个块：8 个 64 位字，恰好一条缓存行
+    struct bf_block {
+        uint64_t words[8];
+    };
+
+    // 模板类 bloom_filter
+    // 参数一代表键值类型，参数二代表哈希函数，缺省使用 ccystl::hash，参数三代表分配器类型
+    template <class Key, class Hash = ccystl::hash<Key>, class Alloc = ccystl::allocator<Key>>
+    class bloom_filter {
+    public:
+        typedef Key                                      key_type;
+        typedef Hash                                     hasher;
+        typedef Alloc                                    allocator_type;
+        typedef size_t                                   size_type;
+
+        static constexpr size_type block_bytes = sizeof(bf_block);
+        static constexpr size_type block_bits = block_bytes * 8;
+        static constexpr bool      supports_erase = false; // 见 filtered_hash_container
+        static constexpr size_type default_bits_per_key = 12;
+
+    private:
+        typedef typename Alloc::template rebind<bf_block>::other block_allocator;
+
+        bf_block*   raw_ = nullptr;     // 分配得到的内存，多分配一个块用于对齐
+        bf_block*   blocks_ = nullptr;  // 按 64 字节对齐的第一个块
+        size_type   block_count_ = 0;
+        size_type   capacity_ = 0;      // 设计容量
+        size_type   size_ = 0;          // 插入的次数
+        size_type   bits_per_key_ = default_bits_per_key;
+        [[no_unique_address]] hasher          hash_;
+        [[no_unique_address]] block_allocator alloc_;
+
+    public:
+        // 构造、复制、移动、析构函数
+
+        // 至少分配一个块，只有被移动后的过滤器没有块
+        bloom_filter()
+            :bloom_filter(0) {
+        }
+
+        // capacity 为预计插入的键值个数，bits_per_key 为每个键值平均分到的位数
+        explicit bloom_filter(size_type capacity,
+            const Hash& hash = Hash(),
+            const allocator_type& alloc = allocator_type())
+            :bloom_filter(capacity, default_bits_per_key, hash, alloc) {
+        }
+
+        bloom_filter(size_type capacity, size_type bits_per_key,
+            const Hash& hash = Hash(),
+            const allocator_type& alloc = allocator_type())
+            :bits_per_key_(bits_per_key), hash_(hash), alloc_(alloc) {
+            THROW_LENGTH_ERROR_IF(bits_per_key == 0, "bloom_filter's bits per key must be positive");
+            reset(capacity);
+        }
+
+        bloom_filter(const bloom_filter& rhs)
+            :capacity_(rhs.capacity_), size_(rhs.size_), bits_per_key_(rhs.bits_per_key_),
+             hash_(rhs.hash_), alloc_(rhs.alloc_) {
+            allocate(rhs.block_count_);
+            std::memcpy(static_cast<void*>(blocks_), rhs.blocks_, rhs.block_count_ * block_bytes);
+        }
+
+        bloom_filter(bloom_filter&& rhs) noexcept
+            :raw_(rhs.raw_), blocks_(rhs.blocks_), block_count_(rhs.block_count_),
+             capacity_(rhs.capacity_), size_(rhs.size_), bits_per_key_(rhs.bits_per_key_),
+             hash_(rhs.hash_), alloc_(rhs.alloc_) {
+            rhs.raw_ = nullptr;
+            rhs.blocks_ = nullptr;
+            rhs.block_count_ = 0;
+            rhs.capacity_ = 0;
+            rhs.size_ = 0;
+        }
+
+        bloom_filter& operator=(const bloom_filter& rhs) {
+            if (this != &rhs) {
+                bloom_filter tmp(rhs);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        bloom_filter& operator=(bloom_filter&& rhs) noexcept {
+            if (this != &rhs) {
+                bloom_filter tmp(ccystl::move(rhs));
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        ~bloom_filter() { deallocate(); }
+
+        // 修改相关
+
+        // 插入键值，总是成功，返回 true
+        bool insert(const key_type& key) {
+            return insert_hash(static_cast<size_type>(hash_(key)));
+        }
+
+        // 以 hasher 算出的哈希值插入，避免重复计算哈希值
+        bool insert_hash(size_type hash) noexcept {
+            if (block_count_ == 0)
+                return true;
+            const uint64_t h = hash_mix(static_cast<uint64_t>(hash));
+            bf_block& block = blocks_[block_index(h)];
+            uint64_t mask[8];
+            make_mask(static_cast<uint32_t>(h), mask);
+            for (size_type i = 0; i < 8; ++i)
+                block.words[i] |= mask[i];
+            ++size_;
+            return true;
+        }
+
+        void clear() noexcept {
+            if (blocks_ != nullptr)
+                std::memset(static_cast<void*>(blocks_), 0, block_count_ * block_bytes);
+            size_ = 0;
+        }
+
+        // 清空，并按新的设计容量重新分配
+        void reset(size_type capacity) {
+            THROW_LENGTH_ERROR_IF(capacity > max_size() / bits_per_key_, "bloom_filter's size too big");
+            bf_block* old_raw = raw_;
+            const size_type old_count = block_count_;
+            allocate((capacity * bits_per_key_ + block_bits - 1) / block_bits);
+            if (old_raw != nullptr)
+                alloc_.deallocate(old_raw, old_count + 1);
+            capacity_ = capacity;
+            size_ = 0;
+        }
+
+        void swap(bloom_filter& rhs) noexcept {
+            ccystl::swap(raw_, rhs.raw_);
+            ccystl::swap(blocks_, rhs.blocks_);
+            ccystl::swap(block_count_, rhs.block_count_);
+            ccystl::swap(capacity_, rhs.capacity_);
+            ccystl::swap(size_, rhs.size_);
+            ccystl::swap(bits_per_key_, rhs.bits_per_key_);
+            ccystl::swap(hash_, rhs.hash_);
+            ccystl::swap(alloc_, rhs.alloc_);
+        }
+
+        // 查询相关
+
+        // 返回 false 时键值一定不在集合中，返回 true 时可能在
+        bool contains(const key_type& key) const {
+            return contains_hash(static_cast<size_type>(hash_(key)));
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash> = 0>
+        bool contains(const K& key) const {
+            return contains_hash(static_cast<size_type>(hash_(key)));
+        }
+
+        bool contains_hash(size_type hash) const noexcept {
+            if (block_count_ == 0)
+                return false;
+            const uint64_t h = hash_mix(static_cast<uint64_t>(hash));
+            const bf_block& block = blocks_[block_index(h)];
+            uint64_t mask[8];
+            make_mask(static_cast<uint32_t>(h), mask);
+            uint64_t miss = 0;
+            for (size_type i = 0; i < 8; ++i)
+                miss |= mask[i] & ~block.words[i];
+            return miss == 0;
+        }
+
+        // 按各块的填充程度估计当前的假阳性率
+        double estimated_false_positive_rate() const noexcept {
+            if (block_count_ == 0)
+                return 0.0;
+            double total = 0.0;
+            for (size_type b = 0; b < block_count_; ++b) {
+                double p = 1.0;
+                for (size_type i = 0; i < 8; ++i)
+                    p *= static_cast<double>(std::popcount(blocks_[b].words[i])) / 64.0;
+                total += p;
+            }
+            return total / static_cast<double>(block_count_);
+        }
+
+        // 容量相关
+
+        bool      empty()       const noexcept { return size_ == 0; }
+        size_type size()        const noexcept { return size_; }
+        size_type capacity()    const noexcept { return capacity_; }
+        size_type block_count() const noexcept { return block_count_; }
+        size_type byte_size()   const noexcept { return block_count_ * block_bytes; }
+        size_type max_size()    const noexcept { return static_cast<size_type>(-1) / block_bits; }
+
+        hasher    hash_function() const { return hash_; }
+
+        allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+    private:
+        // helper functions
+
+        // 以乘法移位把哈希值的高 32 位映射到 [0, block_count_)
+        size_type block_index(uint64_t h) const noexcept {
+            return static_cast<size_type>(((h >> 32) * static_cast<uint64_t>(block_count_)) >> 32);
+        }
+
+        // 块内 8 个字各自要置的位
+        static void make_mask(uint32_t x, uint64_t* mask) noexcept {
+            constexpr uint32_t salt[8] = {
+                0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+            };
+            for (size_type i = 0; i < 8; ++i)
+                mask[i] = uint64_t(1) << ((x * salt[i]) >> 26);
+        }
+
+        void allocate(size_type n) {
+            if (n == 0)
+                n = 1;
+            THROW_LENGTH_ERROR_IF(n > UINT32_MAX, "bloom_filter's size too big");
+            raw_ = alloc_.allocate(n + 1);
+            const uintptr_t p = reinterpret_cast<uintptr_t>(raw_);
+            blocks_ = reinterpret_cast<bf_block*>((p + block_bytes - 1) & ~static_cast<uintptr_t>(block_bytes - 1));
+            block_count_ = n;
+            std::memset(static_cast<void*>(blocks_), 0, n * block_bytes);
+        }
+
+        void deallocate() noexcept {
+            if (raw_ != nullptr)
+                alloc_.deallocate(raw_, block_count_ + 1);
+            raw_ = nullptr;
+            blocks_ = nullptr;
+            block_count_ = 0;
+        }
+    };
+
+    // 重载 ccystl 的 swap
+    template <class Key, class Hash, class Alloc>
+    void swap(bloom_filter<Key, Hash, Alloc>& lhs, bloom_filter<Key, Hash, Alloc>& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+} // namespace ccystl
+#endif // !CCYSTL_BLOOM_FILTER_H_
@@ -0,0 +1,792 @@
+#ifndef CCYSTL_CONCURRENT_UNORDERED_MAP_H_
+#define CCYSTL_CONCURRENT_UNORDERED_MAP_H_
+
+// 这个头文件包含模板类 concurrent_unordered_map
+// 可被多个线程同时读写的哈希表，键值不允许重复
+//
+// 设计：
+//   * 表格分为若干分段（segment），哈希值的高位选择分段，低位选择分段内的 bucket，
+//     每个分段有自己的 bucket 数组、元素计数与一把互斥锁
+//   * 写操作只锁住键值所在的分段，不同分段上的写操作互不阻塞
+//   * 读操作不加锁：bucket 与节点的 next 指针都是原子变量，节点一经发布其元素便不再修改，
+//     更新元素时以新节点整体替换旧节点，读者要么看到旧节点，要么看到新节点
+//   * 被摘下的节点与旧 bucket 数组交给 epoch_manager 延迟释放，保证没有读者还持有它们
+//   * 分段内元素个数超过 bucket 数时，bucket 数组翻倍，节点复制到新数组后整体发布
+//
+// notes:
+//
+// 与 unordered_map 的区别：
+//   * 没有迭代器，也不返回元素的引用：其他线程随时可能修改或删除该元素
+//   * 查找把元素复制出来（find），或在读者临界区内把元素交给回调函数（visit）
+//   * 插入或更新（insert_or_assign）、按需计算（compute_if_absent）、原子修改（update）
+//     都在分段锁内一次完成，不存在先查后写的竞争
+//   * 更新与扩容会复制节点，要求 value_type 可以复制构造
+//   * for_each、size 只反映调用期间某个时刻附近的状态（弱一致）
+//
+// 异常保证：
+// 写操作在修改表格前完成所有可能抛出异常的步骤（分配节点、构造元素、复制旧节点），
+// 因此对 try_emplace、insert、insert_or_assign、compute_if_absent、update 都做强异常安全保证
+
+#include <atomic>
+#include <mutex>
+
+#include "ccystl/allocator/allocator.h"
+#include "ccystl/allocator/memory.h"
+#include "ccystl/container/sequence_container/vector.h"
+#include "ccystl/functor/functional.h"
+#include "ccystl/internal/epoch_manager.h"
+#include "ccystl/internal/hash_table.h"
+#include "ccystl/internal/hashtable_stats.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+
+    // 模板类 concurrent_unordered_map，键值不允许重复
+    // 参数一代表键值类型，参数二代表实值类型，参数三代表哈希函数，缺省使用 ccystl::hash
+    // 参数四代表键值比较方式，缺省使用 ccystl::equal_to
+    // 参数五代表分配器类型，缺省使用 ccystl::allocator
+    template <class Key, class T, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>,
+              class Alloc = ccystl::allocator<ccystl::pair<const Key, T>>>
+    class concurrent_unordered_map {
+    public:
+        typedef Alloc                                    allocator_type;
+        typedef Key                                      key_type;
+        typedef T                                        mapped_type;
+        typedef ccystl::pair<const Key, T>               value_type;
+        typedef Hash                                     hasher;
+        typedef KeyEqual                                 key_equal;
+
+        typedef size_t                                   size_type;
+        typedef ptrdiff_t                                difference_type;
+
+    private:
+        // 节点：next 供读者无锁遍历，hash 为混合后的哈希值，发布后 value 不再修改
+        struct node_type {
+            std::atomic<node_type*> next;
+            size_type               hash;
+            value_type              value;
+        };
+        typedef node_type*                               node_ptr;
+        typedef std::atomic<node_ptr>                    bucket_type;
+
+        // bucket 数组，扩容时整体替换
+        struct table_type {
+            size_type    count;   // bucket 数，2 的幂次
+            bucket_type* buckets;
+        };
+
+        // 等待释放的节点与 bucket 数组，epoch 为摘下时的全局 epoch
+        struct retired_node {
+            node_ptr node;
+            uint64_t epoch;
+        };
+        struct retired_table {
+            table_type* table;
+            uint64_t    epoch;
+        };
+
+        typedef typename Alloc::template rebind<value_type>::other    data_allocator;
+        typedef typename Alloc::template rebind<node_type>::other     node_allocator;
+        typedef typename Alloc::template rebind<table_type>::other    table_allocator;
+        typedef typename Alloc::template rebind<bucket_type>::other   bucket_allocator;
+        typedef typename Alloc::template rebind<retired_node>::other  retired_node_allocator;
+        typedef typename Alloc::template rebind<retired_table>::other retired_table_allocator;
+
+        struct segment {
+            std::mutex                                                 mutex;
+            std::atomic<table_type*>                                   table{nullptr};
+            std::atomic<size_type>                                     size{0};
+            ccystl::vector<retired_node, retired_node_allocator>       retired_nodes;
+            ccystl::vector<retired_table, retired_table_allocator>     retired_tables;
+            [[no_unique_address]] ht_stats_recorder<>                  stats;  // 扩容的历史记录，在分段锁内更新
+            char padding[64];  // 避免相邻分段的锁落在同一缓存行
+
+            explicit segment(const allocator_type& alloc)
+                :retired_nodes(retired_node_allocator(alloc)),
+                 retired_tables(retired_table_allocator(alloc)) {
+            }
+        };
+        typedef typename Alloc::template rebind<segment>::other       segment_allocator;
+
+        // 分段内 bucket 数组的初始大小
+        static constexpr size_type initial_bucket_count = 8;
+        // 分段内等待释放的节点每增加这么多个就尝试回收一次
+        static constexpr size_type reclaim_threshold = 64;
+        // 分段数的上限
+        static constexpr size_type max_segment_count = size_type(1) << 16;
+
+    private:
+        segment*                             segments_;
+        size_type                            segment_count_;
+        size_type                            segment_shift_;
+        size_type                            segment_mask_;
+        [[no_unique_address]] hasher         hash_;
+        [[no_unique_address]] key_equal      equal_;
+        [[no_unique_address]] node_allocator node_alloc_;
+
+    public:
+        allocator_type get_allocator() const { return allocator_type(node_alloc_); }
+
+    public:
+        // 构造、析构函数
+        // concurrency 为期望的并发写线程数，分段数取不小于它的 2 的幂次
+
+        concurrent_unordered_map()
+            :concurrent_unordered_map(64) {
+        }
+
+        explicit concurrent_unordered_map(size_type concurrency,
+            const Hash& hash = Hash(),
+            const KeyEqual& equal = KeyEqual(),
+            const allocator_type& alloc = allocator_type())
+            :segments_(nullptr), segment_count_(0), segment_shift_(0), segment_mask_(0),
+             hash_(hash), equal_(equal), node_alloc_(alloc) {
+            init_segments(concurrency);
+        }
+
+        explicit concurrent_unordered_map(const allocator_type& alloc)
+            :concurrent_unordered_map(64, Hash(), KeyEqual(), alloc) {
+        }
+
+        // 其他线程可能正在访问，不提供复制与移动
+        concurrent_unordered_map(const concurrent_unordered_map&) = delete;
+        concurrent_unordered_map& operator=(const concurrent_unordered_map&) = delete;
+
+        // 析构时不能再有其他线程访问该容器
+        ~concurrent_unordered_map() {
+            destroy_segments();
+        }
+
+        // 容量相关
+
+        bool      empty()    const noexcept { return size() == 0; }
+        size_type size()     const noexcept {
+            size_type n = 0;
+            for (size_type i = 0; i < segment_count_; ++i)
+                n += segments_[i].size.load(std::memory_order_relaxed);
+            return n;
+        }
+
+        size_type segment_count() const noexcept { return segment_count_; }
+
+        // 预留至少能容纳 count 个元素的 bucket
+        void      reserve(size_type count);
+
+        // 读操作，不加锁
+
+        bool contains(const key_type& key) const {
+            const size_type code = hash_code(key);
+            epoch_guard guard;
+            return find_node(code, key) != nullptr;
+        }
+
+        // 找到时把实值复制到 value
+        bool find(const key_type& key, mapped_type& value) const {
+            const size_type code = hash_code(key);
+            epoch_guard guard;
+            const node_type* np = find_node(code, key);
+            if (np == nullptr)
+                return false;
+            value = np->value.second;
+            return true;
+        }
+
+        // 找到时以 const value_type& 调用 f，f 返回后元素可能随即被释放，不要保存它的地址
+        template <class Function>
+        bool visit(const key_type& key, Function f) const {
+            const size_type code = hash_code(key);
+            epoch_guard guard;
+            const node_type* np = find_node(code, key);
+            if (np == nullptr)
+                return false;
+            f(np->value);
+            return true;
+        }
+
+        // 以 const value_type& 依次调用 f，遍历期间其他线程的修改可能看到也可能看不到
+        template <class Function>
+        void for_each(Function f) const {
+            epoch_guard guard;
+            for (size_type i = 0; i < segment_count_; ++i) {
+                const table_type* t = segments_[i].table.load();
+                if (t == nullptr)
+                    continue;
+                for (size_type n = 0; n < t->count; ++n) {
+                    for (const node_type* np = t->buckets[n].load(); np != nullptr; np = np->next.load())
+                        f(np->value);
+                }
+            }
+        }
+
+        // 写操作，只锁住键值所在的分段
+
+        // 键值不存在时以 key 与 mapped_type(args...) 构造元素，返回是否插入
+        template <class ...Args>
+        bool try_emplace(const key_type& key, Args&& ...args);
+
+        bool insert(const value_type& value) {
+            return try_emplace(value.first, value.second);
+        }
+
+        // 键值不存在时插入，存在时以 obj 替换其实值，返回是否插入
+        template <class M>
+        bool insert_or_assign(const key_type& key, M&& obj);
+
+        // 键值不存在时以 f() 的结果插入，返回键值对应的实值
+        // 同一键值的 f 最多被调用一次，调用期间持有分段锁，f 中不能再访问本容器
+        template <class Function>
+        mapped_type compute_if_absent(const key_type& key, Function f);
+
+        // 键值存在时以 f(mapped_type&) 修改实值的一个副本，再以副本替换原元素，返回键值是否存在
+        // 调用期间持有分段锁，f 中不能再访问本容器
+        template <class Function>
+        bool update(const key_type& key, Function f);
+
+        size_type erase(const key_type& key);
+
+        void clear();
+
+        // 统计信息，见 hashtable_stats.h
+        // 依次锁住各分段统计，结果不是整个容器在同一时刻的快照；bucket 数为各分段之和，
+        // 不含等待回收的节点，rehash 的历史记录按分段依次排列
+        hashtable_stats stats() const;
+        void            reset_stats();
+
+        hasher    hash_function() const { return hash_; }
+        key_equal key_eq()        const { return equal_; }
+
+    private:
+        size_type hash_code(const key_type& key) const {
+            return ht_mix(hash_(key));
+        }
+
+        const segment& segment_of(size_type code) const noexcept {
+            return segments_[(code >> segment_shift_) & segment_mask_];
+        }
+        segment& segment_of(size_type code) noexcept {
+            return segments_[(code >> segment_shift_) & segment_mask_];
+        }
+
+        static bucket_type& bucket_of(table_type* t, size_type code) noexcept {
+            return t->buckets[code & (t->count - 1)];
+        }
+
+        const node_type* find_node(size_type code, const key_type& key) const;
+        bucket_type* find_link(table_type* t, size_type code, const key_type& key);
+
+        template <class ...Args>
+        node_ptr create_node(size_type code, Args&& ...args);
+        void destroy_node(node_ptr np) noexcept;
+        table_type* create_table(size_type count);
+        void destroy_table(table_type* t) noexcept;
+        void destroy_chains(table_type* t) noexcept;
+
+        table_type* prepare_insert(segment& seg);
+        table_type* grow(segment& seg, table_type* t, size_type count);
+        void link_front(table_type* t, node_ptr np) noexcept;
+        void reserve_retired(segment& seg, size_type n);
+        void replace_node(segment& seg, bucket_type* link, node_ptr np) noexcept;
+        void retire_node(segment& seg, node_ptr np) noexcept;
+        void reclaim(segment& seg) noexcept;
+
+        void init_segments(size_type concurrency);
+        void destroy_segments() noexcept;
+    };
+
+    /*****************************************************************************************/
+
+    // reserve 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    reserve(size_type count) {
+        const size_type per_segment = ht_power2_policy::next_size(count / segment_count_ + 1);
+        for (size_type i = 0; i < segment_count_; ++i) {
+            segment& seg = segments_[i];
+            std::lock_guard<std::mutex> lock(seg.mutex);
+            table_type* t = seg.table.load(std::memory_order_relaxed);
+            if (t == nullptr)
+                seg.table.store(create_table(per_segment));
+            else if (t->count < per_segment)
+                grow(seg, t, per_segment);
+        }
+    }
+
+    // stats 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    hashtable_stats concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    stats() const {
+        hashtable_stats s;
+        s.max_load_factor = 1.0f;
+        size_type used = 0;
+        for (size_type i = 0; i < segment_count_; ++i) {
+            segment& seg = segments_[i];
+            std::lock_guard<std::mutex> lock(seg.mutex);
+            const table_type* t = seg.table.load(std::memory_order_relaxed);
+            if (t != nullptr) {
+                for (size_type n = 0; n < t->count; ++n) {
+                    size_type len = 0;
+                    for (const node_type* np = t->buckets[n].load(std::memory_order_relaxed); np != nullptr;
+                         np = np->next.load(std::memory_order_relaxed))
+                        ++len;
+                    s.add_chain(len);
+                    used += len != 0;
+                    s.size += len;
+                }
+                s.bucket_count += t->count;
+                s.bucket_bytes += sizeof(table_type) + t->count * sizeof(bucket_type);
+            }
+            hashtable_stats h;
+            seg.stats.fill(h);
+            s.rehash_count += h.rehash_count;
+            s.rehash_nanoseconds += h.rehash_nanoseconds;
+            s.peak_load_factor = ccystl::max(s.peak_load_factor, h.peak_load_factor);
+            for (size_type k = 0; k < h.history_size && s.history_size < ht_stats_history_size; ++k)
+                s.history[s.history_size++] = h.history[k];
+        }
+        s.load_factor = s.bucket_count != 0 ? static_cast<float>(s.size) / static_cast<float>(s.bucket_count) : 0.0f;
+        if (s.rehash_count != 0)
+            s.peak_load_factor = ccystl::max(s.peak_load_factor, s.load_factor);
+        s.empty_buckets = s.bucket_count - used;
+        s.average_chain_length = used != 0 ? static_cast<double>(s.size) / static_cast<double>(used) : 0.0;
+        s.node_bytes = s.size * sizeof(node_type);
+        return s;
+    }
+
+    // reset_stats 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    reset_stats() {
+        for (size_type i = 0; i < segment_count_; ++i) {
+            std::lock_guard<std::mutex> lock(segments_[i].mutex);
+            segments_[i].stats.reset();
+        }
+    }
+
+    // try_emplace 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    template <class ...Args>
+    bool concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    try_emplace(const key_type& key, Args&& ...args) {
+        const size_type code = hash_code(key);
+        segment& seg = segment_of(code);
+        std::lock_guard<std::mutex> lock(seg.mutex);
+        table_type* t = seg.table.load(std::memory_order_relaxed);
+        if (t != nullptr && find_link(t, code, key) != nullptr)
+            return false;
+        node_ptr np = create_node(code, key, mapped_type(ccystl::forward<Args>(args)...));
+        try {
+            t = prepare_insert(seg);
+        }
+        catch (...) {
+            destroy_node(np);
+            throw;
+        }
+        link_front(t, np);
+        seg.size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // insert_or_assign 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    template <class M>
+    bool concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    insert_or_assign(const key_type& key, M&& obj) {
+        const size_type code = hash_code(key);
+        segment& seg = segment_of(code);
+        std::lock_guard<std::mutex> lock(seg.mutex);
+        table_type* t = seg.table.load(std::memory_order_relaxed);
+        bucket_type* link = t == nullptr ? nullptr : find_link(t, code, key);
+        node_ptr np = create_node(code, key, ccystl::forward<M>(obj));
+        if (link != nullptr) {
+            try {
+                reserve_retired(seg, 1);
+            }
+            catch (...) {
+                destroy_node(np);
+                throw;
+            }
+            replace_node(seg, link, np);
+            return false;
+        }
+        try {
+            t = prepare_insert(seg);
+        }
+        catch (...) {
+            destroy_node(np);
+            throw;
+        }
+        link_front(t, np);
+        seg.size.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // compute_if_absent 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    template <class Function>
+    typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::mapped_type
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    compute_if_absent(const key_type& key, Function f) {
+        const size_type code = hash_code(key);
+        segment& seg = segment_of(code);
+        std::lock_guard<std::mutex> lock(seg.mutex);
+        table_type* t = seg.table.load(std::memory_order_relaxed);
+        if (t != nullptr) {
+            if (bucket_type* link = find_link(t, code, key))
+                return link->load(std::memory_order_relaxed)->value.second;
+        }
+        node_ptr np = create_node(code, key, f());
+        try {
+            t = prepare_insert(seg);
+        }
+        catch (...) {
+            destroy_node(np);
+            throw;
+        }
+        link_front(t, np);
+        seg.size.fetch_add(1, std::memory_order_relaxed);
+        return np->value.second;
+    }
+
+    // update 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    template <class Function>
+    bool concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    update(const key_type& key, Function f) {
+        const size_type code = hash_code(key);
+        segment& seg = segment_of(code);
+        std::lock_guard<std::mutex> lock(seg.mutex);
+        table_type* t = seg.table.load(std::memory_order_relaxed);
+        bucket_type* link = t == nullptr ? nullptr : find_link(t, code, key);
+        if (link == nullptr)
+            return false;
+        node_ptr np = create_node(code, link->load(std::memory_order_relaxed)->value);
+        try {
+            f(np->value.second);
+            reserve_retired(seg, 1);
+        }
+        catch (...) {
+            destroy_node(np);
+            throw;
+        }
+        replace_node(seg, link, np);
+        return true;
+    }
+
+    // erase 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::size_type
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    erase(const key_type& key) {
+        const size_type code = hash_code(key);
+        segment& seg = segment_of(code);
+        std::lock_guard<std::mutex> lock(seg.mutex);
+        table_type* t = seg.table.load(std::memory_order_relaxed);
+        bucket_type* link = t == nullptr ? nullptr : find_link(t, code, key);
+        if (link == nullptr)
+            return 0;
+        reserve_retired(seg, 1);
+        node_ptr np = link->load(std::memory_order_relaxed);
+        link->store(np->next.load(std::memory_order_relaxed));
+        seg.size.fetch_sub(1, std::memory_order_relaxed);
+        retire_node(seg, np);
+        return 1;
+    }
+
+    // clear 函数
+    // 逐个分段摘下整个 bucket 数组，其中的节点与数组一起延迟释放
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    clear() {
+        for (size_type i = 0; i < segment_count_; ++i) {
+            segment& seg = segments_[i];
+            std::lock_guard<std::mutex> lock(seg.mutex);
+            table_type* t = seg.table.load(std::memory_order_relaxed);
+            if (t == nullptr)
+                continue;
+            reserve_retired(seg, seg.size.load(std::memory_order_relaxed));
+            seg.retired_tables.reserve(seg.retired_tables.size() + 1);
+            seg.table.store(nullptr);
+            seg.size.store(0, std::memory_order_relaxed);
+            const uint64_t e = epoch_manager::instance().epoch();
+            for (size_type n = 0; n < t->count; ++n) {
+                for (node_ptr np = t->buckets[n].load(std::memory_order_relaxed); np != nullptr;
+                     np = np->next.load(std::memory_order_relaxed))
+                    seg.retired_nodes.push_back(retired_node{np, e});
+            }
+            seg.retired_tables.push_back(retired_table{t, e});
+            reclaim(seg);
+        }
+    }
+
+    /*****************************************************************************************/
+    // helper function
+
+    // 读者在临界区内沿链表查找，节点与 bucket 数组在临界区结束前不会被释放
+    // 读者的载入都使用 seq_cst，与 epoch_manager 对全局 epoch 的读写处于同一全序中
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    const typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::node_type*
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    find_node(size_type code, const key_type& key) const {
+        const table_type* t = segment_of(code).table.load();
+        if (t == nullptr)
+            return nullptr;
+        for (const node_type* np = t->buckets[code & (t->count - 1)].load(); np != nullptr;
+             np = np->next.load()) {
+            if (np->hash == code && equal_(np->value.first, key))
+                return np;
+        }
+        return nullptr;
+    }
+
+    // 持有分段锁时查找，返回指向目标节点的那个原子指针（bucket 或前驱的 next），找不到返回 nullptr
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::bucket_type*
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    find_link(table_type* t, size_type code, const key_type& key) {
+        bucket_type* link = &bucket_of(t, code);
+        for (node_ptr np = link->load(std::memory_order_relaxed); np != nullptr;
+             np = link->load(std::memory_order_relaxed)) {
+            if (np->hash == code && equal_(np->value.first, key))
+                return link;
+            link = &np->next;
+        }
+        return nullptr;
+    }
+
+    // create_node 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    template <class ...Args>
+    typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::node_ptr
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    create_node(size_type code, Args&& ...args) {
+        node_ptr np = node_alloc_.allocate(1);
+        try {
+            data_allocator(node_alloc_).construct(ccystl::address_of(np->value), ccystl::forward<Args>(args)...);
+        }
+        catch (...) {
+            node_alloc_.deallocate(np);
+            throw;
+        }
+        ccystl::construct(ccystl::address_of(np->next), nullptr);
+        np->hash = code;
+        return np;
+    }
+
+    // destroy_node 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    destroy_node(node_ptr np) noexcept {
+        data_allocator(node_alloc_).destroy(ccystl::address_of(np->value));
+        node_alloc_.deallocate(np);
+    }
+
+    // create_table 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::table_type*
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    create_table(size_type count) {
+        table_allocator table_alloc(node_alloc_);
+        bucket_allocator bucket_alloc(node_alloc_);
+        table_type* t = table_alloc.allocate(1);
+        try {
+            t->buckets = bucket_alloc.allocate(count);
+        }
+        catch (...) {
+            table_alloc.deallocate(t);
+            throw;
+        }
+        t->count = count;
+        for (size_type n = 0; n < count; ++n)
+            ccystl::construct(t->buckets + n, nullptr);
+        return t;
+    }
+
+    // destroy_table 函数，只释放 bucket 数组本身
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    destroy_table(table_type* t) noexcept {
+        bucket_allocator(node_alloc_).deallocate(t->buckets, t->count);
+        table_allocator(node_alloc_).deallocate(t);
+    }
+
+    // 释放 bucket 数组中的所有节点
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    destroy_chains(table_type* t) noexcept {
+        for (size_type n = 0; n < t->count; ++n) {
+            node_ptr np = t->buckets[n].load(std::memory_order_relaxed);
+            while (np != nullptr) {
+                node_ptr next = np->next.load(std::memory_order_relaxed);
+                destroy_node(np);
+                np = next;
+            }
+        }
+    }
+
+    // 插入新节点前调用，返回可以直接插入的 bucket 数组
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::table_type*
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    prepare_insert(segment& seg) {
+        table_type* t = seg.table.load(std::memory_order_relaxed);
+        if (t == nullptr) {
+            t = create_table(initial_bucket_count);
+            seg.table.store(t);
+            return t;
+        }
+        if (seg.size.load(std::memory_order_relaxed) + 1 > t->count)
+            t = grow(seg, t, t->count * 2);
+        return t;
+    }
+
+    // 把分段扩容到 count 个 bucket
+    // 旧链表可能正被读者遍历，不能原地改动，因此把节点复制到新数组后一次发布，旧节点与旧数组延迟释放
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    typename concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::table_type*
+    concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    grow(segment& seg, table_type* t, size_type count) {
+        seg.stats.record_rehash(seg.size.load(std::memory_order_relaxed), t->count, count);
+        typename ht_stats_recorder<>::timer timer(seg.stats);
+        reserve_retired(seg, seg.size.load(std::memory_order_relaxed));
+        seg.retired_tables.reserve(seg.retired_tables.size() + 1);
+        table_type* nt = create_table(count);
+        try {
+            for (size_type n = 0; n < t->count; ++n) {
+                for (node_ptr np = t->buckets[n].load(std::memory_order_relaxed); np != nullptr;
+                     np = np->next.load(std::memory_order_relaxed))
+                    link_front(nt, create_node(np->hash, np->value));
+            }
+        }
+        catch (...) {
+            destroy_chains(nt);
+            destroy_table(nt);
+            throw;
+        }
+        seg.table.store(nt);
+        const uint64_t e = epoch_manager::instance().epoch();
+        for (size_type n = 0; n < t->count; ++n) {
+            for (node_ptr np = t->buckets[n].load(std::memory_order_relaxed); np != nullptr;
+                 np = np->next.load(std::memory_order_relaxed))
+                seg.retired_nodes.push_back(retired_node{np, e});
+        }
+        seg.retired_tables.push_back(retired_table{t, e});
+        reclaim(seg);
+        return nt;
+    }
+
+    // 把节点挂到 bucket 的链表头部，节点的内容在发布前已全部写好
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    link_front(table_type* t, node_ptr np) noexcept {
+        bucket_type& bucket = bucket_of(t, np->hash);
+        np->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.store(np);
+    }
+
+    // 在修改表格之前为 n 个待释放节点预留空间，之后记录它们时不会再抛出异常
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    reserve_retired(segment& seg, size_type n) {
+        const size_type need = seg.retired_nodes.size() + n;
+        if (need > seg.retired_nodes.capacity())
+            seg.retired_nodes.reserve(ccystl::max(need, seg.retired_nodes.capacity() * 2));
+    }
+
+    // 以 np 替换 link 指向的节点，正在旧节点上的读者仍能沿它的 next 继续遍历
+    // 调用前需保证 retired_nodes 还有一个空位
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    replace_node(segment& seg, bucket_type* link, node_ptr np) noexcept {
+        node_ptr old = link->load(std::memory_order_relaxed);
+        np->next.store(old->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        link->store(np);
+        retire_node(seg, old);
+    }
+
+    // 记录已摘下的节点，调用前需保证 retired_nodes 还有一个空位
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    retire_node(segment& seg, node_ptr np) noexcept {
+        seg.retired_nodes.push_back(retired_node{np, epoch_manager::instance().epoch()});
+        if (seg.retired_nodes.size() % reclaim_threshold == 0)
+            reclaim(seg);
+    }
+
+    // 推进全局 epoch，释放已经没有读者能够看到的节点与 bucket 数组
+    // 两个列表都按 epoch 递增排列，只需释放前缀
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    reclaim(segment& seg) noexcept {
+        const uint64_t now = epoch_manager::instance().try_advance();
+        size_type n = 0;
+        while (n < seg.retired_nodes.size() && epoch_manager::can_reclaim(seg.retired_nodes[n].epoch, now))
+            destroy_node(seg.retired_nodes[n++].node);
+        if (n != 0)
+            seg.retired_nodes.erase(seg.retired_nodes.begin(), seg.retired_nodes.begin() + n);
+        n = 0;
+        while (n < seg.retired_tables.size() && epoch_manager::can_reclaim(seg.retired_tables[n].epoch, now))
+            destroy_table(seg.retired_tables[n++].table);
+        if (n != 0)
+            seg.retired_tables.erase(seg.retired_tables.begin(), seg.retired_tables.begin() + n);
+    }
+
+    // init_segments 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    init_segments(size_type concurrency) {
+        size_type count = 1;
+        size_type bits = 0;
+        while (count < concurrency && count < max_segment_count) {
+            count <<= 1;
+            ++bits;
+        }
+        segment_allocator seg_alloc(node_alloc_);
+        segments_ = seg_alloc.allocate(count);
+        size_type n = 0;
+        try {
+            for (; n < count; ++n)
+                ccystl::construct(segments_ + n, get_allocator());
+        }
+        catch (...) {
+            ccystl::destroy(segments_, segments_ + n);
+            seg_alloc.deallocate(segments_, count);
+            segments_ = nullptr;
+            throw;
+        }
+        segment_count_ = count;
+        // 分段取混合后哈希值的最高几位，bucket 取最低几位，两者互不相关
+        segment_shift_ = bits == 0 ? 0 : sizeof(size_type) * 8 - bits;
+        segment_mask_ = count - 1;
+    }
+
+    // destroy_segments 函数
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void concurrent_unordered_map<Key, T, Hash, KeyEqual, Alloc>::
+    destroy_segments() noexcept {
+        if (segments_ == nullptr)
+            return;
+        for (size_type i = 0; i < segment_count_; ++i) {
+            segment& seg = segments_[i];
+            if (table_type* t = seg.table.load(std::memory_order_relaxed)) {
+                destroy_chains(t);
+                destroy_table(t);
+            }
+            for (auto& r : seg.retired_nodes)
+                destroy_node(r.node);
+            for (auto& r : seg.retired_tables)
+                destroy_table(r.table);
+        }
+        ccystl::destroy(segments_, segments_ + segment_count_);
+        segment_allocator(node_alloc_).deallocate(segments_, segment_count_);
+        segments_ = nullptr;
+    }
+
+    namespace pmr {
+    // 使用多态内存资源的 concurrent_unordered_map
+    template <class Key, class T, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>>
+    using concurrent_unordered_map = ccystl::concurrent_unordered_map<Key, T, Hash, KeyEqual,
+                                                                      polymorphic_allocator<ccystl::pair<const Key, T>>>;
+    } // namespace pmr
+
+} // namespace ccystl
+#endif // !CCYSTL_CONCURRENT_UNORDERED_MAP_H_
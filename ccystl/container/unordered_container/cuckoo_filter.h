@@ -0,0 +1,343 @@
+#ifndef CCYSTL_CUCKOO_FILTER_H_
+#define CCYSTL_CUCKOO_FILTER_H_
+
+// 这个头文件包含模板类 cuckoo_filter
+// 布谷鸟过滤器（cuckoo filter），判断一个键值“一定不在”或“可能在”集合中，与布隆过滤器不同的是支持删除
+//
+// 设计：
+//   * 每个 bucket 是一个 64 位字，存放 4 个 16 位指纹，0 表示空位
+//   * 键值的哈希值决定第一个 bucket i1 与指纹 fp，另一个 bucket 为 i2 = i1 ^ hash(fp)，
+//     由 i2 与 fp 同样可以算回 i1，因此搬移指纹时不需要原来的键值
+//   * 查询只检查 i1、i2 两个 bucket，用 SWAR 方法一次比较一个 bucket 中的 4 个指纹
+//   * 两个 bucket 都满时随机踢出一个指纹，把它搬到它的另一个 bucket，最多踢 max_kicks 次，
+//     仍失败时把最后一个指纹放在 victim 槽中，此后的插入都返回 false，需要换更大的过滤器
+//   * 装载率约 95% 以内插入基本不会失败，假阳性率约 8 / 2^16 ≈ 0.012%
+//
+// notes:
+//
+// 只能删除确实插入过的键值，删除一个从未插入的键值可能删掉其他键值的指纹，造成漏报
+// 同一个键值插入 k 次就占 k 个位置，同一对 bucket 最多容纳 8 个相同的指纹
+// 哈希值先经 hash_mix 打散，因此可以直接使用恒等映射的整数哈希函数
+
+#include <cstdint>
+#include <cstring>
+
+#include "ccystl/allocator/allocator.h"
+#include "ccystl/functor/functional.h"
+#include "ccystl/utils/except_def.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+
+    // 模板类 cuckoo_filter
+    // 参数一代表键值类型，参数二代表哈希函数，缺省使用 ccystl::hash，参数三代表分配器类型
+    template <class Key, class Hash = ccystl::hash<Key>, class Alloc = ccystl::allocator<Key>>
+    class cuckoo_filter {
+    public:
+        typedef Key                                      key_type;
+        typedef Hash                                     hasher;
+        typedef Alloc                                    allocator_type;
+        typedef size_t                                   size_type;
+
+        static constexpr size_type slots_per_bucket = 4;
+        static constexpr size_type max_kicks = 500;
+        static constexpr bool      supports_erase = true; // 见 filtered_hash_container
+
+    private:
+        typedef typename Alloc::template rebind<uint64_t>::other bucket_allocator;
+
+        static constexpr uint64_t lane_low = 0x0001000100010001ULL;
+        static constexpr uint64_t lane_high = 0x8000800080008000ULL;
+
+        uint64_t*   buckets_ = nullptr;
+        size_type   bucket_count_ = 0;      // 2 的幂次
+        size_type   capacity_ = 0;          // 设计容量
+        size_type   size_ = 0;              // 存放的指纹个数，包括 victim
+        uint64_t    rng_ = 0x9e3779b97f4a7c15ULL;
+        size_type   victim_index_ = 0;
+        uint16_t    victim_fp_ = 0;         // 非零表示 victim 槽被占用
+        [[no_unique_address]] hasher           hash_;
+        [[no_unique_address]] bucket_allocator alloc_;
+
+    public:
+        // 构造、复制、移动、析构函数
+
+        // 至少分配一个 bucket，只有被移动后的过滤器没有 bucket
+        cuckoo_filter()
+            :cuckoo_filter(0) {
+        }
+
+        // capacity 为预计插入的键值个数
+        explicit cuckoo_filter(size_type capacity,
+            const Hash& hash = Hash(),
+            const allocator_type& alloc = allocator_type())
+            :hash_(hash), alloc_(alloc) {
+            reset(capacity);
+        }
+
+        cuckoo_filter(const cuckoo_filter& rhs)
+            :capacity_(rhs.capacity_), size_(rhs.size_), rng_(rhs.rng_),
+             victim_index_(rhs.victim_index_), victim_fp_(rhs.victim_fp_),
+             hash_(rhs.hash_), alloc_(rhs.alloc_) {
+            allocate(rhs.bucket_count_);
+            std::memcpy(buckets_, rhs.buckets_, rhs.bucket_count_ * sizeof(uint64_t));
+        }
+
+        cuckoo_filter(cuckoo_filter&& rhs) noexcept
+            :buckets_(rhs.buckets_), bucket_count_(rhs.bucket_count_), capacity_(rhs.capacity_),
+             size_(rhs.size_), rng_(rhs.rng_), victim_index_(rhs.victim_index_),
+             victim_fp_(rhs.victim_fp_), hash_(rhs.hash_), alloc_(rhs.alloc_) {
+            rhs.buckets_ = nullptr;
+            rhs.bucket_count_ = 0;
+            rhs.capacity_ = 0;
+            rhs.size_ = 0;
+            rhs.victim_fp_ = 0;
+        }
+
+        cuckoo_filter& operator=(const cuckoo_filter& rhs) {
+            if (this != &rhs) {
+                cuckoo_filter tmp(rhs);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        cuckoo_filter& operator=(cuckoo_filter&& rhs) noexcept {
+            if (this != &rhs) {
+                cuckoo_filter tmp(ccystl::move(rhs));
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        ~cuckoo_filter() { deallocate(); }
+
+        // 修改相关
+
+        // 插入键值，过滤器已满（victim 槽被占用）时返回 false，不做任何修改
+        bool insert(const key_type& key) {
+            return insert_hash(static_cast<size_type>(hash_(key)));
+        }
+
+        bool insert_hash(size_type hash) noexcept {
+            if (victim_fp_ != 0 || bucket_count_ == 0)
+                return false;
+            const uint64_t h = hash_mix(static_cast<uint64_t>(hash));
+            const uint16_t fp = fingerprint(h);
+            const size_type i1 = static_cast<size_type>(h) & (bucket_count_ - 1);
+            const size_type i2 = alt_index(i1, fp);
+            ++size_;
+            if (put(i1, fp) || put(i2, fp))
+                return true;
+            kick(next_random() & 1 ? i1 : i2, fp);
+            return true;
+        }
+
+        // 删除一个键值的指纹，找不到时返回 false
+        bool erase(const key_type& key) {
+            return erase_hash(static_cast<size_type>(hash_(key)));
+        }
+
+        bool erase_hash(size_type hash) noexcept {
+            if (bucket_count_ == 0)
+                return false;
+            const uint64_t h = hash_mix(static_cast<uint64_t>(hash));
+            const uint16_t fp = fingerprint(h);
+            const size_type i1 = static_cast<size_type>(h) & (bucket_count_ - 1);
+            const size_type i2 = alt_index(i1, fp);
+            if (remove(i1, fp) || remove(i2, fp)) {
+                --size_;
+                // 腾出了位置，把 victim 放回表中
+                if (victim_fp_ != 0) {
+                    const uint16_t vfp = victim_fp_;
+                    victim_fp_ = 0;
+                    kick(victim_index_, vfp);
+                }
+                return true;
+            }
+            if (victim_fp_ == fp && (victim_index_ == i1 || victim_index_ == i2)) {
+                victim_fp_ = 0;
+                --size_;
+                return true;
+            }
+            return false;
+        }
+
+        void clear() noexcept {
+            if (buckets_ != nullptr)
+                std::memset(buckets_, 0, bucket_count_ * sizeof(uint64_t));
+            size_ = 0;
+            victim_fp_ = 0;
+        }
+
+        // 清空，并按新的设计容量重新分配
+        void reset(size_type capacity) {
+            THROW_LENGTH_ERROR_IF(capacity > max_size(), "cuckoo_filter's size too big");
+            // 装载率不超过 95%
+            const size_type slots = capacity + capacity / 19 + 1;
+            size_type n = 1;
+            while (n * slots_per_bucket < slots)
+                n <<= 1;
+            uint64_t* old = buckets_;
+            const size_type old_count = bucket_count_;
+            allocate(n);
+            if (old != nullptr)
+                alloc_.deallocate(old, old_count);
+            capacity_ = capacity;
+            size_ = 0;
+            victim_fp_ = 0;
+        }
+
+        void swap(cuckoo_filter& rhs) noexcept {
+            ccystl::swap(buckets_, rhs.buckets_);
+            ccystl::swap(bucket_count_, rhs.bucket_count_);
+            ccystl::swap(capacity_, rhs.capacity_);
+            ccystl::swap(size_, rhs.size_);
+            ccystl::swap(rng_, rhs.rng_);
+            ccystl::swap(victim_index_, rhs.victim_index_);
+            ccystl::swap(victim_fp_, rhs.victim_fp_);
+            ccystl::swap(hash_, rhs.hash_);
+            ccystl::swap(alloc_, rhs.alloc_);
+        }
+
+        // 查询相关
+
+        // 返回 false 时键值一定不在集合中，返回 true 时可能在
+        bool contains(const key_type& key) const {
+            return contains_hash(static_cast<size_type>(hash_(key)));
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash> = 0>
+        bool contains(const K& key) const {
+            return contains_hash(static_cast<size_type>(hash_(key)));
+        }
+
+        bool contains_hash(size_type hash) const noexcept {
+            if (bucket_count_ == 0)
+                return false;
+            const uint64_t h = hash_mix(static_cast<uint64_t>(hash));
+            const uint16_t fp = fingerprint(h);
+            const size_type i1 = static_cast<size_type>(h) & (bucket_count_ - 1);
+            const size_type i2 = alt_index(i1, fp);
+            const uint64_t pattern = fp * lane_low;
+            return has_zero_lane(buckets_[i1] ^ pattern) || has_zero_lane(buckets_[i2] ^ pattern) ||
+                   (victim_fp_ == fp && (victim_index_ == i1 || victim_index_ == i2));
+        }
+
+        // 容量相关
+
+        bool      empty()        const noexcept { return size_ == 0; }
+        size_type size()         const noexcept { return size_; }
+        // 装载率达到 95% 时的指纹个数，不小于构造时给出的设计容量
+        size_type capacity()     const noexcept { return bucket_count_ * slots_per_bucket * 19 / 20; }
+        size_type bucket_count() const noexcept { return bucket_count_; }
+        size_type byte_size()    const noexcept { return bucket_count_ * sizeof(uint64_t); }
+        size_type max_size()     const noexcept { return static_cast<size_type>(-1) / 16; }
+        bool      full()         const noexcept { return victim_fp_ != 0; }
+
+        float     load_factor()  const noexcept {
+            return bucket_count_ == 0 ? 0.0f
+                : static_cast<float>(size_) / static_cast<float>(bucket_count_ * slots_per_bucket);
+        }
+
+        hasher    hash_function() const { return hash_; }
+
+        allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+    private:
+        // helper functions
+
+        // 取哈希值的 32~47 位作为指纹，0 留作空位标记
+        static uint16_t fingerprint(uint64_t h) noexcept {
+            const uint16_t fp = static_cast<uint16_t>(h >> 32);
+            return fp == 0 ? 1 : fp;
+        }
+
+        size_type alt_index(size_type i, uint16_t fp) const noexcept {
+            return (i ^ static_cast<size_type>(hash_mix(fp))) & (bucket_count_ - 1);
+        }
+
+        // 是否有某个 16 位的通道为 0
+        static bool has_zero_lane(uint64_t x) noexcept {
+            return ((x - lane_low) & ~x & lane_high) != 0;
+        }
+
+        static uint16_t lane(uint64_t word, size_type s) noexcept {
+            return static_cast<uint16_t>(word >> (16 * s));
+        }
+
+        // 放入 bucket i 的空位
+        bool put(size_type i, uint16_t fp) noexcept {
+            uint64_t& word = buckets_[i];
+            if (!has_zero_lane(word))
+                return false;
+            for (size_type s = 0; s < slots_per_bucket; ++s) {
+                if (lane(word, s) == 0) {
+                    word |= static_cast<uint64_t>(fp) << (16 * s);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 从 bucket i 中删除一个 fp
+        bool remove(size_type i, uint16_t fp) noexcept {
+            uint64_t& word = buckets_[i];
+            for (size_type s = 0; s < slots_per_bucket; ++s) {
+                if (lane(word, s) == fp) {
+                    word &= ~(static_cast<uint64_t>(0xffff) << (16 * s));
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 从 bucket i 开始踢出指纹，直到找到空位；失败时最后一个指纹进入 victim 槽
+        void kick(size_type i, uint16_t fp) noexcept {
+            for (size_type n = 0; n < max_kicks; ++n) {
+                if (put(i, fp))
+                    return;
+                const size_type s = static_cast<size_type>(next_random() & (slots_per_bucket - 1));
+                uint64_t& word = buckets_[i];
+                const uint16_t old = lane(word, s);
+                word = (word & ~(static_cast<uint64_t>(0xffff) << (16 * s))) |
+                       (static_cast<uint64_t>(fp) << (16 * s));
+                fp = old;
+                i = alt_index(i, fp);
+            }
+            if (put(i, fp))
+                return;
+            victim_index_ = i;
+            victim_fp_ = fp;
+        }
+
+        // xorshift64
+        uint64_t next_random() noexcept {
+            rng_ ^= rng_ << 13;
+            rng_ ^= rng_ >> 7;
+            rng_ ^= rng_ << 17;
+            return rng_;
+        }
+
+        void allocate(size_type n) {
+            buckets_ = alloc_.allocate(n);
+            bucket_count_ = n;
+            std::memset(buckets_, 0, n * sizeof(uint64_t));
+        }
+
+        void deallocate() noexcept {
+            if (buckets_ != nullptr)
+                alloc_.deallocate(buckets_, bucket_count_);
+            buckets_ = nullptr;
+            bucket_count_ = 0;
+        }
+    };
+
+    // 重载 ccystl 的 swap
+    template <class Key, class Hash, class Alloc>
+    void swap(cuckoo_filter<Key, Hash, Alloc>& lhs, cuckoo_filter<Key, Hash, Alloc>& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+} // namespace ccystl
+#endif // !CCYSTL_CUCKOO_FILTER_H_
@@ -0,0 +1,309 @@
+#ifndef CCYSTL_FILTERED_HASH_CONTAINER_H_
+#define CCYSTL_FILTERED_HASH_CONTAINER_H_
+
+// 这个头文件包含模板类 filtered_hash_container
+// 在无序容器前面加一层过滤器（cuckoo_filter 或 bloom_filter），查找不存在的键值时
+// 只需访问过滤器中的一两条缓存行，不必访问哈希表本身
+//
+// 适用于大部分查找都落空的场景，例如去重、黑名单、连接操作中的探测；查找大多命中时过滤器只会增加开销
+//
+// notes:
+//
+// 过滤器中每个不同的键值只记录一次：
+//   * 键值不允许重复的容器，插入成功时记录，删除时移除
+//   * 键值允许重复的容器，插入第一个等价元素时记录，删除最后一个等价元素时移除
+// 过滤器不支持删除时（bloom_filter），删除后过滤器中留下旧的记录，只会提高假阳性率，
+// 删除较多后可以调用 rebuild() 重建
+//
+// 过滤器的元素个数达到其容量或插入失败时，按两倍大小重建。重建时抛出异常则暂停使用过滤器，
+// 查找直接访问容器，下一次成功的重建之后恢复
+//
+// 为保证过滤器与容器一致，只提供不可修改的 container()，所有修改都要经过本类
+
+#include <initializer_list>
+#include <type_traits>
+
+#include "ccystl/container/unordered_container/cuckoo_filter.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+
+    // 容器的 insert 是否返回 pair<iterator, bool>，即键值是否不允许重复
+    template <class Container, class = void>
+    struct fhc_is_unique : std::false_type { };
+
+    template <class Container>
+    struct fhc_is_unique<Container, std::void_t<decltype(std::declval<Container&>().insert(
+        std::declval<const typename Container::value_type&>()).second)>> : std::true_type { };
+
+    // 模板类 filtered_hash_container
+    // 参数一代表无序容器类型，如 unordered_set、unordered_multimap、flat_hash_map
+    // 参数二代表过滤器类型，缺省使用 ccystl::cuckoo_filter，可换成 ccystl::bloom_filter
+    template <class Container,
+              class Filter = cuckoo_filter<typename Container::key_type,
+                                           typename Container::hasher,
+                                           typename Container::allocator_type>>
+    class filtered_hash_container {
+    public:
+        typedef Container                                     container_type;
+        typedef Filter                                        filter_type;
+
+        typedef typename Container::allocator_type            allocator_type;
+        typedef typename Container::key_type                  key_type;
+        typedef typename Container::value_type                value_type;
+        typedef typename Container::hasher                    hasher;
+        typedef typename Container::key_equal                 key_equal;
+
+        typedef typename Container::size_type                 size_type;
+        typedef typename Container::iterator                  iterator;
+        typedef typename Container::const_iterator            const_iterator;
+
+        typedef decltype(std::declval<Container&>().insert(
+            std::declval<const value_type&>()))               insert_result;
+
+        static constexpr bool      is_unique = fhc_is_unique<Container>::value;
+        static constexpr size_type min_filter_capacity = 16;
+
+    private:
+        Container c_;
+        Filter    filter_;
+        bool      valid_ = true;  // 过滤器是否与容器一致
+
+    public:
+        // 构造、复制、移动函数
+
+        filtered_hash_container()
+            :c_(), filter_(min_filter_capacity, c_.hash_fcn(), c_.get_allocator()) {
+        }
+
+        // capacity 为预计的元素个数，同时用作容器的 bucket 数与过滤器的容量
+        explicit filtered_hash_container(size_type capacity,
+            const hasher& hash = hasher(),
+            const key_equal& equal = key_equal(),
+            const allocator_type& alloc = allocator_type())
+            :c_(capacity, hash, equal, alloc),
+             filter_(capacity < min_filter_capacity ? min_filter_capacity : capacity, hash, alloc) {
+        }
+
+        template <class InputIterator>
+        filtered_hash_container(InputIterator first, InputIterator last)
+            :filtered_hash_container() {
+            insert(first, last);
+        }
+
+        filtered_hash_container(std::initializer_list<value_type> ilist)
+            :filtered_hash_container(ilist.size()) {
+            insert(ilist.begin(), ilist.end());
+        }
+
+        filtered_hash_container(const filtered_hash_container&) = default;
+        filtered_hash_container(filtered_hash_container&&) = default;
+        filtered_hash_container& operator=(const filtered_hash_container&) = default;
+        filtered_hash_container& operator=(filtered_hash_container&&) = default;
+
+        ~filtered_hash_container() = default;
+
+        // 迭代器相关
+
+        iterator       begin()        noexcept { return c_.begin(); }
+        const_iterator begin()  const noexcept { return c_.begin(); }
+        iterator       end()          noexcept { return c_.end(); }
+        const_iterator end()    const noexcept { return c_.end(); }
+
+        // 容量相关
+
+        bool      empty()    const noexcept { return c_.empty(); }
+        size_type size()     const noexcept { return c_.size(); }
+
+        // 修改容器相关
+
+        template <class ...Args>
+        auto emplace(Args&& ...args) -> decltype(c_.emplace(ccystl::forward<Args>(args)...)) {
+            auto res = c_.emplace(ccystl::forward<Args>(args)...);
+            added(res);
+            return res;
+        }
+
+        insert_result insert(const value_type& value) {
+            auto res = c_.insert(value);
+            added(res);
+            return res;
+        }
+
+        insert_result insert(value_type&& value) {
+            auto res = c_.insert(ccystl::move(value));
+            added(res);
+            return res;
+        }
+
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        void erase(iterator it) {
+            if constexpr (Filter::supports_erase) {
+                const key_type key = key_of(*it);
+                c_.erase(it);
+                if (valid_ && (is_unique || c_.count(key) == 0))
+                    filter_.erase(key);
+            }
+            else {
+                c_.erase(it);
+            }
+        }
+
+        size_type erase(const key_type& key) {
+            const size_type n = c_.erase(key);
+            if constexpr (Filter::supports_erase) {
+                if (n != 0 && valid_)
+                    filter_.erase(key);
+            }
+            return n;
+        }
+
+        void clear() {
+            c_.clear();
+            filter_.clear();
+            valid_ = true;
+        }
+
+        void reserve(size_type count) {
+            c_.reserve(count);
+            if (count > filter_.capacity())
+                rebuild(count);
+        }
+
+        // 按当前元素个数重建过滤器，清除删除后留下的旧记录
+        void rebuild() {
+            rebuild(c_.size() < min_filter_capacity ? min_filter_capacity : c_.size());
+        }
+
+        void swap(filtered_hash_container& rhs) noexcept {
+            c_.swap(rhs.c_);
+            filter_.swap(rhs.filter_);
+            ccystl::swap(valid_, rhs.valid_);
+        }
+
+        // 查找相关，先查过滤器
+
+        size_type      count(const key_type& key) const {
+            return may_contain(key) ? c_.count(key) : 0;
+        }
+
+        iterator       find(const key_type& key) {
+            return may_contain(key) ? c_.find(key) : c_.end();
+        }
+        const_iterator find(const key_type& key) const {
+            return may_contain(key) ? c_.find(key) : c_.end();
+        }
+
+        bool           contains(const key_type& key) const {
+            return may_contain(key) && c_.find(key) != c_.end();
+        }
+
+        template <class K, enable_if_transparent_t<K, hasher, key_equal> = 0>
+        size_type      count(const K& key) const {
+            return may_contain(key) ? c_.count(key) : 0;
+        }
+
+        template <class K, enable_if_transparent_t<K, hasher, key_equal> = 0>
+        iterator       find(const K& key) {
+            return may_contain(key) ? c_.find(key) : c_.end();
+        }
+
+        template <class K, enable_if_transparent_t<K, hasher, key_equal> = 0>
+        const_iterator find(const K& key) const {
+            return may_contain(key) ? c_.find(key) : c_.end();
+        }
+
+        template <class K, enable_if_transparent_t<K, hasher, key_equal> = 0>
+        bool           contains(const K& key) const {
+            return may_contain(key) && c_.find(key) != c_.end();
+        }
+
+        // 访问底层容器与过滤器
+
+        const container_type& container() const noexcept { return c_; }
+        const filter_type&    filter()    const noexcept { return filter_; }
+        bool                  filter_valid() const noexcept { return valid_; }
+
+        hasher    hash_fcn()   const { return c_.hash_fcn(); }
+        key_equal key_eq()     const { return c_.key_eq(); }
+
+        allocator_type get_allocator() const { return c_.get_allocator(); }
+
+    private:
+        // helper functions
+
+        template <class K>
+        bool may_contain(const K& key) const {
+            return !valid_ || filter_.contains(key);
+        }
+
+        static const key_type& key_of(const key_type& value) noexcept {
+            return value;
+        }
+
+        template <class V, std::enable_if_t<!std::is_same_v<std::decay_t<V>, key_type>, int> = 0>
+        static const key_type& key_of(const V& value) noexcept {
+            return value.first;
+        }
+
+        // 插入之后把新键值记入过滤器
+        void added(const pair<iterator, bool>& res) {
+            if (res.second)
+                add_key(key_of(*res.first));
+        }
+
+        void added(const iterator& it) {
+            const key_type& key = key_of(*it);
+            if (c_.count(key) == 1)
+                add_key(key);
+        }
+
+        void add_key(const key_type& key) {
+            if (!valid_ || filter_.size() >= filter_.capacity() || !filter_.insert(key))
+                rebuild(c_.size() * 2);
+        }
+
+        // 新建一个容量为 n 的过滤器，记入容器中所有不同的键值，成功后替换原来的过滤器
+        void rebuild(size_type n) {
+            try {
+                Filter tmp(n, c_.hash_fcn(), c_.get_allocator());
+                while (!fill(tmp)) {
+                    n *= 2;
+                    tmp.reset(n);
+                }
+                filter_.swap(tmp);
+                valid_ = true;
+            }
+            catch (...) {
+                valid_ = false;
+                throw;
+            }
+        }
+
+        bool fill(Filter& f) {
+            for (auto it = c_.begin(); it != c_.end(); ++it) {
+                const key_type& key = key_of(*it);
+                // 每个键值只记录一次：等价元素中只记录 find 返回的那一个
+                if (!is_unique && c_.find(key) != it)
+                    continue;
+                if (!f.insert(key))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    // 重载 ccystl 的 swap
+    template <class Container, class Filter>
+    void swap(filtered_hash_container<Container, Filter>& lhs,
+        filtered_hash_container<Container, Filter>& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+} // namespace ccystl
+#endif // !CCYSTL_FILTERED_HASH_CONTAINER_H_
@@ -0,0 +1,577 @@
+#ifndef CCYSTL_FROZEN_HASH_MAP_H_
+#define CCYSTL_FROZEN_HASH_MAP_H_
+
+// 这个头文件包含模板类 frozen_hash_map
+// 只读的哈希表，构造后不能修改，用于启动时加载的大型静态字典
+//
+// 设计：
+//   * 构造时为所有键值求出最小完美哈希函数（见 perfect_hash.h），每个元素恰好占用一个槽位，
+//     查找只需计算一次哈希值、读取一个 pilot 与一个元素，不存在探测或链表
+//   * 全部数据（文件头、pilot 数组、remap 数组、元素数组、字符串键值的字符）
+//     保存在一块连续的映像中，其中没有任何绝对地址，可以直接写入文件
+//   * map_file 把文件 mmap 到内存后直接在映像上查找，不做任何反序列化；
+//     不支持 mmap 的平台退化为把文件读入内存
+//
+// notes:
+//
+// 与 unordered_map 的区别：
+//   * 不能插入、删除或修改元素，迭代器就是指向映像中元素的指针
+//   * 实值类型必须可平凡复制；键值类型必须可平凡复制，或者是 basic_string
+//     （在映像中保存为 frozen_basic_string，可以直接用 const char* 等查找）
+//   * 映像与构造时使用的哈希函数绑定，查找时必须使用相同的哈希函数；
+//     文件只做基本的一致性检查，不应加载不可信的文件
+//   * 映像按本机的字节序与类型布局保存，只能在相同平台上使用
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CCYSTL_FROZEN_HASH_MMAP 1
+#endif
+
+#include "ccystl/algorithm/algo.h"
+#include "ccystl/container/sequence_container/basic_string.h"
+#include "ccystl/container/sequence_container/vector.h"
+#include "ccystl/functor/functional.h"
+#include "ccystl/internal/perfect_hash.h"
+#include "ccystl/utils/except_def.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+
+    // 字符串键值在映像中的形式：字符保存在映像末尾，这里只记录字符相对于自身地址的偏移与长度，
+    // 因此映像映射到任何地址都能直接访问
+    template <class CharT>
+    struct frozen_basic_string {
+        int64_t  offset_;  // 首字符相对于 this 的字节偏移
+        uint64_t size_;    // 字符个数，不含末尾的空字符
+
+        const CharT* data()  const noexcept {
+            return reinterpret_cast<const CharT*>(reinterpret_cast<const char*>(this) + offset_);
+        }
+        const CharT* c_str() const noexcept { return data(); }
+        size_t       size()  const noexcept { return static_cast<size_t>(size_); }
+        bool         empty() const noexcept { return size_ == 0; }
+    };
+
+    typedef frozen_basic_string<char> frozen_string;
+
+    // 键值在映像中的保存方式
+    // 可平凡复制的键值原样保存，缺省使用 ccystl::hash 与 ccystl::equal_to
+    template <class Key>
+    struct frozen_key_traits {
+        static_assert(std::is_trivially_copyable_v<Key>,
+                      "frozen_hash_map's key must be trivially copyable or basic_string");
+
+        typedef Key                      stored_type;
+        typedef ccystl::hash<Key>        default_hash;
+        typedef ccystl::equal_to<Key>    default_equal;
+
+        static constexpr size_t extra_align = 1;
+
+        static size_t extra_size(const Key&) noexcept {
+            return 0;
+        }
+
+        static void store(stored_type* dst, const Key& key, char* /*extra*/) noexcept {
+            ::new (static_cast<void*>(dst)) stored_type(key);
+        }
+    };
+
+    // basic_string 保存为 frozen_basic_string，字符（含末尾的空字符）另存在 extra 处
+    // 缺省使用透明的 string_hash 与 string_equal
+    template <class CharT, class Traits, class Alloc>
+    struct frozen_key_traits<basic_string<CharT, Traits, Alloc>> {
+        typedef frozen_basic_string<CharT> stored_type;
+        typedef string_hash<CharT>         default_hash;
+        typedef string_equal<CharT>        default_equal;
+
+        static constexpr size_t extra_align = alignof(CharT);
+
+        static size_t extra_size(char_sequence<CharT> key) noexcept {
+            return (key.size + 1) * sizeof(CharT);
+        }
+
+        static void store(stored_type* dst, char_sequence<CharT> key, char* extra) noexcept {
+            const CharT nul = CharT();
+            std::memcpy(extra, key.data, key.size * sizeof(CharT));
+            std::memcpy(extra + key.size * sizeof(CharT), &nul, sizeof(CharT));
+            dst->offset_ = static_cast<int64_t>(extra - reinterpret_cast<char*>(dst));
+            dst->size_ = key.size;
+        }
+    };
+
+    // 映像的文件头，各数组的位置都是相对于映像起始地址的偏移
+    struct frozen_hash_header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t entry_size;      // sizeof(value_type)，用于检查类型是否匹配
+        uint32_t entry_align;     // alignof(value_type)
+        uint32_t reserved;
+        uint64_t size;            // 元素个数
+        uint64_t seed;            // 完美哈希函数的种子
+        uint64_t pilots_offset;   // uint32_t[ph_bucket_count(size)]
+        uint64_t remap_offset;    // uint32_t[ph_slot_count(size) - size]
+        uint64_t entries_offset;  // value_type[size]
+        uint64_t total_size;      // 映像的总字节数
+    };
+
+    constexpr uint64_t frozen_hash_magic = 0x4e5a4f5246594343ULL; // 小端序下为 "CCYFROZN"
+    constexpr uint32_t frozen_hash_version = 1;
+
+    // 模板类 frozen_hash_map，键值不允许重复，构造后只读
+    // 参数一代表键值类型，参数二代表实值类型
+    // 参数三代表哈希函数，参数四代表键值比较方式，缺省值见 frozen_key_traits
+    template <class Key, class T,
+              class Hash = typename frozen_key_traits<Key>::default_hash,
+              class KeyEqual = typename frozen_key_traits<Key>::default_equal>
+    class frozen_hash_map {
+        static_assert(std::is_trivially_copyable_v<T>, "frozen_hash_map's mapped type must be trivially copyable");
+
+    public:
+        typedef frozen_key_traits<Key>                   key_traits;
+        typedef Key                                      key_type;
+        typedef T                                        mapped_type;
+        typedef typename key_traits::stored_type         stored_key_type;
+        typedef Hash                                     hasher;
+        typedef KeyEqual                                 key_equal;
+
+        // 映像中的元素
+        struct value_type {
+            stored_key_type first;
+            T               second;
+        };
+
+        typedef size_t                                   size_type;
+        typedef ptrdiff_t                                difference_type;
+        typedef const value_type*                        pointer;
+        typedef const value_type*                        const_pointer;
+        typedef const value_type&                        reference;
+        typedef const value_type&                        const_reference;
+
+        typedef const value_type*                        iterator;
+        typedef const value_type*                        const_iterator;
+
+        // 内存中的映像按此对齐，mmap 得到的地址总能满足
+        static constexpr size_type image_alignment = 64;
+        static_assert(alignof(value_type) <= image_alignment, "frozen_hash_map's value type is over-aligned");
+
+    private:
+        // 映像的来源，决定析构时如何释放
+        enum storage_kind { storage_view, storage_heap, storage_mmap };
+
+        const unsigned char* image_   = nullptr;
+        size_type            bytes_   = 0;
+        storage_kind         storage_ = storage_view;
+
+        const uint32_t*      pilots_  = nullptr;
+        const uint32_t*      remap_   = nullptr;
+        const value_type*    entries_ = nullptr;
+        size_type            size_    = 0;
+        uint64_t             seed_    = 0;
+
+        hasher               hash_;
+        key_equal            equal_;
+
+    public:
+        // 构造、移动、析构函数
+
+        frozen_hash_map() = default;
+
+        // 由 [first, last) 内的键值对构造，first 与 second 分别为键值与实值；键值重复时保留先出现的元素
+        template <class ForwardIter>
+        frozen_hash_map(ForwardIter first, ForwardIter last,
+            const Hash& hash = Hash(),
+            const KeyEqual& equal = KeyEqual())
+            :hash_(hash), equal_(equal) {
+            build(first, last);
+        }
+
+        frozen_hash_map(std::initializer_list<ccystl::pair<Key, T>> ilist,
+            const Hash& hash = Hash(),
+            const KeyEqual& equal = KeyEqual())
+            :hash_(hash), equal_(equal) {
+            build(ilist.begin(), ilist.end());
+        }
+
+        frozen_hash_map(const frozen_hash_map&) = delete;
+        frozen_hash_map& operator=(const frozen_hash_map&) = delete;
+
+        frozen_hash_map(frozen_hash_map&& rhs) noexcept
+            :hash_(rhs.hash_), equal_(rhs.equal_) {
+            steal(rhs);
+        }
+
+        frozen_hash_map& operator=(frozen_hash_map&& rhs) noexcept {
+            if (this != &rhs) {
+                release();
+                hash_ = rhs.hash_;
+                equal_ = rhs.equal_;
+                steal(rhs);
+            }
+            return *this;
+        }
+
+        ~frozen_hash_map() { release(); }
+
+        // 映像相关
+
+        // 在调用者提供的映像上查找，不复制也不接管这块内存，映像须在本对象销毁前保持有效
+        static frozen_hash_map view(const void* image, size_type bytes,
+            const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()) {
+            frozen_hash_map result(hash, equal);
+            result.attach(static_cast<const unsigned char*>(image), bytes);
+            return result;
+        }
+
+        // 映射 save 写出的文件，之后直接在文件内容上查找
+        static frozen_hash_map map_file(const char* path,
+            const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual());
+
+        // 把映像写入文件
+        void save(const char* path) const;
+
+        const void* data()      const noexcept { return image_; }
+        size_type   byte_size() const noexcept { return bytes_; }
+
+        // 迭代器相关
+
+        const_iterator begin()  const noexcept { return entries_; }
+        const_iterator end()    const noexcept { return entries_ + size_; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend()   const noexcept { return end(); }
+
+        // 容量相关
+
+        bool      empty()    const noexcept { return size_ == 0; }
+        size_type size()     const noexcept { return size_; }
+
+        // 查找相关
+
+        const_iterator find(const key_type& key) const {
+            return find_impl(key);
+        }
+
+        size_type      count(const key_type& key) const {
+            return find_impl(key) != end() ? 1 : 0;
+        }
+
+        bool           contains(const key_type& key) const {
+            return find_impl(key) != end();
+        }
+
+        const mapped_type& at(const key_type& key) const {
+            const_iterator it = find_impl(key);
+            THROW_OUT_OF_RANGE_IF(it == end(), "frozen_hash_map<Key, T> no such element exists");
+            return it->second;
+        }
+
+        // 异构查找：哈希函数与比较器都透明时（如字符串键值缺省使用的 string_hash 与 string_equal），
+        // 可以直接用 const char* 等类型查找，不构造临时键值
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        const_iterator find(const K& key) const {
+            return find_impl(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        size_type      count(const K& key) const {
+            return find_impl(key) != end() ? 1 : 0;
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        bool           contains(const K& key) const {
+            return find_impl(key) != end();
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        const mapped_type& at(const K& key) const {
+            const_iterator it = find_impl(key);
+            THROW_OUT_OF_RANGE_IF(it == end(), "frozen_hash_map<Key, T> no such element exists");
+            return it->second;
+        }
+
+        hasher    hash_function() const { return hash_; }
+        key_equal key_eq()        const { return equal_; }
+
+        void      swap(frozen_hash_map& rhs) noexcept {
+            ccystl::swap(image_, rhs.image_);
+            ccystl::swap(bytes_, rhs.bytes_);
+            ccystl::swap(storage_, rhs.storage_);
+            ccystl::swap(pilots_, rhs.pilots_);
+            ccystl::swap(remap_, rhs.remap_);
+            ccystl::swap(entries_, rhs.entries_);
+            ccystl::swap(size_, rhs.size_);
+            ccystl::swap(seed_, rhs.seed_);
+            ccystl::swap(hash_, rhs.hash_);
+            ccystl::swap(equal_, rhs.equal_);
+        }
+
+    private:
+        // helper functions
+
+        frozen_hash_map(const Hash& hash, const KeyEqual& equal)
+            :hash_(hash), equal_(equal) {
+        }
+
+        template <class K>
+        const_iterator find_impl(const K& key) const {
+            if (size_ == 0)
+                return end();
+            const size_type i = ph_lookup(static_cast<uint64_t>(hash_(key)), seed_, pilots_, remap_, size_);
+            return equal_(entries_[i].first, key) ? entries_ + i : end();
+        }
+
+        static size_type align_up(size_type n, size_type align) noexcept {
+            return (n + align - 1) / align * align;
+        }
+
+        template <class ForwardIter>
+        void build(ForwardIter first, ForwardIter last);
+        void attach(const unsigned char* image, size_type bytes);
+        void steal(frozen_hash_map& rhs) noexcept;
+        void release() noexcept;
+
+        static unsigned char* allocate_image(size_type bytes) {
+            return static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(image_alignment)));
+        }
+        static void deallocate_image(const unsigned char* image) noexcept {
+            ::operator delete(const_cast<unsigned char*>(image), std::align_val_t(image_alignment));
+        }
+    };
+
+    /*****************************************************************************************/
+
+    template <class Key, class T, class Hash, class KeyEqual>
+    frozen_hash_map<Key, T, Hash, KeyEqual>
+    frozen_hash_map<Key, T, Hash, KeyEqual>::
+    map_file(const char* path, const Hash& hash, const KeyEqual& equal) {
+        frozen_hash_map result(hash, equal);
+#ifdef CCYSTL_FROZEN_HASH_MMAP
+        const int fd = ::open(path, O_RDONLY);
+        THROW_RUNTIME_ERROR_IF(fd < 0, "frozen_hash_map: cannot open file");
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            THROW_RUNTIME_ERROR_IF(true, "frozen_hash_map: cannot read file");
+        }
+        const size_type bytes = static_cast<size_type>(st.st_size);
+        void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        THROW_RUNTIME_ERROR_IF(p == MAP_FAILED, "frozen_hash_map: cannot map file");
+        result.storage_ = storage_mmap;
+#else
+        std::FILE* f = std::fopen(path, "rb");
+        THROW_RUNTIME_ERROR_IF(f == nullptr, "frozen_hash_map: cannot open file");
+        long end = -1;
+        if (std::fseek(f, 0, SEEK_END) == 0)
+            end = std::ftell(f);
+        if (end <= 0 || std::fseek(f, 0, SEEK_SET) != 0) {
+            std::fclose(f);
+            THROW_RUNTIME_ERROR_IF(true, "frozen_hash_map: cannot read file");
+        }
+        const size_type bytes = static_cast<size_type>(end);
+        unsigned char* p = allocate_image(bytes);
+        const size_type n = std::fread(p, 1, bytes, f);
+        std::fclose(f);
+        if (n != bytes) {
+            deallocate_image(p);
+            THROW_RUNTIME_ERROR_IF(true, "frozen_hash_map: cannot read file");
+        }
+        result.storage_ = storage_heap;
+#endif
+        // 先记下映像再检查，检查失败时由 result 的析构函数释放
+        result.image_ = static_cast<const unsigned char*>(p);
+        result.bytes_ = bytes;
+        result.attach(result.image_, bytes);
+        return result;
+    }
+
+    template <class Key, class T, class Hash, class KeyEqual>
+    void frozen_hash_map<Key, T, Hash, KeyEqual>::
+    save(const char* path) const {
+        THROW_RUNTIME_ERROR_IF(image_ == nullptr, "frozen_hash_map: no image to save");
+        std::FILE* f = std::fopen(path, "wb");
+        THROW_RUNTIME_ERROR_IF(f == nullptr, "frozen_hash_map: cannot open file");
+        const bool ok = std::fwrite(image_, 1, bytes_, f) == bytes_;
+        const bool closed = std::fclose(f) == 0;
+        THROW_RUNTIME_ERROR_IF(!ok || !closed, "frozen_hash_map: cannot write file");
+    }
+
+    /*****************************************************************************************/
+    // helper function
+
+    // 构造映像：去除重复的键值，求出完美哈希函数，再把元素放到各自的槽位上
+    template <class Key, class T, class Hash, class KeyEqual>
+    template <class ForwardIter>
+    void frozen_hash_map<Key, T, Hash, KeyEqual>::
+    build(ForwardIter first, ForwardIter last) {
+        // 按哈希值排序，相同哈希值的元素相邻，其中下标最小的即先出现的元素
+        ccystl::vector<ForwardIter> items;
+        ccystl::vector<uint64_t> item_hashes;
+        for (; first != last; ++first) {
+            items.push_back(first);
+            item_hashes.push_back(static_cast<uint64_t>(hash_(first->first)));
+        }
+        ccystl::vector<size_type> order(items.size());
+        for (size_type i = 0; i < order.size(); ++i)
+            order[i] = i;
+        ccystl::sort(order.begin(), order.end(), [&](size_type a, size_type b) {
+            return item_hashes[a] < item_hashes[b] || (item_hashes[a] == item_hashes[b] && a < b);
+        });
+
+        ccystl::vector<uint64_t> hashes;
+        ccystl::vector<ForwardIter> unique;
+        hashes.reserve(order.size());
+        unique.reserve(order.size());
+        for (size_type i = 0, run = 0; i < order.size(); ++i) {
+            if (i != 0 && item_hashes[order[i]] == item_hashes[order[run]]) {
+                // 哈希值相同的不同键值无法被任何完美哈希函数区分
+                THROW_RUNTIME_ERROR_IF(!equal_(items[order[run]]->first, items[order[i]]->first),
+                                       "frozen_hash_map: two different keys have the same hash value");
+                continue;
+            }
+            run = i;
+            hashes.push_back(item_hashes[order[i]]);
+            unique.push_back(items[order[i]]);
+        }
+        const size_type n = unique.size();
+        THROW_LENGTH_ERROR_IF(n > UINT32_MAX, "frozen_hash_map's size too big");
+
+        // 求出完美哈希函数，失败时换一个种子
+        const size_type r = ph_bucket_count(n), m = ph_slot_count(n);
+        ccystl::vector<uint32_t> pilots(r);
+        ccystl::vector<uint32_t> remap(m - n);
+        ccystl::vector<size_type> positions(n);
+        uint64_t seed = 0x5851f42d4c957f2dULL;
+        for (int attempt = 0; !ph_build(hashes.data(), n, seed, pilots.data(), remap.data(), positions.data()); ++attempt) {
+            THROW_RUNTIME_ERROR_IF(attempt == 8, "frozen_hash_map: failed to build perfect hash");
+            seed = hash_mix(seed + 1);
+        }
+
+        // 计算映像的布局
+        frozen_hash_header header{};
+        header.magic = frozen_hash_magic;
+        header.version = frozen_hash_version;
+        header.entry_size = static_cast<uint32_t>(sizeof(value_type));
+        header.entry_align = static_cast<uint32_t>(alignof(value_type));
+        header.size = n;
+        header.seed = seed;
+        header.pilots_offset = align_up(sizeof(frozen_hash_header), alignof(uint32_t));
+        header.remap_offset = header.pilots_offset + r * sizeof(uint32_t);
+        header.entries_offset = align_up(header.remap_offset + (m - n) * sizeof(uint32_t), alignof(value_type));
+        size_type total = header.entries_offset + n * sizeof(value_type);
+        for (size_type i = 0; i < n; ++i)
+            total = align_up(total, key_traits::extra_align) + key_traits::extra_size(unique[i]->first);
+        header.total_size = total;
+
+        // 写入映像，填充字节置零，使相同的输入得到相同的文件
+        unsigned char* image = allocate_image(total);
+        std::memset(image, 0, total);
+        std::memcpy(image, &header, sizeof(header));
+        std::memcpy(image + header.pilots_offset, pilots.data(), r * sizeof(uint32_t));
+        if (m != n)
+            std::memcpy(image + header.remap_offset, remap.data(), (m - n) * sizeof(uint32_t));
+        value_type* entries = reinterpret_cast<value_type*>(image + header.entries_offset);
+        size_type extra = header.entries_offset + n * sizeof(value_type);
+        for (size_type i = 0; i < n; ++i) {
+            extra = align_up(extra, key_traits::extra_align);
+            value_type* e = entries + positions[i];
+            key_traits::store(&e->first, unique[i]->first, reinterpret_cast<char*>(image + extra));
+            ::new (static_cast<void*>(&e->second)) T(unique[i]->second);
+            extra += key_traits::extra_size(unique[i]->first);
+        }
+
+        release();
+        image_ = image;
+        bytes_ = total;
+        storage_ = storage_heap;
+        attach(image_, bytes_);
+    }
+
+    // 检查映像并取出各数组的位置
+    template <class Key, class T, class Hash, class KeyEqual>
+    void frozen_hash_map<Key, T, Hash, KeyEqual>::
+    attach(const unsigned char* image, size_type bytes) {
+        const char* invalid = "frozen_hash_map: invalid image";
+        THROW_RUNTIME_ERROR_IF(image == nullptr || bytes < sizeof(frozen_hash_header) ||
+                               reinterpret_cast<uintptr_t>(image) % alignof(frozen_hash_header) != 0, invalid);
+        const frozen_hash_header& h = *reinterpret_cast<const frozen_hash_header*>(image);
+        THROW_RUNTIME_ERROR_IF(h.magic != frozen_hash_magic || h.version != frozen_hash_version, invalid);
+        THROW_RUNTIME_ERROR_IF(h.entry_size != sizeof(value_type) || h.entry_align != alignof(value_type), invalid);
+        THROW_RUNTIME_ERROR_IF(h.total_size > bytes || h.size > UINT32_MAX, invalid);
+        const size_type n = static_cast<size_type>(h.size);
+        THROW_RUNTIME_ERROR_IF(h.pilots_offset < sizeof(frozen_hash_header) ||
+                               h.pilots_offset % alignof(uint32_t) != 0 ||
+                               h.remap_offset < h.pilots_offset + ph_bucket_count(n) * sizeof(uint32_t) ||
+                               h.entries_offset < h.remap_offset + (ph_slot_count(n) - n) * sizeof(uint32_t) ||
+                               h.entries_offset + n * sizeof(value_type) > h.total_size ||
+                               (reinterpret_cast<uintptr_t>(image) + h.entries_offset) % alignof(value_type) != 0, invalid);
+        pilots_ = reinterpret_cast<const uint32_t*>(image + h.pilots_offset);
+        remap_ = reinterpret_cast<const uint32_t*>(image + h.remap_offset);
+        entries_ = reinterpret_cast<const value_type*>(image + h.entries_offset);
+        size_ = n;
+        seed_ = h.seed;
+        image_ = image;
+        bytes_ = bytes;
+    }
+
+    // 接管 rhs 的映像，rhs 变为空表
+    template <class Key, class T, class Hash, class KeyEqual>
+    void frozen_hash_map<Key, T, Hash, KeyEqual>::
+    steal(frozen_hash_map& rhs) noexcept {
+        image_ = rhs.image_;
+        bytes_ = rhs.bytes_;
+        storage_ = rhs.storage_;
+        pilots_ = rhs.pilots_;
+        remap_ = rhs.remap_;
+        entries_ = rhs.entries_;
+        size_ = rhs.size_;
+        seed_ = rhs.seed_;
+        rhs.image_ = nullptr;
+        rhs.bytes_ = 0;
+        rhs.storage_ = storage_view;
+        rhs.pilots_ = nullptr;
+        rhs.remap_ = nullptr;
+        rhs.entries_ = nullptr;
+        rhs.size_ = 0;
+    }
+
+    // 按来源释放映像
+    template <class Key, class T, class Hash, class KeyEqual>
+    void frozen_hash_map<Key, T, Hash, KeyEqual>::
+    release() noexcept {
+        if (image_ != nullptr) {
+            if (storage_ == storage_heap)
+                deallocate_image(image_);
+#ifdef CCYSTL_FROZEN_HASH_MMAP
+            else if (storage_ == storage_mmap)
+                ::munmap(const_cast<unsigned char*>(image_), bytes_);
+#endif
+        }
+        image_ = nullptr;
+        bytes_ = 0;
+        storage_ = storage_view;
+        pilots_ = nullptr;
+        remap_ = nullptr;
+        entries_ = nullptr;
+        size_ = 0;
+    }
+
+    // 重载 ccystl 的 swap
+    template <class Key, class T, class Hash, class KeyEqual>
+    void swap(frozen_hash_map<Key, T, Hash, KeyEqual>& lhs,
+        frozen_hash_map<Key, T, Hash, KeyEqual>& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+} // namespace ccystl
+#endif // !CCYSTL_FROZEN_HASH_MAP_H_
@@ -11,21 +11,44 @@
 //   * emplace
 //   * emplace_hint
 //   * insert
+//
+// 迭代器失效：
+// 缺省的链式 hashtable 中，删除只使被删除元素的迭代器失效，插入引起 rehash 时只使迭代器失效，指针和引用仍然有效
+// 使用 ht_robin_hood_policy 时元素直接存放在槽位数组中：
+//   * 插入会移动其他元素，使所有迭代器、指针和引用失效
+//   * 删除会把其后的元素前移一格，同样使所有迭代器、指针和引用失效
+// 因此边遍历边删除时应使用 erase 返回的迭代器，即 it = c.erase(it)，不要写成 c.erase(it++)
 
-#include "ccystl/internal/hash_table.h"
+#include "ccystl/internal/robin_hood_table.h"
 
 namespace ccystl {
 
+    // forward declaration
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    class unordered_multimap;
+
     // 模板类 unordered_map，键值不允许重复
     // 参数一代表键值类型，参数二代表实值类型，参数三代表哈希函数，缺省使用 ccystl::hash
     // 参数四代表键值比较方式，缺省使用 ccystl::equal_to
-    template <class Key, class T, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>>
+    // 参数五代表分配器类型，缺省使用 ccystl::allocator，可传入 ccystl::pool_allocator 使用节点内存池
+    // 参数六代表 bucket 数量与下标的计算策略，缺省使用 ccystl::ht_prime_policy，可换成 ht_power2_policy 或 ht_fastrange_policy，
+    // 传入 ht_robin_hood_policy 时底层改用开放寻址的 robin_hood_hashtable，此时不支持节点句柄与渐进式 rehash，
+    // 插入与删除会使所有迭代器、指针和引用失效，见文件开头的 notes
+    template <class Key, class T, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>,
+              class Alloc = ccystl::allocator<ccystl::pair<const Key, T>>,
+              class BucketPolicy = ht_prime_policy>
     class unordered_map {
     private:
-        // 使用 hashtable 作为底层机制
-        typedef hashtable<ccystl::pair<const Key, T>, Hash, KeyEqual> base_type;
+        // 使用 hashtable 作为底层机制，见 ht_table_selector
+        typedef typename ht_table_selector<ccystl::pair<const Key, T>, Hash, KeyEqual, Alloc, BucketPolicy>::type base_type;
         base_type ht_;
 
+        // merge 需要访问同类容器的底层 hashtable
+        template <class, class, class, class, class, class>
+        friend class unordered_map;
+        template <class, class, class, class, class, class>
+        friend class unordered_multimap;
+
     public:
         // 使用 hashtable 的型别  
 
@@ -48,27 +71,36 @@ namespace ccystl {
         typedef typename base_type::local_iterator       local_iterator;
         typedef typename base_type::const_local_iterator const_local_iterator;
 
+        typedef typename base_type::node_handle_type     node_type;
+        typedef typename base_type::insert_return_type   insert_return_type;
+
         allocator_type get_allocator() const { return ht_.get_allocator(); }
 
     public:
         // 构造、复制、移动、析构函数
 
-        unordered_map()
-            :ht_(100, Hash(), KeyEqual()) {
+        unordered_map() noexcept
+            :ht_(0, Hash(), KeyEqual()) {
+        }
+
+        explicit unordered_map(const allocator_type& alloc) noexcept
+            :ht_(0, Hash(), KeyEqual(), alloc) {
         }
 
         explicit unordered_map(size_type bucket_count,
             const Hash& hash = Hash(),
-            const KeyEqual& equal = KeyEqual())
-            :ht_(bucket_count, hash, equal) {
+            const KeyEqual& equal = KeyEqual(),
+            const allocator_type& alloc = allocator_type())
+            :ht_(bucket_count, hash, equal, alloc) {
         }
 
         template <class InputIterator>
         unordered_map(InputIterator first, InputIterator last,
             const size_type bucket_count = 100,
             const Hash& hash = Hash(),
-            const KeyEqual& equal = KeyEqual())
-            : ht_(ccystl::max(bucket_count, static_cast<size_type>(ccystl::distance(first, last))), hash, equal) {
+            const KeyEqual& equal = KeyEqual(),
+            const allocator_type& alloc = allocator_type())
+            :ht_(ccystl::max(bucket_count, static_cast<size_type>(ccystl::distance(first, last))), hash, equal, alloc) {
             for (; first != last; ++first)
                 ht_.insert_unique_noresize(*first);
         }
@@ -76,8 +108,9 @@ namespace ccystl {
         unordered_map(std::initializer_list<value_type> ilist,
             const size_type bucket_count = 100,
             const Hash& hash = Hash(),
-            const KeyEqual& equal = KeyEqual())
-            :ht_(ccystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal) {
+            const KeyEqual& equal = KeyEqual(),
+            const allocator_type& alloc = allocator_type())
+            :ht_(ccystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal, alloc) {
             for (auto first = ilist.begin(), last = ilist.end(); first != last; ++first)
                 ht_.insert_unique_noresize(*first);
         }
@@ -85,6 +118,11 @@ namespace ccystl {
         unordered_map(const unordered_map& rhs)
             :ht_(rhs.ht_) {
         }
+
+        unordered_map(const unordered_map& rhs, const allocator_type& alloc)
+            :ht_(rhs.ht_, alloc) {
+        }
+
         unordered_map(unordered_map&& rhs) noexcept
             :ht_(ccystl::move(rhs.ht_)) {
         }
@@ -173,11 +211,11 @@ namespace ccystl {
 
         // erase / clear
 
-        void      erase(iterator it) {
-            ht_.erase(it);
+        iterator  erase(iterator it) {
+            return ht_.erase(it);
         }
-        void      erase(iterator first, iterator last) {
-            ht_.erase(first, last);
+        iterator  erase(iterator first, iterator last) {
+            return ht_.erase(first, last);
         }
 
         size_type erase(const key_type& key) {
@@ -188,6 +226,45 @@ namespace ccystl {
             ht_.clear();
         }
 
+        // 节点句柄：在容器之间移动元素时只摘下、挂上节点，不重新分配
+
+        node_type extract(const_iterator position) {
+            return ht_.extract(position);
+        }
+        node_type extract(iterator position) {
+            return ht_.extract(const_iterator(position));
+        }
+        node_type extract(const key_type& key) {
+            return ht_.extract(key);
+        }
+
+        insert_return_type insert(node_type&& nh) {
+            return ht_.insert_unique(ccystl::move(nh));
+        }
+        iterator insert(const_iterator hint, node_type&& nh) {
+            return ht_.insert_unique_use_hint(hint, ccystl::move(nh));
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_map<Key, T, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_map<Key, T, Hash2, KeyEqual2, Alloc, BucketPolicy2>&& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_multimap<Key, T, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_multimap<Key, T, Hash2, KeyEqual2, Alloc, BucketPolicy2>&& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
         void      swap(unordered_map& other) noexcept {
             ht_.swap(other.ht_);
         }
@@ -196,24 +273,24 @@ namespace ccystl {
 
         mapped_type& at(const key_type& key) {
             iterator it = ht_.find(key);
-            THROW_OUT_OF_RANGE_IF(it.node == nullptr, "unordered_map<Key, T> no such element exists");
+            THROW_OUT_OF_RANGE_IF(it == ht_.end(), "unordered_map<Key, T> no such element exists");
             return it->second;
         }
         const mapped_type& at(const key_type& key) const {
             iterator it = ht_.find(key);
-            THROW_OUT_OF_RANGE_IF(it.node == nullptr, "unordered_map<Key, T> no such element exists");
+            THROW_OUT_OF_RANGE_IF(it == ht_.end(), "unordered_map<Key, T> no such element exists");
             return it->second;
         }
 
         mapped_type& operator[](const key_type& key) {
             iterator it = ht_.find(key);
-            if (it.node == nullptr)
+            if (it == ht_.end())
                 it = ht_.emplace_unique(key, T{}).first;
             return it->second;
         }
         mapped_type& operator[](key_type&& key) {
             iterator it = ht_.find(key);
-            if (it.node == nullptr)
+            if (it == ht_.end())
                 it = ht_.emplace_unique(ccystl::move(key), T{}).first;
             return it->second;
         }
@@ -236,6 +313,50 @@ namespace ccystl {
             return ht_.equal_range_unique(key);
         }
 
+        // 异构查找：哈希函数与比较器都透明时（如 ccystl::string_hash 与 ccystl::string_equal），
+        // 可以直接用 const char* 等类型查找，不构造临时键值
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        size_type      count(const K& key) const {
+            return ht_.count(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        iterator       find(const K& key) {
+            return ht_.find(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        const_iterator find(const K& key)  const {
+            return ht_.find(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        pair<iterator, iterator> equal_range(const K& key) {
+            return ht_.equal_range_unique(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        pair<const_iterator, const_iterator> equal_range(const K& key) const {
+            return ht_.equal_range_unique(key);
+        }
+
+        // 批量查找，见 hashtable::find_batch
+
+        template <class ForwardIter, class OutputIter>
+        OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) {
+            return ht_.find_batch(first, last, result);
+        }
+        template <class ForwardIter, class OutputIter>
+        OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+            return ht_.find_batch(first, last, result);
+        }
+
+        template <class ForwardIter, class OutputIter>
+        OutputIter contains_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+            return ht_.contains_batch(first, last, result);
+        }
+
         // bucket interface
 
         local_iterator       begin(size_type n)        noexcept {
@@ -282,6 +403,13 @@ namespace ccystl {
         void      rehash(size_type count) { ht_.rehash(count); }
         void      reserve(size_type count) { ht_.reserve(count); }
 
+        bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+        void      incremental_rehash(bool on) { ht_.incremental_rehash(on); }
+
+        // 统计信息，见 hashtable_stats.h
+        hashtable_stats stats()            const { return ht_.stats(); }
+        void      reset_stats() noexcept { ht_.reset_stats(); }
+
         hasher    hash_fcn()               const { return ht_.hash_fcn(); }
         key_equal key_eq()                 const { return ht_.key_eq(); }
 
@@ -295,24 +423,31 @@ namespace ccystl {
     };
 
     // 重载比较操作符
-    template <class Key, class T, class Hash, class KeyEqual>
-    bool operator==(const unordered_map<Key, T, Hash, KeyEqual>& lhs,
-        const unordered_map<Key, T, Hash, KeyEqual>& rhs) {
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    bool operator==(const unordered_map<Key, T, Hash, KeyEqual, Alloc, BucketPolicy>& lhs,
+        const unordered_map<Key, T, Hash, KeyEqual, Alloc, BucketPolicy>& rhs) {
         return lhs == rhs;
     }
 
-    template <class Key, class T, class Hash, class KeyEqual>
-    bool operator!=(const unordered_map<Key, T, Hash, KeyEqual>& lhs,
-        const unordered_map<Key, T, Hash, KeyEqual>& rhs) {
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    bool operator!=(const unordered_map<Key, T, Hash, KeyEqual, Alloc, BucketPolicy>& lhs,
+        const unordered_map<Key, T, Hash, KeyEqual, Alloc, BucketPolicy>& rhs) {
         return lhs != rhs;
     }
 
     // 重载 ccystl 的 swap
-    template <class Key, class T, class Hash, class KeyEqual>
-    void swap(unordered_map<Key, T, Hash, KeyEqual>& lhs,
-        unordered_map<Key, T, Hash, KeyEqual>& rhs) {
+    template <class Key, class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    void swap(unordered_map<Key, T, Hash, KeyEqual, Alloc, BucketPolicy>& lhs,
+        unordered_map<Key, T, Hash, KeyEqual, Alloc, BucketPolicy>& rhs) {
         lhs.swap(rhs);
     }
+
+    namespace pmr {
+    // 使用多态内存资源的 unordered_map
+    template <class Key, class T, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>>
+    using unordered_map = ccystl::unordered_map<Key, T, Hash, KeyEqual, polymorphic_allocator<ccystl::pair<const Key, T>>>;
+    } // namespace pmr
+
 } // namespace ccystl
 #endif // !CCYSTL_UNORDERED_MAP_H_
 
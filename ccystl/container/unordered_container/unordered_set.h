@@ -11,21 +11,44 @@
 //   * emplace
 //   * emplace_hint
 //   * insert
+//
+// 迭代器失效：
+// 缺省的链式 hashtable 中，删除只使被删除元素的迭代器失效，插入引起 rehash 时只使迭代器失效，指针和引用仍然有效
+// 使用 ht_robin_hood_policy 时元素直接存放在槽位数组中：
+//   * 插入会移动其他元素，使所有迭代器、指针和引用失效
+//   * 删除会把其后的元素前移一格，同样使所有迭代器、指针和引用失效
+// 因此边遍历边删除时应使用 erase 返回的迭代器，即 it = c.erase(it)，不要写成 c.erase(it++)
 
-#include "ccystl/internal/hash_table.h"
+#include "ccystl/internal/robin_hood_table.h"
 
 namespace ccystl {
 
+    // forward declaration
+    template <class Key, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    class unordered_multiset;
+
     // 模板类 unordered_set，键值不允许重复
     // 参数一代表键值类型，参数二代表哈希函数，缺省使用 ccystl::hash，
     // 参数三代表键值比较方式，缺省使用 ccystl::equal_to
-    template <class Key, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>>
+    // 参数四代表分配器类型，缺省使用 ccystl::allocator，可传入 ccystl::pool_allocator 使用节点内存池
+    // 参数五代表 bucket 数量与下标的计算策略，缺省使用 ccystl::ht_prime_policy，可换成 ht_power2_policy 或 ht_fastrange_policy，
+    // 传入 ht_robin_hood_policy 时底层改用开放寻址的 robin_hood_hashtable，此时不支持节点句柄与渐进式 rehash，
+    // 插入与删除会使所有迭代器、指针和引用失效，见文件开头的 notes
+    template <class Key, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>,
+              class Alloc = ccystl::allocator<Key>,
+              class BucketPolicy = ht_prime_policy>
     class unordered_set {
     private:
-        // 使用 hashtable 作为底层机制
-        typedef hashtable<Key, Hash, KeyEqual> base_type;
+        // 使用 hashtable 作为底层机制，见 ht_table_selector
+        typedef typename ht_table_selector<Key, Hash, KeyEqual, Alloc, BucketPolicy>::type base_type;
         base_type ht_;
 
+        // merge 需要访问同类容器的底层 hashtable
+        template <class, class, class, class, class>
+        friend class unordered_set;
+        template <class, class, class, class, class>
+        friend class unordered_multiset;
+
     public:
         // 使用 hashtable 的型别
         typedef typename base_type::allocator_type       allocator_type;
@@ -46,27 +69,36 @@ namespace ccystl {
         typedef typename base_type::const_local_iterator local_iterator;
         typedef typename base_type::const_local_iterator const_local_iterator;
 
+        typedef typename base_type::node_handle_type     node_type;
+        typedef node_insert_return<iterator, node_type>  insert_return_type;
+
         allocator_type get_allocator() const { return ht_.get_allocator(); }
 
     public:
         // 构造、复制、移动函数
 
-        unordered_set()
-            :ht_(100, Hash(), KeyEqual()) {
+        unordered_set() noexcept
+            :ht_(0, Hash(), KeyEqual()) {
+        }
+
+        explicit unordered_set(const allocator_type& alloc) noexcept
+            :ht_(0, Hash(), KeyEqual(), alloc) {
         }
 
         explicit unordered_set(size_type bucket_count,
             const Hash& hash = Hash(),
-            const KeyEqual& equal = KeyEqual())
-            :ht_(bucket_count, hash, equal) {
+            const KeyEqual& equal = KeyEqual(),
+            const allocator_type& alloc = allocator_type())
+            :ht_(bucket_count, hash, equal, alloc) {
         }
 
         template <class InputIterator>
         unordered_set(InputIterator first, InputIterator last,
             const size_type bucket_count = 100,
             const Hash& hash = Hash(),
-            const KeyEqual& equal = KeyEqual())
-            : ht_(ccystl::max(bucket_count, static_cast<size_type>(ccystl::distance(first, last))), hash, equal) {
+            const KeyEqual& equal = KeyEqual(),
+            const allocator_type& alloc = allocator_type())
+            :ht_(ccystl::max(bucket_count, static_cast<size_type>(ccystl::distance(first, last))), hash, equal, alloc) {
             for (; first != last; ++first)
                 ht_.insert_unique_noresize(*first);
         }
@@ -74,8 +106,9 @@ namespace ccystl {
         unordered_set(std::initializer_list<value_type> ilist,
             const size_type bucket_count = 100,
             const Hash& hash = Hash(),
-            const KeyEqual& equal = KeyEqual())
-            :ht_(ccystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal) {
+            const KeyEqual& equal = KeyEqual(),
+            const allocator_type& alloc = allocator_type())
+            :ht_(ccystl::max(bucket_count, static_cast<size_type>(ilist.size())), hash, equal, alloc) {
             for (auto first = ilist.begin(), last = ilist.end(); first != last; ++first)
                 ht_.insert_unique_noresize(*first);
         }
@@ -83,6 +116,11 @@ namespace ccystl {
         unordered_set(const unordered_set& rhs)
             :ht_(rhs.ht_) {
         }
+
+        unordered_set(const unordered_set& rhs, const allocator_type& alloc)
+            :ht_(rhs.ht_, alloc) {
+        }
+
         unordered_set(unordered_set&& rhs) noexcept
             : ht_(ccystl::move(rhs.ht_)) {
         }
@@ -171,11 +209,11 @@ namespace ccystl {
 
         // erase / clear
 
-        void      erase(iterator it) {
-            ht_.erase(it);
+        iterator  erase(iterator it) {
+            return ht_.erase(it);
         }
-        void      erase(iterator first, iterator last) {
-            ht_.erase(first, last);
+        iterator  erase(iterator first, iterator last) {
+            return ht_.erase(first, last);
         }
 
         size_type erase(const key_type& key) {
@@ -186,6 +224,43 @@ namespace ccystl {
             ht_.clear();
         }
 
+        // 节点句柄：在容器之间移动元素时只摘下、挂上节点，不重新分配
+
+        node_type extract(const_iterator position) {
+            return ht_.extract(position);
+        }
+        node_type extract(const key_type& key) {
+            return ht_.extract(key);
+        }
+
+        insert_return_type insert(node_type&& nh) {
+            auto res = ht_.insert_unique(ccystl::move(nh));
+            return insert_return_type{iterator(res.position), res.inserted, ccystl::move(res.node)};
+        }
+        iterator insert(const_iterator hint, node_type&& nh) {
+            return iterator(ht_.insert_unique_use_hint(hint, ccystl::move(nh)));
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_set<Key, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_set<Key, Hash2, KeyEqual2, Alloc, BucketPolicy2>&& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_multiset<Key, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
+        template <class Hash2, class KeyEqual2, class BucketPolicy2>
+        void merge(unordered_multiset<Key, Hash2, KeyEqual2, Alloc, BucketPolicy2>&& source) {
+            ht_.merge_unique(source.ht_);
+        }
+
         void      swap(unordered_set& other) noexcept {
             ht_.swap(other.ht_);
         }
@@ -210,6 +285,46 @@ namespace ccystl {
             return ht_.equal_range_unique(key);
         }
 
+        // 异构查找：哈希函数与比较器都透明时（如 ccystl::string_hash 与 ccystl::string_equal），
+        // 可以直接用 const char* 等类型查找，不构造临时键值
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        size_type      count(const K& key) const {
+            return ht_.count(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        iterator       find(const K& key) {
+            return ht_.find(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        const_iterator find(const K& key)  const {
+            return ht_.find(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        pair<iterator, iterator> equal_range(const K& key) {
+            return ht_.equal_range_unique(key);
+        }
+
+        template <class K, enable_if_transparent_t<K, Hash, KeyEqual> = 0>
+        pair<const_iterator, const_iterator> equal_range(const K& key) const {
+            return ht_.equal_range_unique(key);
+        }
+
+        // 批量查找，见 hashtable::find_batch
+
+        template <class ForwardIter, class OutputIter>
+        OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+            return ht_.find_batch(first, last, result);
+        }
+
+        template <class ForwardIter, class OutputIter>
+        OutputIter contains_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+            return ht_.contains_batch(first, last, result);
+        }
+
         // bucket interface
 
         local_iterator       begin(size_type n)        noexcept {
@@ -256,6 +371,13 @@ namespace ccystl {
         void      rehash(size_type count) { ht_.rehash(count); }
         void      reserve(size_type count) { ht_.reserve(count); }
 
+        bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+        void      incremental_rehash(bool on) { ht_.incremental_rehash(on); }
+
+        // 统计信息，见 hashtable_stats.h
+        hashtable_stats stats()            const { return ht_.stats(); }
+        void      reset_stats() noexcept { ht_.reset_stats(); }
+
         hasher    hash_fcn()               const { return ht_.hash_fcn(); }
         key_equal key_eq()                 const { return ht_.key_eq(); }
 
@@ -270,25 +392,31 @@ namespace ccystl {
     };
 
     // 重载比较操作符
-    template <class Key, class Hash, class KeyEqual, class Alloc>
-    bool operator==(const unordered_set<Key, Hash, KeyEqual>& lhs,
-        const unordered_set<Key, Hash, KeyEqual>& rhs) {
+    template <class Key, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    bool operator==(const unordered_set<Key, Hash, KeyEqual, Alloc, BucketPolicy>& lhs,
+        const unordered_set<Key, Hash, KeyEqual, Alloc, BucketPolicy>& rhs) {
         return lhs == rhs;
     }
 
-    template <class Key, class Hash, class KeyEqual, class Alloc>
-    bool operator!=(const unordered_set<Key, Hash, KeyEqual>& lhs,
-        const unordered_set<Key, Hash, KeyEqual>& rhs) {
+    template <class Key, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    bool operator!=(const unordered_set<Key, Hash, KeyEqual, Alloc, BucketPolicy>& lhs,
+        const unordered_set<Key, Hash, KeyEqual, Alloc, BucketPolicy>& rhs) {
         return lhs != rhs;
     }
 
     // 重载 ccystl 的 swap
-    template <class Key, class Hash, class KeyEqual, class Alloc>
-    void swap(unordered_set<Key, Hash, KeyEqual>& lhs,
-        unordered_set<Key, Hash, KeyEqual>& rhs) {
+    template <class Key, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+    void swap(unordered_set<Key, Hash, KeyEqual, Alloc, BucketPolicy>& lhs,
+        unordered_set<Key, Hash, KeyEqual, Alloc, BucketPolicy>& rhs) {
         lhs.swap(rhs);
     }
 
+    namespace pmr {
+    // 使用多态内存资源的 unordered_set
+    template <class Key, class Hash = ccystl::hash<Key>, class KeyEqual = ccystl::equal_to<Key>>
+    using unordered_set = ccystl::unordered_set<Key, Hash, KeyEqual, polymorphic_allocator<Key>>;
+    } // namespace pmr
+
 } // namespace ccystl
 
 #endif // !CCYSTL_UNORDERED_SET_H_
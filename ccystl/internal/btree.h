@@ -0,0 +1,1427 @@
+#ifndef CCYSTL_BTREE_H_
+#define CCYSTL_BTREE_H_
+
+// 这个头文件包含一个模板类 btree
+// btree : B+ 树，btree_set / btree_multiset / btree_map / btree_multimap 的底层实现
+//
+// 设计：
+//   * 元素只存放在叶节点中，叶节点之间以双向链表相连，顺序遍历只是在叶节点内移动下标
+//   * 内部节点只存放分隔键值与子节点指针，分隔键值 keys[i] 满足：
+//     子树 i 中的键值 <= keys[i] <= 子树 i + 1 中的键值
+//   * 节点大小以 btree_target_node_size（256 字节，4 条缓存行）为目标，由元素与键值的大小算出节点容量，
+//     例如 btree_set<int> 的叶节点可放 56 个元素，内部节点可放 19 个分隔键值
+//   * 叶节点满时分裂；在叶节点末尾插入时新元素单独进入新的叶节点，因此顺序插入得到的叶节点都是满的
+//   * 删除后节点的元素个数低于容量的一半时，向兄弟节点借一个元素，借不到就与兄弟节点合并
+//   * header 是一个不存放元素的叶节点，与首、尾叶节点连成环，end() 指向 header
+//
+// notes:
+//
+// 与 rb_tree 的区别：
+//   * 插入与删除会使所有迭代器、指针和引用失效，元素会在节点内与节点间移动
+//   * 元素不单独分配节点，因此没有节点句柄，不提供 extract / merge
+//   * 分隔键值是元素键值的副本，key_type 必须可复制，且移动构造不应抛出异常
+//
+// 异常保证：
+// 插入满足强异常安全保证（节点分裂本身不可撤销，但不改变元素），其余操作满足基本异常安全保证
+
+#include <cstdint>
+#include <cstring>
+
+#include "ccystl/container/sequence_container/vector.h"
+#include "ccystl/internal/rb_tree.h"
+#include "ccystl/utils/type_traits.h"
+
+namespace ccystl {
+// 节点大小的目标字节数
+constexpr size_t btree_target_node_size = 256;
+
+// btree 的节点设计
+
+struct btree_node_base {
+    btree_node_base* parent;   // 父节点，根节点为 nullptr
+    uint16_t         position; // 在父节点 children 中的下标
+    uint16_t         count;    // 叶节点为元素个数，内部节点为分隔键值个数
+    bool             leaf;
+};
+
+struct btree_leaf_base : public btree_node_base {
+    btree_leaf_base* prev; // 前一个叶节点，首叶节点指向 header
+    btree_leaf_base* next; // 后一个叶节点，尾叶节点指向 header
+};
+
+template <class T, size_t N>
+struct btree_leaf : public btree_leaf_base {
+    alignas(T) unsigned char storage[N * sizeof(T)];
+
+    T* values() noexcept {
+        return reinterpret_cast<T*>(storage);
+    }
+};
+
+template <class Key, size_t N>
+struct btree_inner : public btree_node_base {
+    btree_node_base* children[N + 1];
+    alignas(Key) unsigned char storage[N * sizeof(Key)];
+
+    Key* keys() noexcept {
+        return reinterpret_cast<Key*>(storage);
+    }
+};
+
+// 节点容量：使节点大小接近 btree_target_node_size，叶节点至少 4 个元素，内部节点至少 3 个分隔键值
+template <class T, class Key>
+struct btree_node_traits {
+    static constexpr size_t leaf_raw =
+        (btree_target_node_size - sizeof(btree_leaf_base)) / sizeof(T);
+    static constexpr size_t inner_raw =
+        (btree_target_node_size - sizeof(btree_node_base) - sizeof(void*)) / (sizeof(Key) + sizeof(void*));
+
+    static constexpr size_t leaf_slots = leaf_raw < 4 ? 4 : leaf_raw;
+    static constexpr size_t inner_slots = inner_raw < 3 ? 3 : inner_raw;
+};
+
+// 把 [first, last) 重定位到 result，两个区间可以重叠
+template <class T>
+void btree_relocate(T* first, T* last, T* result) {
+    if (first == last || first == result)
+        return;
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::memmove(static_cast<void*>(result), static_cast<const void*>(first),
+                     static_cast<size_t>(last - first) * sizeof(T));
+    }
+    else if (result < first) {
+        for (; first != last; ++first, ++result) {
+            ccystl::construct(result, ccystl::move(*first));
+            ccystl::destroy(first);
+        }
+    }
+    else {
+        result += last - first;
+        while (last != first) {
+            --last, --result;
+            ccystl::construct(result, ccystl::move(*last));
+            ccystl::destroy(last);
+        }
+    }
+}
+
+// btree 的迭代器设计
+// 迭代器由叶节点与节点内下标组成，end() 为 (header, 0)
+
+template <class T, size_t N>
+struct btree_iterator;
+template <class T, size_t N>
+struct btree_const_iterator;
+
+template <class T, size_t N>
+struct btree_iterator_base : public iterator<bidirectional_iterator_tag, T> {
+    btree_leaf_base* node;  // 所在的叶节点
+    size_t           index; // 在叶节点中的下标
+
+    btree_iterator_base() : node(nullptr), index(0) { }
+
+    btree_iterator_base(btree_leaf_base* x, size_t i) : node(x), index(i) { }
+
+    T* value_ptr() const {
+        return static_cast<btree_leaf<T, N>*>(node)->values() + index;
+    }
+
+    // 使迭代器前进
+    void inc() {
+        if (++index == node->count) {
+            node = node->next;
+            index = 0;
+        }
+    }
+
+    // 使迭代器后退
+    void dec() {
+        if (index == 0) {
+            node = node->prev;
+            index = node->count - 1;
+        }
+        else {
+            --index;
+        }
+    }
+
+    bool operator==(const btree_iterator_base& rhs) const {
+        return node == rhs.node && index == rhs.index;
+    }
+
+    bool operator!=(const btree_iterator_base& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+template <class T, size_t N>
+struct btree_iterator : public btree_iterator_base<T, N> {
+    typedef T value_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    typedef btree_iterator<T, N> iterator;
+    typedef btree_const_iterator<T, N> const_iterator;
+    typedef iterator self;
+
+    using btree_iterator_base<T, N>::node;
+    using btree_iterator_base<T, N>::index;
+
+    // 构造函数
+    btree_iterator() { }
+
+    btree_iterator(btree_leaf_base* x, size_t i)
+        : btree_iterator_base<T, N>(x, i) { }
+
+    btree_iterator(const iterator& rhs)
+        : btree_iterator_base<T, N>(rhs.node, rhs.index) { }
+
+    btree_iterator(const const_iterator& rhs)
+        : btree_iterator_base<T, N>(rhs.node, rhs.index) { }
+
+    // 重载操作符
+    reference operator*() const {
+        return *this->value_ptr();
+    }
+
+    pointer operator->() const {
+        return this->value_ptr();
+    }
+
+    self& operator++() {
+        this->inc();
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp(*this);
+        this->inc();
+        return tmp;
+    }
+
+    self& operator--() {
+        this->dec();
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp(*this);
+        this->dec();
+        return tmp;
+    }
+};
+
+template <class T, size_t N>
+struct btree_const_iterator : public btree_iterator_base<T, N> {
+    typedef T value_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    typedef btree_iterator<T, N> iterator;
+    typedef btree_const_iterator<T, N> const_iterator;
+    typedef const_iterator self;
+
+    using btree_iterator_base<T, N>::node;
+    using btree_iterator_base<T, N>::index;
+
+    // 构造函数
+    btree_const_iterator() { }
+
+    btree_const_iterator(btree_leaf_base* x, size_t i)
+        : btree_iterator_base<T, N>(x, i) { }
+
+    btree_const_iterator(const iterator& rhs)
+        : btree_iterator_base<T, N>(rhs.node, rhs.index) { }
+
+    btree_const_iterator(const const_iterator& rhs)
+        : btree_iterator_base<T, N>(rhs.node, rhs.index) { }
+
+    // 重载操作符
+    reference operator*() const {
+        return *this->value_ptr();
+    }
+
+    pointer operator->() const {
+        return this->value_ptr();
+    }
+
+    self& operator++() {
+        this->inc();
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp(*this);
+        this->inc();
+        return tmp;
+    }
+
+    self& operator--() {
+        this->dec();
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp(*this);
+        this->dec();
+        return tmp;
+    }
+};
+
+// 模板类 btree
+// 参数一代表数据类型，参数二代表键值比较类型，参数三代表分配器类型，缺省使用 ccystl::allocator
+template <class T, class Compare, class Alloc = ccystl::allocator<T>>
+class btree {
+public:
+    // btree 的嵌套型别定义
+
+    typedef rb_tree_value_traits<T> value_traits;
+
+    typedef typename value_traits::key_type key_type;
+    typedef typename value_traits::mapped_type mapped_type;
+    typedef typename value_traits::value_type value_type;
+    typedef Compare key_compare;
+
+    static constexpr size_t leaf_slots = btree_node_traits<T, key_type>::leaf_slots;
+    static constexpr size_t inner_slots = btree_node_traits<T, key_type>::inner_slots;
+    static constexpr size_t leaf_min = leaf_slots / 2;   // 非根叶节点删除后的最少元素个数
+    static constexpr size_t inner_min = inner_slots / 2; // 非根内部节点删除后的最少分隔键值个数
+
+    static_assert(leaf_slots <= UINT16_MAX && inner_slots < UINT16_MAX, "btree node is too large");
+
+    typedef btree_node_base* base_ptr;
+    typedef btree_leaf_base* leaf_base_ptr;
+    typedef btree_leaf<T, leaf_slots> leaf_type;
+    typedef btree_inner<key_type, inner_slots> inner_type;
+    typedef leaf_type* leaf_ptr;
+    typedef inner_type* inner_ptr;
+
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
+    typedef typename Alloc::template rebind<leaf_type>::other leaf_allocator;
+    typedef typename Alloc::template rebind<inner_type>::other inner_allocator;
+
+    typedef typename allocator_type::pointer pointer;
+    typedef typename allocator_type::const_pointer const_pointer;
+    typedef typename allocator_type::reference reference;
+    typedef typename allocator_type::const_reference const_reference;
+    typedef typename allocator_type::size_type size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef btree_iterator<T, leaf_slots> iterator;
+    typedef btree_const_iterator<T, leaf_slots> const_iterator;
+    typedef ccystl::reverse_iterator<iterator> reverse_iterator;
+    typedef ccystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    allocator_type get_allocator() const {
+        return allocator_type(leaf_alloc_);
+    }
+
+    key_compare key_comp() const {
+        return key_comp_;
+    }
+
+private:
+    // 用以下数据表现 btree
+    btree_leaf_base header_; // 不存放元素的叶节点，与首、尾叶节点连成环，内嵌于容器中因而无需分配
+    base_ptr root_;          // 根节点，空树为 nullptr
+    size_type size_;         // 元素个数
+    key_compare key_comp_;   // 键值比较的准则
+    [[no_unique_address]] leaf_allocator leaf_alloc_; // 叶节点分配器，其余分配器由它转换得到
+
+private:
+    leaf_base_ptr header() const noexcept {
+        return const_cast<leaf_base_ptr>(&header_);
+    }
+
+public:
+    // 构造、复制、析构函数
+    btree() noexcept : key_comp_() {
+        btree_init();
+    }
+
+    explicit btree(const allocator_type& alloc) noexcept
+        : key_comp_(), leaf_alloc_(alloc) {
+        btree_init();
+    }
+
+    explicit btree(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : key_comp_(comp), leaf_alloc_(alloc) {
+        btree_init();
+    }
+
+    btree(const btree& rhs);
+    btree(const btree& rhs, const allocator_type& alloc);
+    btree(btree&& rhs) noexcept;
+
+    btree& operator=(const btree& rhs);
+    btree& operator=(btree&& rhs);
+
+    ~btree() {
+        clear();
+    }
+
+public:
+    // 迭代器相关操作
+
+    iterator begin() noexcept {
+        return iterator(header()->next, 0);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(header()->next, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(header(), 0);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(header(), 0);
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关操作
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept {
+        return size_;
+    }
+
+    size_type max_size() const noexcept {
+        return static_cast<size_type>(-1) / sizeof(T);
+    }
+
+    // 树的高度，空树为 0，只有一个叶节点时为 1
+    size_type height() const noexcept {
+        size_type h = 0;
+        for (base_ptr x = root_; x != nullptr; ++h)
+            x = x->leaf ? nullptr : static_cast<inner_ptr>(x)->children[0];
+        return h;
+    }
+
+    // 插入删除相关操作
+
+    // emplace
+
+    template <class... Args>
+    iterator emplace_multi(Args&&... args) {
+        value_type tmp(ccystl::forward<Args>(args)...);
+        return insert_at(upper_pos(value_traits::get_key(tmp)), value_traits::get_key(tmp), ccystl::move(tmp));
+    }
+
+    template <class... Args>
+    ccystl::pair<iterator, bool> emplace_unique(Args&&... args) {
+        value_type tmp(ccystl::forward<Args>(args)...);
+        return insert_unique(ccystl::move(tmp));
+    }
+
+    // [note]: 只利用 end() 作为 hint：按顺序插入时不必从根节点查找插入位置，其余 hint 被忽略
+    template <class... Args>
+    iterator emplace_multi_use_hint(const_iterator hint, Args&&... args) {
+        value_type tmp(ccystl::forward<Args>(args)...);
+        const key_type& key = value_traits::get_key(tmp);
+        if (hint == end() && size_ != 0 && !key_comp_(key, value_traits::get_key(*--end())))
+            return insert_at(iterator(header()->prev, header()->prev->count), key, ccystl::move(tmp));
+        return insert_at(upper_pos(key), key, ccystl::move(tmp));
+    }
+
+    template <class... Args>
+    iterator emplace_unique_use_hint(const_iterator hint, Args&&... args) {
+        value_type tmp(ccystl::forward<Args>(args)...);
+        return insert_unique(hint, ccystl::move(tmp));
+    }
+
+    // insert
+
+    iterator insert_multi(const value_type& value) {
+        return emplace_multi(value);
+    }
+
+    iterator insert_multi(value_type&& value) {
+        return emplace_multi(ccystl::move(value));
+    }
+
+    iterator insert_multi(const_iterator hint, const value_type& value) {
+        return emplace_multi_use_hint(hint, value);
+    }
+
+    iterator insert_multi(const_iterator hint, value_type&& value) {
+        return emplace_multi_use_hint(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert_multi(InputIterator first, InputIterator last) {
+        for (; first != last; ++first)
+            insert_multi(end(), *first);
+    }
+
+    ccystl::pair<iterator, bool> insert_unique(const value_type& value) {
+        return insert_unique_value(value);
+    }
+
+    ccystl::pair<iterator, bool> insert_unique(value_type&& value) {
+        return insert_unique_value(ccystl::move(value));
+    }
+
+    iterator insert_unique(const_iterator hint, const value_type& value) {
+        return insert_unique_use_hint(hint, value);
+    }
+
+    iterator insert_unique(const_iterator hint, value_type&& value) {
+        return insert_unique_use_hint(hint, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert_unique(InputIterator first, InputIterator last) {
+        for (; first != last; ++first)
+            insert_unique(end(), *first);
+    }
+
+    // erase
+
+    // 删除 position 处的元素，返回指向下一个元素的迭代器
+    iterator erase(const_iterator position);
+
+    size_type erase_multi(const key_type& key);
+    size_type erase_unique(const key_type& key);
+
+    iterator erase(const_iterator first, const_iterator last);
+
+    void clear();
+
+    // btree 相关操作
+
+    template <class K>
+    iterator find(const K& key) {
+        iterator it = lower_bound(key);
+        return (it == end() || key_comp_(key, value_traits::get_key(*it))) ? end() : it;
+    }
+
+    template <class K>
+    const_iterator find(const K& key) const {
+        const_iterator it = lower_bound(key);
+        return (it == end() || key_comp_(key, value_traits::get_key(*it))) ? end() : it;
+    }
+
+    template <class K>
+    size_type count_multi(const K& key) const {
+        auto p = equal_range_multi(key);
+        return static_cast<size_type>(ccystl::distance(p.first, p.second));
+    }
+
+    template <class K>
+    size_type count_unique(const K& key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    // 键值不小于 key 的第一个位置
+    template <class K>
+    iterator lower_bound(const K& key) {
+        return normalize(lower_pos(key));
+    }
+
+    template <class K>
+    const_iterator lower_bound(const K& key) const {
+        return normalize(lower_pos(key));
+    }
+
+    // 键值大于 key 的第一个位置
+    template <class K>
+    iterator upper_bound(const K& key) {
+        return normalize(upper_pos(key));
+    }
+
+    template <class K>
+    const_iterator upper_bound(const K& key) const {
+        return normalize(upper_pos(key));
+    }
+
+    template <class K>
+    ccystl::pair<iterator, iterator>
+    equal_range_multi(const K& key) {
+        return ccystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    template <class K>
+    ccystl::pair<const_iterator, const_iterator>
+    equal_range_multi(const K& key) const {
+        return ccystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    template <class K>
+    ccystl::pair<iterator, iterator>
+    equal_range_unique(const K& key) {
+        iterator it = find(key);
+        auto next = it;
+        return it == end() ? ccystl::make_pair(it, it) : ccystl::make_pair(it, ++next);
+    }
+
+    template <class K>
+    ccystl::pair<const_iterator, const_iterator>
+    equal_range_unique(const K& key) const {
+        const_iterator it = find(key);
+        auto next = it;
+        return it == end() ? ccystl::make_pair(it, it) : ccystl::make_pair(it, ++next);
+    }
+
+    void swap(btree& rhs) noexcept;
+
+private:
+    // node related
+    static T* values(leaf_base_ptr x) noexcept {
+        return static_cast<leaf_ptr>(x)->values();
+    }
+    static key_type* keys(base_ptr x) noexcept {
+        return static_cast<inner_ptr>(x)->keys();
+    }
+    static base_ptr* children(base_ptr x) noexcept {
+        return static_cast<inner_ptr>(x)->children;
+    }
+
+    leaf_ptr create_leaf();
+    inner_ptr create_inner();
+    void destroy_leaf(leaf_base_ptr x) noexcept;
+    void destroy_inner(base_ptr x) noexcept;
+    void destroy_subtree(base_ptr x) noexcept;
+
+    void link_leaf_after(leaf_base_ptr x, leaf_base_ptr pos) noexcept;
+    void unlink_leaf(leaf_base_ptr x) noexcept;
+
+    // init / reset
+    void btree_init() noexcept;
+    void relink_header() noexcept;
+    void steal(btree& rhs) noexcept;
+    template <class InputIterator>
+    void build_sorted(InputIterator first, size_type n);
+
+    // 查找位置，返回的下标可能等于叶节点的元素个数，需经 normalize 转为合法的迭代器
+    template <class K>
+    iterator lower_pos(const K& key) const;
+    template <class K>
+    iterator upper_pos(const K& key) const;
+    iterator normalize(iterator it) const noexcept {
+        if (it.index == it.node->count && it.node != header())
+            return iterator(it.node->next, 0);
+        return it;
+    }
+
+    static const key_type& min_key(base_ptr x) noexcept {
+        while (!x->leaf)
+            x = children(x)[0];
+        return value_traits::get_key(values(static_cast<leaf_base_ptr>(x))[0]);
+    }
+
+    // insert
+    template <class V>
+    ccystl::pair<iterator, bool> insert_unique_value(V&& value);
+    template <class V>
+    iterator insert_unique_use_hint(const_iterator hint, V&& value);
+    template <class... Args>
+    iterator insert_at(iterator pos, const key_type& key, Args&&... args);
+
+    void split_leaf(leaf_base_ptr& leaf, size_t& index, const key_type& key);
+    void split_inner(base_ptr node, size_t pos);
+    base_ptr ensure_parent_room(base_ptr node);
+    template <class K>
+    void inner_insert(base_ptr p, size_t pos, K&& key, base_ptr child);
+    void collapse_root() noexcept;
+
+    // erase
+    void inner_erase(base_ptr p, size_t pos) noexcept;
+    void fix_leaf(leaf_base_ptr& leaf, size_t& index);
+    void fix_inner(base_ptr node);
+};
+
+/*****************************************************************************************/
+
+// 复制构造函数
+template <class T, class Compare, class Alloc>
+btree<T, Compare, Alloc>::
+btree(const btree& rhs)
+    : key_comp_(rhs.key_comp_), leaf_alloc_(rhs.leaf_alloc_) {
+    btree_init();
+    build_sorted(rhs.begin(), rhs.size_);
+}
+
+// 使用指定分配器的复制构造函数
+template <class T, class Compare, class Alloc>
+btree<T, Compare, Alloc>::
+btree(const btree& rhs, const allocator_type& alloc)
+    : key_comp_(rhs.key_comp_), leaf_alloc_(alloc) {
+    btree_init();
+    build_sorted(rhs.begin(), rhs.size_);
+}
+
+// 移动构造函数
+template <class T, class Compare, class Alloc>
+btree<T, Compare, Alloc>::
+btree(btree&& rhs) noexcept
+    : key_comp_(ccystl::move(rhs.key_comp_)), leaf_alloc_(rhs.leaf_alloc_) {
+    btree_init();
+    steal(rhs);
+}
+
+// 复制赋值操作符
+template <class T, class Compare, class Alloc>
+btree<T, Compare, Alloc>&
+btree<T, Compare, Alloc>::
+operator=(const btree& rhs) {
+    if (this != &rhs) {
+        btree tmp(rhs, get_allocator());
+        swap(tmp);
+    }
+    return *this;
+}
+
+// 移动赋值操作符
+template <class T, class Compare, class Alloc>
+btree<T, Compare, Alloc>&
+btree<T, Compare, Alloc>::
+operator=(btree&& rhs) {
+    if (this != &rhs) {
+        clear();
+        key_comp_ = ccystl::move(rhs.key_comp_);
+        steal(rhs);
+    }
+    return *this;
+}
+
+// 删除 position 处的元素，返回指向下一个元素的迭代器
+template <class T, class Compare, class Alloc>
+typename btree<T, Compare, Alloc>::iterator
+btree<T, Compare, Alloc>::
+erase(const_iterator position) {
+    leaf_base_ptr leaf = position.node;
+    size_t index = position.index;
+    T* v = values(leaf);
+    data_allocator(leaf_alloc_).destroy(v + index);
+    btree_relocate(v + index + 1, v + leaf->count, v + index);
+    --leaf->count;
+    --size_;
+    if (leaf->count < leaf_min)
+        fix_leaf(leaf, index);
+    return normalize(iterator(leaf, index));
+}
+
+// 删除键值等于 key 的元素，返回删除的个数
+template <class T, class Compare, class Alloc>
+typename btree<T, Compare, Alloc>::size_type
+btree<T, Compare, Alloc>::
+erase_multi(const key_type& key) {
+    auto p = equal_range_multi(key);
+    size_type n = ccystl::distance(p.first, p.second);
+    // 删除会移动元素，只能从同一位置反复删除
+    for (size_type i = 0; i < n; ++i)
+        p.first = erase(p.first);
+    return n;
+}
+
+// 删除键值等于 key 的元素，返回删除的个数
+template <class T, class Compare, class Alloc>
+typename btree<T, Compare, Alloc>::size_type
+btree<T, Compare, Alloc>::
+erase_unique(const key_type& key) {
+    iterator it = find(key);
+    if (it != end()) {
+        erase(it);
+        return 1;
+    }
+    return 0;
+}
+
+// 删除[first, last)区间内的元素
+template <class T, class Compare, class Alloc>
+typename btree<T, Compare, Alloc>::iterator
+btree<T, Compare, Alloc>::
+erase(const_iterator first, const_iterator last) {
+    if (first == begin() && last == end()) {
+        clear();
+        return end();
+    }
+    size_type n = ccystl::distance(first, last);
+    iterator it(first);
+    for (; n > 0; --n)
+        it = erase(it);
+    return it;
+}
+
+// 清空 btree
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+clear() {
+    if (root_ != nullptr) {
+        destroy_subtree(root_);
+        btree_init();
+    }
+}
+
+// 交换 btree
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+swap(btree& rhs) noexcept {
+    if (this != &rhs) {
+        ccystl::swap(header_.prev, rhs.header_.prev);
+        ccystl::swap(header_.next, rhs.header_.next);
+        ccystl::swap(root_, rhs.root_);
+        ccystl::swap(size_, rhs.size_);
+        ccystl::swap(key_comp_, rhs.key_comp_);
+        ccystl::swap(leaf_alloc_, rhs.leaf_alloc_);
+        relink_header();
+        rhs.relink_header();
+    }
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 分配一个空的叶节点
+template <class T, class Compare, class Alloc>
+typename btree<T, Compare, Alloc>::leaf_ptr
+btree<T, Compare, Alloc>::
+create_leaf() {
+    leaf_ptr x = leaf_alloc_.allocate(1);
+    x->parent = nullptr;
+    x->position = 0;
+    x->count = 0;
+    x->leaf = true;
+    x->prev = nullptr;
+    x->next = nullptr;
+    return x;
+}
+
+// 分配一个空的内部节点
+template <class T, class Compare, class Alloc>
+typename btree<T, Compare, Alloc>::inner_ptr
+btree<T, Compare, Alloc>::
+create_inner() {
+    inner_ptr x = inner_allocator(leaf_alloc_).allocate(1);
+    x->parent = nullptr;
+    x->position = 0;
+    x->count = 0;
+    x->leaf = false;
+    return x;
+}
+
+// 析构叶节点中的元素并释放叶节点
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+destroy_leaf(leaf_base_ptr x) noexcept {
+    data_allocator data_alloc(leaf_alloc_);
+    T* v = values(x);
+    for (size_t i = 0; i < x->count; ++i)
+        data_alloc.destroy(v + i);
+    leaf_alloc_.deallocate(static_cast<leaf_ptr>(x), 1);
+}
+
+// 析构内部节点中的分隔键值并释放内部节点，不处理子节点
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+destroy_inner(base_ptr x) noexcept {
+    key_type* k = keys(x);
+    for (size_t i = 0; i < x->count; ++i)
+        ccystl::destroy(k + i);
+    inner_allocator(leaf_alloc_).deallocate(static_cast<inner_ptr>(x), 1);
+}
+
+// 释放以 x 为根的子树
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+destroy_subtree(base_ptr x) noexcept {
+    if (x->leaf) {
+        destroy_leaf(static_cast<leaf_base_ptr>(x));
+        return;
+    }
+    for (size_t i = 0; i <= x->count; ++i)
+        destroy_subtree(children(x)[i]);
+    destroy_inner(x);
+}
+
+// 把叶节点 x 链入 pos 之后
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+link_leaf_after(leaf_base_ptr x, leaf_base_ptr pos) noexcept {
+    x->prev = pos;
+    x->next = pos->next;
+    pos->next->prev = x;
+    pos->next = x;
+}
+
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+unlink_leaf(leaf_base_ptr x) noexcept {
+    x->prev->next = x->next;
+    x->next->prev = x->prev;
+}
+
+// 初始化为空树，不释放节点
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+btree_init() noexcept {
+    header_.parent = nullptr;
+    header_.position = 0;
+    header_.count = 0;
+    header_.leaf = true;
+    header_.prev = header();
+    header_.next = header();
+    root_ = nullptr;
+    size_ = 0;
+}
+
+// 交换 header 的内容后修正指向 header 的指针
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+relink_header() noexcept {
+    if (root_ == nullptr) {
+        header_.prev = header();
+        header_.next = header();
+    }
+    else {
+        header_.prev->next = header();
+        header_.next->prev = header();
+    }
+}
+
+// 接管 rhs 的所有节点，本树必须为空，完成后 rhs 为空树
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+steal(btree& rhs) noexcept {
+    if (rhs.root_ == nullptr)
+        return;
+    root_ = rhs.root_;
+    size_ = rhs.size_;
+    header_.prev = rhs.header_.prev;
+    header_.next = rhs.header_.next;
+    relink_header();
+    rhs.btree_init();
+}
+
+// 由 n 个已排序的元素自底向上建树，本树必须为空
+// 元素平均分到各叶节点，每层的节点数都取最少，因此除根节点外的节点都不少于半满
+template <class T, class Compare, class Alloc>
+template <class InputIterator>
+void btree<T, Compare, Alloc>::
+build_sorted(InputIterator first, size_type n) {
+    if (n == 0)
+        return;
+    ccystl::vector<base_ptr> level;
+    ccystl::vector<base_ptr> inners; // 已分配的内部节点，出错时释放
+    data_allocator data_alloc(leaf_alloc_);
+    try {
+        const size_type leaves = (n + leaf_slots - 1) / leaf_slots;
+        level.reserve(leaves);
+        for (size_type i = 0; i < leaves; ++i) {
+            const size_type m = n / leaves + (i < n % leaves ? 1 : 0);
+            leaf_ptr leaf = create_leaf();
+            link_leaf_after(leaf, header_.prev);
+            level.push_back(leaf);
+            T* v = leaf->values();
+            for (; leaf->count < m; ++first) {
+                data_alloc.construct(v + leaf->count, *first);
+                ++leaf->count;
+            }
+        }
+        while (level.size() > 1) {
+            const size_type m = level.size();
+            const size_type parents = (m + inner_slots) / (inner_slots + 1);
+            ccystl::vector<base_ptr> upper;
+            upper.reserve(parents);
+            for (size_type j = 0, c = 0; j < parents; ++j) {
+                const size_type k = m / parents + (j < m % parents ? 1 : 0);
+                inners.push_back(nullptr);
+                inner_ptr in = create_inner();
+                inners.back() = in;
+                for (size_type t = 0; t < k; ++t) {
+                    base_ptr child = level[c + t];
+                    if (t != 0) {
+                        ccystl::construct(in->keys() + in->count, min_key(child));
+                        ++in->count;
+                    }
+                    in->children[t] = child;
+                    child->parent = in;
+                    child->position = static_cast<uint16_t>(t);
+                }
+                c += k;
+                upper.push_back(in);
+            }
+            level.swap(upper);
+        }
+    }
+    catch (...) {
+        for (auto x : inners) {
+            if (x != nullptr)
+                destroy_inner(x);
+        }
+        for (leaf_base_ptr x = header_.next; x != header();) {
+            leaf_base_ptr next = x->next;
+            destroy_leaf(x);
+            x = next;
+        }
+        btree_init();
+        throw;
+    }
+    root_ = level[0];
+    root_->parent = nullptr;
+    size_ = n;
+}
+
+// 第一个键值不小于 key 的位置
+template <class T, class Compare, class Alloc>
+template <class K>
+typename btree<T, Compare, Alloc>::iterator
+btree<T, Compare, Alloc>::
+lower_pos(const K& key) const {
+    base_ptr x = root_;
+    if (x == nullptr)
+        return iterator(header(), 0);
+    while (!x->leaf) {
+        const key_type* k = keys(x);
+        size_t lo = 0, hi = x->count;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (key_comp_(k[mid], key))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        x = children(x)[lo];
+    }
+    leaf_base_ptr leaf = static_cast<leaf_base_ptr>(x);
+    const T* v = values(leaf);
+    size_t lo = 0, hi = leaf->count;
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (key_comp_(value_traits::get_key(v[mid]), key))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return iterator(leaf, lo);
+}
+
+// 第一个键值大于 key 的位置
+template <class T, class Compare, class Alloc>
+template <class K>
+typename btree<T, Compare, Alloc>::iterator
+btree<T, Compare, Alloc>::
+upper_pos(const K& key) const {
+    base_ptr x = root_;
+    if (x == nullptr)
+        return iterator(header(), 0);
+    while (!x->leaf) {
+        const key_type* k = keys(x);
+        size_t lo = 0, hi = x->count;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (!key_comp_(key, k[mid]))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        x = children(x)[lo];
+    }
+    leaf_base_ptr leaf = static_cast<leaf_base_ptr>(x);
+    const T* v = values(leaf);
+    size_t lo = 0, hi = leaf->count;
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (!key_comp_(key, value_traits::get_key(v[mid])))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return iterator(leaf, lo);
+}
+
+// 插入新值，键值不允许重复
+template <class T, class Compare, class Alloc>
+template <class V>
+ccystl::pair<typename btree<T, Compare, Alloc>::iterator, bool>
+btree<T, Compare, Alloc>::
+insert_unique_value(V&& value) {
+    const key_type& key = value_traits::get_key(value);
+    iterator pos = lower_pos(key);
+    iterator it = normalize(pos);
+    if (it != end() && !key_comp_(key, value_traits::get_key(*it)))
+        return ccystl::make_pair(it, false);
+    return ccystl::make_pair(insert_at(pos, key, ccystl::forward<V>(value)), true);
+}
+
+// 插入新值，键值不允许重复，hint 为 end() 且新值大于所有元素时直接插在最后
+template <class T, class Compare, class Alloc>
+template <class V>
+typename btree<T, Compare, Alloc>::iterator
+btree<T, Compare, Alloc>::
+insert_unique_use_hint(const_iterator hint, V&& value) {
+    const key_type& key = value_traits::get_key(value);
+    if (hint == end() && size_ != 0 && key_comp_(value_traits::get_key(*--end()), key))
+        return insert_at(iterator(header()->prev, header()->prev->count), key, ccystl::forward<V>(value));
+    return insert_unique_value(ccystl::forward<V>(value)).first;
+}
+
+// 在 pos 处构造新元素，key 为新元素的键值，叶节点已满时先分裂
+template <class T, class Compare, class Alloc>
+template <class... Args>
+typename btree<T, Compare, Alloc>::iterator
+btree<T, Compare, Alloc>::
+insert_at(iterator pos, const key_type& key, Args&&... args) {
+    leaf_base_ptr leaf = pos.node;
+    size_t index = pos.index;
+    if (root_ == nullptr) {
+        leaf = create_leaf();
+        link_leaf_after(leaf, header());
+        root_ = leaf;
+        index = 0;
+    }
+    else if (leaf->count == leaf_slots) {
+        try {
+            split_leaf(leaf, index, key);
+        }
+        catch (...) {
+            collapse_root();
+            throw;
+        }
+    }
+    T* v = values(leaf);
+    btree_relocate(v + index, v + leaf->count, v + index + 1);
+    try {
+        data_allocator(leaf_alloc_).construct(v + index, ccystl::forward<Args>(args)...);
+    }
+    catch (...) {
+        btree_relocate(v + index + 1, v + leaf->count + 1, v + index);
+        if (leaf->count == 0)
+            fix_leaf(leaf, index); // 新建的空叶节点
+        throw;
+    }
+    ++leaf->count;
+    ++size_;
+    return iterator(leaf, index);
+}
+
+// 分裂已满的叶节点，并把 (leaf, index) 调整为新元素应插入的位置
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+split_leaf(leaf_base_ptr& leaf, size_t& index, const key_type& key) {
+    base_ptr p = ensure_parent_room(leaf);
+    leaf_ptr right = create_leaf();
+    // 在末尾插入时左节点保持满，新元素单独进入右节点
+    const size_t mid = index == leaf_slots ? leaf_slots : leaf_slots / 2;
+    T* v = values(leaf);
+    try {
+        inner_insert(p, leaf->position, mid == leaf_slots ? key : value_traits::get_key(v[mid]), right);
+    }
+    catch (...) {
+        leaf_alloc_.deallocate(right, 1);
+        throw;
+    }
+    btree_relocate(v + mid, v + leaf->count, right->values());
+    right->count = static_cast<uint16_t>(leaf->count - mid);
+    leaf->count = static_cast<uint16_t>(mid);
+    link_leaf_after(right, leaf);
+    // 新元素不大于右节点的第一个元素时留在左节点，保证分隔键值不大于右节点的所有键值
+    if (index > mid || index == leaf_slots) {
+        leaf = right;
+        index -= mid;
+    }
+}
+
+// 分裂已满的内部节点，pos 为即将分裂的子节点的下标
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+split_inner(base_ptr node, size_t pos) {
+    base_ptr p = ensure_parent_room(node);
+    inner_ptr right = create_inner();
+    // 最后一个子节点分裂时左节点保持满
+    const size_t mid = pos == inner_slots ? inner_slots - 1 : inner_slots / 2;
+    key_type* k = keys(node);
+    try {
+        inner_insert(p, node->position, ccystl::move(k[mid]), right);
+    }
+    catch (...) {
+        inner_allocator(leaf_alloc_).deallocate(right, 1);
+        throw;
+    }
+    ccystl::destroy(k + mid);
+    btree_relocate(k + mid + 1, k + node->count, right->keys());
+    base_ptr* c = children(node);
+    for (size_t i = mid + 1; i <= node->count; ++i) {
+        base_ptr child = c[i];
+        right->children[i - mid - 1] = child;
+        child->parent = right;
+        child->position = static_cast<uint16_t>(i - mid - 1);
+    }
+    right->count = static_cast<uint16_t>(node->count - mid - 1);
+    node->count = static_cast<uint16_t>(mid);
+}
+
+// 保证 node 的父节点还能再放一个分隔键值，返回（可能已改变的）父节点
+template <class T, class Compare, class Alloc>
+typename btree<T, Compare, Alloc>::base_ptr
+btree<T, Compare, Alloc>::
+ensure_parent_room(base_ptr node) {
+    if (node->parent == nullptr) {
+        inner_ptr r = create_inner();
+        r->children[0] = node;
+        node->parent = r;
+        node->position = 0;
+        root_ = r;
+        return r;
+    }
+    if (node->parent->count == inner_slots)
+        split_inner(node->parent, node->position);
+    return node->parent;
+}
+
+// 在 p 的 keys[pos] 处插入分隔键值，在 children[pos + 1] 处插入子节点
+template <class T, class Compare, class Alloc>
+template <class K>
+void btree<T, Compare, Alloc>::
+inner_insert(base_ptr p, size_t pos, K&& key, base_ptr child) {
+    key_type* k = keys(p);
+    btree_relocate(k + pos, k + p->count, k + pos + 1);
+    try {
+        ccystl::construct(k + pos, ccystl::forward<K>(key));
+    }
+    catch (...) {
+        btree_relocate(k + pos + 1, k + p->count + 1, k + pos);
+        throw;
+    }
+    base_ptr* c = children(p);
+    std::memmove(c + pos + 2, c + pos + 1, (p->count - pos) * sizeof(base_ptr));
+    c[pos + 1] = child;
+    child->parent = p;
+    ++p->count;
+    for (size_t i = pos + 1; i <= p->count; ++i)
+        c[i]->position = static_cast<uint16_t>(i);
+}
+
+// 分裂失败后，去掉只有一个子节点的根
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+collapse_root() noexcept {
+    while (root_ != nullptr && !root_->leaf && root_->count == 0) {
+        base_ptr old = root_;
+        root_ = children(old)[0];
+        root_->parent = nullptr;
+        root_->position = 0;
+        destroy_inner(old);
+    }
+}
+
+// 删除 p 的 keys[pos] 与 children[pos + 1]，不释放子节点
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+inner_erase(base_ptr p, size_t pos) noexcept {
+    key_type* k = keys(p);
+    ccystl::destroy(k + pos);
+    btree_relocate(k + pos + 1, k + p->count, k + pos);
+    base_ptr* c = children(p);
+    std::memmove(c + pos + 1, c + pos + 2, (p->count - pos - 1) * sizeof(base_ptr));
+    --p->count;
+    for (size_t i = pos + 1; i <= p->count; ++i)
+        c[i]->position = static_cast<uint16_t>(i);
+}
+
+// 叶节点元素过少时向兄弟节点借一个元素或与之合并，(leaf, index) 随元素的移动而调整
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+fix_leaf(leaf_base_ptr& leaf, size_t& index) {
+    if (leaf == root_) {
+        if (leaf->count == 0) {
+            destroy_leaf(leaf);
+            btree_init();
+            leaf = header();
+            index = 0;
+        }
+        return;
+    }
+    base_ptr p = leaf->parent;
+    const size_t pos = leaf->position;
+    leaf_base_ptr left = pos > 0 ? static_cast<leaf_base_ptr>(children(p)[pos - 1]) : nullptr;
+    leaf_base_ptr right = pos < p->count ? static_cast<leaf_base_ptr>(children(p)[pos + 1]) : nullptr;
+    T* v = values(leaf);
+    if (left != nullptr && left->count > leaf_min) {
+        // 借左兄弟的最后一个元素
+        btree_relocate(v, v + leaf->count, v + 1);
+        btree_relocate(values(left) + left->count - 1, values(left) + left->count, v);
+        --left->count;
+        ++leaf->count;
+        keys(p)[pos - 1] = value_traits::get_key(v[0]);
+        ++index;
+        return;
+    }
+    if (right != nullptr && right->count > leaf_min) {
+        // 借右兄弟的第一个元素
+        T* rv = values(right);
+        btree_relocate(rv, rv + 1, v + leaf->count);
+        btree_relocate(rv + 1, rv + right->count, rv);
+        --right->count;
+        ++leaf->count;
+        keys(p)[pos] = value_traits::get_key(rv[0]);
+        return;
+    }
+    // 合并到左边的节点
+    if (left == nullptr) {
+        left = leaf;
+        leaf = right;
+    }
+    else {
+        index += left->count;
+    }
+    btree_relocate(values(leaf), values(leaf) + leaf->count, values(left) + left->count);
+    left->count = static_cast<uint16_t>(left->count + leaf->count);
+    leaf->count = 0;
+    unlink_leaf(leaf);
+    inner_erase(p, leaf->position - 1);
+    destroy_leaf(leaf);
+    leaf = left;
+    fix_inner(p);
+}
+
+// 内部节点分隔键值过少时，经由父节点向兄弟节点借一个子节点或与之合并
+template <class T, class Compare, class Alloc>
+void btree<T, Compare, Alloc>::
+fix_inner(base_ptr node) {
+    while (true) {
+        if (node == root_) {
+            collapse_root();
+            return;
+        }
+        if (node->count >= inner_min)
+            return;
+        base_ptr p = node->parent;
+        const size_t pos = node->position;
+        base_ptr left = pos > 0 ? children(p)[pos - 1] : nullptr;
+        base_ptr right = pos < p->count ? children(p)[pos + 1] : nullptr;
+        key_type* k = keys(node);
+        base_ptr* c = children(node);
+        if (left != nullptr && left->count > inner_min) {
+            // 右旋：父节点的分隔键值下移，左兄弟的最后一个键值上移
+            btree_relocate(k, k + node->count, k + 1);
+            std::memmove(c + 1, c, (node->count + 1) * sizeof(base_ptr));
+            ccystl::construct(k, ccystl::move(keys(p)[pos - 1]));
+            key_type* lk = keys(left);
+            keys(p)[pos - 1] = ccystl::move(lk[left->count - 1]);
+            ccystl::destroy(lk + left->count - 1);
+            c[0] = children(left)[left->count];
+            c[0]->parent = node;
+            --left->count;
+            ++node->count;
+            for (size_t i = 0; i <= node->count; ++i)
+                c[i]->position = static_cast<uint16_t>(i);
+            return;
+        }
+        if (right != nullptr && right->count > inner_min) {
+            // 左旋：父节点的分隔键值下移，右兄弟的第一个键值上移
+            key_type* rk = keys(right);
+            base_ptr* rc = children(right);
+            ccystl::construct(k + node->count, ccystl::move(keys(p)[pos]));
+            keys(p)[pos] = ccystl::move(rk[0]);
+            ccystl::destroy(rk);
+            btree_relocate(rk + 1, rk + right->count, rk);
+            c[node->count + 1] = rc[0];
+            rc[0]->parent = node;
+            rc[0]->position = static_cast<uint16_t>(node->count + 1);
+            std::memmove(rc, rc + 1, right->count * sizeof(base_ptr));
+            --right->count;
+            ++node->count;
+            for (size_t i = 0; i <= right->count; ++i)
+                rc[i]->position = static_cast<uint16_t>(i);
+            return;
+        }
+        // 与兄弟节点合并：左节点 + 父节点的分隔键值 + 右节点
+        if (left == nullptr) {
+            left = node;
+            node = right;
+        }
+        const size_t sep = node->position - 1;
+        key_type* lk = keys(left);
+        ccystl::construct(lk + left->count, ccystl::move(keys(p)[sep]));
+        btree_relocate(keys(node), keys(node) + node->count, lk + left->count + 1);
+        base_ptr* lc = children(left);
+        for (size_t i = 0; i <= node->count; ++i) {
+            base_ptr child = children(node)[i];
+            lc[left->count + 1 + i] = child;
+            child->parent = left;
+            child->position = static_cast<uint16_t>(left->count + 1 + i);
+        }
+        left->count = static_cast<uint16_t>(left->count + 1 + node->count);
+        node->count = 0;
+        inner_erase(p, sep);
+        destroy_inner(node);
+        node = p;
+    }
+}
+
+// 重载比较操作符
+template <class T, class Compare, class Alloc>
+bool operator==(const btree<T, Compare, Alloc>& lhs, const btree<T, Compare, Alloc>& rhs) {
+    return lhs.size() == rhs.size() && ccystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, class Compare, class Alloc>
+bool operator<(const btree<T, Compare, Alloc>& lhs, const btree<T, Compare, Alloc>& rhs) {
+    return ccystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, class Compare, class Alloc>
+bool operator!=(const btree<T, Compare, Alloc>& lhs, const btree<T, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class T, class Compare, class Alloc>
+bool operator>(const btree<T, Compare, Alloc>& lhs, const btree<T, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class T, class Compare, class Alloc>
+bool operator<=(const btree<T, Compare, Alloc>& lhs, const btree<T, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class T, class Compare, class Alloc>
+bool operator>=(const btree<T, Compare, Alloc>& lhs, const btree<T, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class T, class Compare, class Alloc>
+void swap(btree<T, Compare, Alloc>& lhs, btree<T, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+} // namespace ccystl
+#endif // !CCYSTL_BTREE_H_
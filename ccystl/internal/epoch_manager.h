@@ -0,0 +1,166 @@
+#ifndef CCYSTL_EPOCH_MANAGER_H_
+#define CCYSTL_EPOCH_MANAGER_H_
+
+// 这个头文件包含了基于 epoch 的内存回收（epoch-based reclamation）
+// epoch_manager : 进程内唯一的全局 epoch 与各线程的读者记录
+// epoch_guard   : 读者临界区，作用域内读到的共享节点不会被释放
+//
+// 用法：
+//   * 读者在访问无锁结构前构造 epoch_guard，离开作用域后不再持有任何节点指针
+//   * 写者把节点从结构中摘下后，记录当时的 epoch() 并暂存节点，
+//     之后定期调用 try_advance()，can_reclaim 成立的节点才能真正释放
+//
+// 正确性：
+// 读者进入临界区时公布自己看到的全局 epoch e，并确认公布之后全局 epoch 仍为 e。
+// 全局 epoch 只有在所有活跃读者都已公布当前值时才能前进，
+// 因此在 epoch e 摘下的节点，等全局 epoch 到达 e + 2 时，不会再有读者持有它。
+//
+// notes:
+//
+// 线程记录在线程退出后留给新线程复用，不会归还给系统（与 thread_cache_allocator 的线程堆相同）
+
+#include <atomic>
+#include <cstdint>
+
+namespace ccystl {
+class epoch_manager {
+public:
+    // 进程内唯一的实例
+    static epoch_manager& instance() noexcept {
+        static epoch_manager manager;
+        return manager;
+    }
+
+    // 当前的全局 epoch
+    uint64_t epoch() const noexcept {
+        return global_.load();
+    }
+
+    // 在 retire_epoch 摘下的节点，全局 epoch 为 now 时能否释放
+    static bool can_reclaim(uint64_t retire_epoch, uint64_t now) noexcept {
+        return retire_epoch + 2 <= now;
+    }
+
+    void enter();
+    void leave() noexcept;
+    uint64_t try_advance() noexcept;
+
+    epoch_manager(const epoch_manager&) = delete;
+    epoch_manager& operator=(const epoch_manager&) = delete;
+
+private:
+    // 每个线程一个读者记录，0 表示不在临界区内
+    struct record {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> in_use{true};
+        record* next = nullptr;  // 挂入记录链表后不再改变
+        size_t depth = 0;        // 临界区嵌套层数，只由所属线程访问
+    };
+
+    // 线程退出时交还记录
+    struct releaser {
+        ~releaser();
+    };
+
+    epoch_manager() noexcept = default;
+
+    static record*& tls_record() noexcept {
+        static thread_local record* rec = nullptr;
+        return rec;
+    }
+
+    record* local();
+    record* acquire();
+
+private:
+    std::atomic<uint64_t> global_{1};      // 全局 epoch，从 1 开始，0 留给不活跃的记录
+    std::atomic<record*> records_{nullptr}; // 所有线程记录，只增不减
+};
+
+// 读者临界区，支持嵌套
+class epoch_guard {
+public:
+    epoch_guard() {
+        epoch_manager::instance().enter();
+    }
+    ~epoch_guard() {
+        epoch_manager::instance().leave();
+    }
+
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+};
+
+// 方法实现
+
+inline epoch_manager::releaser::~releaser() {
+    record*& rec = tls_record();
+    if (rec != nullptr) {
+        rec->depth = 0;
+        rec->epoch.store(0);
+        rec->in_use.store(false);
+        rec = nullptr;
+    }
+}
+
+// 进入临界区：公布当前的全局 epoch，直到公布后全局 epoch 没有变化
+inline void epoch_manager::enter() {
+    record* rec = local();
+    if (rec->depth++ != 0)
+        return;
+    uint64_t e = global_.load();
+    for (;;) {
+        rec->epoch.store(e);
+        const uint64_t now = global_.load();
+        if (now == e)
+            break;
+        e = now;
+    }
+}
+
+inline void epoch_manager::leave() noexcept {
+    record* rec = tls_record();
+    if (rec != nullptr && --rec->depth == 0)
+        rec->epoch.store(0, std::memory_order_release);
+}
+
+// 所有活跃读者都已公布当前 epoch 时，把全局 epoch 加一，返回之后的全局 epoch
+inline uint64_t epoch_manager::try_advance() noexcept {
+    uint64_t e = global_.load();
+    for (record* rec = records_.load(); rec != nullptr; rec = rec->next) {
+        const uint64_t re = rec->epoch.load();
+        if (re != 0 && re != e)
+            return e;
+    }
+    global_.compare_exchange_strong(e, e + 1);
+    return global_.load();
+}
+
+inline epoch_manager::record* epoch_manager::local() {
+    record*& rec = tls_record();
+    if (rec == nullptr) {
+        rec = acquire();
+        // 首次访问 thread_local 的 releaser 会注册其析构函数；
+        // 若线程退出阶段（releaser 已析构）再次进入临界区，该记录不再交还，只占用一个记录
+        static thread_local releaser r;
+        (void)r;
+    }
+    return rec;
+}
+
+// 优先复用已退出线程留下的记录，没有则新建一个挂到链表头部
+inline epoch_manager::record* epoch_manager::acquire() {
+    for (record* rec = records_.load(); rec != nullptr; rec = rec->next) {
+        bool expected = false;
+        if (!rec->in_use.load() && rec->in_use.compare_exchange_strong(expected, true))
+            return rec;
+    }
+    record* rec = new record();
+    record* head = records_.load();
+    do {
+        rec->next = head;
+    } while (!records_.compare_exchange_weak(head, rec));
+    return rec;
+}
+} // namespace ccystl
+#endif // !CCYSTL_EPOCH_MANAGER_H_
@@ -0,0 +1,1028 @@
+#ifndef CCYSTL_FLAT_HASH_TABLE_H_
+#define CCYSTL_FLAT_HASH_TABLE_H_
+
+// 这个头文件包含了一个模板类 flat_hashtable
+// flat_hashtable : 开放寻址的哈希表，元素直接存放在连续的槽位数组中，不为每个元素单独分配节点
+//
+// 设计参照 SwissTable：
+//   * 每个槽位对应一个控制字节，空位为 ctrl_empty，删除后的墓碑为 ctrl_deleted，
+//     有元素时保存哈希值的低 7 位（h2）
+//   * 控制字节按组（group）探测，一组 16 个（SSE2）或 8 个（可移植实现），
+//     一次比较就能筛出组内所有 h2 相同的槽位，绝大多数查找只访问一次控制字节和一次槽位
+//   * 哈希值的高位（h1）决定起始组，组之间使用二次探测
+//   * 槽位数为组宽的 2 的幂次倍，最大负载因子固定为 7/8
+//
+// notes:
+//
+// 插入或 rehash 会使所有迭代器、指针和引用失效
+// 元素不可平凡重定位且移动构造可能抛出异常时，rehash 只提供基本异常保证
+
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <initializer_list>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CCYSTL_FLAT_HASH_SSE2 1
+#endif
+
+#include "ccystl/allocator/allocator.h"
+#include "ccystl/allocator/memory.h"
+#include "ccystl/internal/hash_table.h"
+#include "ccystl/internal/hashtable_stats.h"
+#include "ccystl/utils/except_def.h"
+#include "ccystl/utils/type_traits.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+// 控制字节
+typedef signed char fh_ctrl_type;
+
+constexpr fh_ctrl_type fh_ctrl_empty = -128;  // 0b10000000，空槽位
+constexpr fh_ctrl_type fh_ctrl_deleted = -2;  // 0b11111110，墓碑
+constexpr fh_ctrl_type fh_ctrl_sentinel = -1; // 0b11111111，控制字节数组末尾的哨兵，迭代到此停止
+
+inline bool fh_is_full(fh_ctrl_type c) noexcept {
+    return c >= 0;
+}
+
+inline bool fh_is_empty_or_deleted(fh_ctrl_type c) noexcept {
+    return c < fh_ctrl_sentinel;
+}
+
+inline size_t fh_h1(size_t hash) noexcept {
+    return hash >> 7;
+}
+
+inline fh_ctrl_type fh_h2(size_t hash) noexcept {
+    return static_cast<fh_ctrl_type>(hash & 0x7f);
+}
+
+// 组内匹配结果，每个匹配的槽位对应一个置位的比特
+// Shift 为每个槽位占用比特数的对数：SSE2 每槽 1 比特，可移植实现每槽 8 比特
+template <class Mask, int Shift>
+class fh_bitmask {
+public:
+    explicit fh_bitmask(Mask mask) noexcept : mask_(mask) { }
+
+    explicit operator bool() const noexcept {
+        return mask_ != 0;
+    }
+
+    // 最低的匹配槽位在组内的下标
+    size_t lowest() const noexcept {
+        return static_cast<size_t>(std::countr_zero(mask_)) >> Shift;
+    }
+
+    // 去掉最低的匹配槽位
+    void next() noexcept {
+        mask_ &= mask_ - 1;
+    }
+
+private:
+    Mask mask_;
+};
+
+#ifdef CCYSTL_FLAT_HASH_SSE2
+
+// SSE2 实现：一组 16 个控制字节，一条比较指令得到整组的匹配结果
+class fh_group {
+public:
+    static constexpr size_t width = 16;
+
+    typedef fh_bitmask<uint32_t, 0> bitmask;
+
+    explicit fh_group(const fh_ctrl_type* pos) noexcept
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) { }
+
+    // 控制字节等于 h2 的槽位
+    bitmask match(fh_ctrl_type h2) const noexcept {
+        return bitmask(static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_))));
+    }
+
+    bitmask match_empty() const noexcept {
+        return match(fh_ctrl_empty);
+    }
+
+    bitmask match_empty_or_deleted() const noexcept {
+        return bitmask(static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(fh_ctrl_sentinel), ctrl_))));
+    }
+
+    // 从组首开始连续的空位与墓碑的个数
+    size_t count_leading_empty_or_deleted() const noexcept {
+        const uint32_t mask = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(fh_ctrl_sentinel), ctrl_)));
+        return static_cast<size_t>(std::countr_one(mask));
+    }
+
+private:
+    __m128i ctrl_;
+};
+
+#else
+
+// 可移植实现：把 8 个控制字节装进一个 64 位整数，用位运算并行比较
+class fh_group {
+    static constexpr uint64_t lsbs = 0x0101010101010101ULL;
+    static constexpr uint64_t msbs = 0x8080808080808080ULL;
+
+public:
+    static constexpr size_t width = 8;
+
+    typedef fh_bitmask<uint64_t, 3> bitmask;
+
+    explicit fh_group(const fh_ctrl_type* pos) noexcept {
+        std::memcpy(&ctrl_, pos, sizeof(ctrl_));
+        if constexpr (std::endian::native == std::endian::big)
+            ctrl_ = byte_swap(ctrl_);
+    }
+
+    // 控制字节等于 h2 的槽位，可能有误报，调用者总会再比较键值
+    bitmask match(fh_ctrl_type h2) const noexcept {
+        const uint64_t x = ctrl_ ^ (lsbs * static_cast<unsigned char>(h2));
+        return bitmask((x - lsbs) & ~x & msbs);
+    }
+
+    bitmask match_empty() const noexcept {
+        return bitmask((ctrl_ & ~(ctrl_ << 6)) & msbs);
+    }
+
+    bitmask match_empty_or_deleted() const noexcept {
+        return bitmask((ctrl_ & ~(ctrl_ << 7)) & msbs);
+    }
+
+    // 从组首开始连续的空位与墓碑的个数
+    size_t count_leading_empty_or_deleted() const noexcept {
+        const uint64_t full_or_sentinel = ~ctrl_ & msbs | (ctrl_ << 7) & msbs;
+        return static_cast<size_t>(std::countr_zero(full_or_sentinel)) >> 3;
+    }
+
+private:
+    static uint64_t byte_swap(uint64_t x) noexcept {
+        uint64_t r = 0;
+        for (int i = 0; i < 8; ++i, x >>= 8)
+            r = (r << 8) | (x & 0xff);
+        return r;
+    }
+
+    uint64_t ctrl_;
+};
+
+#endif // CCYSTL_FLAT_HASH_SSE2
+
+// 组之间的二次探测序列，组数为 2 的幂次时能遍历所有组
+class fh_probe_seq {
+public:
+    fh_probe_seq(size_t hash, size_t group_mask) noexcept
+        : mask_(group_mask), offset_(hash & group_mask), index_(0) { }
+
+    // 当前组第一个槽位的下标
+    size_t offset() const noexcept {
+        return offset_ * fh_group::width;
+    }
+
+    void next() noexcept {
+        ++index_;
+        offset_ = (offset_ + index_) & mask_;
+    }
+
+private:
+    size_t mask_;
+    size_t offset_;
+    size_t index_;
+};
+
+template <class T, class Hash, class KeyEqual, class Alloc = ccystl::allocator<T>>
+class flat_hashtable;
+
+// flat_hashtable 的迭代器，同时指向控制字节与对应的槽位
+template <class T, class Ref, class Ptr>
+struct flat_ht_iterator : public iterator<forward_iterator_tag, T> {
+    typedef flat_ht_iterator<T, T&, T*> iterator;
+    typedef flat_ht_iterator<T, const T&, const T*> const_iterator;
+    typedef flat_ht_iterator self;
+
+    typedef T value_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    fh_ctrl_type* ctrl; // 当前槽位的控制字节
+    T* slot; // 当前槽位
+
+    flat_ht_iterator() noexcept : ctrl(nullptr), slot(nullptr) { }
+
+    flat_ht_iterator(fh_ctrl_type* c, T* s) noexcept : ctrl(c), slot(s) { }
+
+    flat_ht_iterator(const iterator& rhs) noexcept : ctrl(rhs.ctrl), slot(rhs.slot) { }
+
+    reference operator*() const {
+        return *slot;
+    }
+
+    pointer operator->() const {
+        return slot;
+    }
+
+    self& operator++() {
+        ++ctrl;
+        ++slot;
+        skip_empty_or_deleted();
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const noexcept {
+        return ctrl == rhs.ctrl;
+    }
+
+    bool operator!=(const self& rhs) const noexcept {
+        return ctrl != rhs.ctrl;
+    }
+
+    // 跳过空位与墓碑，停在下一个元素或末尾的哨兵上
+    void skip_empty_or_deleted() noexcept {
+        while (fh_is_empty_or_deleted(*ctrl)) {
+            const size_t shift = fh_group(ctrl).count_leading_empty_or_deleted();
+            ctrl += shift;
+            slot += shift;
+        }
+    }
+};
+
+// 模板类 flat_hashtable，键值不允许重复
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数，参数四代表分配器类型
+template <class T, class Hash, class KeyEqual, class Alloc>
+class flat_hashtable {
+public:
+    // flat_hashtable 的型别定义
+    typedef ht_value_traits<T> value_traits;
+    typedef typename value_traits::key_type key_type;
+    typedef typename value_traits::mapped_type mapped_type;
+    typedef typename value_traits::value_type value_type;
+    typedef Hash hasher;
+    typedef KeyEqual key_equal;
+
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
+    typedef typename Alloc::template rebind<fh_ctrl_type>::other ctrl_allocator;
+
+    typedef typename allocator_type::pointer pointer;
+    typedef typename allocator_type::const_pointer const_pointer;
+    typedef typename allocator_type::reference reference;
+    typedef typename allocator_type::const_reference const_reference;
+    typedef typename allocator_type::size_type size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef flat_ht_iterator<T, T&, T*> iterator;
+    typedef flat_ht_iterator<T, const T&, const T*> const_iterator;
+
+    static constexpr size_type group_width = fh_group::width;
+
+    allocator_type get_allocator() const {
+        return allocator_type(data_alloc_);
+    }
+
+private:
+    // 空表不分配任何空间，ctrl_ 与 slots_ 均为空
+    fh_ctrl_type* ctrl_ = nullptr; // 控制字节数组，长度为 capacity_ + group_width
+    value_type* slots_ = nullptr; // 槽位数组，长度为 capacity_
+    size_type capacity_ = 0; // 槽位数，为 0 或 group_width 的 2 的幂次倍
+    size_type size_ = 0; // 元素个数
+    size_type growth_left_ = 0; // 不触发 rehash 还能占用的空位数
+    hasher hash_;
+    key_equal equal_;
+    [[no_unique_address]] data_allocator data_alloc_; // 槽位分配器，控制字节的分配器由它转换得到
+    [[no_unique_address]] ht_stats_recorder<> stats_; // rehash 的历史记录，未定义 CCYSTL_HASHTABLE_STATS 时为空类
+
+public:
+    // 构造、复制、移动、析构函数
+    flat_hashtable() = default;
+
+    explicit flat_hashtable(size_type bucket_count,
+                            const Hash& hash = Hash(),
+                            const KeyEqual& equal = KeyEqual(),
+                            const allocator_type& alloc = allocator_type())
+        : hash_(hash), equal_(equal), data_alloc_(alloc) {
+        if (bucket_count != 0)
+            resize(normalize_capacity(bucket_count));
+    }
+
+    flat_hashtable(const flat_hashtable& rhs)
+        : flat_hashtable(rhs, rhs.get_allocator()) {
+    }
+
+    flat_hashtable(const flat_hashtable& rhs, const allocator_type& alloc)
+        : hash_(rhs.hash_), equal_(rhs.equal_), data_alloc_(alloc) {
+        copy_init(rhs);
+    }
+
+    flat_hashtable(flat_hashtable&& rhs) noexcept
+        : ctrl_(rhs.ctrl_), slots_(rhs.slots_), capacity_(rhs.capacity_),
+          size_(rhs.size_), growth_left_(rhs.growth_left_),
+          hash_(rhs.hash_), equal_(rhs.equal_), data_alloc_(rhs.data_alloc_),
+          stats_(ccystl::move(rhs.stats_)) {
+        rhs.reset();
+    }
+
+    flat_hashtable& operator=(const flat_hashtable& rhs);
+    flat_hashtable& operator=(flat_hashtable&& rhs) noexcept(std::is_empty_v<data_allocator>);
+
+    ~flat_hashtable() {
+        destroy_slots();
+        deallocate_arrays(ctrl_, slots_, capacity_);
+    }
+
+    // 迭代器相关操作
+    iterator begin() noexcept {
+        if (size_ == 0)
+            return end();
+        iterator it(ctrl_, slots_);
+        it.skip_empty_or_deleted();
+        return it;
+    }
+
+    const_iterator begin() const noexcept {
+        return const_cast<flat_hashtable*>(this)->begin();
+    }
+
+    iterator end() noexcept {
+        return iterator(ctrl_ + capacity_, slots_ + capacity_);
+    }
+
+    const_iterator end() const noexcept {
+        return const_cast<flat_hashtable*>(this)->end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // 容量相关操作
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept {
+        return size_;
+    }
+
+    size_type max_size() const noexcept {
+        return static_cast<size_type>(-1) / sizeof(value_type);
+    }
+
+    // 修改容器相关操作
+
+    // emplace / insert，键值不允许重复
+    // 先构造出元素再取键值查找，已存在时丢弃该元素
+    template <class... Args>
+    pair<iterator, bool> emplace_unique(Args&&... args);
+
+    template <class... Args>
+    iterator emplace_unique_use_hint(const_iterator /*hint*/, Args&&... args) {
+        return emplace_unique(ccystl::forward<Args>(args)...).first;
+    }
+
+    pair<iterator, bool> insert_unique(const value_type& value) {
+        return insert_key_first(value_traits::get_key(value), value);
+    }
+
+    pair<iterator, bool> insert_unique(value_type&& value) {
+        return insert_key_first(value_traits::get_key(value), ccystl::move(value));
+    }
+
+    iterator insert_unique_use_hint(const_iterator /*hint*/, const value_type& value) {
+        return insert_unique(value).first;
+    }
+
+    iterator insert_unique_use_hint(const_iterator /*hint*/, value_type&& value) {
+        return insert_unique(ccystl::move(value)).first;
+    }
+
+    template <class InputIter>
+    void insert_unique(InputIter first, InputIter last) {
+        if constexpr (is_forward_iterator<InputIter>::value)
+            reserve(size_ + static_cast<size_type>(ccystl::distance(first, last)));
+        for (; first != last; ++first)
+            insert_unique(*first);
+    }
+
+    // 键值不存在时以 key 与 mapped_type(args...) 构造元素，供 map 的 operator[] 与 try_emplace 使用
+    template <class K, class... Args>
+    pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return insert_key_first(key, ccystl::forward<K>(key),
+                                mapped_type(ccystl::forward<Args>(args)...));
+    }
+
+    // erase / clear
+    iterator erase(const_iterator position);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase_unique(const key_type& key);
+
+    void clear() noexcept;
+
+    void swap(flat_hashtable& rhs) noexcept;
+
+    // 查找相关操作
+    template <class K>
+    size_type count(const K& key) const {
+        return find_index(key, hash_of(key)) != capacity_ ? 1 : 0;
+    }
+
+    template <class K>
+    iterator find(const K& key) {
+        return iterator_at(find_index(key, hash_of(key)));
+    }
+
+    template <class K>
+    const_iterator find(const K& key) const {
+        return const_cast<flat_hashtable*>(this)->find(key);
+    }
+
+    template <class K>
+    bool contains(const K& key) const {
+        return count(key) != 0;
+    }
+
+    template <class K>
+    pair<iterator, iterator> equal_range_unique(const K& key) {
+        iterator it = find(key);
+        iterator next = it;
+        return it == end() ? ccystl::make_pair(it, it) : ccystl::make_pair(it, ++next);
+    }
+
+    template <class K>
+    pair<const_iterator, const_iterator> equal_range_unique(const K& key) const {
+        auto p = const_cast<flat_hashtable*>(this)->equal_range_unique(key);
+        return ccystl::make_pair(const_iterator(p.first), const_iterator(p.second));
+    }
+
+    // bucket interface，开放寻址时每个槽位就是一个 bucket
+
+    size_type bucket_count() const noexcept {
+        return capacity_;
+    }
+
+    size_type max_bucket_count() const noexcept {
+        return max_size();
+    }
+
+    // hash policy
+
+    float load_factor() const noexcept {
+        return capacity_ != 0 ? static_cast<float>(size_) / static_cast<float>(capacity_) : 0.0f;
+    }
+
+    // 最大负载因子固定为 7/8
+    float max_load_factor() const noexcept {
+        return 0.875f;
+    }
+
+    void max_load_factor(float /*ml*/) noexcept { }
+
+    void rehash(size_type count);
+
+    void reserve(size_type count) {
+        if (count > growth_left_ + size_)
+            resize(capacity_for(count));
+    }
+
+    // 统计信息，见 hashtable_stats.h
+    // 链长统计的是各元素的探测长度，以组为单位：位于起始组的元素为 1，每多探测一组加 1
+    hashtable_stats stats() const;
+
+    void reset_stats() noexcept {
+        stats_.reset();
+    }
+
+    hasher hash_fcn() const {
+        return hash_;
+    }
+
+    key_equal key_eq() const {
+        return equal_;
+    }
+
+    // 元素个数相等且 lhs 的每个元素都能在 rhs 中找到相等的元素
+    bool equal_unique(const flat_hashtable& rhs) const;
+
+private:
+    // helper functions
+
+    template <class K>
+    size_type hash_of(const K& key) const {
+        return ht_mix(hash_(key)); // 用户的哈希函数可能质量不高，先混合再拆出 h1 与 h2
+    }
+
+    iterator iterator_at(size_type i) noexcept {
+        return iterator(ctrl_ + i, slots_ + i);
+    }
+
+    size_type index_of(const_iterator it) const noexcept {
+        return static_cast<size_type>(it.ctrl - ctrl_);
+    }
+
+    // 槽位数的取值：不小于 n 的 group_width 的 2 的幂次倍
+    static size_type normalize_capacity(size_type n) noexcept {
+        return n <= group_width ? group_width : std::bit_ceil(n);
+    }
+
+    // 能容纳 n 个元素的最小槽位数
+    static size_type capacity_for(size_type n) noexcept {
+        if (n == 0)
+            return 0;
+        return normalize_capacity(n + (n - 1) / 7);
+    }
+
+    // 最大负载因子 7/8 下能容纳的元素个数
+    static size_type max_growth(size_type capacity) noexcept {
+        return capacity - capacity / 8;
+    }
+
+    template <class K>
+    size_type find_index(const K& key, size_type hash) const;
+    pair<size_type, bool> find_or_prepare_insert(const key_type& key, size_type hash);
+    size_type find_first_non_full(size_type hash) const noexcept;
+    size_type prepare_insert(size_type hash);
+    void commit_insert(size_type i, size_type hash) noexcept;
+
+    template <class... Args>
+    pair<iterator, bool> insert_key_first(const key_type& key, Args&&... args);
+
+    void set_ctrl(size_type i, fh_ctrl_type c) noexcept {
+        ctrl_[i] = c;
+    }
+
+    void erase_at(size_type i) noexcept;
+
+    void resize(size_type new_capacity);
+    void rehash_and_grow();
+
+    void allocate_arrays(size_type capacity, fh_ctrl_type*& ctrl, value_type*& slots);
+    void deallocate_arrays(fh_ctrl_type* ctrl, value_type* slots, size_type capacity) noexcept;
+    void destroy_slots() noexcept;
+    void copy_init(const flat_hashtable& rhs);
+    void reset() noexcept;
+};
+
+/*****************************************************************************************/
+
+// 复制赋值运算符
+template <class T, class Hash, class KeyEqual, class Alloc>
+flat_hashtable<T, Hash, KeyEqual, Alloc>&
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+operator=(const flat_hashtable& rhs) {
+    if (this != &rhs) {
+        flat_hashtable tmp(rhs, get_allocator());
+        swap(tmp);
+    }
+    return *this;
+}
+
+// 移动赋值运算符
+template <class T, class Hash, class KeyEqual, class Alloc>
+flat_hashtable<T, Hash, KeyEqual, Alloc>&
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+operator=(flat_hashtable&& rhs) noexcept(std::is_empty_v<data_allocator>) {
+    if (this == &rhs)
+        return *this;
+    if (data_alloc_ == rhs.data_alloc_) {
+        flat_hashtable tmp(ccystl::move(rhs));
+        swap(tmp);
+    }
+    else {
+        // 分配器不随移动赋值传播，逐个移动元素到使用本容器分配器的新表中
+        flat_hashtable tmp(0, rhs.hash_, rhs.equal_, get_allocator());
+        tmp.reserve(rhs.size_);
+        for (auto& value : rhs)
+            tmp.insert_unique(ccystl::move(value));
+        rhs.clear();
+        swap(tmp);
+    }
+    return *this;
+}
+
+// 就地构造元素，键值不允许重复
+// 强异常安全保证
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+pair<typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+emplace_unique(Args&&... args) {
+    value_type tmp(ccystl::forward<Args>(args)...);
+    return insert_key_first(value_traits::get_key(tmp), ccystl::move(tmp));
+}
+
+// 先按键值查找，不存在时才在空出的槽位上构造元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+pair<typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+insert_key_first(const key_type& key, Args&&... args) {
+    const size_type hash = hash_of(key);
+    auto res = find_or_prepare_insert(key, hash);
+    if (res.second)
+        return ccystl::make_pair(iterator_at(res.first), false);
+    // 构造成功后才写入控制字节，构造抛出异常时容器保持不变
+    data_alloc_.construct(slots_ + res.first, ccystl::forward<Args>(args)...);
+    commit_insert(res.first, hash);
+    return ccystl::make_pair(iterator_at(res.first), true);
+}
+
+// 删除迭代器所指的元素，返回下一个元素的迭代器
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase(const_iterator position) {
+    const size_type i = index_of(position);
+    erase_at(i);
+    iterator next = iterator_at(i);
+    next.skip_empty_or_deleted();
+    return next;
+}
+
+// 删除 [first, last) 内的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::iterator
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase(const_iterator first, const_iterator last) {
+    if (first == cbegin() && last == cend()) {
+        clear();
+        return end();
+    }
+    while (first != last)
+        first = erase(first);
+    return iterator_at(index_of(last));
+}
+
+// 删除键值为 key 的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase_unique(const key_type& key) {
+    const size_type i = find_index(key, hash_of(key));
+    if (i == capacity_)
+        return 0;
+    erase_at(i);
+    return 1;
+}
+
+// 清空元素，保留槽位数组
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+clear() noexcept {
+    if (capacity_ == 0)
+        return;
+    destroy_slots();
+    std::memset(ctrl_, fh_ctrl_empty, capacity_);
+    size_ = 0;
+    growth_left_ = max_growth(capacity_);
+}
+
+// 交换 flat_hashtable
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+swap(flat_hashtable& rhs) noexcept {
+    if (this != &rhs) {
+        ccystl::swap(ctrl_, rhs.ctrl_);
+        ccystl::swap(slots_, rhs.slots_);
+        ccystl::swap(capacity_, rhs.capacity_);
+        ccystl::swap(size_, rhs.size_);
+        ccystl::swap(growth_left_, rhs.growth_left_);
+        ccystl::swap(hash_, rhs.hash_);
+        ccystl::swap(equal_, rhs.equal_);
+        ccystl::swap(data_alloc_, rhs.data_alloc_);
+        stats_.swap(rhs.stats_);
+    }
+}
+
+// 重新调整槽位数，使其不小于 count 且能容纳现有元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+rehash(size_type count) {
+    size_type new_capacity = capacity_for(size_);
+    if (count != 0)
+        new_capacity = ccystl::max(new_capacity, normalize_capacity(count));
+    if (new_capacity != capacity_)
+        resize(new_capacity);
+}
+
+// 统计信息：重新计算每个元素的哈希值，沿探测序列数出它所在的组是第几组
+template <class T, class Hash, class KeyEqual, class Alloc>
+hashtable_stats flat_hashtable<T, Hash, KeyEqual, Alloc>::
+stats() const {
+    hashtable_stats s;
+    s.size = size_;
+    s.bucket_count = capacity_;
+    s.load_factor = load_factor();
+    s.max_load_factor = max_load_factor();
+    size_type total = 0;
+    for (size_type i = 0; i < capacity_; ++i) {
+        if (ctrl_[i] == fh_ctrl_empty) {
+            ++s.empty_buckets;
+            continue;
+        }
+        if (ctrl_[i] == fh_ctrl_deleted) {
+            ++s.tombstones;
+            continue;
+        }
+        fh_probe_seq seq(fh_h1(hash_of(value_traits::get_key(slots_[i]))), capacity_ / group_width - 1);
+        size_type len = 1;
+        for (; seq.offset() != (i & ~(group_width - 1)); seq.next())
+            ++len;
+        s.add_chain(len);
+        total += len;
+    }
+    s.average_chain_length = size_ != 0 ? static_cast<double>(total) / static_cast<double>(size_) : 0.0;
+    s.node_bytes = capacity_ * sizeof(value_type);
+    s.bucket_bytes = ctrl_ != nullptr ? (capacity_ + group_width) * sizeof(fh_ctrl_type) : 0;
+    stats_.fill(s);
+    return s;
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+bool flat_hashtable<T, Hash, KeyEqual, Alloc>::
+equal_unique(const flat_hashtable& rhs) const {
+    if (size_ != rhs.size_)
+        return false;
+    for (auto it = begin(), last = end(); it != last; ++it) {
+        auto res = rhs.find(value_traits::get_key(*it));
+        if (res == rhs.end() || !(*res == *it))
+            return false;
+    }
+    return true;
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 查找键值为 key 的元素所在的槽位，找不到时返回 capacity_
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class K>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+find_index(const K& key, size_type hash) const {
+    if (size_ == 0)
+        return capacity_;
+    const fh_ctrl_type h2 = fh_h2(hash);
+    fh_probe_seq seq(fh_h1(hash), capacity_ / group_width - 1);
+    while (true) {
+        fh_group group(ctrl_ + seq.offset());
+        for (auto match = group.match(h2); match; match.next()) {
+            const size_type i = seq.offset() + match.lowest();
+            if (equal_(value_traits::get_key(slots_[i]), key))
+                return i;
+        }
+        // 组内有空位说明插入时不曾越过这一组，键值不存在
+        if (group.match_empty())
+            return capacity_;
+        seq.next();
+    }
+}
+
+// 查找 key，找到时返回其槽位与 true；否则返回可以放入新元素的槽位与 false，但不写入控制字节
+template <class T, class Hash, class KeyEqual, class Alloc>
+pair<typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type, bool>
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+find_or_prepare_insert(const key_type& key, size_type hash) {
+    const size_type i = find_index(key, hash);
+    if (i != capacity_)
+        return ccystl::make_pair(i, true);
+    return ccystl::make_pair(prepare_insert(hash), false);
+}
+
+// 探测序列中第一个空位或墓碑
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+find_first_non_full(size_type hash) const noexcept {
+    fh_probe_seq seq(fh_h1(hash), capacity_ / group_width - 1);
+    while (true) {
+        auto mask = fh_group(ctrl_ + seq.offset()).match_empty_or_deleted();
+        if (mask)
+            return seq.offset() + mask.lowest();
+        seq.next();
+    }
+}
+
+// 为哈希值为 hash 的新元素找一个槽位，必要时先 rehash
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename flat_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+flat_hashtable<T, Hash, KeyEqual, Alloc>::
+prepare_insert(size_type hash) {
+    THROW_LENGTH_ERROR_IF(size_ == max_size(), "flat_hashtable's size too big");
+    if (capacity_ == 0) {
+        resize(group_width);
+        return find_first_non_full(hash);
+    }
+    size_type i = find_first_non_full(hash);
+    // 复用墓碑不消耗空位，只有占用空位且空位额度用尽时才需要 rehash
+    if (growth_left_ == 0 && ctrl_[i] != fh_ctrl_deleted) {
+        rehash_and_grow();
+        i = find_first_non_full(hash);
+    }
+    return i;
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+commit_insert(size_type i, size_type hash) noexcept {
+    growth_left_ -= (ctrl_[i] == fh_ctrl_empty);
+    set_ctrl(i, fh_h2(hash));
+    ++size_;
+}
+
+// 删除第 i 个槽位的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+erase_at(size_type i) noexcept {
+    data_alloc_.destroy(slots_ + i);
+    --size_;
+    // 所在组还有空位时，从上次 rehash 以来探测都不会越过这一组，可以直接置为空位；
+    // 否则可能有元素的探测序列经过这里，只能留下墓碑
+    const size_type group_start = i & ~(group_width - 1);
+    if (fh_group(ctrl_ + group_start).match_empty()) {
+        set_ctrl(i, fh_ctrl_empty);
+        ++growth_left_;
+    }
+    else {
+        set_ctrl(i, fh_ctrl_deleted);
+    }
+}
+
+// 把所有元素重新放入 new_capacity 个槽位中，同时清除墓碑
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+resize(size_type new_capacity) {
+    stats_.record_rehash(size_, capacity_, new_capacity);
+    typename ht_stats_recorder<>::timer timer(stats_);
+    fh_ctrl_type* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    const size_type old_capacity = capacity_;
+
+    fh_ctrl_type* new_ctrl = nullptr;
+    value_type* new_slots = nullptr;
+    allocate_arrays(new_capacity, new_ctrl, new_slots);
+    ctrl_ = new_ctrl;
+    slots_ = new_slots;
+    capacity_ = new_capacity;
+
+    size_type moved = 0;
+    try {
+        for (size_type i = 0; i != old_capacity; ++i) {
+            if (!fh_is_full(old_ctrl[i]))
+                continue;
+            const size_type hash = hash_of(value_traits::get_key(old_slots[i]));
+            const size_type j = find_first_non_full(hash);
+            if constexpr (is_trivially_relocatable_v<value_type>) {
+                std::memcpy(static_cast<void*>(slots_ + j), static_cast<const void*>(old_slots + i),
+                            sizeof(value_type));
+            }
+            else {
+                data_alloc_.construct(slots_ + j, ccystl::move(old_slots[i]));
+            }
+            set_ctrl(j, fh_h2(hash));
+            ++moved;
+        }
+    }
+    catch (...) {
+        // 只有非平凡重定位的元素会走到这里：销毁新表中已构造的元素，旧表保持原样
+        for (size_type j = 0; j != new_capacity; ++j) {
+            if (fh_is_full(new_ctrl[j]))
+                data_alloc_.destroy(new_slots + j);
+        }
+        deallocate_arrays(new_ctrl, new_slots, new_capacity);
+        ctrl_ = old_ctrl;
+        slots_ = old_slots;
+        capacity_ = old_capacity;
+        throw;
+    }
+    if constexpr (!is_trivially_relocatable_v<value_type>) {
+        for (size_type i = 0; i != old_capacity; ++i) {
+            if (fh_is_full(old_ctrl[i]))
+                data_alloc_.destroy(old_slots + i);
+        }
+    }
+    deallocate_arrays(old_ctrl, old_slots, old_capacity);
+    size_ = moved;
+    growth_left_ = max_growth(new_capacity) - moved;
+}
+
+// 空位额度用尽时调用：墓碑较多时原样大小重建即可，否则加倍
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+rehash_and_grow() {
+    if (size_ <= max_growth(capacity_) / 2)
+        resize(capacity_);
+    else
+        resize(capacity_ * 2);
+}
+
+// 分配控制字节与槽位数组，控制字节全部置为空位，末尾放置哨兵
+// 控制字节数组多出 group_width 个字节，使从任意位置开始读取一组都不会越界
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+allocate_arrays(size_type capacity, fh_ctrl_type*& ctrl, value_type*& slots) {
+    if (capacity == 0) {
+        ctrl = nullptr;
+        slots = nullptr;
+        return;
+    }
+    THROW_LENGTH_ERROR_IF(capacity > max_size(), "flat_hashtable's size too big");
+    ctrl_allocator ctrl_alloc(data_alloc_);
+    ctrl = ctrl_alloc.allocate(capacity + group_width);
+    try {
+        slots = data_alloc_.allocate(capacity);
+    }
+    catch (...) {
+        ctrl_alloc.deallocate(ctrl, capacity + group_width);
+        throw;
+    }
+    std::memset(ctrl, fh_ctrl_empty, capacity + group_width);
+    ctrl[capacity] = fh_ctrl_sentinel;
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+deallocate_arrays(fh_ctrl_type* ctrl, value_type* slots, size_type capacity) noexcept {
+    if (capacity == 0)
+        return;
+    ctrl_allocator(data_alloc_).deallocate(ctrl, capacity + group_width);
+    data_alloc_.deallocate(slots, capacity);
+}
+
+// 析构所有元素，不修改控制字节
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+destroy_slots() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+        for (size_type i = 0; i != capacity_; ++i) {
+            if (fh_is_full(ctrl_[i]))
+                data_alloc_.destroy(slots_ + i);
+        }
+    }
+}
+
+// 复制 rhs 的控制字节，把元素复制到相同的槽位上，无需重新计算哈希值
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+copy_init(const flat_hashtable& rhs) {
+    if (rhs.size_ == 0)
+        return;
+    allocate_arrays(rhs.capacity_, ctrl_, slots_);
+    capacity_ = rhs.capacity_;
+    size_type i = 0;
+    try {
+        for (; i != capacity_; ++i) {
+            if (fh_is_full(rhs.ctrl_[i]))
+                data_alloc_.construct(slots_ + i, rhs.slots_[i]);
+        }
+    }
+    catch (...) {
+        while (i != 0) {
+            --i;
+            if (fh_is_full(rhs.ctrl_[i]))
+                data_alloc_.destroy(slots_ + i);
+        }
+        deallocate_arrays(ctrl_, slots_, capacity_);
+        reset();
+        throw;
+    }
+    std::memcpy(ctrl_, rhs.ctrl_, capacity_ + group_width);
+    size_ = rhs.size_;
+    growth_left_ = rhs.growth_left_;
+}
+
+// 置为不持有任何空间的空表
+template <class T, class Hash, class KeyEqual, class Alloc>
+void flat_hashtable<T, Hash, KeyEqual, Alloc>::
+reset() noexcept {
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    growth_left_ = 0;
+}
+
+// 重载 ccystl 的 swap
+template <class T, class Hash, class KeyEqual, class Alloc>
+void swap(flat_hashtable<T, Hash, KeyEqual, Alloc>& lhs,
+          flat_hashtable<T, Hash, KeyEqual, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+} // namespace ccystl
+
+#endif // !CCYSTL_FLAT_HASH_TABLE_H_
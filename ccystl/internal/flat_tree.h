@@ -0,0 +1,928 @@
+#ifndef CCYSTL_FLAT_TREE_H_
+#define CCYSTL_FLAT_TREE_H_
+
+// 这个头文件包含一个模板类 flat_tree
+// flat_tree : 有序向量，flat_set / flat_multiset / flat_map / flat_multimap 的底层实现
+//
+// 设计：
+//   * 键值按升序存放在一个 ccystl::vector 中，查找用 ccystl::lower_bound 在连续内存上二分，
+//     顺序遍历只是移动指针，没有 rb_tree 那样的指针追逐
+//   * 映射的实值存放在另一个 vector 中，与键值按下标一一对应。查找只访问键值数组，
+//     实值不会挤占键值所在的缓存行
+//   * 集合的迭代器就是指向键值的指针；映射的迭代器同时持有两个数组中的指针，
+//     解引用得到 pair<const Key&, T&>
+//   * 成批构造时整体排序、去重一次；成批插入时先把新元素排好序，再与原有元素合并，
+//     代价为 O(n + m log m)，而不是逐个插入的 O(m * n)
+//
+// notes:
+//
+// 单个插入、删除要移动其后的所有元素，代价为 O(n)，适合构造后以查找为主的场景
+// 插入与删除会使所有迭代器、指针和引用失效
+// 成批插入时范围内的等价键值之间不保证先后次序；键值不允许重复时，原有元素优先于新元素保留
+//
+// 异常保证：
+// 单个插入满足强异常安全保证，成批插入与删除满足基本异常安全保证
+
+#include <type_traits>
+
+#include "ccystl/algorithm/algo.h"
+#include "ccystl/container/sequence_container/vector.h"
+#include "ccystl/functor/functional.h"
+#include "ccystl/iterator/iterator.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+// flat_map 的迭代器设计
+// 迭代器由指向键值与实值的两个指针组成，两个指针总是同步移动
+
+// operator-> 返回的代理对象，内含一个由引用组成的 pair
+template <class Reference>
+struct flat_map_arrow_proxy {
+    Reference ref;
+
+    Reference* operator->() noexcept {
+        return &ref;
+    }
+};
+
+template <class Key>
+struct flat_map_iterator_base {
+    const Key* key; // 指向键值
+
+    flat_map_iterator_base() : key(nullptr) { }
+
+    explicit flat_map_iterator_base(const Key* k) : key(k) { }
+
+    ptrdiff_t operator-(const flat_map_iterator_base& rhs) const {
+        return key - rhs.key;
+    }
+
+    bool operator==(const flat_map_iterator_base& rhs) const {
+        return key == rhs.key;
+    }
+
+    bool operator!=(const flat_map_iterator_base& rhs) const {
+        return key != rhs.key;
+    }
+
+    bool operator<(const flat_map_iterator_base& rhs) const {
+        return key < rhs.key;
+    }
+
+    bool operator>(const flat_map_iterator_base& rhs) const {
+        return key > rhs.key;
+    }
+
+    bool operator<=(const flat_map_iterator_base& rhs) const {
+        return key <= rhs.key;
+    }
+
+    bool operator>=(const flat_map_iterator_base& rhs) const {
+        return key >= rhs.key;
+    }
+};
+
+template <class Key, class T>
+struct flat_map_iterator;
+template <class Key, class T>
+struct flat_map_const_iterator;
+
+template <class Key, class T>
+struct flat_map_iterator : public flat_map_iterator_base<Key> {
+    typedef random_access_iterator_tag iterator_category;
+    typedef ccystl::pair<Key, T> value_type;
+    typedef ptrdiff_t difference_type;
+    typedef ccystl::pair<const Key&, T&> reference;
+    typedef flat_map_arrow_proxy<reference> pointer;
+
+    typedef flat_map_iterator<Key, T> iterator;
+    typedef flat_map_const_iterator<Key, T> const_iterator;
+    typedef iterator self;
+
+    using flat_map_iterator_base<Key>::key;
+    using flat_map_iterator_base<Key>::operator-;
+
+    T* value; // 指向实值
+
+    // 构造函数
+    flat_map_iterator() : value(nullptr) { }
+
+    flat_map_iterator(const Key* k, T* v)
+        : flat_map_iterator_base<Key>(k), value(v) { }
+
+    flat_map_iterator(const const_iterator& rhs)
+        : flat_map_iterator_base<Key>(rhs.key), value(const_cast<T*>(rhs.value)) { }
+
+    // 重载操作符
+    reference operator*() const {
+        return reference(*key, *value);
+    }
+
+    pointer operator->() const {
+        return pointer{**this};
+    }
+
+    reference operator[](difference_type n) const {
+        return reference(key[n], value[n]);
+    }
+
+    self& operator++() {
+        ++key, ++value;
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    self& operator--() {
+        --key, --value;
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp(*this);
+        --*this;
+        return tmp;
+    }
+
+    self& operator+=(difference_type n) {
+        key += n, value += n;
+        return *this;
+    }
+
+    self& operator-=(difference_type n) {
+        key -= n, value -= n;
+        return *this;
+    }
+
+    self operator+(difference_type n) const {
+        return self(key + n, value + n);
+    }
+
+    self operator-(difference_type n) const {
+        return self(key - n, value - n);
+    }
+};
+
+template <class Key, class T>
+struct flat_map_const_iterator : public flat_map_iterator_base<Key> {
+    typedef random_access_iterator_tag iterator_category;
+    typedef ccystl::pair<Key, T> value_type;
+    typedef ptrdiff_t difference_type;
+    typedef ccystl::pair<const Key&, const T&> reference;
+    typedef flat_map_arrow_proxy<reference> pointer;
+
+    typedef flat_map_iterator<Key, T> iterator;
+    typedef flat_map_const_iterator<Key, T> const_iterator;
+    typedef const_iterator self;
+
+    using flat_map_iterator_base<Key>::key;
+    using flat_map_iterator_base<Key>::operator-;
+
+    const T* value; // 指向实值
+
+    // 构造函数
+    flat_map_const_iterator() : value(nullptr) { }
+
+    flat_map_const_iterator(const Key* k, const T* v)
+        : flat_map_iterator_base<Key>(k), value(v) { }
+
+    flat_map_const_iterator(const iterator& rhs)
+        : flat_map_iterator_base<Key>(rhs.key), value(rhs.value) { }
+
+    // 重载操作符
+    reference operator*() const {
+        return reference(*key, *value);
+    }
+
+    pointer operator->() const {
+        return pointer{**this};
+    }
+
+    reference operator[](difference_type n) const {
+        return reference(key[n], value[n]);
+    }
+
+    self& operator++() {
+        ++key, ++value;
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    self& operator--() {
+        --key, --value;
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp(*this);
+        --*this;
+        return tmp;
+    }
+
+    self& operator+=(difference_type n) {
+        key += n, value += n;
+        return *this;
+    }
+
+    self& operator-=(difference_type n) {
+        key -= n, value -= n;
+        return *this;
+    }
+
+    self operator+(difference_type n) const {
+        return self(key + n, value + n);
+    }
+
+    self operator-(difference_type n) const {
+        return self(key - n, value - n);
+    }
+};
+
+// flat_tree 的型别萃取，Mapped 为 void 时为集合
+
+struct flat_tree_no_values { };
+
+template <class Key, class Mapped, class Alloc>
+struct flat_tree_traits {
+    typedef ccystl::pair<Key, Mapped> value_type;
+    typedef ccystl::vector<Mapped, typename Alloc::template rebind<Mapped>::other> mapped_container;
+    typedef flat_map_iterator<Key, Mapped> iterator;
+    typedef flat_map_const_iterator<Key, Mapped> const_iterator;
+
+    static const Key& get_key(const value_type& value) noexcept {
+        return value.first;
+    }
+};
+
+template <class Key, class Alloc>
+struct flat_tree_traits<Key, void, Alloc> {
+    typedef Key value_type;
+    typedef flat_tree_no_values mapped_container;
+    typedef const Key* iterator;
+    typedef const Key* const_iterator;
+
+    static const Key& get_key(const value_type& value) noexcept {
+        return value;
+    }
+};
+
+// 模板类 flat_tree
+// 参数一代表键值类型，参数二代表实值类型，为 void 时表示集合，参数三代表键值比较类型，参数四代表分配器类型
+template <class Key, class Mapped, class Compare, class Alloc = ccystl::allocator<Key>>
+class flat_tree {
+public:
+    // flat_tree 的嵌套型别定义
+
+    typedef flat_tree_traits<Key, Mapped, Alloc> tree_traits;
+
+    static constexpr bool is_map = !std::is_void_v<Mapped>;
+
+    typedef Key key_type;
+    typedef Mapped mapped_type;
+    typedef typename tree_traits::value_type value_type;
+    typedef Compare key_compare;
+
+    typedef Alloc allocator_type;
+    typedef ccystl::vector<Key, typename Alloc::template rebind<Key>::other> key_container;
+    typedef typename tree_traits::mapped_container mapped_container;
+    typedef ccystl::vector<value_type, typename Alloc::template rebind<value_type>::other> value_buffer;
+
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    typedef typename tree_traits::iterator iterator;
+    typedef typename tree_traits::const_iterator const_iterator;
+    typedef typename iterator_traits<iterator>::reference reference;
+    typedef typename iterator_traits<const_iterator>::reference const_reference;
+    typedef typename iterator_traits<iterator>::pointer pointer;
+    typedef typename iterator_traits<const_iterator>::pointer const_pointer;
+    typedef ccystl::reverse_iterator<iterator> reverse_iterator;
+    typedef ccystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    allocator_type get_allocator() const {
+        return allocator_type(keys_.get_allocator());
+    }
+
+    key_compare key_comp() const {
+        return key_comp_;
+    }
+
+private:
+    // 用以下数据表现 flat_tree
+    key_container keys_;                              // 升序排列的键值
+    [[no_unique_address]] mapped_container values_;   // 与键值按下标对应的实值，集合不使用
+    [[no_unique_address]] key_compare key_comp_;      // 键值比较的准则
+
+public:
+    // 构造、复制、移动函数
+    flat_tree() = default;
+
+    explicit flat_tree(const allocator_type& alloc)
+        : keys_(alloc), values_(make_values(alloc)), key_comp_() { }
+
+    explicit flat_tree(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : keys_(alloc), values_(make_values(alloc)), key_comp_(comp) { }
+
+    flat_tree(const flat_tree& rhs) = default;
+
+    flat_tree(const flat_tree& rhs, const allocator_type& alloc)
+        : keys_(rhs.keys_, alloc), values_(copy_values(rhs.values_, alloc)), key_comp_(rhs.key_comp_) { }
+
+    flat_tree(flat_tree&& rhs) noexcept = default;
+
+    flat_tree& operator=(const flat_tree& rhs) = default;
+    flat_tree& operator=(flat_tree&& rhs) = default;
+
+public:
+    // 迭代器相关操作
+
+    iterator begin() noexcept {
+        return make_iter(0);
+    }
+
+    const_iterator begin() const noexcept {
+        return make_iter(0);
+    }
+
+    iterator end() noexcept {
+        return make_iter(size());
+    }
+
+    const_iterator end() const noexcept {
+        return make_iter(size());
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // 容量相关操作
+
+    bool empty() const noexcept {
+        return keys_.empty();
+    }
+
+    size_type size() const noexcept {
+        return keys_.size();
+    }
+
+    size_type max_size() const noexcept {
+        return keys_.max_size();
+    }
+
+    size_type capacity() const noexcept {
+        return keys_.capacity();
+    }
+
+    void reserve(size_type n) {
+        keys_.reserve(n);
+        if constexpr (is_map)
+            values_.reserve(n);
+    }
+
+    void shrink_to_fit() {
+        keys_.shrink_to_fit();
+        if constexpr (is_map)
+            values_.shrink_to_fit();
+    }
+
+    // 底层数组
+
+    const key_container& keys() const noexcept {
+        return keys_;
+    }
+
+    const mapped_container& values() const noexcept {
+        return values_;
+    }
+
+    // 插入删除相关操作
+
+    // emplace，先构造出元素再查找位置
+
+    template <class... Args>
+    iterator emplace_multi(Args&&... args) {
+        value_type value(ccystl::forward<Args>(args)...);
+        return insert_multi(ccystl::move(value));
+    }
+
+    template <class... Args>
+    ccystl::pair<iterator, bool> emplace_unique(Args&&... args) {
+        value_type value(ccystl::forward<Args>(args)...);
+        return insert_unique(ccystl::move(value));
+    }
+
+    template <class... Args>
+    iterator emplace_multi_use_hint(const_iterator hint, Args&&... args) {
+        value_type value(ccystl::forward<Args>(args)...);
+        return insert_multi(hint, ccystl::move(value));
+    }
+
+    template <class... Args>
+    iterator emplace_unique_use_hint(const_iterator hint, Args&&... args) {
+        value_type value(ccystl::forward<Args>(args)...);
+        return insert_unique(hint, ccystl::move(value));
+    }
+
+    // insert
+
+    iterator insert_multi(const value_type& value) {
+        return insert_at(upper_index(get_key(value)), value);
+    }
+
+    iterator insert_multi(value_type&& value) {
+        return insert_at(upper_index(get_key(value)), ccystl::move(value));
+    }
+
+    iterator insert_multi(const_iterator hint, const value_type& value) {
+        return insert_at(multi_hint_index(hint, get_key(value)), value);
+    }
+
+    iterator insert_multi(const_iterator hint, value_type&& value) {
+        return insert_at(multi_hint_index(hint, get_key(value)), ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert_multi(InputIterator first, InputIterator last) {
+        insert_range(first, last, false, false);
+    }
+
+    // 范围已按键值升序排列时不再排序
+    template <class InputIterator>
+    void insert_multi(sorted_equivalent_t, InputIterator first, InputIterator last) {
+        insert_range(first, last, false, true);
+    }
+
+    ccystl::pair<iterator, bool> insert_unique(const value_type& value) {
+        const size_type i = lower_index(get_key(value));
+        if (i != size() && !key_comp_(get_key(value), keys_[i]))
+            return ccystl::pair<iterator, bool>(make_iter(i), false);
+        return ccystl::pair<iterator, bool>(insert_at(i, value), true);
+    }
+
+    ccystl::pair<iterator, bool> insert_unique(value_type&& value) {
+        const size_type i = lower_index(get_key(value));
+        if (i != size() && !key_comp_(get_key(value), keys_[i]))
+            return ccystl::pair<iterator, bool>(make_iter(i), false);
+        return ccystl::pair<iterator, bool>(insert_at(i, ccystl::move(value)), true);
+    }
+
+    iterator insert_unique(const_iterator hint, const value_type& value) {
+        const size_type i = unique_hint_index(hint, get_key(value));
+        if (i != size() && !key_comp_(get_key(value), keys_[i]))
+            return make_iter(i);
+        return insert_at(i, value);
+    }
+
+    iterator insert_unique(const_iterator hint, value_type&& value) {
+        const size_type i = unique_hint_index(hint, get_key(value));
+        if (i != size() && !key_comp_(get_key(value), keys_[i]))
+            return make_iter(i);
+        return insert_at(i, ccystl::move(value));
+    }
+
+    template <class InputIterator>
+    void insert_unique(InputIterator first, InputIterator last) {
+        insert_range(first, last, true, false);
+    }
+
+    // 范围已按键值升序排列且没有重复时不再排序
+    template <class InputIterator>
+    void insert_unique(sorted_unique_t, InputIterator first, InputIterator last) {
+        insert_range(first, last, true, true);
+    }
+
+    // erase，返回指向下一个元素的迭代器
+
+    iterator erase(const_iterator position) {
+        const size_type i = index_of(position);
+        keys_.erase(keys_.begin() + i);
+        if constexpr (is_map)
+            values_.erase(values_.begin() + i);
+        return make_iter(i);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return erase_index(index_of(first), index_of(last));
+    }
+
+    template <class K>
+    size_type erase_multi(const K& key) {
+        const size_type first = lower_index(key);
+        const size_type last = upper_index(key);
+        erase_index(first, last);
+        return last - first;
+    }
+
+    template <class K>
+    size_type erase_unique(const K& key) {
+        const size_type i = lower_index(key);
+        if (i == size() || key_comp_(key, keys_[i]))
+            return 0;
+        erase_index(i, i + 1);
+        return 1;
+    }
+
+    void clear() {
+        keys_.clear();
+        if constexpr (is_map)
+            values_.clear();
+    }
+
+    // flat_tree 相关操作
+
+    template <class K>
+    iterator find(const K& key) {
+        return make_iter(find_index(key));
+    }
+
+    template <class K>
+    const_iterator find(const K& key) const {
+        return make_iter(find_index(key));
+    }
+
+    template <class K>
+    size_type count_multi(const K& key) const {
+        return upper_index(key) - lower_index(key);
+    }
+
+    template <class K>
+    size_type count_unique(const K& key) const {
+        return find_index(key) != size() ? 1 : 0;
+    }
+
+    template <class K>
+    iterator lower_bound(const K& key) {
+        return make_iter(lower_index(key));
+    }
+
+    template <class K>
+    const_iterator lower_bound(const K& key) const {
+        return make_iter(lower_index(key));
+    }
+
+    template <class K>
+    iterator upper_bound(const K& key) {
+        return make_iter(upper_index(key));
+    }
+
+    template <class K>
+    const_iterator upper_bound(const K& key) const {
+        return make_iter(upper_index(key));
+    }
+
+    template <class K>
+    ccystl::pair<iterator, iterator>
+    equal_range_multi(const K& key) {
+        return ccystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    template <class K>
+    ccystl::pair<const_iterator, const_iterator>
+    equal_range_multi(const K& key) const {
+        return ccystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    template <class K>
+    ccystl::pair<iterator, iterator>
+    equal_range_unique(const K& key) {
+        const size_type i = find_index(key);
+        return ccystl::pair<iterator, iterator>(make_iter(i), make_iter(i == size() ? i : i + 1));
+    }
+
+    template <class K>
+    ccystl::pair<const_iterator, const_iterator>
+    equal_range_unique(const K& key) const {
+        const size_type i = find_index(key);
+        return ccystl::pair<const_iterator, const_iterator>(make_iter(i), make_iter(i == size() ? i : i + 1));
+    }
+
+    void swap(flat_tree& rhs) noexcept {
+        keys_.swap(rhs.keys_);
+        if constexpr (is_map)
+            values_.swap(rhs.values_);
+        ccystl::swap(key_comp_, rhs.key_comp_);
+    }
+
+private:
+    // helper functions
+
+    static const key_type& get_key(const value_type& value) noexcept {
+        return tree_traits::get_key(value);
+    }
+
+    static mapped_container make_values(const allocator_type& alloc) {
+        if constexpr (is_map)
+            return mapped_container(alloc);
+        else
+            return mapped_container();
+    }
+
+    static mapped_container copy_values(const mapped_container& rhs, const allocator_type& alloc) {
+        if constexpr (is_map)
+            return mapped_container(rhs, alloc);
+        else
+            return mapped_container();
+    }
+
+    iterator make_iter(size_type i) noexcept {
+        if constexpr (is_map)
+            return iterator(keys_.data() + i, values_.data() + i);
+        else
+            return keys_.data() + i;
+    }
+
+    const_iterator make_iter(size_type i) const noexcept {
+        if constexpr (is_map)
+            return const_iterator(keys_.data() + i, values_.data() + i);
+        else
+            return keys_.data() + i;
+    }
+
+    size_type index_of(const_iterator it) const noexcept {
+        if constexpr (is_map)
+            return static_cast<size_type>(it.key - keys_.data());
+        else
+            return static_cast<size_type>(it - keys_.data());
+    }
+
+    template <class K>
+    size_type lower_index(const K& key) const {
+        return static_cast<size_type>(ccystl::lower_bound(keys_.begin(), keys_.end(), key, key_comp_) - keys_.begin());
+    }
+
+    template <class K>
+    size_type upper_index(const K& key) const {
+        return static_cast<size_type>(ccystl::upper_bound(keys_.begin(), keys_.end(), key, key_comp_) - keys_.begin());
+    }
+
+    // 找不到时返回 size()
+    template <class K>
+    size_type find_index(const K& key) const {
+        const size_type i = lower_index(key);
+        return i == size() || key_comp_(key, keys_[i]) ? size() : i;
+    }
+
+    // hint 恰好是插入位置时直接使用，否则重新查找
+    size_type unique_hint_index(const_iterator hint, const key_type& key) const {
+        const size_type i = index_of(hint);
+        if ((i == size() || key_comp_(key, keys_[i])) && (i == 0 || key_comp_(keys_[i - 1], key)))
+            return i;
+        return lower_index(key);
+    }
+
+    size_type multi_hint_index(const_iterator hint, const key_type& key) const {
+        const size_type i = index_of(hint);
+        if ((i == size() || !key_comp_(keys_[i], key)) && (i == 0 || !key_comp_(key, keys_[i - 1])))
+            return i;
+        return upper_index(key);
+    }
+
+    template <class V>
+    iterator insert_at(size_type i, V&& value);
+
+    iterator erase_index(size_type first, size_type last);
+
+    template <class InputIterator>
+    void insert_range(InputIterator first, InputIterator last, bool unique, bool sorted);
+
+    void merge_keys(size_type n, bool unique, bool sorted);
+    void merge_values(value_buffer& buf, bool unique, bool sorted);
+};
+
+/*****************************************************************************************/
+
+// 在下标 i 处插入元素
+template <class Key, class Mapped, class Compare, class Alloc>
+template <class V>
+typename flat_tree<Key, Mapped, Compare, Alloc>::iterator
+flat_tree<Key, Mapped, Compare, Alloc>::
+insert_at(size_type i, V&& value) {
+    if constexpr (is_map) {
+        keys_.insert(keys_.begin() + i, ccystl::forward<V>(value).first);
+        try {
+            values_.insert(values_.begin() + i, ccystl::forward<V>(value).second);
+        }
+        catch (...) {
+            keys_.erase(keys_.begin() + i);
+            throw;
+        }
+    }
+    else {
+        keys_.insert(keys_.begin() + i, ccystl::forward<V>(value));
+    }
+    return make_iter(i);
+}
+
+// 删除下标 [first, last) 内的元素
+template <class Key, class Mapped, class Compare, class Alloc>
+typename flat_tree<Key, Mapped, Compare, Alloc>::iterator
+flat_tree<Key, Mapped, Compare, Alloc>::
+erase_index(size_type first, size_type last) {
+    if (first == 0 && last == size()) {
+        clear();
+    }
+    else if (first != last) {
+        keys_.erase(keys_.begin() + first, keys_.begin() + last);
+        if constexpr (is_map)
+            values_.erase(values_.begin() + first, values_.begin() + last);
+    }
+    return make_iter(first);
+}
+
+// 成批插入：集合把新键值追加到末尾后排序、合并；映射先把新元素放进临时数组排序，再与原有元素合并
+template <class Key, class Mapped, class Compare, class Alloc>
+template <class InputIterator>
+void flat_tree<Key, Mapped, Compare, Alloc>::
+insert_range(InputIterator first, InputIterator last, bool unique, bool sorted) {
+    if (first == last)
+        return;
+    if constexpr (is_map) {
+        value_buffer buf(get_allocator());
+        for (; first != last; ++first)
+            buf.emplace_back(*first);
+        merge_values(buf, unique, sorted);
+    }
+    else {
+        const size_type n = size();
+        try {
+            for (; first != last; ++first)
+                keys_.emplace_back(*first);
+        }
+        catch (...) {
+            keys_.erase(keys_.begin() + n, keys_.end());
+            throw;
+        }
+        merge_keys(n, unique, sorted);
+    }
+}
+
+// 把 [n, size()) 内新追加的键值稳定排序，再用 inplace_merge 与 [0, n) 合并
+// 两步都是稳定的：等价键值中原有的排在新的前面，新的之间保持插入的次序
+template <class Key, class Mapped, class Compare, class Alloc>
+void flat_tree<Key, Mapped, Compare, Alloc>::
+merge_keys(size_type n, bool unique, bool sorted) {
+    const auto first = keys_.begin();
+    const auto middle = first + n;
+    if (!sorted)
+        ccystl::stable_sort(middle, keys_.end(), key_comp_);
+    // 新键值都不小于原有的最大键值时无需合并，顺序追加时常见
+    if (n != 0 && key_comp_(*middle, *(middle - 1)))
+        ccystl::inplace_merge(first, middle, keys_.end(), key_comp_);
+    if (unique) {
+        // inplace_merge 是稳定的，等价键值中原有的排在前面，unique 保留第一个
+        auto equiv = [this](const key_type& lhs, const key_type& rhs) {
+            return !key_comp_(lhs, rhs);
+        };
+        keys_.erase(ccystl::unique(keys_.begin(), keys_.end(), equiv), keys_.end());
+    }
+}
+
+// 把 buf 中的新元素稳定排序后与原有元素合并，键值与实值各自写入新的数组
+// 键值不允许重复时，unique 保留新元素中第一次出现的，合并时保留原有的元素
+template <class Key, class Mapped, class Compare, class Alloc>
+void flat_tree<Key, Mapped, Compare, Alloc>::
+merge_values(value_buffer& buf, bool unique, bool sorted) {
+    auto less = [this](const value_type& lhs, const value_type& rhs) {
+        return key_comp_(lhs.first, rhs.first);
+    };
+    if (!sorted)
+        ccystl::stable_sort(buf.begin(), buf.end(), less);
+    if (unique) {
+        auto equiv = [this](const value_type& lhs, const value_type& rhs) {
+            return !key_comp_(lhs.first, rhs.first);
+        };
+        buf.erase(ccystl::unique(buf.begin(), buf.end(), equiv), buf.end());
+    }
+
+    const size_type n = size();
+    const size_type m = buf.size();
+    // 新元素都大于原有的最大键值时直接追加，顺序追加时常见
+    if (n == 0 || (unique ? key_comp_(keys_.back(), buf.front().first)
+                          : !key_comp_(buf.front().first, keys_.back()))) {
+        reserve(n + m);
+        try {
+            for (size_type j = 0; j < m; ++j) {
+                keys_.emplace_back(ccystl::move(buf[j].first));
+                values_.emplace_back(ccystl::move(buf[j].second));
+            }
+        }
+        catch (...) {
+            keys_.erase(keys_.begin() + n, keys_.end());
+            values_.erase(values_.begin() + n, values_.end());
+            throw;
+        }
+        return;
+    }
+
+    key_container keys(keys_.get_allocator());
+    mapped_container values(values_.get_allocator());
+    keys.reserve(n + m);
+    values.reserve(n + m);
+    size_type i = 0, j = 0;
+    while (i < n && j < m) {
+        if (key_comp_(buf[j].first, keys_[i])) {
+            keys.emplace_back(ccystl::move(buf[j].first));
+            values.emplace_back(ccystl::move(buf[j].second));
+            ++j;
+        }
+        else if (unique && !key_comp_(keys_[i], buf[j].first)) {
+            ++j; // 键值已存在，保留原有元素
+        }
+        else {
+            // 等价键值中原有的排在前面
+            keys.emplace_back(ccystl::move(keys_[i]));
+            values.emplace_back(ccystl::move(values_[i]));
+            ++i;
+        }
+    }
+    for (; i < n; ++i) {
+        keys.emplace_back(ccystl::move(keys_[i]));
+        values.emplace_back(ccystl::move(values_[i]));
+    }
+    for (; j < m; ++j) {
+        keys.emplace_back(ccystl::move(buf[j].first));
+        values.emplace_back(ccystl::move(buf[j].second));
+    }
+    keys_.swap(keys);
+    values_.swap(values);
+}
+
+// 重载比较操作符
+template <class Key, class Mapped, class Compare, class Alloc>
+bool operator==(const flat_tree<Key, Mapped, Compare, Alloc>& lhs, const flat_tree<Key, Mapped, Compare, Alloc>& rhs) {
+    if constexpr (flat_tree<Key, Mapped, Compare, Alloc>::is_map)
+        return lhs.keys() == rhs.keys() && lhs.values() == rhs.values();
+    else
+        return lhs.keys() == rhs.keys();
+}
+
+template <class Key, class Mapped, class Compare, class Alloc>
+bool operator<(const flat_tree<Key, Mapped, Compare, Alloc>& lhs, const flat_tree<Key, Mapped, Compare, Alloc>& rhs) {
+    return ccystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class Key, class Mapped, class Compare, class Alloc>
+bool operator!=(const flat_tree<Key, Mapped, Compare, Alloc>& lhs, const flat_tree<Key, Mapped, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class Mapped, class Compare, class Alloc>
+bool operator>(const flat_tree<Key, Mapped, Compare, Alloc>& lhs, const flat_tree<Key, Mapped, Compare, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <class Key, class Mapped, class Compare, class Alloc>
+bool operator<=(const flat_tree<Key, Mapped, Compare, Alloc>& lhs, const flat_tree<Key, Mapped, Compare, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <class Key, class Mapped, class Compare, class Alloc>
+bool operator>=(const flat_tree<Key, Mapped, Compare, Alloc>& lhs, const flat_tree<Key, Mapped, Compare, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
+
+// 重载 ccystl 的 swap
+template <class Key, class Mapped, class Compare, class Alloc>
+void swap(flat_tree<Key, Mapped, Compare, Alloc>& lhs, flat_tree<Key, Mapped, Compare, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+} // namespace ccystl
+#endif // !CCYSTL_FLAT_TREE_H_
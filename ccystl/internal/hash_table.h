@@ -4,19 +4,41 @@
 // 这个头文件包含了一个模板类 hashtable
 // hashtable : 哈希表，使用开链法处理冲突
 
+#include <bit>
+#include <cstdint>
 #include <initializer_list>
+#include <type_traits>
 #include <ccystl/allocator/allocator.h>
 
 #include "ccystl/algorithm/algo.h"
 #include "ccystl/allocator/memory.h"
+#include "ccystl/allocator/memory_resource.h"
 #include "ccystl/container/sequence_container/vector.h"
+#include "ccystl/internal/hashtable_stats.h"
+#include "ccystl/internal/node_handle.h"
 #include "ccystl/utils/except_def.h"
 #include "ccystl/utils/utils.h"
 
 namespace ccystl {
+// 是否在节点中缓存完整的哈希值
+// 缓存后 rehash 不再调用哈希函数，沿链表查找时先比较哈希值，不相等就不必调用 KeyEqual
+// 缺省只对非标量的键值（如字符串）缓存，标量的哈希与比较都很便宜，不值得每个节点多占一个 size_t
+// 可以针对自己的键值与哈希函数特化此模板来改变选择
+template <class Key, class Hash>
+struct ht_cache_hash_code : std::bool_constant<!std::is_scalar_v<Key>> { };
+
+// 节点中保存哈希值的部分，不缓存时为空基类
+template <bool CacheHash>
+struct hashtable_node_hash {
+    size_t hash_code; // 键值的完整哈希值
+};
+
+template <>
+struct hashtable_node_hash<false> { };
+
 // hashtable 的节点定义
-template <class T>
-struct hashtable_node {
+template <class T, bool CacheHash = false>
+struct hashtable_node : hashtable_node_hash<CacheHash> {
     hashtable_node* next; // 指向下一个节点
     T value; // 储存实值
 
@@ -24,9 +46,11 @@ struct hashtable_node {
 
     explicit hashtable_node(const T& n) : next(nullptr), value(n) { }
 
-    hashtable_node(const hashtable_node& node) : next(node.next), value(node.value) { }
+    hashtable_node(const hashtable_node& node)
+        : hashtable_node_hash<CacheHash>(node), next(node.next), value(node.value) { }
 
-    hashtable_node(hashtable_node&& node) noexcept : next(node.next), value(ccystl::move(node.value)) {
+    hashtable_node(hashtable_node&& node) noexcept
+        : hashtable_node_hash<CacheHash>(node), next(node.next), value(ccystl::move(node.value)) {
         node.next = nullptr;
     }
 };
@@ -87,33 +111,43 @@ struct ht_value_traits {
     }
 };
 
+// 由值类型与哈希函数决定的节点类型
+template <class T, class Hash>
+using ht_node_t = hashtable_node<T, ht_cache_hash_code<typename ht_value_traits<T>::key_type, Hash>::value>;
+
+
+// bucket 策略，定义见 ht_next_prime 之后
+struct ht_prime_policy;
+struct ht_power2_policy;
+struct ht_fastrange_policy;
 
 // forward declaration
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class Alloc = ccystl::allocator<T>,
+          class BucketPolicy = ht_prime_policy>
 class hashtable;
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class Alloc, class BucketPolicy>
 struct ht_iterator;
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class Alloc, class BucketPolicy>
 struct ht_const_iterator;
 
-template <class T>
+template <class T, bool CacheHash>
 struct ht_local_iterator;
 
-template <class T>
+template <class T, bool CacheHash>
 struct ht_const_local_iterator;
 
 // ht_iterator
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 struct ht_iterator_base : iterator<forward_iterator_tag, T> {
-    typedef hashtable<T, Hash, KeyEqual> hashtable;
-    typedef ht_iterator_base<T, Hash, KeyEqual> base;
-    typedef ht_iterator<T, Hash, KeyEqual> iterator;
-    typedef ht_const_iterator<T, Hash, KeyEqual> const_iterator;
-    typedef hashtable_node<T>* node_ptr;
+    typedef hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy> hashtable;
+    typedef ht_iterator_base<T, Hash, KeyEqual, Alloc, BucketPolicy> base;
+    typedef ht_iterator<T, Hash, KeyEqual, Alloc, BucketPolicy> iterator;
+    typedef ht_const_iterator<T, Hash, KeyEqual, Alloc, BucketPolicy> const_iterator;
+    typedef ht_node_t<T, Hash>* node_ptr;
     typedef hashtable* contain_ptr;
     typedef const node_ptr const_node_ptr;
     typedef const contain_ptr const_contain_ptr;
@@ -135,9 +169,9 @@ struct ht_iterator_base : iterator<forward_iterator_tag, T> {
     }
 };
 
-template <class T, class Hash, class KeyEqual>
-struct ht_iterator : ht_iterator_base<T, Hash, KeyEqual> {
-    typedef ht_iterator_base<T, Hash, KeyEqual> base;
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+struct ht_iterator : ht_iterator_base<T, Hash, KeyEqual, Alloc, BucketPolicy> {
+    typedef ht_iterator_base<T, Hash, KeyEqual, Alloc, BucketPolicy> base;
     typedef typename base::hashtable hashtable;
     typedef typename base::iterator iterator;
     typedef typename base::const_iterator const_iterator;
@@ -159,7 +193,7 @@ struct ht_iterator : ht_iterator_base<T, Hash, KeyEqual> {
         ht = t;
     }
 
-    explicit ht_iterator(const iterator& rhs) {
+    ht_iterator(const iterator& rhs) {
         node = rhs.node;
         ht = rhs.ht;
     }
@@ -200,9 +234,9 @@ struct ht_iterator : ht_iterator_base<T, Hash, KeyEqual> {
         node = node->next;
         if (node == nullptr) {
             // 如果下一个位置为空，跳到下一个 bucket 的起始处
-            auto index = ht->hash(value_traits::get_key(old->value));
-            while (!node && ++index < ht->bucket_size_)
-                node = ht->buckets_[index];
+            auto index = ht->bucket_of(old);
+            while (!node && ++index < ht->slot_count())
+                node = ht->slot(index);
         }
         return *this;
     }
@@ -214,9 +248,9 @@ struct ht_iterator : ht_iterator_base<T, Hash, KeyEqual> {
     }
 };
 
-template <class T, class Hash, class KeyEqual>
-struct ht_const_iterator : ht_iterator_base<T, Hash, KeyEqual> {
-    typedef ht_iterator_base<T, Hash, KeyEqual> base;
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+struct ht_const_iterator : ht_iterator_base<T, Hash, KeyEqual, Alloc, BucketPolicy> {
+    typedef ht_iterator_base<T, Hash, KeyEqual, Alloc, BucketPolicy> base;
     typedef typename base::hashtable hashtable;
     typedef typename base::iterator iterator;
     typedef typename base::const_iterator const_iterator;
@@ -238,12 +272,12 @@ struct ht_const_iterator : ht_iterator_base<T, Hash, KeyEqual> {
         ht = t;
     }
 
-    explicit ht_const_iterator(const iterator& rhs) {
+    ht_const_iterator(const iterator& rhs) {
         node = rhs.node;
         ht = rhs.ht;
     }
 
-    explicit ht_const_iterator(const const_iterator& rhs) {
+    ht_const_iterator(const const_iterator& rhs) {
         node = rhs.node;
         ht = rhs.ht;
     }
@@ -279,9 +313,9 @@ struct ht_const_iterator : ht_iterator_base<T, Hash, KeyEqual> {
         node = node->next;
         if (node == nullptr) {
             // 如果下一个位置为空，跳到下一个 bucket 的起始处
-            auto index = ht->hash(value_traits::get_key(old->value));
-            while (!node && ++index < ht->bucket_size_) {
-                node = ht->buckets_[index];
+            auto index = ht->bucket_of(old);
+            while (!node && ++index < ht->slot_count()) {
+                node = ht->slot(index);
             }
         }
         return *this;
@@ -295,18 +329,18 @@ struct ht_const_iterator : ht_iterator_base<T, Hash, KeyEqual> {
 };
 
 // local iterator
-template <class T>
+template <class T, bool CacheHash>
 struct ht_local_iterator : public ccystl::iterator<ccystl::forward_iterator_tag, T> {
     typedef T value_type;
     typedef value_type* pointer;
     typedef value_type& reference;
     typedef size_t size_type;
     typedef ptrdiff_t difference_type;
-    typedef hashtable_node<T>* node_ptr;
+    typedef hashtable_node<T, CacheHash>* node_ptr;
 
-    typedef ht_local_iterator<T> self;
-    typedef ht_local_iterator<T> local_iterator;
-    typedef ht_const_local_iterator<T> const_local_iterator;
+    typedef ht_local_iterator<T, CacheHash> self;
+    typedef ht_local_iterator<T, CacheHash> local_iterator;
+    typedef ht_const_local_iterator<T, CacheHash> const_local_iterator;
     node_ptr node;
 
     explicit ht_local_iterator(node_ptr n)
@@ -347,18 +381,18 @@ struct ht_local_iterator : public ccystl::iterator<ccystl::forward_iterator_tag,
     }
 };
 
-template <class T>
+template <class T, bool CacheHash>
 struct ht_const_local_iterator : public ccystl::iterator<ccystl::forward_iterator_tag, T> {
     typedef T value_type;
     typedef const value_type* pointer;
     typedef const value_type& reference;
     typedef size_t size_type;
     typedef ptrdiff_t difference_type;
-    typedef const hashtable_node<T>* node_ptr;
+    typedef const hashtable_node<T, CacheHash>* node_ptr;
 
-    typedef ht_const_local_iterator<T> self;
-    typedef ht_local_iterator<T> local_iterator;
-    typedef ht_const_local_iterator<T> const_local_iterator;
+    typedef ht_const_local_iterator<T, CacheHash> self;
+    typedef ht_local_iterator<T, CacheHash> local_iterator;
+    typedef ht_const_local_iterator<T, CacheHash> const_local_iterator;
 
     node_ptr node;
 
@@ -466,12 +500,101 @@ inline size_t ht_next_prime(size_t n) {
     return pos == last ? *(last - 1) : *pos;
 }
 
+// 对哈希值再做一次混合，让低位与高位都依赖于输入的每一位
+// ccystl::hash 对整数是恒等映射，直接取低位或高位定位 bucket 会严重冲突
+inline size_t ht_mix(size_t h) noexcept {
+    uint64_t x = static_cast<uint64_t>(h);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+}
+
+// 预取 p 所在的缓存行，编译器不支持时什么也不做
+inline void ht_prefetch(const void* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
+// 批量查找时每一轮处理的键值个数，足以让多次缓存未命中重叠，又不会让预取的数据在使用前被挤出缓存
+constexpr size_t ht_batch_size = 32;
+
+// bucket 策略：决定 bucket 数的取值以及如何把哈希值映射到 [0, n)
+// 每个策略提供三个静态函数：
+//   * next_size(n)：不小于 n 的合法 bucket 数
+//   * index(hash, n)：哈希值所在的 bucket
+//   * max_bucket_count()：bucket 数的上限
+
+// 质数个 bucket，以取模定位，对哈希函数的质量要求最低，但每次定位都要做一次除法
+struct ht_prime_policy {
+    static size_t next_size(size_t n) noexcept {
+        return ht_next_prime(n);
+    }
+
+    static size_t index(size_t hash, size_t n) noexcept {
+        return hash % n;
+    }
+
+    static size_t max_bucket_count() noexcept {
+        return ht_prime_list[PRIME_NUM - 1];
+    }
+};
+
+// 2 的幂次个 bucket，混合哈希值后以掩码定位，扩容时 bucket 数加倍
+struct ht_power2_policy {
+    static size_t next_size(size_t n) noexcept {
+        return n <= 16 ? 16 : std::bit_ceil(ccystl::min(n, max_bucket_count()));
+    }
+
+    static size_t index(size_t hash, size_t n) noexcept {
+        return ht_mix(hash) & (n - 1);
+    }
+
+    static size_t max_bucket_count() noexcept {
+        return (static_cast<size_t>(-1) >> 1) + 1;
+    }
+};
+
+// 沿用质数表的 bucket 数，但以 Lemire 的 fastrange 乘法移位代替取模：
+// 把混合后的哈希值视作 [0, 1) 内的定点小数，乘以 n 后取整数部分
+struct ht_fastrange_policy {
+    static size_t next_size(size_t n) noexcept {
+        return ht_next_prime(n);
+    }
+
+    static size_t index(size_t hash, size_t n) noexcept {
+        const size_t h = ht_mix(hash);
+#if SIZE_MAX > UINT32_MAX
+#if defined(__SIZEOF_INT128__)
+        return static_cast<size_t>((static_cast<unsigned __int128>(h) * n) >> 64);
+#else
+        // 没有 128 位整数时手工计算 64 x 64 乘积的高 64 位
+        const uint64_t h_lo = h & 0xffffffffu, h_hi = h >> 32;
+        const uint64_t n_lo = n & 0xffffffffu, n_hi = n >> 32;
+        const uint64_t lo_lo = h_lo * n_lo, hi_lo = h_hi * n_lo, lo_hi = h_lo * n_hi;
+        const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffu) + lo_hi;
+        return static_cast<size_t>((hi_lo >> 32) + (cross >> 32) + h_hi * n_hi);
+#endif
+#else
+        return static_cast<size_t>((static_cast<uint64_t>(h) * n) >> 32);
+#endif
+    }
+
+    static size_t max_bucket_count() noexcept {
+        return ht_prime_list[PRIME_NUM - 1];
+    }
+};
+
 // 模板类 hashtable
-// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数
-template <class T, class Hash, class KeyEqual>
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数，参数四代表分配器类型，
+// 参数五代表 bucket 策略，缺省使用 ht_prime_policy
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 class hashtable {
-    friend struct ccystl::ht_iterator<T, Hash, KeyEqual>;
-    friend struct ccystl::ht_const_iterator<T, Hash, KeyEqual>;
+    friend struct ccystl::ht_iterator<T, Hash, KeyEqual, Alloc, BucketPolicy>;
+    friend struct ccystl::ht_const_iterator<T, Hash, KeyEqual, Alloc, BucketPolicy>;
 
 public:
     // hashtable 的型别定义
@@ -482,13 +605,18 @@ public:
     typedef Hash hasher;
     typedef KeyEqual key_equal;
 
-    typedef hashtable_node<T> node_type;
+    // 是否在节点中缓存哈希值，见 ht_cache_hash_code
+    static constexpr bool cache_hash_code = ht_cache_hash_code<key_type, Hash>::value;
+
+    typedef hashtable_node<T, cache_hash_code> node_type;
     typedef node_type* node_ptr;
-    typedef ccystl::vector<node_ptr> bucket_type;
 
-    typedef allocator<T> allocator_type;
-    typedef allocator<T> data_allocator;
-    typedef allocator<node_type> node_allocator;
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
+    typedef typename Alloc::template rebind<node_type>::other node_allocator;
+    typedef typename Alloc::template rebind<node_ptr>::other bucket_allocator;
+
+    typedef ccystl::vector<node_ptr, bucket_allocator> bucket_type;
 
     typedef typename allocator_type::pointer pointer;
     typedef typename allocator_type::const_pointer const_pointer;
@@ -497,23 +625,38 @@ public:
     typedef typename allocator_type::size_type size_type;
     typedef typename allocator_type::difference_type difference_type;
 
-    typedef ccystl::ht_iterator<T, Hash, KeyEqual> iterator;
-    typedef ccystl::ht_const_iterator<T, Hash, KeyEqual> const_iterator;
-    typedef ccystl::ht_local_iterator<T> local_iterator;
-    typedef ccystl::ht_const_local_iterator<T> const_local_iterator;
+    typedef ccystl::ht_iterator<T, Hash, KeyEqual, Alloc, BucketPolicy> iterator;
+    typedef ccystl::ht_const_iterator<T, Hash, KeyEqual, Alloc, BucketPolicy> const_iterator;
+    typedef ccystl::ht_local_iterator<T, cache_hash_code> local_iterator;
+    typedef ccystl::ht_const_local_iterator<T, cache_hash_code> const_local_iterator;
+
+    typedef ccystl::node_handle<node_type, Alloc> node_handle_type;
+    typedef ccystl::node_insert_return<iterator, node_handle_type> insert_return_type;
 
-    static allocator_type get_allocator() {
-        return allocator_type();
+    allocator_type get_allocator() const {
+        return allocator_type(node_alloc_);
     }
 
 private:
-    // 用以下六个参数来表现 hashtable
+    // 用以下参数来表现 hashtable
     bucket_type buckets_;
     size_type bucket_size_;
     size_type size_;
     float mlf_{};
     hasher hash_;
     key_equal equal_;
+    [[no_unique_address]] node_allocator node_alloc_; // 节点分配器，bucket 数组使用同一分配器的绑定版本
+
+    // 渐进式 rehash 的状态
+    // 迁移期间 old_buckets_ 保存旧的 bucket 数组，[0, rehash_index_) 内的 bucket 已迁移到 buckets_ 中
+    // 同一键值的节点总是全部位于旧数组或全部位于新数组
+    bucket_type old_buckets_;
+    size_type rehash_index_ = 0;
+    size_type rehash_step_ = 0; // 每次插入迁移的旧 bucket 数，保证下一次扩容前迁移完毕
+    bool incremental_ = false;
+
+    // rehash 的历史记录，未定义 CCYSTL_HASHTABLE_STATS 时为空类
+    [[no_unique_address]] ht_stats_recorder<> stats_;
 
 private:
     bool is_equal(const key_type& key1, const key_type& key2) {
@@ -524,32 +667,78 @@ private:
         return equal_(key1, key2);
     }
 
+    // 节点的键值是否与 key 相等，code 为 key 的哈希值
+    // 缓存了哈希值时先比较哈希值，不相等就无需调用 KeyEqual
+    template <class K>
+    bool node_equal(const node_type* np, size_type code, const K& key) const {
+        if constexpr (cache_hash_code) {
+            if (np->hash_code != code)
+                return false;
+        }
+        return equal_(value_traits::get_key(np->value), key);
+    }
+
+    // 两个节点的键值是否相等
+    bool node_equal(const node_type* lhs, const node_type* rhs) const {
+        return node_equal(lhs, node_hash_code(rhs), value_traits::get_key(rhs->value));
+    }
+
     const_iterator M_cit(node_ptr node) const noexcept {
         return const_iterator(node, const_cast<hashtable*>(this));
     }
 
     iterator M_begin() noexcept {
-        for (size_type n = 0; n < bucket_size_; ++n) {
-            if (buckets_[n]) // 找到第一个有节点的位置就返回
-                return iterator(buckets_[n], this);
+        for (size_type n = 0; n < slot_count(); ++n) {
+            if (slot(n)) // 找到第一个有节点的位置就返回
+                return iterator(slot(n), this);
         }
         return iterator(nullptr, this);
     }
 
     const_iterator M_begin() const noexcept {
-        for (size_type n = 0; n < bucket_size_; ++n) {
-            if (buckets_[n]) // 找到第一个有节点的位置就返回
-                return M_cit(buckets_[n]);
+        for (size_type n = 0; n < slot_count(); ++n) {
+            if (slot(n)) // 找到第一个有节点的位置就返回
+                return M_cit(slot(n));
         }
         return M_cit(nullptr);
     }
 
+    // 迁移期间把两个 bucket 数组拼接起来看待：
+    // [0, bucket_size_) 为新数组，[bucket_size_, slot_count()) 为旧数组，遍历与定位都基于这个统一的下标
+    bool rehashing() const noexcept {
+        return !old_buckets_.empty();
+    }
+
+    size_type slot_count() const noexcept {
+        return bucket_size_ + old_buckets_.size();
+    }
+
+    node_ptr& slot(size_type n) noexcept {
+        return n < bucket_size_ ? buckets_[n] : old_buckets_[n - bucket_size_];
+    }
+
+    const node_ptr& slot(size_type n) const noexcept {
+        return n < bucket_size_ ? buckets_[n] : old_buckets_[n - bucket_size_];
+    }
+
+    // 哈希值为 code 的节点所在的下标
+    size_type slot_of(size_type code) const noexcept {
+        if (rehashing()) {
+            const auto old_index = BucketPolicy::index(code, old_buckets_.size());
+            if (old_index >= rehash_index_)
+                return bucket_size_ + old_index;
+        }
+        return BucketPolicy::index(code, bucket_size_);
+    }
+
 public:
     // 构造、复制、移动、析构函数
     explicit hashtable(size_type bucket_count,
                        const Hash& hash = Hash(),
-                       const KeyEqual& equal = KeyEqual())
-        : size_(0), mlf_(1.0f), hash_(hash), equal_(equal) {
+                       const KeyEqual& equal = KeyEqual(),
+                       const allocator_type& alloc = allocator_type())
+        : buckets_(bucket_allocator(alloc)), size_(0), mlf_(1.0f),
+          hash_(hash), equal_(equal), node_alloc_(alloc), old_buckets_(bucket_allocator(alloc)) {
         init(bucket_count);
     }
 
@@ -557,30 +746,43 @@ public:
     hashtable(Iter first, Iter last,
               size_type bucket_count,
               const Hash& hash = Hash(),
-              const KeyEqual& equal = KeyEqual())
-        : size_(ccystl::distance(first, last)), mlf_(1.0f), hash_(hash), equal_(equal) {
+              const KeyEqual& equal = KeyEqual(),
+              const allocator_type& alloc = allocator_type())
+        : buckets_(bucket_allocator(alloc)), size_(ccystl::distance(first, last)), mlf_(1.0f),
+          hash_(hash), equal_(equal), node_alloc_(alloc), old_buckets_(bucket_allocator(alloc)) {
         init(ccystl::max(bucket_count, static_cast<size_type>(ccystl::distance(first, last))));
     }
 
     hashtable(const hashtable& rhs)
-        : hash_(rhs.hash_), equal_(rhs.equal_) {
+        : hashtable(rhs, rhs.get_allocator()) {
+    }
+
+    hashtable(const hashtable& rhs, const allocator_type& alloc)
+        : buckets_(bucket_allocator(alloc)), hash_(rhs.hash_), equal_(rhs.equal_), node_alloc_(alloc),
+          old_buckets_(bucket_allocator(alloc)) {
         copy_init(rhs);
     }
 
     hashtable(hashtable&& rhs) noexcept
-        : bucket_size_(rhs.bucket_size_),
+        : buckets_(ccystl::move(rhs.buckets_)),
+          bucket_size_(rhs.bucket_size_),
           size_(rhs.size_),
           mlf_(rhs.mlf_),
           hash_(rhs.hash_),
-          equal_(rhs.equal_) {
-        buckets_ = ccystl::move(rhs.buckets_);
+          equal_(rhs.equal_),
+          node_alloc_(rhs.node_alloc_),
+          old_buckets_(ccystl::move(rhs.old_buckets_)),
+          rehash_index_(rhs.rehash_index_),
+          rehash_step_(rhs.rehash_step_),
+          incremental_(rhs.incremental_),
+          stats_(ccystl::move(rhs.stats_)) {
         rhs.bucket_size_ = 0;
         rhs.size_ = 0;
-        rhs.mlf_ = 0.0f;
+        rhs.rehash_index_ = 0;
     }
 
     hashtable& operator=(const hashtable& rhs);
-    hashtable& operator=(hashtable&& rhs) noexcept;
+    hashtable& operator=(hashtable&& rhs) noexcept(std::is_empty_v<node_allocator>);
 
     ~hashtable() {
         clear();
@@ -699,8 +901,8 @@ public:
 
     // erase / clear
 
-    void erase(const_iterator position);
-    void erase(const_iterator first, const_iterator last);
+    iterator erase(const_iterator position);
+    iterator erase(const_iterator first, const_iterator last);
 
     size_type erase_multi(const key_type& key);
     size_type erase_unique(const key_type& key);
@@ -709,34 +911,88 @@ public:
 
     void swap(hashtable& rhs) noexcept;
 
+    // 节点句柄：摘下与插入都只调整指针，不分配也不释放节点
+
+    node_handle_type extract(const_iterator position);
+    node_handle_type extract(const key_type& key);
+
+    insert_return_type insert_unique(node_handle_type&& nh);
+    iterator insert_multi(node_handle_type&& nh);
+
+    // [note]: 同 emplace_hint
+    iterator insert_unique_use_hint(const_iterator /*hint*/, node_handle_type&& nh) {
+        return insert_unique(ccystl::move(nh)).position;
+    }
+
+    iterator insert_multi_use_hint(const_iterator /*hint*/, node_handle_type&& nh) {
+        return insert_multi(ccystl::move(nh));
+    }
+
+    // 把 source 中的节点移到本表，键值已存在的节点留在 source 中
+    // 两个表的节点类型必须相同（是否缓存哈希值由键值与哈希函数决定，见 ht_cache_hash_code）
+    template <class Hash2, class KeyEqual2, class BucketPolicy2>
+    void merge_unique(hashtable<T, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source);
+
+    template <class Hash2, class KeyEqual2, class BucketPolicy2>
+    void merge_multi(hashtable<T, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source);
+
     // 查找相关操作
 
-    size_type count(const key_type& key) const;
+    template <class K>
+    size_type count(const K& key) const;
 
-    iterator find(const key_type& key);
-    const_iterator find(const key_type& key) const;
+    template <class K>
+    iterator find(const K& key);
+    template <class K>
+    const_iterator find(const K& key) const;
 
-    pair<iterator, iterator> equal_range_multi(const key_type& key);
-    pair<const_iterator, const_iterator> equal_range_multi(const key_type& key) const;
+    template <class K>
+    pair<iterator, iterator> equal_range_multi(const K& key);
+    template <class K>
+    pair<const_iterator, const_iterator> equal_range_multi(const K& key) const;
 
-    pair<iterator, iterator> equal_range_unique(const key_type& key);
-    pair<const_iterator, const_iterator> equal_range_unique(const key_type& key) const;
+    template <class K>
+    pair<iterator, iterator> equal_range_unique(const K& key);
+    template <class K>
+    pair<const_iterator, const_iterator> equal_range_unique(const K& key) const;
+
+    // 批量查找：[first, last) 中每个键值的查找结果依次写入 result，返回写入结束的位置
+    // 每轮先计算一批键值的哈希值并预取 bucket，再预取各链表的首节点，最后才逐个比较，
+    // 让这些缓存未命中重叠，而不是像逐个 find 那样一个接一个地等待
+    template <class ForwardIter, class OutputIter>
+    OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) {
+        lookup_batch(first, last, [&](node_ptr np) { *result++ = iterator(np, this); });
+        return result;
+    }
+
+    template <class ForwardIter, class OutputIter>
+    OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+        lookup_batch(first, last, [&](node_ptr np) { *result++ = M_cit(np); });
+        return result;
+    }
+
+    // 同 find_batch，结果为键值是否存在
+    template <class ForwardIter, class OutputIter>
+    OutputIter contains_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+        lookup_batch(first, last, [&](node_ptr np) { *result++ = np != nullptr; });
+        return result;
+    }
 
     // bucket interface
 
     local_iterator begin(size_type n) noexcept {
         ccystl_DEBUG(n < size_);
-        return buckets_[n];
+        return slot(n);
     }
 
     const_local_iterator begin(size_type n) const noexcept {
         ccystl_DEBUG(n < size_);
-        return buckets_[n];
+        return slot(n);
     }
 
     const_local_iterator cbegin(size_type n) const noexcept {
         ccystl_DEBUG(n < size_);
-        return buckets_[n];
+        return slot(n);
     }
 
     local_iterator end(size_type n) noexcept {
@@ -754,18 +1010,19 @@ public:
         return nullptr;
     }
 
+    // 渐进式 rehash 期间 bucket 接口同时覆盖新旧两个数组
     size_type bucket_count() const noexcept {
-        return bucket_size_;
+        return slot_count();
     }
 
     static size_type max_bucket_count() noexcept {
-        return ht_prime_list[PRIME_NUM - 1];
+        return BucketPolicy::max_bucket_count();
     }
 
     size_type bucket_size(size_type n) const noexcept;
 
     size_type bucket(const key_type& key) const {
-        return hash(key);
+        return slot_of(hash_code(key));
     }
 
     // hash policy
@@ -789,6 +1046,25 @@ public:
         rehash(static_cast<size_type>(static_cast<float>(count) / max_load_factor() + 0.5f));
     }
 
+    // 渐进式 rehash：开启后插入引起的扩容不再一次性搬移所有节点，
+    // 而是新旧 bucket 数组并存，之后每次插入迁移若干个旧 bucket，从而限制单次插入的最坏耗时
+    [[nodiscard]] bool incremental_rehash() const noexcept {
+        return incremental_;
+    }
+
+    void incremental_rehash(bool on) {
+        if (!on)
+            finish_rehash();
+        incremental_ = on;
+    }
+
+    // 统计信息，见 hashtable_stats.h
+    hashtable_stats stats() const;
+
+    void reset_stats() noexcept {
+        stats_.reset();
+    }
+
     hasher hash_fcn() const {
         return hash_;
     }
@@ -813,7 +1089,20 @@ private:
     size_type next_size(size_type n) const;
     size_type hash(const key_type& key, size_type n) const;
     size_type hash(const key_type& key) const;
+    template <class K>
+    size_type hash_code(const K& key) const;
+    size_type node_hash_code(const node_type* np) const;
+    void set_hash_code(node_ptr np, size_type code) const;
+    size_type bucket_of(const node_type* np) const;
     void rehash_if_need(size_type n);
+    void start_rehash(size_type bucket_count);
+    void rehash_step();
+    void finish_rehash();
+    void link_node(bucket_type& bucket, size_type n, node_ptr np, size_type code);
+
+    // lookup
+    template <class ForwardIter, class Function>
+    void lookup_batch(ForwardIter first, ForwardIter last, Function fn) const;
 
     // insert
     template <class InputIter>
@@ -825,9 +1114,10 @@ private:
     template <class ForwardIter>
     void copy_insert_unique(ForwardIter first, ForwardIter last, ccystl::forward_iterator_tag);
 
-    // insert node
+    // insert node / unlink node
     pair<iterator, bool> insert_node_unique(node_ptr np);
     iterator insert_node_multi(node_ptr np);
+    void unlink_node(node_ptr p);
 
     // bucket operator
     void replace_bucket(size_type bucket_count);
@@ -842,9 +1132,9 @@ private:
 /*****************************************************************************************/
 
 // 复制赋值运算符
-template <class T, class Hash, class KeyEqual>
-hashtable<T, Hash, KeyEqual>&
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>&
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 operator=(const hashtable& rhs) {
     if (this != &rhs) {
         hashtable tmp(rhs);
@@ -854,26 +1144,38 @@ operator=(const hashtable& rhs) {
 }
 
 // 移动赋值运算符
-template <class T, class Hash, class KeyEqual>
-hashtable<T, Hash, KeyEqual>&
-hashtable<T, Hash, KeyEqual>::
-operator=(hashtable&& rhs) noexcept {
-    hashtable tmp(ccystl::move(rhs));
-    swap(tmp);
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>&
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+operator=(hashtable&& rhs) noexcept(std::is_empty_v<node_allocator>) {
+    if (this == &rhs)
+        return *this;
+    if (node_alloc_ == rhs.node_alloc_) {
+        hashtable tmp(ccystl::move(rhs));
+        swap(tmp);
+    }
+    else {
+        // 分配器不随移动赋值传播，逐个移动元素到使用本容器分配器的新表中
+        hashtable tmp(rhs.bucket_size_, rhs.hash_, rhs.equal_, get_allocator());
+        tmp.mlf_ = rhs.mlf_;
+        for (auto& value : rhs)
+            tmp.emplace_multi(ccystl::move(const_cast<value_type&>(value)));
+        rhs.clear();
+        swap(tmp);
+    }
     return *this;
 }
 
 // 就地构造元素，键值允许重复
 // 强异常安全保证
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 template <class... Args>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 emplace_multi(Args&&... args) {
     auto np = create_node(ccystl::forward<Args>(args)...);
     try {
-        if (static_cast<float>(size_ + 1) > static_cast<float>(bucket_size_) * max_load_factor())
-            rehash(size_ + 1);
+        rehash_if_need(1);
     }
     catch (...) {
         destroy_node(np);
@@ -884,15 +1186,14 @@ emplace_multi(Args&&... args) {
 
 // 就地构造元素，键值允许重复
 // 强异常安全保证
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 template <class... Args>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-hashtable<T, Hash, KeyEqual>::
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 emplace_unique(Args&&... args) {
     auto np = create_node(ccystl::forward<Args>(args)...);
     try {
-        if (static_cast<float>(size_ + 1) > static_cast<float>(bucket_size_) * max_load_factor())
-            rehash(size_ + 1);
+        rehash_if_need(1);
     }
     catch (...) {
         destroy_node(np);
@@ -902,34 +1203,38 @@ emplace_unique(Args&&... args) {
 }
 
 // 在不需要重建表格的情况下插入新节点，键值不允许重复
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 insert_unique_noresize(const value_type& value) {
-    const auto n = hash(value_traits::get_key(value));
-    auto first = buckets_[n];
+    const auto code = hash_code(value_traits::get_key(value));
+    const auto n = slot_of(code);
+    auto first = slot(n);
     for (auto cur = first; cur; cur = cur->next) {
-        if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value)))
+        if (node_equal(cur, code, value_traits::get_key(value)))
             return ccystl::make_pair(iterator(cur, this), false);
     }
     // 让新节点成为链表的第一个节点
     auto tmp = create_node(value);
+    set_hash_code(tmp, code);
     tmp->next = first;
-    buckets_[n] = tmp;
+    slot(n) = tmp;
     ++size_;
     return ccystl::make_pair(iterator(tmp, this), true);
 }
 
 // 在不需要重建表格的情况下插入新节点，键值允许重复
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 insert_multi_noresize(const value_type& value) {
-    const auto n = hash(value_traits::get_key(value));
-    auto first = buckets_[n];
+    const auto code = hash_code(value_traits::get_key(value));
+    const auto n = slot_of(code);
+    auto first = slot(n);
     auto tmp = create_node(value);
+    set_hash_code(tmp, code);
     for (auto cur = first; cur; cur = cur->next) {
-        if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value))) {
+        if (node_equal(cur, tmp)) {
             // 如果链表中存在相同键值的节点就马上插入，然后返回
             tmp->next = cur->next;
             cur->next = tmp;
@@ -939,55 +1244,131 @@ insert_multi_noresize(const value_type& value) {
     }
     // 否则插入在链表头部
     tmp->next = first;
-    buckets_[n] = tmp;
+    slot(n) = tmp;
     ++size_;
     return iterator(tmp, this);
 }
 
-// 删除迭代器所指的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+// 删除迭代器所指的节点，返回下一个节点的迭代器
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 erase(const_iterator position) {
     auto p = position.node;
+    iterator next(p, this);
     if (p) {
-        const auto n = hash(value_traits::get_key(p->value));
-        auto cur = buckets_[n];
-        if (cur == p) {
-            // p 位于链表头部
-            buckets_[n] = cur->next;
-            destroy_node(cur);
-            --size_;
-        }
-        else {
-            auto next = cur->next;
-            while (next) {
-                if (next == p) {
-                    cur->next = next->next;
-                    destroy_node(next);
-                    --size_;
-                    break;
-                }
-                else {
-                    cur = next;
-                    next = cur->next;
-                }
-            }
-        }
+        ++next;
+        unlink_node(p);
+        destroy_node(p);
     }
+    return next;
+}
+
+// 摘下 position 所指的节点，交给节点句柄
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::node_handle_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+extract(const_iterator position) {
+    auto p = position.node;
+    unlink_node(p);
+    return node_handle_type(p, node_alloc_);
+}
+
+// 摘下第一个键值等于 key 的节点，不存在时返回空句柄
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::node_handle_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+extract(const key_type& key) {
+    auto it = find(key);
+    if (it == end())
+        return node_handle_type();
+    return extract(const_iterator(it.node, this));
 }
 
-// 删除[first, last)内的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+// 插入节点句柄持有的节点，键值不允许重复，失败时节点留在返回值的 node 中
+// rehash 或哈希函数抛出异常时节点仍由 nh 持有
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::insert_return_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+insert_unique(node_handle_type&& nh) {
+    if (nh.empty())
+        return insert_return_type{end(), false, node_handle_type()};
+    rehash_if_need(1);
+    auto res = insert_node_unique(nh.node_);
+    if (!res.second)
+        return insert_return_type{res.first, false, ccystl::move(nh)};
+    nh.release();
+    return insert_return_type{res.first, true, node_handle_type()};
+}
+
+// 插入节点句柄持有的节点，键值允许重复，句柄为空时返回 end()
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+insert_multi(node_handle_type&& nh) {
+    if (nh.empty())
+        return end();
+    rehash_if_need(1);
+    auto it = insert_node_multi(nh.node_);
+    nh.release();
+    return it;
+}
+
+// 先确认本表中没有相同键值，再从 source 摘下节点挂到本表
+// 哈希函数抛出异常时正在移动的那个元素会被销毁，其余元素仍在原来的表中
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class Hash2, class KeyEqual2, class BucketPolicy2>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+merge_unique(hashtable<T, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source) {
+    typedef hashtable<T, Hash2, KeyEqual2, Alloc, BucketPolicy2> source_type;
+    typedef typename source_type::const_iterator source_iterator;
+    static_assert(std::is_same_v<node_type, typename source_type::node_type>,
+                  "hashtable::merge requires both tables to use the same node type");
+    if (static_cast<void*>(&source) == static_cast<void*>(this))
+        return;
+    for (auto it = source.begin(); it != source.end();) {
+        auto cur = it++;
+        if (find(value_traits::get_key(*cur)) != end())
+            continue;
+        rehash_if_need(1);
+        auto nh = source.extract(source_iterator(cur));
+        insert_node_unique(nh.node_);
+        nh.release();
+    }
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class Hash2, class KeyEqual2, class BucketPolicy2>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+merge_multi(hashtable<T, Hash2, KeyEqual2, Alloc, BucketPolicy2>& source) {
+    typedef hashtable<T, Hash2, KeyEqual2, Alloc, BucketPolicy2> source_type;
+    typedef typename source_type::const_iterator source_iterator;
+    static_assert(std::is_same_v<node_type, typename source_type::node_type>,
+                  "hashtable::merge requires both tables to use the same node type");
+    if (static_cast<void*>(&source) == static_cast<void*>(this))
+        return;
+    for (auto it = source.begin(); it != source.end();) {
+        auto cur = it++;
+        rehash_if_need(1);
+        auto nh = source.extract(source_iterator(cur));
+        insert_node_multi(nh.node_);
+        nh.release();
+    }
+}
+
+// 删除[first, last)内的节点，返回 last
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 erase(const_iterator first, const_iterator last) {
     if (first.node == last.node)
-        return;
+        return iterator(last.node, this);
     auto first_bucket = first.node
-                            ? hash(value_traits::get_key(first.node->value))
-                            : bucket_size_;
+                            ? bucket_of(first.node)
+                            : slot_count();
     auto last_bucket = last.node
-                           ? hash(value_traits::get_key(last.node->value))
-                           : bucket_size_;
+                           ? bucket_of(last.node)
+                           : slot_count();
     if (first_bucket == last_bucket) {
         // 如果在 bucket 在同一个位置
         erase_bucket(first_bucket, first.node, last.node);
@@ -995,37 +1376,43 @@ erase(const_iterator first, const_iterator last) {
     else {
         erase_bucket(first_bucket, first.node, nullptr);
         for (auto n = first_bucket + 1; n < last_bucket; ++n) {
-            if (buckets_[n] != nullptr)
+            if (slot(n) != nullptr)
                 erase_bucket(n, nullptr);
         }
-        if (last_bucket != bucket_size_) {
+        if (last_bucket != slot_count()) {
             erase_bucket(last_bucket, last.node);
         }
     }
+    return iterator(last.node, this);
 }
 
 // 删除键值为 key 的节点
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 erase_multi(const key_type& key) {
     auto p = equal_range_multi(key);
     if (p.first.node != nullptr) {
+        // 先计数再删除，删除后 p.first 已失效
+        const auto n = static_cast<size_type>(ccystl::distance(p.first, p.second));
         erase(p.first, p.second);
-        return ccystl::distance(p.first, p.second);
+        return n;
     }
     return 0;
 }
 
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 erase_unique(const key_type& key) {
-    const auto n = hash(key);
-    auto first = buckets_[n];
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return 0;
+    const auto code = hash_code(key);
+    const auto n = slot_of(code);
+    auto first = slot(n);
     if (first) {
-        if (is_equal(value_traits::get_key(first->value), key)) {
-            buckets_[n] = first->next;
+        if (node_equal(first, code, key)) {
+            slot(n) = first->next;
             destroy_node(first);
             --size_;
             return 1;
@@ -1033,7 +1420,7 @@ erase_unique(const key_type& key) {
         else {
             auto next = first->next;
             while (next) {
-                if (is_equal(value_traits::get_key(next->value), key)) {
+                if (node_equal(next, code, key)) {
                     first->next = next->next;
                     destroy_node(next);
                     --size_;
@@ -1048,40 +1435,47 @@ erase_unique(const key_type& key) {
 }
 
 // 清空 hashtable
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 clear() {
     if (size_ != 0) {
-        for (size_type i = 0; i < bucket_size_; ++i) {
-            node_ptr cur = buckets_[i];
+        for (size_type i = 0; i < slot_count(); ++i) {
+            node_ptr cur = slot(i);
             while (cur != nullptr) {
                 node_ptr next = cur->next;
                 destroy_node(cur);
                 cur = next;
             }
-            buckets_[i] = nullptr;
+            slot(i) = nullptr;
         }
         size_ = 0;
     }
+    if (rehashing()) {
+        // 没有节点需要迁移了，直接丢弃旧数组
+        bucket_type(old_buckets_.get_allocator()).swap(old_buckets_);
+        rehash_index_ = 0;
+    }
 }
 
 // 在某个 bucket 节点的个数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 bucket_size(size_type n) const noexcept {
     size_type result = 0;
-    for (auto cur = buckets_[n]; cur; cur = cur->next) {
+    for (auto cur = slot(n); cur; cur = cur->next) {
         ++result;
     }
     return result;
 }
 
 // 重新对元素进行一遍哈希，插入到新的位置
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 rehash(size_type count) {
-    auto n = ht_next_prime(count);
+    // 显式调用的 rehash 总是一次完成
+    finish_rehash();
+    auto n = BucketPolicy::next_size(count);
     if (n > bucket_size_) {
         replace_bucket(n);
     }
@@ -1094,59 +1488,97 @@ rehash(size_type count) {
     }
 }
 
+// 统计信息：遍历全部 bucket 得到链长分布与内存占用，再填入 rehash 的历史记录
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+hashtable_stats hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+stats() const {
+    hashtable_stats s;
+    s.size = size_;
+    s.bucket_count = slot_count();
+    s.load_factor = load_factor();
+    s.max_load_factor = mlf_;
+    size_type used = 0;
+    for (size_type i = 0; i < slot_count(); ++i) {
+        size_type len = 0;
+        for (auto cur = slot(i); cur; cur = cur->next)
+            ++len;
+        s.add_chain(len);
+        used += len != 0;
+    }
+    s.empty_buckets = s.bucket_count - used;
+    s.average_chain_length = used != 0 ? static_cast<double>(size_) / static_cast<double>(used) : 0.0;
+    s.node_bytes = size_ * sizeof(node_type);
+    s.bucket_bytes = (buckets_.capacity() + old_buckets_.capacity()) * sizeof(node_ptr);
+    stats_.fill(s);
+    return s;
+}
+
 // 查找键值为 key 的节点，返回其迭代器
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
-find(const key_type& key) {
-    const auto n = hash(key);
-    node_ptr first = buckets_[n];
-    for (; first && !is_equal(value_traits::get_key(first->value), key); first = first->next) { }
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+find(const K& key) {
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return end();
+    const auto code = hash_code(key);
+    node_ptr first = slot(slot_of(code));
+    for (; first && !node_equal(first, code, key); first = first->next) { }
     return iterator(first, this);
 }
 
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::const_iterator
-hashtable<T, Hash, KeyEqual>::
-find(const key_type& key) const {
-    const auto n = hash(key);
-    node_ptr first = buckets_[n];
-    for (; first && !is_equal(value_traits::get_key(first->value), key); first = first->next) { }
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::const_iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+find(const K& key) const {
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return end();
+    const auto code = hash_code(key);
+    node_ptr first = slot(slot_of(code));
+    for (; first && !node_equal(first, code, key); first = first->next) { }
     return M_cit(first);
 }
 
 // 查找键值为 key 出现的次数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
-count(const key_type& key) const {
-    const auto n = hash(key);
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+count(const K& key) const {
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return 0;
+    const auto code = hash_code(key);
     size_type result = 0;
-    for (node_ptr cur = buckets_[n]; cur; cur = cur->next) {
-        if (is_equal(value_traits::get_key(cur->value), key))
+    for (node_ptr cur = slot(slot_of(code)); cur; cur = cur->next) {
+        if (node_equal(cur, code, key))
             ++result;
     }
     return result;
 }
 
 // 查找与键值 key 相等的区间，返回一个 pair，指向相等区间的首尾
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-     typename hashtable<T, Hash, KeyEqual>::iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_multi(const key_type& key) {
-    const auto n = hash(key);
-    for (node_ptr first = buckets_[n]; first; first = first->next) {
-        if (is_equal(value_traits::get_key(first->value), key)) {
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator,
+     typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+equal_range_multi(const K& key) {
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return ccystl::make_pair(end(), end());
+    const auto code = hash_code(key);
+    const auto n = slot_of(code);
+    for (node_ptr first = slot(n); first; first = first->next) {
+        if (node_equal(first, code, key)) {
             // 如果出现相等的键值
             for (node_ptr second = first->next; second; second = second->next) {
-                if (!is_equal(value_traits::get_key(second->value), key))
+                if (!node_equal(second, code, key))
                     return ccystl::make_pair(iterator(first, this), iterator(second, this));
             }
-            for (auto m = n + 1; m < bucket_size_; ++m) {
+            for (auto m = n + 1; m < slot_count(); ++m) {
                 // 整个链表都相等，查找下一个链表出现的位置
-                if (buckets_[m])
-                    return ccystl::make_pair(iterator(first, this), iterator(buckets_[m], this));
+                if (slot(m))
+                    return ccystl::make_pair(iterator(first, this), iterator(slot(m), this));
             }
             return ccystl::make_pair(iterator(first, this), end());
         }
@@ -1154,22 +1586,26 @@ equal_range_multi(const key_type& key) {
     return ccystl::make_pair(end(), end());
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::const_iterator,
-     typename hashtable<T, Hash, KeyEqual>::const_iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_multi(const key_type& key) const {
-    const auto n = hash(key);
-    for (node_ptr first = buckets_[n]; first; first = first->next) {
-        if (is_equal(value_traits::get_key(first->value), key)) {
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::const_iterator,
+     typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::const_iterator>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+equal_range_multi(const K& key) const {
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return ccystl::make_pair(end(), end());
+    const auto code = hash_code(key);
+    const auto n = slot_of(code);
+    for (node_ptr first = slot(n); first; first = first->next) {
+        if (node_equal(first, code, key)) {
             for (node_ptr second = first->next; second; second = second->next) {
-                if (!is_equal(value_traits::get_key(second->value), key))
+                if (!node_equal(second, code, key))
                     return ccystl::make_pair(M_cit(first), M_cit(second));
             }
-            for (auto m = n + 1; m < bucket_size_; ++m) {
+            for (auto m = n + 1; m < slot_count(); ++m) {
                 // 整个链表都相等，查找下一个链表出现的位置
-                if (buckets_[m])
-                    return ccystl::make_pair(M_cit(first), M_cit(buckets_[m]));
+                if (slot(m))
+                    return ccystl::make_pair(M_cit(first), M_cit(slot(m)));
             }
             return ccystl::make_pair(M_cit(first), cend());
         }
@@ -1177,20 +1613,24 @@ equal_range_multi(const key_type& key) const {
     return ccystl::make_pair(cend(), cend());
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-     typename hashtable<T, Hash, KeyEqual>::iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_unique(const key_type& key) {
-    const auto n = hash(key);
-    for (node_ptr first = buckets_[n]; first; first = first->next) {
-        if (is_equal(value_traits::get_key(first->value), key)) {
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator,
+     typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+equal_range_unique(const K& key) {
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return ccystl::make_pair(end(), end());
+    const auto code = hash_code(key);
+    const auto n = slot_of(code);
+    for (node_ptr first = slot(n); first; first = first->next) {
+        if (node_equal(first, code, key)) {
             if (first->next)
                 return ccystl::make_pair(iterator(first, this), iterator(first->next, this));
-            for (auto m = n + 1; m < bucket_size_; ++m) {
+            for (auto m = n + 1; m < slot_count(); ++m) {
                 // 整个链表都相等，查找下一个链表出现的位置
-                if (buckets_[m])
-                    return ccystl::make_pair(iterator(first, this), iterator(buckets_[m], this));
+                if (slot(m))
+                    return ccystl::make_pair(iterator(first, this), iterator(slot(m), this));
             }
             return ccystl::make_pair(iterator(first, this), end());
         }
@@ -1198,20 +1638,24 @@ equal_range_unique(const key_type& key) {
     return ccystl::make_pair(end(), end());
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::const_iterator,
-     typename hashtable<T, Hash, KeyEqual>::const_iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_unique(const key_type& key) const {
-    const auto n = hash(key);
-    for (node_ptr first = buckets_[n]; first; first = first->next) {
-        if (is_equal(value_traits::get_key(first->value), key)) {
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::const_iterator,
+     typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::const_iterator>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+equal_range_unique(const K& key) const {
+    if (size_ == 0) // 空表可能尚未分配 bucket
+        return ccystl::make_pair(end(), end());
+    const auto code = hash_code(key);
+    const auto n = slot_of(code);
+    for (node_ptr first = slot(n); first; first = first->next) {
+        if (node_equal(first, code, key)) {
             if (first->next)
                 return ccystl::make_pair(M_cit(first), M_cit(first->next));
-            for (auto m = n + 1; m < bucket_size_; ++m) {
+            for (auto m = n + 1; m < slot_count(); ++m) {
                 // 整个链表都相等，查找下一个链表出现的位置
-                if (buckets_[m])
-                    return ccystl::make_pair(M_cit(first), M_cit(buckets_[m]));
+                if (slot(m))
+                    return ccystl::make_pair(M_cit(first), M_cit(slot(m)));
             }
             return ccystl::make_pair(M_cit(first), cend());
         }
@@ -1220,8 +1664,8 @@ equal_range_unique(const key_type& key) const {
 }
 
 // 交换 hashtable
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 swap(hashtable& rhs) noexcept {
     if (this != &rhs) {
         buckets_.swap(rhs.buckets_);
@@ -1230,6 +1674,12 @@ swap(hashtable& rhs) noexcept {
         ccystl::swap(mlf_, rhs.mlf_);
         ccystl::swap(hash_, rhs.hash_);
         ccystl::swap(equal_, rhs.equal_);
+        ccystl::swap(node_alloc_, rhs.node_alloc_);
+        old_buckets_.swap(rhs.old_buckets_);
+        ccystl::swap(rehash_index_, rhs.rehash_index_);
+        ccystl::swap(rehash_step_, rhs.rehash_step_);
+        ccystl::swap(incremental_, rhs.incremental_);
+        stats_.swap(rhs.stats_);
     }
 }
 
@@ -1237,9 +1687,14 @@ swap(hashtable& rhs) noexcept {
 // helper function
 
 // init 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 init(size_type n) {
+    // 不指定 bucket 数时不分配，第一次插入时再由 rehash_if_need 分配
+    if (n == 0) {
+        bucket_size_ = 0;
+        return;
+    }
     const auto bucket_nums = next_size(n);
     try {
         buckets_.reserve(bucket_nums);
@@ -1254,23 +1709,32 @@ init(size_type n) {
 }
 
 // copy_init 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 copy_init(const hashtable& ht) {
     bucket_size_ = 0;
     buckets_.reserve(ht.bucket_size_);
     buckets_.assign(ht.bucket_size_, nullptr);
+    if (ht.rehashing()) {
+        // 连同迁移进度一起复制，新表继续迁移
+        old_buckets_.assign(ht.old_buckets_.size(), nullptr);
+        rehash_index_ = ht.rehash_index_;
+        rehash_step_ = ht.rehash_step_;
+    }
+    incremental_ = ht.incremental_;
     try {
-        for (size_type i = 0; i < ht.bucket_size_; ++i) {
-            node_ptr cur = ht.buckets_[i];
+        for (size_type i = 0; i < ht.slot_count(); ++i) {
+            node_ptr cur = ht.slot(i);
             if (cur) {
                 // 如果某 bucket 存在链表
                 auto copy = create_node(cur->value);
-                buckets_[i] = copy;
+                set_hash_code(copy, ht.node_hash_code(cur));
+                (i < ht.bucket_size_ ? buckets_[i] : old_buckets_[i - ht.bucket_size_]) = copy;
                 for (auto next = cur->next; next; cur = next, next = cur->next) {
                     //复制链表
                     copy->next = create_node(next->value);
                     copy = copy->next;
+                    set_hash_code(copy, ht.node_hash_code(next));
                 }
                 copy->next = nullptr;
             }
@@ -1285,75 +1749,210 @@ copy_init(const hashtable& ht) {
 }
 
 // create_node 函数
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 template <class... Args>
-typename hashtable<T, Hash, KeyEqual>::node_ptr
-hashtable<T, Hash, KeyEqual>::
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::node_ptr
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 create_node(Args&&... args) {
-    node_ptr tmp = node_allocator::allocate(1);
+    node_ptr tmp = node_alloc_.allocate(1);
     try {
-        data_allocator::construct(ccystl::address_of(tmp->value), ccystl::forward<Args>(args)...);
+        data_allocator(node_alloc_).construct(ccystl::address_of(tmp->value), ccystl::forward<Args>(args)...);
         tmp->next = nullptr;
     }
     catch (...) {
-        node_allocator::deallocate(tmp);
+        node_alloc_.deallocate(tmp);
         throw;
     }
     return tmp;
 }
 
 // destroy_node 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 destroy_node(node_ptr n) {
-    data_allocator::destroy(ccystl::address_of(n->value));
-    node_allocator::deallocate(n);
+    data_allocator(node_alloc_).destroy(ccystl::address_of(n->value));
+    node_alloc_.deallocate(n);
     n = nullptr;
 }
 
 // next_size 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::next_size(size_type n) const {
-    return ht_next_prime(n);
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::next_size(size_type n) const {
+    return BucketPolicy::next_size(n);
 }
 
 // hash 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 hash(const key_type& key, size_type n) const {
-    return hash_(key) % n;
+    return BucketPolicy::index(hash_(key), n);
 }
 
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 hash(const key_type& key) const {
-    return hash_(key) % bucket_size_;
+    return BucketPolicy::index(hash_(key), bucket_size_);
+}
+
+// 键值的完整哈希值
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class K>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+hash_code(const K& key) const {
+    return hash_(key);
+}
+
+// 节点的哈希值，缓存时直接读取，否则重新计算
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+node_hash_code(const node_type* np) const {
+    if constexpr (cache_hash_code)
+        return np->hash_code;
+    else
+        return hash_(value_traits::get_key(np->value));
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+set_hash_code(node_ptr np, size_type code) const {
+    if constexpr (cache_hash_code)
+        np->hash_code = code;
+    else
+        (void)np, (void)code;
+}
+
+// 节点所在的 bucket
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+bucket_of(const node_type* np) const {
+    return slot_of(node_hash_code(np));
 }
 
 // rehash_if_need 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 rehash_if_need(size_type n) {
-    if (static_cast<float>(size_ + n) > static_cast<float>(bucket_size_) * max_load_factor())
-        rehash(size_ + n);
+    if (rehashing())
+        rehash_step();
+    if (static_cast<float>(size_ + n) > static_cast<float>(bucket_size_) * max_load_factor()) {
+        // 批量插入的代价本就与元素个数成正比，仍然一次完成
+        if (incremental_ && n == 1 && size_ != 0)
+            start_rehash(BucketPolicy::next_size(size_ + n));
+        else
+            rehash(size_ + n);
+    }
+}
+
+// 开始渐进式 rehash：分配新的 bucket 数组，旧数组留待之后的插入逐步迁移
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+start_rehash(size_type bucket_count) {
+    // 上一次迁移还没完成就再次扩容只会发生在 max_load_factor 被调小等情况下，此时先完成它
+    finish_rehash();
+    if (bucket_count <= bucket_size_)
+        return;
+    bucket_type bucket(bucket_count, buckets_.get_allocator());
+    stats_.record_rehash(size_, bucket_size_, bucket_count);
+    buckets_.swap(bucket);
+    old_buckets_.swap(bucket);
+    bucket_size_ = buckets_.size();
+    rehash_index_ = 0;
+    // 新数组在插入 bucket_size_ * mlf - size_ 个元素后才会再次扩容，在此之前必须迁移完旧数组
+    const auto room = static_cast<float>(bucket_size_) * max_load_factor() - static_cast<float>(size_);
+    const auto room_count = room < 1.0f ? static_cast<size_type>(1) : static_cast<size_type>(room);
+    rehash_step_ = old_buckets_.size() / room_count + 1;
+    rehash_step();
+}
+
+// 迁移 rehash_step_ 个旧 bucket，迁移完毕后释放旧数组
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+rehash_step() {
+    typename ht_stats_recorder<>::timer timer(stats_);
+    const auto old_size = old_buckets_.size();
+    for (size_type k = 0; k < rehash_step_ && rehash_index_ < old_size; ++k, ++rehash_index_) {
+        auto first = old_buckets_[rehash_index_];
+        while (first) {
+            auto next = first->next;
+            const auto code = node_hash_code(first);
+            link_node(buckets_, BucketPolicy::index(code, bucket_size_), first, code);
+            first = next;
+        }
+        old_buckets_[rehash_index_] = nullptr;
+    }
+    if (rehash_index_ == old_size) {
+        bucket_type(old_buckets_.get_allocator()).swap(old_buckets_);
+        rehash_index_ = 0;
+    }
+}
+
+// 一次迁移完所有剩余的旧 bucket
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+finish_rehash() {
+    if (rehashing()) {
+        rehash_step_ = old_buckets_.size();
+        rehash_step();
+    }
+}
+
+// lookup_batch 函数
+// 对 [first, last) 中的每个键值，以找到的节点（未找到时为 nullptr）调用 fn
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+template <class ForwardIter, class Function>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+lookup_batch(ForwardIter first, ForwardIter last, Function fn) const {
+    if (size_ == 0) { // 空表可能尚未分配 bucket
+        for (; first != last; ++first)
+            fn(nullptr);
+        return;
+    }
+    size_type codes[ht_batch_size];
+    size_type slots[ht_batch_size];
+    node_ptr heads[ht_batch_size];
+    while (first != last) {
+        // 计算哈希值，预取 bucket
+        size_type n = 0;
+        for (auto it = first; n < ht_batch_size && it != last; ++n, ++it) {
+            codes[n] = hash_code(*it);
+            slots[n] = slot_of(codes[n]);
+            ht_prefetch(&slot(slots[n]));
+        }
+        // 读取链表头，预取首节点
+        for (size_type i = 0; i < n; ++i) {
+            heads[i] = slot(slots[i]);
+            if (heads[i])
+                ht_prefetch(heads[i]);
+        }
+        // 沿链表比较
+        for (size_type i = 0; i < n; ++i, ++first) {
+            node_ptr cur = heads[i];
+            while (cur && !node_equal(cur, codes[i], *first))
+                cur = cur->next;
+            fn(cur);
+        }
+    }
 }
 
 // copy_insert
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 template <class InputIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 copy_insert_multi(InputIter first, InputIter last, ccystl::input_iterator_tag) {
     rehash_if_need(ccystl::distance(first, last));
     for (; first != last; ++first)
         insert_multi_noresize(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 template <class ForwardIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 copy_insert_multi(ForwardIter first, ForwardIter last, ccystl::forward_iterator_tag) {
     size_type n = ccystl::distance(first, last);
     rehash_if_need(n);
@@ -1361,18 +1960,18 @@ copy_insert_multi(ForwardIter first, ForwardIter last, ccystl::forward_iterator_
         insert_multi_noresize(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 template <class InputIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 copy_insert_unique(InputIter first, InputIter last, ccystl::input_iterator_tag) {
     rehash_if_need(ccystl::distance(first, last));
     for (; first != last; ++first)
         insert_unique_noresize(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
 template <class ForwardIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 copy_insert_unique(ForwardIter first, ForwardIter last, ccystl::forward_iterator_tag) {
     size_type n = ccystl::distance(first, last);
     rehash_if_need(n);
@@ -1381,91 +1980,125 @@ copy_insert_unique(ForwardIter first, ForwardIter last, ccystl::forward_iterator
 }
 
 // insert_node 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 insert_node_multi(node_ptr np) {
-    const auto n = hash(value_traits::get_key(np->value));
-    auto cur = buckets_[n];
+    const auto code = hash_code(value_traits::get_key(np->value));
+    set_hash_code(np, code);
+    const auto n = slot_of(code);
+    auto cur = slot(n);
     if (cur == nullptr) {
-        buckets_[n] = np;
+        slot(n) = np;
         ++size_;
         return iterator(np, this);
     }
     for (; cur; cur = cur->next) {
-        if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value))) {
+        if (node_equal(cur, code, value_traits::get_key(np->value))) {
             np->next = cur->next;
             cur->next = np;
             ++size_;
             return iterator(np, this);
         }
     }
-    np->next = buckets_[n];
-    buckets_[n] = np;
+    np->next = slot(n);
+    slot(n) = np;
     ++size_;
     return iterator(np, this);
 }
 
 // insert_node_unique 函数
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+pair<typename hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 insert_node_unique(node_ptr np) {
-    const auto n = hash(value_traits::get_key(np->value));
-    auto cur = buckets_[n];
+    const auto code = hash_code(value_traits::get_key(np->value));
+    set_hash_code(np, code);
+    const auto n = slot_of(code);
+    auto cur = slot(n);
     if (cur == nullptr) {
-        buckets_[n] = np;
+        slot(n) = np;
         ++size_;
         return ccystl::make_pair(iterator(np, this), true);
     }
     for (; cur; cur = cur->next) {
-        if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value))) {
+        if (node_equal(cur, code, value_traits::get_key(np->value))) {
             return ccystl::make_pair(iterator(cur, this), false);
         }
     }
-    np->next = buckets_[n];
-    buckets_[n] = np;
+    np->next = slot(n);
+    slot(n) = np;
     ++size_;
     return ccystl::make_pair(iterator(np, this), true);
 }
 
+// unlink_node 函数
+// 把 p 从所在的链表中摘下，p 必须属于本表
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+unlink_node(node_ptr p) {
+    const auto n = bucket_of(p);
+    auto cur = slot(n);
+    if (cur == p) {
+        // p 位于链表头部
+        slot(n) = cur->next;
+    }
+    else {
+        while (cur->next != p)
+            cur = cur->next;
+        cur->next = p->next;
+    }
+    p->next = nullptr;
+    --size_;
+}
+
 // replace_bucket 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 replace_bucket(size_type bucket_count) {
-    bucket_type bucket(bucket_count);
+    bucket_type bucket(bucket_count, buckets_.get_allocator());
+    stats_.record_rehash(size_, bucket_size_, bucket_count);
+    typename ht_stats_recorder<>::timer timer(stats_);
     if (size_ != 0) {
+        // 将原有节点直接摘下挂到新的 bucket 上，不重新分配节点
+        // 缓存了哈希值时整个过程不调用哈希函数
         for (size_type i = 0; i < bucket_size_; ++i) {
-            for (auto first = buckets_[i]; first; first = first->next) {
-                auto tmp = create_node(first->value);
-                const auto n = hash(value_traits::get_key(first->value), bucket_count);
-                auto f = bucket[n];
-                bool is_inserted = false;
-                for (auto cur = f; cur; cur = cur->next) {
-                    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(first->value))) {
-                        tmp->next = cur->next;
-                        cur->next = tmp;
-                        is_inserted = true;
-                        break;
-                    }
-                }
-                if (!is_inserted) {
-                    tmp->next = f;
-                    bucket[n] = tmp;
-                }
+            auto first = buckets_[i];
+            while (first) {
+                auto next = first->next;
+                const auto code = node_hash_code(first);
+                link_node(bucket, BucketPolicy::index(code, bucket_count), first, code);
+                first = next;
             }
+            buckets_[i] = nullptr;
         }
     }
     buckets_.swap(bucket);
     bucket_size_ = buckets_.size();
 }
 
+// link_node 函数
+// 把摘下的节点挂到 bucket[n] 上，紧跟在相同键值的节点之后，没有则放在链表头部
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
+link_node(bucket_type& bucket, size_type n, node_ptr np, size_type code) {
+    for (auto cur = bucket[n]; cur; cur = cur->next) {
+        if (node_equal(cur, code, value_traits::get_key(np->value))) {
+            np->next = cur->next;
+            cur->next = np;
+            return;
+        }
+    }
+    np->next = bucket[n];
+    bucket[n] = np;
+}
+
 // erase_bucket 函数
 // 在第 n 个 bucket 内，删除 [first, last) 的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 erase_bucket(size_type n, node_ptr first, node_ptr last) {
-    auto cur = buckets_[n];
+    auto cur = slot(n);
     if (cur == first) {
         erase_bucket(n, last);
     }
@@ -1483,22 +2116,22 @@ erase_bucket(size_type n, node_ptr first, node_ptr last) {
 
 // erase_bucket 函数
 // 在第 n 个 bucket 内，删除 [buckets_[n], last) 的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::
 erase_bucket(size_type n, node_ptr last) {
-    auto cur = buckets_[n];
+    auto cur = slot(n);
     while (cur != last) {
         auto next = cur->next;
         destroy_node(cur);
         cur = next;
         --size_;
     }
-    buckets_[n] = last;
+    slot(n) = last;
 }
 
 // equal_to 函数
-template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other) {
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+bool hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::equal_to_multi(const hashtable& other) {
     if (size_ != other.size_)
         return false;
     for (auto f = begin(), l = end(); f != l;) {
@@ -1512,8 +2145,8 @@ bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other) {
     return true;
 }
 
-template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other) {
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+bool hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>::equal_to_unique(const hashtable& other) {
     if (size_ != other.size_)
         return false;
     for (auto f = begin(), l = end(); f != l; ++f) {
@@ -1525,9 +2158,9 @@ bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other) {
 }
 
 // 重载 ccystl 的 swap
-template <class T, class Hash, class KeyEqual>
-void swap(hashtable<T, Hash, KeyEqual>& lhs,
-          hashtable<T, Hash, KeyEqual>& rhs) noexcept {
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+void swap(hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>& lhs,
+          hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy>& rhs) noexcept {
     lhs.swap(rhs);
 }
 } // namespace ccystl
@@ -0,0 +1,176 @@
+#ifndef CCYSTL_HASHTABLE_STATS_H_
+#define CCYSTL_HASHTABLE_STATS_H_
+
+// 这个头文件包含哈希表的统计信息 hashtable_stats 与 rehash 记录器 ht_stats_recorder
+// 各哈希表与无序容器通过 stats() 返回 hashtable_stats，用于排查哈希函数分布不均、表格过大等问题
+//
+// 统计信息分为两部分：
+//   * 快照：bucket 占用直方图、最长与平均链长、装载因子、内存占用，
+//     调用 stats() 时遍历表格得到，平时不做任何记录
+//   * 历史：rehash 次数、耗时、峰值装载因子与最近若干次 rehash 的记录，由 ht_stats_recorder 在 rehash 时记录
+//
+// notes:
+//
+// 定义宏 CCYSTL_HASHTABLE_STATS 为非零值时才记录历史。缺省不记录，此时 ht_stats_recorder 是空类，
+// 成员函数都是空的内联函数，不占用空间也不生成代码，stats() 中的历史部分全为零
+//
+// 开放寻址的表格没有链表，histogram、max_chain_length、average_chain_length 统计的是
+// 每个元素的探测长度：位于起始位置的元素为 1，向后每移一位加 1
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef CCYSTL_HASHTABLE_STATS
+#define CCYSTL_HASHTABLE_STATS 0
+#endif
+
+namespace ccystl {
+constexpr size_t ht_stats_histogram_size = 16; // 直方图的格数，最后一格统计所有不小于它的长度
+constexpr size_t ht_stats_history_size = 16;   // 保留最近多少次 rehash 的记录
+
+// 一次 rehash 的记录
+struct ht_rehash_event {
+    size_t   size;             // rehash 时的元素个数
+    size_t   old_bucket_count; // 为零表示第一次分配 bucket
+    size_t   new_bucket_count;
+    uint64_t nanoseconds;      // 搬移元素的耗时，渐进式 rehash 为各步之和
+};
+
+// 哈希表的统计信息
+struct hashtable_stats {
+    // 快照
+    size_t size = 0;
+    size_t bucket_count = 0;
+    float  load_factor = 0.0f;
+    float  max_load_factor = 0.0f;
+    size_t empty_buckets = 0;
+    size_t tombstones = 0;             // 删除后留下的墓碑数，只有使用墓碑的开放寻址表非零
+    // 链式表中 histogram[i] 为恰有 i 个元素的 bucket 数；开放寻址表中为探测长度为 i 的元素数
+    size_t histogram[ht_stats_histogram_size] = {};
+    size_t max_chain_length = 0;
+    double average_chain_length = 0.0; // 链式表按非空 bucket 平均，开放寻址表按元素平均
+    size_t node_bytes = 0;             // 节点或槽位占用的字节数
+    size_t bucket_bytes = 0;           // bucket 数组或元数据占用的字节数
+
+    // 历史，只在 CCYSTL_HASHTABLE_STATS 非零时记录
+    size_t          rehash_count = 0;
+    uint64_t        rehash_nanoseconds = 0;
+    float           peak_load_factor = 0.0f; // rehash 前的最大装载因子，与当前装载因子取较大者
+    ht_rehash_event history[ht_stats_history_size] = {}; // 最近的 rehash，按发生顺序排列
+    size_t          history_size = 0;
+
+    size_t total_bytes() const noexcept {
+        return node_bytes + bucket_bytes;
+    }
+
+    // 统计一条长度为 len 的链（或一个探测长度为 len 的元素）
+    void add_chain(size_t len) noexcept {
+        ++histogram[len < ht_stats_histogram_size ? len : ht_stats_histogram_size - 1];
+        if (len > max_chain_length)
+            max_chain_length = len;
+    }
+};
+
+// rehash 记录器，作为哈希表的成员，随表格移动与交换，复制时不复制
+template <bool Enabled = (CCYSTL_HASHTABLE_STATS != 0)>
+class ht_stats_recorder {
+    typedef std::chrono::steady_clock clock;
+
+    ht_rehash_event history_[ht_stats_history_size] = {};
+    size_t          rehash_count_ = 0;
+    uint64_t        rehash_ns_ = 0;
+    float           peak_load_factor_ = 0.0f;
+    bool            timing_ = false; // 已有计时器在计时，嵌套的计时器不再重复计时
+
+public:
+    // 在作用域内计时，析构时计入最近一次 rehash
+    class timer {
+        ht_stats_recorder* recorder_;
+        clock::time_point  start_;
+
+    public:
+        explicit timer(ht_stats_recorder& recorder) noexcept
+            : recorder_(recorder.timing_ ? nullptr : &recorder) {
+            if (recorder_ != nullptr) {
+                recorder_->timing_ = true;
+                start_ = clock::now();
+            }
+        }
+        timer(const timer&) = delete;
+        timer& operator=(const timer&) = delete;
+        ~timer() {
+            if (recorder_ != nullptr) {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_).count();
+                recorder_->timing_ = false;
+                recorder_->add_time(static_cast<uint64_t>(ns));
+            }
+        }
+    };
+
+    ht_stats_recorder() noexcept = default;
+    ht_stats_recorder(const ht_stats_recorder&) noexcept { }
+    ht_stats_recorder& operator=(const ht_stats_recorder&) noexcept {
+        return *this;
+    }
+    ht_stats_recorder(ht_stats_recorder&&) noexcept = default;
+    ht_stats_recorder& operator=(ht_stats_recorder&&) noexcept = default;
+
+    // 开始一次 rehash
+    void record_rehash(size_t size, size_t old_bucket_count, size_t new_bucket_count) noexcept {
+        if (old_bucket_count != 0) {
+            const float lf = static_cast<float>(size) / static_cast<float>(old_bucket_count);
+            if (lf > peak_load_factor_)
+                peak_load_factor_ = lf;
+        }
+        history_[rehash_count_ % ht_stats_history_size] = {size, old_bucket_count, new_bucket_count, 0};
+        ++rehash_count_;
+    }
+
+    void add_time(uint64_t ns) noexcept {
+        rehash_ns_ += ns;
+        if (rehash_count_ != 0)
+            history_[(rehash_count_ - 1) % ht_stats_history_size].nanoseconds += ns;
+    }
+
+    void reset() noexcept {
+        *this = ht_stats_recorder();
+    }
+
+    void swap(ht_stats_recorder& rhs) noexcept {
+        ht_stats_recorder tmp(static_cast<ht_stats_recorder&&>(rhs));
+        rhs = static_cast<ht_stats_recorder&&>(*this);
+        *this = static_cast<ht_stats_recorder&&>(tmp);
+    }
+
+    // 把历史部分填入 s，s 的快照部分须已填好
+    void fill(hashtable_stats& s) const noexcept {
+        s.rehash_count = rehash_count_;
+        s.rehash_nanoseconds = rehash_ns_;
+        s.peak_load_factor = peak_load_factor_ > s.load_factor ? peak_load_factor_ : s.load_factor;
+        s.history_size = rehash_count_ < ht_stats_history_size ? rehash_count_ : ht_stats_history_size;
+        const size_t first = rehash_count_ - s.history_size;
+        for (size_t i = 0; i < s.history_size; ++i)
+            s.history[i] = history_[(first + i) % ht_stats_history_size];
+    }
+};
+
+// 不记录历史时为空类
+template <>
+class ht_stats_recorder<false> {
+public:
+    class timer {
+    public:
+        explicit timer(ht_stats_recorder&) noexcept { }
+        timer(const timer&) = delete;
+        timer& operator=(const timer&) = delete;
+    };
+
+    void record_rehash(size_t, size_t, size_t) noexcept { }
+    void add_time(uint64_t) noexcept { }
+    void reset() noexcept { }
+    void swap(ht_stats_recorder&) noexcept { }
+    void fill(hashtable_stats&) const noexcept { }
+};
+} // namespace ccystl
+#endif // !CCYSTL_HASHTABLE_STATS_H_
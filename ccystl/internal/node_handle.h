@@ -0,0 +1,158 @@
+#ifndef CCYSTL_NODE_HANDLE_H_
+#define CCYSTL_NODE_HANDLE_H_
+
+// 这个头文件包含了节点式容器共用的节点句柄
+// node_handle        : 持有一个已从容器中摘下的节点，可以把它插入另一个兼容的容器而不重新分配
+// node_insert_return : 以节点句柄插入键值不允许重复的容器时的返回值
+//
+// notes:
+//
+// 句柄销毁时若仍持有节点，会析构其中的元素并释放节点
+// 把节点插入另一个容器时，两个容器的分配器必须相等，否则行为未定义
+
+#include <type_traits>
+
+#include "ccystl/allocator/memory.h"
+#include "ccystl/utils/type_traits.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+// forward declaration
+
+template <class T, class Compare, class Alloc, bool CountSubtree>
+class rb_tree;
+
+template <class T, class HashFun, class KeyEqual, class Alloc, class BucketPolicy>
+class hashtable;
+
+// 节点中元素的型别，元素为 pair 时提供 key_type 与 mapped_type
+template <class T, bool>
+struct node_handle_value_traits {
+    typedef T value_type;
+};
+
+template <class T>
+struct node_handle_value_traits<T, true> {
+    typedef typename std::remove_cv<typename T::first_type>::type key_type;
+    typedef typename T::second_type mapped_type;
+};
+
+// 模板类 node_handle
+// 参数一代表节点类型，节点须有名为 value 的元素成员，参数二代表容器的分配器类型
+template <class Node, class Alloc>
+class node_handle
+    : public node_handle_value_traits<decltype(Node::value), ccystl::is_pair<decltype(Node::value)>::value> {
+    template <class, class, class, bool>
+    friend class rb_tree;
+    template <class, class, class, class, class>
+    friend class hashtable;
+
+public:
+    typedef Alloc allocator_type;
+
+private:
+    typedef decltype(Node::value) element_type;
+    typedef typename Alloc::template rebind<element_type>::other data_allocator;
+    typedef typename Alloc::template rebind<Node>::other node_allocator;
+
+    Node* node_;
+    [[no_unique_address]] node_allocator alloc_;
+
+    node_handle(Node* np, const node_allocator& alloc) noexcept
+        : node_(np), alloc_(alloc) { }
+
+    // 交出节点，句柄变为空
+    Node* release() noexcept {
+        Node* np = node_;
+        node_ = nullptr;
+        return np;
+    }
+
+    void reset() noexcept {
+        if (node_ != nullptr) {
+            data_allocator(alloc_).destroy(ccystl::address_of(node_->value));
+            alloc_.deallocate(node_);
+            node_ = nullptr;
+        }
+    }
+
+public:
+    // 构造、移动、析构函数
+
+    constexpr node_handle() noexcept
+        : node_(nullptr), alloc_() { }
+
+    node_handle(node_handle&& rhs) noexcept
+        : node_(rhs.node_), alloc_(rhs.alloc_) {
+        rhs.node_ = nullptr;
+    }
+
+    node_handle& operator=(node_handle&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            node_ = rhs.node_;
+            alloc_ = rhs.alloc_;
+            rhs.node_ = nullptr;
+        }
+        return *this;
+    }
+
+    node_handle(const node_handle&) = delete;
+    node_handle& operator=(const node_handle&) = delete;
+
+    ~node_handle() {
+        reset();
+    }
+
+    // 访问元素，句柄不能为空
+
+    template <class E = element_type, std::enable_if_t<!ccystl::is_pair<E>::value, int> = 0>
+    E& value() const noexcept {
+        return node_->value;
+    }
+
+    // 可以修改键值，之后插入容器时按新键值定位
+    template <class E = element_type, std::enable_if_t<ccystl::is_pair<E>::value, int> = 0>
+    typename std::remove_cv<typename E::first_type>::type& key() const noexcept {
+        return const_cast<typename std::remove_cv<typename E::first_type>::type&>(node_->value.first);
+    }
+
+    template <class E = element_type, std::enable_if_t<ccystl::is_pair<E>::value, int> = 0>
+    typename E::second_type& mapped() const noexcept {
+        return node_->value.second;
+    }
+
+    allocator_type get_allocator() const {
+        return allocator_type(alloc_);
+    }
+
+    bool empty() const noexcept {
+        return node_ == nullptr;
+    }
+
+    explicit operator bool() const noexcept {
+        return node_ != nullptr;
+    }
+
+    void swap(node_handle& rhs) noexcept {
+        ccystl::swap(node_, rhs.node_);
+        ccystl::swap(alloc_, rhs.alloc_);
+    }
+};
+
+// 重载 ccystl 的 swap
+template <class Node, class Alloc>
+void swap(node_handle<Node, Alloc>& lhs, node_handle<Node, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+// 以节点句柄插入键值不允许重复的容器时的返回值
+// 插入失败时 position 指向已有的相同键值元素，节点交还给 node
+template <class Iterator, class NodeHandle>
+struct node_insert_return {
+    Iterator position;
+    bool inserted;
+    NodeHandle node;
+};
+} // namespace ccystl
+#endif // !CCYSTL_NODE_HANDLE_H_
@@ -0,0 +1,156 @@
+#ifndef CCYSTL_PERFECT_HASH_H_
+#define CCYSTL_PERFECT_HASH_H_
+
+// 这个头文件包含了最小完美哈希函数（minimal perfect hash function）的构造与查询
+// 把 n 个互不相同的哈希值一一映射到 [0, n)，供 frozen_hash_map 使用
+//
+// 采用 hash-and-displace（CHD / PTHash 一类）：
+//   * 哈希值先分到 r 个 bucket 中，平均每个 bucket 约 ph_bucket_load 个
+//   * bucket 按大小从大到小依次放置：为每个 bucket 找一个 pilot，使其中的所有哈希值
+//     经 pilot 扰动后落在 [0, m) 内互不相同且尚未被占用的位置
+//   * m 略大于 n（负载约 0.98），使最后放置的 bucket 仍有足够的空位可选；
+//     落在 [n, m) 的位置再经 remap 数组映射到 [0, n) 中剩下的空位，保证结果是“最小”的
+//   * 查询只需读取一个 pilot，必要时再读取一次 remap，与 n 无关
+//
+// notes:
+//
+// 对不在构造集合中的哈希值也会返回 [0, n) 中的某个位置，调用者需要再比较键值
+
+#include <cstdint>
+#include <cstring>
+
+#include "ccystl/container/sequence_container/vector.h"
+#include "ccystl/functor/functional.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+constexpr size_t ph_bucket_load = 4; // 平均每个 bucket 的哈希值个数
+constexpr uint32_t ph_max_pilot = 1u << 22; // 单个 bucket 尝试的 pilot 个数上限，超出时换种子重建
+
+// 把 64 位值均匀映射到 [0, n)，以乘法移位代替取模
+inline size_t ph_reduce(uint64_t x, size_t n) noexcept {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<size_t>((static_cast<unsigned __int128>(x) * n) >> 64);
+#else
+    return static_cast<size_t>((x >> 32) * static_cast<uint64_t>(n) >> 32);
+#endif
+}
+
+inline size_t ph_bucket_count(size_t n) noexcept {
+    return n / ph_bucket_load + 1;
+}
+
+inline size_t ph_slot_count(size_t n) noexcept {
+    return n + n / 50 + 1;
+}
+
+// 以种子打散后的哈希值
+inline uint64_t ph_key_hash(uint64_t hash, uint64_t seed) noexcept {
+    return hash_mix(hash ^ seed);
+}
+
+// 哈希值 h（已经过 ph_key_hash）在 pilot 扰动下落在 [0, m) 中的位置
+inline size_t ph_slot(uint64_t h, uint32_t pilot, size_t m) noexcept {
+    return ph_reduce(hash_mix(h ^ hash_mix(pilot + 0x9e3779b97f4a7c15ULL)), m);
+}
+
+// 查询哈希值 hash 对应的位置
+// pilots 长度为 ph_bucket_count(n)，remap 长度为 ph_slot_count(n) - n
+inline size_t ph_lookup(uint64_t hash, uint64_t seed, const uint32_t* pilots,
+                        const uint32_t* remap, size_t n) noexcept {
+    const uint64_t h = ph_key_hash(hash, seed);
+    const size_t pos = ph_slot(h, pilots[ph_reduce(h, ph_bucket_count(n))], ph_slot_count(n));
+    return pos < n ? pos : remap[pos - n];
+}
+
+// 以种子 seed 为 n 个互不相同的哈希值构造最小完美哈希函数
+// 成功时写出 pilots、remap，以及每个哈希值的位置 positions，返回 true；
+// 某个 bucket 找不到合适的 pilot 时返回 false，调用者换一个种子重试
+inline bool ph_build(const uint64_t* hashes, size_t n, uint64_t seed,
+                     uint32_t* pilots, uint32_t* remap, size_t* positions) {
+    const size_t r = ph_bucket_count(n);
+    const size_t m = ph_slot_count(n);
+
+    // 按 bucket 计数排序，keys 中同一 bucket 的哈希值相邻，first[b] 为 bucket b 的起点
+    ccystl::vector<uint64_t> h(n);
+    ccystl::vector<size_t> first(r + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        h[i] = ph_key_hash(hashes[i], seed);
+        ++first[ph_reduce(h[i], r) + 1];
+    }
+    size_t max_size = 0;
+    for (size_t b = 0; b < r; ++b) {
+        max_size = ccystl::max(max_size, first[b + 1]);
+        first[b + 1] += first[b];
+    }
+    ccystl::vector<size_t> keys(n);
+    {
+        ccystl::vector<size_t> cursor(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < n; ++i)
+            keys[cursor[ph_reduce(h[i], r)]++] = i;
+    }
+
+    // bucket 按大小从大到小排列
+    ccystl::vector<size_t> order(r);
+    {
+        ccystl::vector<size_t> count(max_size + 2, 0);
+        for (size_t b = 0; b < r; ++b)
+            ++count[max_size - (first[b + 1] - first[b]) + 1];
+        for (size_t s = 0; s <= max_size; ++s)
+            count[s + 1] += count[s];
+        for (size_t b = 0; b < r; ++b)
+            order[count[max_size - (first[b + 1] - first[b])]++] = b;
+    }
+
+    ccystl::vector<unsigned char> taken(m, 0);
+    ccystl::vector<size_t> pos(max_size);
+    for (size_t b : order) {
+        const size_t lo = first[b], size = first[b + 1] - lo;
+        if (size == 0) {
+            pilots[b] = 0;
+            continue;
+        }
+        uint32_t pilot = 0;
+        for (;; ++pilot) {
+            if (pilot == ph_max_pilot)
+                return false;
+            size_t k = 0;
+            for (; k < size; ++k) {
+                pos[k] = ph_slot(h[keys[lo + k]], pilot, m);
+                if (taken[pos[k]])
+                    break;
+                size_t j = 0;
+                while (j < k && pos[j] != pos[k])
+                    ++j;
+                if (j != k)
+                    break;
+            }
+            if (k == size)
+                break;
+        }
+        pilots[b] = pilot;
+        for (size_t k = 0; k < size; ++k) {
+            taken[pos[k]] = 1;
+            positions[keys[lo + k]] = pos[k];
+        }
+    }
+
+    // 把 [n, m) 中被占用的位置依次对应到 [0, n) 中的空位
+    size_t hole = 0;
+    for (size_t p = n; p < m; ++p) {
+        if (!taken[p]) {
+            remap[p - n] = 0;
+            continue;
+        }
+        while (taken[hole])
+            ++hole;
+        remap[p - n] = static_cast<uint32_t>(hole++);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (positions[i] >= n)
+            positions[i] = remap[positions[i] - n];
+    }
+    return true;
+}
+} // namespace ccystl
+#endif // !CCYSTL_PERFECT_HASH_H_
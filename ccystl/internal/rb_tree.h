@@ -4,7 +4,12 @@
 // 这个头文件包含一个模板类 rb_tree
 // rb_tree : 红黑树
 
+#include <cstdint>
+
+#include "ccystl/allocator/allocator.h"
 #include "ccystl/allocator/memory.h"
+#include "ccystl/allocator/memory_resource.h"
+#include "ccystl/internal/node_handle.h"
 #include "ccystl/internal/type_traits.h"
 #include "ccystl/iterator/iterator.h"
 #include "ccystl/utils/except_def.h"
@@ -17,6 +22,14 @@ using rb_tree_color_type = bool;
 static constexpr rb_tree_color_type rb_tree_red = false;
 static constexpr rb_tree_color_type rb_tree_black = true;
 
+// 指针至少按 2 字节对齐时，把颜色存放在父节点指针的最低位，节点少占一个字
+// 定义 CCYSTL_RB_TREE_PLAIN_NODE 可以改用颜色单独存放的布局，便于调试器直接查看
+#ifdef CCYSTL_RB_TREE_PLAIN_NODE
+static constexpr bool rb_tree_compact_node = false;
+#else
+static constexpr bool rb_tree_compact_node = alignof(void*) >= 2;
+#endif // CCYSTL_RB_TREE_PLAIN_NODE
+
 // forward declaration
 
 template <class T>
@@ -103,17 +116,97 @@ struct rb_tree_node_traits {
 
 // rb tree 的节点设计
 
+// 节点的链接与颜色
+// 两种布局的接口相同，父节点与颜色一律通过 get_parent / set_parent / get_color / set_color 访问，
+// 不要直接使用 parent_ 与 color_
+
+// 普通布局：颜色单独存放，补齐后每个节点多占一个字
+template <class BasePtr, bool Compact>
+struct rb_tree_node_links {
+    typedef rb_tree_color_type color_type;
+
+    BasePtr parent_; // 父节点
+    BasePtr left; // 左子节点
+    BasePtr right; // 右子节点
+    color_type color_; // 节点颜色
+
+    BasePtr get_parent() const noexcept {
+        return parent_;
+    }
+
+    void set_parent(BasePtr p) noexcept {
+        parent_ = p;
+    }
+
+    color_type get_color() const noexcept {
+        return color_;
+    }
+
+    void set_color(color_type c) noexcept {
+        color_ = c;
+    }
+
+    // 用于尚未初始化的节点
+    void set_parent_color(BasePtr p, color_type c) noexcept {
+        parent_ = p;
+        color_ = c;
+    }
+
+    // header 的父节点即根节点，容器以引用的方式修改它
+    BasePtr& parent_ref() noexcept {
+        return parent_;
+    }
+};
+
+// 紧凑布局：节点至少按指针对齐，父节点指针的最低位总为 0，用它存放颜色，每个节点只有三个字
+// rb_tree_red 为 0，红色节点的 parent_ 就是父节点的地址；header 永远为红，parent_ref() 因而可以直接使用
+template <class BasePtr>
+struct rb_tree_node_links<BasePtr, true> {
+    typedef rb_tree_color_type color_type;
+
+    BasePtr parent_; // 父节点，最低位为颜色
+    BasePtr left; // 左子节点
+    BasePtr right; // 右子节点
+
+    static uintptr_t bits(BasePtr p) noexcept {
+        return reinterpret_cast<uintptr_t>(p);
+    }
+
+    static BasePtr from_bits(uintptr_t v) noexcept {
+        return reinterpret_cast<BasePtr>(v);
+    }
+
+    BasePtr get_parent() const noexcept {
+        return from_bits(bits(parent_) & ~uintptr_t(1));
+    }
+
+    void set_parent(BasePtr p) noexcept {
+        parent_ = from_bits(bits(p) | (bits(parent_) & uintptr_t(1)));
+    }
+
+    color_type get_color() const noexcept {
+        return static_cast<color_type>(bits(parent_) & uintptr_t(1));
+    }
+
+    void set_color(color_type c) noexcept {
+        parent_ = from_bits((bits(parent_) & ~uintptr_t(1)) | static_cast<uintptr_t>(c));
+    }
+
+    void set_parent_color(BasePtr p, color_type c) noexcept {
+        parent_ = from_bits(bits(p) | static_cast<uintptr_t>(c));
+    }
+
+    BasePtr& parent_ref() noexcept {
+        return parent_;
+    }
+};
+
 template <class T>
-struct rb_tree_node_base {
+struct rb_tree_node_base : public rb_tree_node_links<rb_tree_node_base<T>*, rb_tree_compact_node> {
     typedef rb_tree_color_type color_type;
     typedef rb_tree_node_base<T>* base_ptr;
     typedef rb_tree_node<T>* node_ptr;
 
-    base_ptr parent; // 父节点
-    base_ptr left; // 左子节点
-    base_ptr right; // 右子节点
-    color_type color; // 节点颜色
-
     base_ptr get_base_ptr() {
         return &*this;
     }
@@ -143,6 +236,12 @@ struct rb_tree_node : public rb_tree_node_base<T> {
     }
 };
 
+// 顺序统计树的节点，多记录子树的节点数；size 位于元素之后，不改变 value 的偏移
+template <class T>
+struct rb_tree_counted_node : public rb_tree_node<T> {
+    size_t size; // 以该节点为根的子树的节点数
+};
+
 // rb tree traits
 
 template <class T>
@@ -182,10 +281,10 @@ struct rb_tree_iterator_base : iterator<bidirectional_iterator_tag, T> {
         }
         else {
             // 如果没有右子节点
-            auto y = node->parent;
+            auto y = node->get_parent();
             while (y->right == node) {
                 node = y;
-                y = y->parent;
+                y = y->get_parent();
             }
             if (node->right != y) // 应对“寻找根节点的下一节点，而根节点没有右子节点”的特殊情况
                 node = y;
@@ -194,7 +293,7 @@ struct rb_tree_iterator_base : iterator<bidirectional_iterator_tag, T> {
 
     // 使迭代器后退
     void dec() {
-        if (node->parent->parent == node && rb_tree_is_red(node)) {
+        if (node->get_parent()->get_parent() == node && rb_tree_is_red(node)) {
             // 如果 node 为 header
             node = node->right; // 指向整棵树的 max 节点
         }
@@ -203,10 +302,10 @@ struct rb_tree_iterator_base : iterator<bidirectional_iterator_tag, T> {
         }
         else {
             // 非 header 节点，也无左子节点
-            auto y = node->parent;
+            auto y = node->get_parent();
             while (node == y->left) {
                 node = y;
-                y = y->parent;
+                y = y->get_parent();
             }
             node = y;
         }
@@ -373,22 +472,22 @@ NodePtr rb_tree_max(NodePtr x) noexcept {
 
 template <class NodePtr>
 bool rb_tree_is_lchild(NodePtr node) noexcept {
-    return node == node->parent->left;
+    return node == node->get_parent()->left;
 }
 
 template <class NodePtr>
 bool rb_tree_is_red(NodePtr node) noexcept {
-    return node->color == rb_tree_red;
+    return node->get_color() == rb_tree_red;
 }
 
 template <class NodePtr>
-void rb_tree_set_black(NodePtr& node) noexcept {
-    node->color = rb_tree_black;
+void rb_tree_set_black(NodePtr node) noexcept {
+    node->set_color(rb_tree_black);
 }
 
 template <class NodePtr>
-void rb_tree_set_red(NodePtr& node) noexcept {
-    node->color = rb_tree_red;
+void rb_tree_set_red(NodePtr node) noexcept {
+    node->set_color(rb_tree_red);
 }
 
 template <class NodePtr>
@@ -396,10 +495,103 @@ NodePtr rb_tree_next(NodePtr node) noexcept {
     if (node->right != nullptr)
         return rb_tree_min(node->right);
     while (!rb_tree_is_lchild(node))
-        node = node->parent;
-    return node->parent;
+        node = node->get_parent();
+    return node->get_parent();
 }
 
+// 集合运算的执行策略：递归中两个互不相交的子问题怎样计算
+//   fork_depth()      : 递归中最多分叉的层数，为 0 时从不分叉
+//   fork_join(f1, f2) : 计算 f1 与 f2，两者都完成后返回
+// 缺省的策略依次计算，不创建线程；并行的策略见 ccystl/internal/rb_tree_parallel.h
+struct rb_tree_sequential_policy {
+    size_t fork_depth() const noexcept {
+        return 0;
+    }
+
+    template <class F1, class F2>
+    void fork_join(F1&& f1, F2&& f2) const {
+        f1();
+        f2();
+    }
+};
+
+// 节点的附加信息（augment）在结构调整时的维护策略，以下算法在相应的时机调用：
+//   rotated(x, y)  : x 旋转到了原子节点 y 的下方
+//   inserted(x, r) : 新节点 x 已挂入树中，尚未调整平衡
+//   erasing(y, r)  : 即将摘下 y（要删除的节点或它的后继）
+//   replaced(z, y) : y 顶替了要删除的节点 z 的位置
+//   changed(x, r)  : x 的子节点被整棵替换（join 时），重新计算 x 及其所有祖先
+// 参数 r 为根节点
+
+// 普通的红黑树不维护附加信息，各函数都是空的，内联后没有任何开销
+struct rb_tree_no_augment {
+    template <class NodePtr>
+    void rotated(NodePtr, NodePtr) const noexcept { }
+
+    template <class NodePtr>
+    void inserted(NodePtr, NodePtr) const noexcept { }
+
+    template <class NodePtr>
+    void erasing(NodePtr, NodePtr) const noexcept { }
+
+    template <class NodePtr>
+    void replaced(NodePtr, NodePtr) const noexcept { }
+
+    template <class NodePtr>
+    void changed(NodePtr, NodePtr) const noexcept { }
+};
+
+// 维护 rb_tree_counted_node 的子树大小
+template <class T>
+struct rb_tree_size_augment {
+    typedef rb_tree_node_base<T>* base_ptr;
+    typedef rb_tree_counted_node<T>* node_ptr;
+
+    static size_t& size(base_ptr x) noexcept {
+        return static_cast<node_ptr>(x->get_node_ptr())->size;
+    }
+
+    static size_t size_or_zero(base_ptr x) noexcept {
+        return x == nullptr ? 0 : size(x);
+    }
+
+    // y 接管 x 原来的整棵子树，x 的子树大小由新的子节点重新计算
+    void rotated(base_ptr x, base_ptr y) const noexcept {
+        size(y) = size(x);
+        size(x) = size_or_zero(x->left) + size_or_zero(x->right) + 1;
+    }
+
+    // 新节点到根节点路径上的每个祖先都多了一个节点
+    void inserted(base_ptr x, base_ptr root) const noexcept {
+        size(x) = 1;
+        while (x != root) {
+            x = x->get_parent();
+            ++size(x);
+        }
+    }
+
+    void erasing(base_ptr y, base_ptr root) const noexcept {
+        while (y != root) {
+            y = y->get_parent();
+            --size(y);
+        }
+    }
+
+    // z 的子树大小已在 erasing 中减去了 y
+    void replaced(base_ptr z, base_ptr y) const noexcept {
+        size(y) = size(z);
+    }
+
+    void changed(base_ptr x, base_ptr root) const noexcept {
+        while (true) {
+            size(x) = size_or_zero(x->left) + size_or_zero(x->right) + 1;
+            if (x == root)
+                break;
+            x = x->get_parent();
+        }
+    }
+};
+
 /*---------------------------------------*\
 |       p                         p       |
 |      / \                       / \      |
@@ -409,14 +601,14 @@ NodePtr rb_tree_next(NodePtr node) noexcept {
 |      / \                   / \          |
 |     b   c                 a   b         |
 \*---------------------------------------*/
-// 左旋，参数一为左旋点，参数二为根节点
-template <class NodePtr>
-void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept {
+// 左旋，参数一为左旋点，参数二为根节点，参数三为附加信息的维护策略
+template <class NodePtr, class Augment = rb_tree_no_augment>
+void rb_tree_rotate_left(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept {
     auto y = x->right; // y 为 x 的右子节点
     x->right = y->left;
     if (y->left != nullptr)
-        y->left->parent = x;
-    y->parent = x->parent;
+        y->left->set_parent(x);
+    y->set_parent(x->get_parent());
 
     if (x == root) {
         // 如果 x 为根节点，让 y 顶替 x 成为根节点
@@ -424,15 +616,16 @@ void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept {
     }
     else if (rb_tree_is_lchild(x)) {
         // 如果 x 是左子节点
-        x->parent->left = y;
+        x->get_parent()->left = y;
     }
     else {
         // 如果 x 是右子节点
-        x->parent->right = y;
+        x->get_parent()->right = y;
     }
     // 调整 x 与 y 的关系
     y->left = x;
-    x->parent = y;
+    x->set_parent(y);
+    aug.rotated(x, y);
 }
 
 /*----------------------------------------*\
@@ -444,14 +637,14 @@ void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept {
 |    / \                           / \     |
 |   b   c                         c   a    |
 \*----------------------------------------*/
-// 右旋，参数一为右旋点，参数二为根节点
-template <class NodePtr>
-void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept {
+// 右旋，参数一为右旋点，参数二为根节点，参数三为附加信息的维护策略
+template <class NodePtr, class Augment = rb_tree_no_augment>
+void rb_tree_rotate_right(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept {
     auto y = x->left;
     x->left = y->right;
     if (y->right)
-        y->right->parent = x;
-    y->parent = x->parent;
+        y->right->set_parent(x);
+    y->set_parent(x->get_parent());
 
     if (x == root) {
         // 如果 x 为根节点，让 y 顶替 x 成为根节点
@@ -459,18 +652,21 @@ void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept {
     }
     else if (rb_tree_is_lchild(x)) {
         // 如果 x 是右子节点
-        x->parent->left = y;
+        x->get_parent()->left = y;
     }
     else {
         // 如果 x 是左子节点
-        x->parent->right = y;
+        x->get_parent()->right = y;
     }
     // 调整 x 与 y 的关系
     y->right = x;
-    x->parent = y;
+    x->set_parent(y);
+    aug.rotated(x, y);
 }
 
-// 插入节点后使 rb tree 重新平衡，参数一为新增节点，参数二为根节点
+// 消除红色节点 x 与其父节点的连续红色，参数一为红色节点，参数二为根节点，参数三为附加信息的维护策略
+// x 不必是叶节点，只要求它的两棵子树黑高相同（join 时挂入的是一整棵子树）
+// 返回根节点最后是否由红涂黑，即整棵树的黑高是否增加了一
 //
 // case 1: 新增节点位于根节点，令新增节点为黑
 // case 2: 新增节点的父节点为黑，没有破坏平衡，直接返回
@@ -483,42 +679,41 @@ void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept {
 //
 // 参考博客: http://blog.csdn.net/v_JULY_v/article/details/6105630
 //          http://blog.csdn.net/v_JULY_v/article/details/6109153
-template <class NodePtr>
-void rb_tree_insert_rebalance(NodePtr x, NodePtr& root) noexcept {
-    rb_tree_set_red(x); // 新增节点为红色
-    while (x != root && rb_tree_is_red(x->parent)) {
-        if (rb_tree_is_lchild(x->parent)) {
+template <class NodePtr, class Augment = rb_tree_no_augment>
+bool rb_tree_insert_fixup(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept {
+    while (x != root && rb_tree_is_red(x->get_parent())) {
+        if (rb_tree_is_lchild(x->get_parent())) {
             // 如果父节点是左子节点
-            auto uncle = x->parent->parent->right;
+            auto uncle = x->get_parent()->get_parent()->right;
             if (uncle != nullptr && rb_tree_is_red(uncle)) {
                 // case 3: 父节点和叔叔节点都为红
-                rb_tree_set_black(x->parent);
+                rb_tree_set_black(x->get_parent());
                 rb_tree_set_black(uncle);
-                x = x->parent->parent;
+                x = x->get_parent()->get_parent();
                 rb_tree_set_red(x);
             }
             else {
                 // 无叔叔节点或叔叔节点为黑
                 if (!rb_tree_is_lchild(x)) {
                     // case 4: 当前节点 x 为右子节点
-                    x = x->parent;
-                    rb_tree_rotate_left(x, root);
+                    x = x->get_parent();
+                    rb_tree_rotate_left(x, root, aug);
                 }
                 // 都转换成 case 5： 当前节点为左子节点
-                rb_tree_set_black(x->parent);
-                rb_tree_set_red(x->parent->parent);
-                rb_tree_rotate_right(x->parent->parent, root);
+                rb_tree_set_black(x->get_parent());
+                rb_tree_set_red(x->get_parent()->get_parent());
+                rb_tree_rotate_right(x->get_parent()->get_parent(), root, aug);
                 break;
             }
         }
         else // 如果父节点是右子节点，对称处理
         {
-            auto uncle = x->parent->parent->left;
+            auto uncle = x->get_parent()->get_parent()->left;
             if (uncle != nullptr && rb_tree_is_red(uncle)) {
                 // case 3: 父节点和叔叔节点都为红
-                rb_tree_set_black(x->parent);
+                rb_tree_set_black(x->get_parent());
                 rb_tree_set_black(uncle);
-                x = x->parent->parent;
+                x = x->get_parent()->get_parent();
                 rb_tree_set_red(x);
                 // 此时祖父节点为红，可能会破坏红黑树的性质，令当前节点为祖父节点，继续处理
             }
@@ -526,28 +721,41 @@ void rb_tree_insert_rebalance(NodePtr x, NodePtr& root) noexcept {
                 // 无叔叔节点或叔叔节点为黑
                 if (rb_tree_is_lchild(x)) {
                     // case 4: 当前节点 x 为左子节点
-                    x = x->parent;
-                    rb_tree_rotate_right(x, root);
+                    x = x->get_parent();
+                    rb_tree_rotate_right(x, root, aug);
                 }
                 // 都转换成 case 5： 当前节点为左子节点
-                rb_tree_set_black(x->parent);
-                rb_tree_set_red(x->parent->parent);
-                rb_tree_rotate_left(x->parent->parent, root);
+                rb_tree_set_black(x->get_parent());
+                rb_tree_set_red(x->get_parent()->get_parent());
+                rb_tree_rotate_left(x->get_parent()->get_parent(), root, aug);
                 break;
             }
         }
     }
+    const bool grew = rb_tree_is_red(root);
     rb_tree_set_black(root); // 根节点永远为黑
+    return grew;
 }
 
-// 删除节点后使 rb tree 重新平衡，参数一为要删除的节点，参数二为根节点，参数三为最小节点，参数四为最大节点
+// 插入节点后使 rb tree 重新平衡，参数一为新增节点，参数二为根节点，参数三为附加信息的维护策略
+template <class NodePtr, class Augment = rb_tree_no_augment>
+void rb_tree_insert_rebalance(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept {
+    aug.inserted(x, root);
+    rb_tree_set_red(x); // 新增节点为红色
+    rb_tree_insert_fixup(x, root, aug);
+}
+
+// 删除节点后使 rb tree 重新平衡，参数一为要删除的节点，参数二为根节点，参数三为最小节点，参数四为最大节点，
+// 参数五为附加信息的维护策略
 //
 // 参考博客: http://blog.csdn.net/v_JULY_v/article/details/6105630
 //          http://blog.csdn.net/v_JULY_v/article/details/6109153
-template <class NodePtr>
-NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost) {
+template <class NodePtr, class Augment = rb_tree_no_augment>
+NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost,
+                                Augment aug = Augment()) {
     // y 是可能的替换节点，指向最终要删除的节点
     auto y = (z->left == nullptr || z->right == nullptr) ? z : rb_tree_next(z);
+    aug.erasing(y, root);
     // x 是 y 的一个独子节点或 NIL 节点
     auto x = y->left != nullptr ? y->left : y->right;
     // xp 为 x 的父节点
@@ -556,19 +764,19 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
     // y != z 说明 z 有两个非空子节点，此时 y 指向 z 右子树的最左节点，x 指向 y 的右子节点。
     // 用 y 顶替 z 的位置，用 x 顶替 y 的位置，最后用 y 指向 z
     if (y != z) {
-        z->left->parent = y;
+        z->left->set_parent(y);
         y->left = z->left;
 
         // 如果 y 不是 z 的右子节点，那么 z 的右子节点一定有左孩子
         if (y != z->right) {
             // x 替换 y 的位置
-            xp = y->parent;
+            xp = y->get_parent();
             if (x != nullptr)
-                x->parent = y->parent;
+                x->set_parent(y->get_parent());
 
-            y->parent->left = x;
+            y->get_parent()->left = x;
             y->right = z->right;
-            z->right->parent = y;
+            z->right->set_parent(y);
         }
         else {
             xp = y;
@@ -578,26 +786,29 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         if (root == z)
             root = y;
         else if (rb_tree_is_lchild(z))
-            z->parent->left = y;
+            z->get_parent()->left = y;
         else
-            z->parent->right = y;
-        y->parent = z->parent;
-        ccystl::swap(y->color, z->color);
+            z->get_parent()->right = y;
+        y->set_parent(z->get_parent());
+        const auto color = y->get_color();
+        y->set_color(z->get_color());
+        z->set_color(color);
+        aug.replaced(z, y);
         y = z;
     }
     // y == z 说明 z 至多只有一个孩子
     else {
-        xp = y->parent;
+        xp = y->get_parent();
         if (x)
-            x->parent = y->parent;
+            x->set_parent(y->get_parent());
 
         // 连接 x 与 z 的父节点
         if (root == z)
             root = x;
         else if (rb_tree_is_lchild(z))
-            z->parent->left = x;
+            z->get_parent()->left = x;
         else
-            z->parent->right = x;
+            z->get_parent()->right = x;
 
         // 此时 z 有可能是最左节点或最右节点，更新数据
         if (leftmost == z)
@@ -624,7 +835,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
                     // case 1
                     rb_tree_set_black(brother);
                     rb_tree_set_red(xp);
-                    rb_tree_rotate_left(xp, root);
+                    rb_tree_rotate_left(xp, root, aug);
                     brother = xp->right;
                 }
                 // case 1 转为为了 case 2、3、4 中的一种
@@ -633,7 +844,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
                     // case 2
                     rb_tree_set_red(brother);
                     x = xp;
-                    xp = xp->parent;
+                    xp = xp->get_parent();
                 }
                 else {
                     if (brother->right == nullptr || !rb_tree_is_red(brother->right)) {
@@ -641,15 +852,15 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
                         if (brother->left != nullptr)
                             rb_tree_set_black(brother->left);
                         rb_tree_set_red(brother);
-                        rb_tree_rotate_right(brother, root);
+                        rb_tree_rotate_right(brother, root, aug);
                         brother = xp->right;
                     }
                     // 转为 case 4
-                    brother->color = xp->color;
+                    brother->set_color(xp->get_color());
                     rb_tree_set_black(xp);
                     if (brother->right != nullptr)
                         rb_tree_set_black(brother->right);
-                    rb_tree_rotate_left(xp, root);
+                    rb_tree_rotate_left(xp, root, aug);
                     break;
                 }
             }
@@ -660,7 +871,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
                     // case 1
                     rb_tree_set_black(brother);
                     rb_tree_set_red(xp);
-                    rb_tree_rotate_right(xp, root);
+                    rb_tree_rotate_right(xp, root, aug);
                     brother = xp->left;
                 }
                 if ((brother->left == nullptr || !rb_tree_is_red(brother->left)) &&
@@ -668,7 +879,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
                     // case 2
                     rb_tree_set_red(brother);
                     x = xp;
-                    xp = xp->parent;
+                    xp = xp->get_parent();
                 }
                 else {
                     if (brother->left == nullptr || !rb_tree_is_red(brother->left)) {
@@ -676,15 +887,15 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
                         if (brother->right != nullptr)
                             rb_tree_set_black(brother->right);
                         rb_tree_set_red(brother);
-                        rb_tree_rotate_left(brother, root);
+                        rb_tree_rotate_left(brother, root, aug);
                         brother = xp->left;
                     }
                     // 转为 case 4
-                    brother->color = xp->color;
+                    brother->set_color(xp->get_color());
                     rb_tree_set_black(xp);
                     if (brother->left != nullptr)
                         rb_tree_set_black(brother->left);
-                    rb_tree_rotate_right(xp, root);
+                    rb_tree_rotate_right(xp, root, aug);
                     break;
                 }
             }
@@ -696,8 +907,9 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
 }
 
 // 模板类 rb_tree
-// 参数一代表数据类型，参数二代表键值比较类型
-template <class T, class Compare>
+// 参数一代表数据类型，参数二代表键值比较类型，参数三代表分配器类型，缺省使用 ccystl::allocator
+// 参数四为 true 时每个节点记录子树大小，成为顺序统计树，支持 O(log n) 的 rank、select、distance 与 advance
+template <class T, class Compare, class Alloc = ccystl::allocator<T>, bool CountSubtree = false>
 class rb_tree {
 public:
     // rb_tree 的嵌套型别定义
@@ -707,17 +919,20 @@ public:
 
     typedef typename tree_traits::base_type base_type;
     typedef typename tree_traits::base_ptr base_ptr;
-    typedef typename tree_traits::node_type node_type;
-    typedef typename tree_traits::node_ptr node_ptr;
+    typedef typename std::conditional<CountSubtree,
+        rb_tree_counted_node<T>, typename tree_traits::node_type>::type node_type;
+    typedef node_type* node_ptr;
+    typedef typename std::conditional<CountSubtree,
+        rb_tree_size_augment<T>, rb_tree_no_augment>::type augment_type;
     typedef typename tree_traits::key_type key_type;
     typedef typename tree_traits::mapped_type mapped_type;
     typedef typename tree_traits::value_type value_type;
     typedef Compare key_compare;
 
-    typedef ccystl::allocator<T> allocator_type;
-    typedef ccystl::allocator<T> data_allocator;
-    typedef ccystl::allocator<base_type> base_allocator;
-    typedef ccystl::allocator<node_type> node_allocator;
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
+    typedef typename Alloc::template rebind<node_type>::other node_allocator;
+    typedef typename Alloc::template rebind<base_ptr>::other base_ptr_allocator;
 
     typedef typename allocator_type::pointer pointer;
     typedef typename allocator_type::const_pointer const_pointer;
@@ -731,8 +946,11 @@ public:
     typedef ccystl::reverse_iterator<iterator> reverse_iterator;
     typedef ccystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
+    typedef ccystl::node_handle<node_type, Alloc> node_handle_type;
+    typedef ccystl::node_insert_return<iterator, node_handle_type> insert_return_type;
+
     allocator_type get_allocator() const {
-        return node_allocator();
+        return allocator_type(node_alloc_);
     }
 
     key_compare key_comp() const {
@@ -741,31 +959,47 @@ public:
 
 private:
     // 用以下三个数据表现 rb tree
-    base_ptr header_; // 特殊节点，与根节点互为对方的父节点
+    base_type header_node_; // 特殊节点，与根节点互为对方的父节点，内嵌于容器中因而无需分配
     size_type node_count_; // 节点数
     key_compare key_comp_; // 节点键值比较的准则
+    [[no_unique_address]] node_allocator node_alloc_; // 节点分配器，数据与 header 的分配器由它转换得到
 
 private:
+    base_ptr header() const noexcept {
+        return const_cast<base_ptr>(&header_node_);
+    }
+
     // 以下三个函数用于取得根节点，最小节点和最大节点
     base_ptr& root() const {
-        return header_->parent;
+        return header()->parent_ref();
     }
 
     base_ptr& leftmost() const {
-        return header_->left;
+        return header()->left;
     }
 
     base_ptr& rightmost() const {
-        return header_->right;
+        return header()->right;
     }
 
 public:
     // 构造、复制、析构函数
-    rb_tree() {
+    rb_tree() noexcept {
+        rb_tree_init();
+    }
+
+    explicit rb_tree(const allocator_type& alloc) noexcept
+        : key_comp_(), node_alloc_(alloc) {
+        rb_tree_init();
+    }
+
+    explicit rb_tree(const key_compare& comp, const allocator_type& alloc = allocator_type())
+        : key_comp_(comp), node_alloc_(alloc) {
         rb_tree_init();
     }
 
     rb_tree(const rb_tree& rhs);
+    rb_tree(const rb_tree& rhs, const allocator_type& alloc);
     rb_tree(rb_tree&& rhs) noexcept;
 
     rb_tree& operator=(const rb_tree& rhs);
@@ -787,11 +1021,11 @@ public:
     }
 
     iterator end() noexcept {
-        return header_;
+        return header();
     }
 
     const_iterator end() const noexcept {
-        return header_;
+        return header();
     }
 
     reverse_iterator rbegin() noexcept {
@@ -872,10 +1106,28 @@ public:
         return emplace_multi_use_hint(hint, ccystl::move(value));
     }
 
+    // 空树插入有序范围时以 O(n) 直接建树，否则逐个插入
     template <class InputIterator>
     void insert_multi(InputIterator first, InputIterator last) {
         size_type n = ccystl::distance(first, last);
         THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+        if (node_count_ == 0 && n != 0 && count_sorted(first, last, false) == n) {
+            build_sorted(first, last, n, false);
+            return;
+        }
+        for (; n > 0; --n, ++first)
+            insert_multi(end(), *first);
+    }
+
+    // 调用者保证范围已按键值升序排列，空树时不再检查，直接建树
+    template <class InputIterator>
+    void insert_multi(sorted_equivalent_t, InputIterator first, InputIterator last) {
+        size_type n = ccystl::distance(first, last);
+        THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+        if (node_count_ == 0 && n != 0) {
+            build_sorted(first, last, n, false);
+            return;
+        }
         for (; n > 0; --n, ++first)
             insert_multi(end(), *first);
     }
@@ -894,10 +1146,31 @@ public:
         return emplace_unique_use_hint(hint, ccystl::move(value));
     }
 
+    // 空树插入有序范围时以 O(n) 直接建树，重复的键值只保留第一个，否则逐个插入
     template <class InputIterator>
     void insert_unique(InputIterator first, InputIterator last) {
         size_type n = ccystl::distance(first, last);
         THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+        if (node_count_ == 0 && n != 0) {
+            const size_type distinct = count_sorted(first, last, true);
+            if (distinct != 0) {
+                build_sorted(first, last, distinct, distinct != n);
+                return;
+            }
+        }
+        for (; n > 0; --n, ++first)
+            insert_unique(end(), *first);
+    }
+
+    // 调用者保证范围已按键值升序排列且没有重复，空树时不再检查，直接建树
+    template <class InputIterator>
+    void insert_unique(sorted_unique_t, InputIterator first, InputIterator last) {
+        size_type n = ccystl::distance(first, last);
+        THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+        if (node_count_ == 0 && n != 0) {
+            build_sorted(first, last, n, false);
+            return;
+        }
         for (; n > 0; --n, ++first)
             insert_unique(end(), *first);
     }
@@ -915,43 +1188,58 @@ public:
 
     // rb_tree 相关操作
 
-    iterator find(const key_type& key);
-    const_iterator find(const key_type& key) const;
+    template <class K>
+    iterator find(const K& key);
+    template <class K>
+    const_iterator find(const K& key) const;
 
-    size_type count_multi(const key_type& key) const {
+    template <class K>
+    size_type count_multi(const K& key) const {
         auto p = equal_range_multi(key);
-        return static_cast<size_type>(ccystl::distance(p.first, p.second));
+        if constexpr (CountSubtree)
+            return index_of(p.second) - index_of(p.first);
+        else
+            return static_cast<size_type>(ccystl::distance(p.first, p.second));
     }
 
-    size_type count_unique(const key_type& key) const {
+    template <class K>
+    size_type count_unique(const K& key) const {
         return find(key) != end() ? 1 : 0;
     }
 
-    iterator lower_bound(const key_type& key);
-    const_iterator lower_bound(const key_type& key) const;
+    template <class K>
+    iterator lower_bound(const K& key);
+    template <class K>
+    const_iterator lower_bound(const K& key) const;
 
-    iterator upper_bound(const key_type& key);
-    const_iterator upper_bound(const key_type& key) const;
+    template <class K>
+    iterator upper_bound(const K& key);
+    template <class K>
+    const_iterator upper_bound(const K& key) const;
 
+    template <class K>
     ccystl::pair<iterator, iterator>
-    equal_range_multi(const key_type& key) {
+    equal_range_multi(const K& key) {
         return ccystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
     }
 
+    template <class K>
     ccystl::pair<const_iterator, const_iterator>
-    equal_range_multi(const key_type& key) const {
+    equal_range_multi(const K& key) const {
         return ccystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
     }
 
+    template <class K>
     ccystl::pair<iterator, iterator>
-    equal_range_unique(const key_type& key) {
+    equal_range_unique(const K& key) {
         iterator it = find(key);
         auto next = it;
         return it == end() ? ccystl::make_pair(it, it) : ccystl::make_pair(it, ++next);
     }
 
+    template <class K>
     ccystl::pair<const_iterator, const_iterator>
-    equal_range_unique(const key_type& key) const {
+    equal_range_unique(const K& key) const {
         const_iterator it = find(key);
         auto next = it;
         return it == end() ? ccystl::make_pair(it, it) : ccystl::make_pair(it, ++next);
@@ -959,6 +1247,79 @@ public:
 
     void swap(rb_tree& rhs) noexcept;
 
+    // 顺序统计，只有 CountSubtree 为 true 时可用，均为 O(log n)
+
+    // 键值小于 key 的元素个数，即 lower_bound(key) 的下标
+    template <class K>
+    size_type rank(const K& key) const;
+
+    // 下标为 k 的元素，k 不小于 size() 时返回 end()
+    iterator select(size_type k);
+    const_iterator select(size_type k) const;
+
+    // 迭代器所指元素的下标，end() 的下标为 size()
+    size_type index_of(const_iterator position) const;
+
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return static_cast<difference_type>(index_of(last)) - static_cast<difference_type>(index_of(first));
+    }
+
+    // 令 position 前进 n 个位置（n 可以为负），越过两端时停在 end()
+    void advance(iterator& position, difference_type n) const {
+        position = iterator(select_node(index_of(position) + n));
+    }
+
+    void advance(const_iterator& position, difference_type n) const {
+        position = const_iterator(select_node(index_of(position) + n));
+    }
+
+    // 节点句柄：摘下与插入都只调整指针，不分配也不释放节点
+
+    node_handle_type extract(iterator position);
+    node_handle_type extract(const key_type& key);
+
+    insert_return_type insert_unique(node_handle_type&& nh);
+    iterator insert_multi(node_handle_type&& nh);
+
+    // [note]: 节点句柄的 hint 只是提示，直接按键值查找插入位置
+    iterator insert_unique(iterator /*hint*/, node_handle_type&& nh) {
+        return insert_unique(ccystl::move(nh)).position;
+    }
+
+    iterator insert_multi(iterator /*hint*/, node_handle_type&& nh) {
+        return insert_multi(ccystl::move(nh));
+    }
+
+    // 把 source 中的节点移到本树，键值已存在的节点留在 source 中
+    template <class Compare2>
+    void merge_unique(rb_tree<T, Compare2, Alloc, CountSubtree>& source);
+
+    template <class Compare2>
+    void merge_multi(rb_tree<T, Compare2, Alloc, CountSubtree>& source);
+
+    // 基于 join 的操作：只调整指针，不分配节点，两棵树的分配器必须相等
+
+    // 把键值不小于 key 的元素移到返回的树中，本树只留下键值小于 key 的元素，O(log n)
+    // 只有 CountSubtree 为 true 时可用：两边的元素个数由 rank 得出，之后按子树大小分割，不再调用比较器
+    template <class K>
+    rb_tree split(const K& key);
+
+    // 把 rhs 的元素全部接到本树的最后，完成后 rhs 为空树，O(log n)
+    // 调用者保证本树的键值都不大于 rhs 的键值，键值不允许重复时都小于 rhs 的键值
+    void join(rb_tree& rhs);
+
+    // 集合运算，键值不允许重复，结果留在本树中，rhs 的节点或并入本树或被释放，完成后 rhs 为空树
+    // 比较器不抛出异常时基于 join 计算，两棵树分别有 m <= n 个元素时代价为 O(m log(n/m + 1))，
+    // 较大的子问题按 policy 计算，缺省依次计算；传入并行的策略时比较器会被多个线程同时调用
+    // 比较器可能抛出异常时改用 O(m + n) 的线性归并，policy 不起作用，抛出异常时两棵树都不变
+    // 键值相同时保留本树的元素
+    template <class Policy = rb_tree_sequential_policy>
+    void union_unique(rb_tree& rhs, const Policy& policy = Policy());
+    template <class Policy = rb_tree_sequential_policy>
+    void intersection_unique(rb_tree& rhs, const Policy& policy = Policy());
+    template <class Policy = rb_tree_sequential_policy>
+    void difference_unique(rb_tree& rhs, const Policy& policy = Policy());
+
 private:
     // node related
     template <class... Args>
@@ -966,9 +1327,92 @@ private:
     node_ptr clone_node(base_ptr x);
     void destroy_node(node_ptr p);
 
+    static node_ptr as_node(base_ptr x) noexcept {
+        return static_cast<node_ptr>(x->get_node_ptr());
+    }
+
+    // order statistic
+    static size_type subtree_size(base_ptr x) noexcept {
+        return x == nullptr ? 0 : as_node(x)->size;
+    }
+    base_ptr select_node(size_type k) const noexcept;
+
+    // 比较器不抛出异常时，集合运算才使用基于 join 的算法，其中的辅助函数都是 noexcept 的
+    static constexpr bool nothrow_compare =
+        std::is_nothrow_invocable_v<const key_compare&, const key_type&, const key_type&>;
+
+    enum merge_kind { merge_union, merge_intersection, merge_difference };
+
+    void merge_sorted(rb_tree& rhs, merge_kind kind);
+    static base_ptr link_sorted(base_ptr* nodes, size_type n, size_type depth, size_type red_depth) noexcept;
+
+    // join based algorithms
+    // 一棵脱离了 header 的子树，根节点为黑色且父节点为空，black_height 为各路径上的黑色节点数（含根节点）
+    struct subtree {
+        base_ptr root;
+        size_type black_height;
+    };
+
+    // 等待释放的子树，以各子树根节点的父节点指针串成链表，集合运算结束后统一释放
+    struct node_list {
+        base_ptr head = nullptr;
+        base_ptr tail = nullptr;
+
+        void push_tree(base_ptr x) noexcept {
+            if (x == nullptr)
+                return;
+            x->set_parent(nullptr);
+            if (tail != nullptr)
+                tail->set_parent(x);
+            else
+                head = x;
+            tail = x;
+        }
+
+        // 单个节点，先断开它与原来子节点的联系
+        void push_node(base_ptr x) noexcept {
+            x->left = nullptr;
+            x->right = nullptr;
+            push_tree(x);
+        }
+
+        void append(node_list& rhs) noexcept {
+            if (rhs.head == nullptr)
+                return;
+            if (tail != nullptr)
+                tail->set_parent(rhs.head);
+            else
+                head = rhs.head;
+            tail = rhs.tail;
+        }
+    };
+
+    // 集合运算中两棵子树的黑高都不小于它时才按 policy 分叉，约为各有 4096 个以上的节点
+    static constexpr size_type parallel_min_height = 12;
+
+    subtree detach() noexcept;
+    void attach(subtree t, size_type count) noexcept;
+    size_type destroy_list(node_list& list) noexcept;
+    static subtree child_subtree(base_ptr x, size_type black_height) noexcept;
+
+    subtree join_trees(subtree l, base_ptr k, subtree r) const noexcept;
+    subtree join_trees(subtree l, subtree r) const noexcept;
+    subtree split_last(subtree t, base_ptr& last) const noexcept;
+    template <class K>
+    void split_tree(subtree t, const K& key, bool take_equal, subtree& l, base_ptr& mid, subtree& r) const noexcept;
+    void split_at(subtree t, size_type k, subtree& l, subtree& r) const noexcept;
+
+    template <class Policy>
+    subtree union_trees(subtree a, subtree b, node_list& discard, size_type depth, const Policy& policy) const noexcept;
+    template <class Policy>
+    subtree intersection_trees(subtree a, subtree b, node_list& discard, size_type depth, const Policy& policy) const noexcept;
+    template <class Policy>
+    subtree difference_trees(subtree a, subtree b, node_list& discard, size_type depth, const Policy& policy) const noexcept;
+
     // init / reset
-    void rb_tree_init();
-    void reset();
+    void rb_tree_init() noexcept;
+    void relink_header() noexcept;
+    void steal(rb_tree& rhs) noexcept;
 
     // get insert pos
     ccystl::pair<base_ptr, bool>
@@ -986,45 +1430,61 @@ private:
 
     // copy tree / erase tree
     base_ptr copy_from(base_ptr x, base_ptr p);
-    void erase_since(base_ptr x);
+    size_type erase_since(base_ptr x);
+
+    // build tree from sorted range
+    template <class ForwardIter>
+    size_type count_sorted(ForwardIter first, ForwardIter last, bool unique) const;
+    template <class InputIterator>
+    void build_sorted(InputIterator first, InputIterator last, size_type n, bool skip_equal);
+    template <class InputIterator>
+    base_ptr build_subtree(InputIterator& first, InputIterator last, size_type n,
+                           size_type depth, size_type red_depth, bool skip_equal);
 };
 
 /*****************************************************************************************/
 
 // 复制构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::
-rb_tree(const rb_tree& rhs) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+rb_tree<T, Compare, Alloc, CountSubtree>::
+rb_tree(const rb_tree& rhs)
+    : rb_tree(rhs, rhs.get_allocator()) {
+}
+
+// 使用指定分配器的复制构造函数
+template <class T, class Compare, class Alloc, bool CountSubtree>
+rb_tree<T, Compare, Alloc, CountSubtree>::
+rb_tree(const rb_tree& rhs, const allocator_type& alloc)
+    : key_comp_(rhs.key_comp_), node_alloc_(alloc) {
     rb_tree_init();
     if (rhs.node_count_ != 0) {
-        root() = copy_from(rhs.root(), header_);
+        root() = copy_from(rhs.root(), header());
         leftmost() = rb_tree_min(root());
         rightmost() = rb_tree_max(root());
     }
     node_count_ = rhs.node_count_;
-    key_comp_ = rhs.key_comp_;
 }
 
 // 移动构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+rb_tree<T, Compare, Alloc, CountSubtree>::
 rb_tree(rb_tree&& rhs) noexcept
-    : header_(ccystl::move(rhs.header_)),
-      node_count_(rhs.node_count_),
-      key_comp_(rhs.key_comp_) {
-    rhs.reset();
+    : key_comp_(rhs.key_comp_),
+      node_alloc_(rhs.node_alloc_) {
+    rb_tree_init();
+    steal(rhs);
 }
 
 // 复制赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>&
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+rb_tree<T, Compare, Alloc, CountSubtree>&
+rb_tree<T, Compare, Alloc, CountSubtree>::
 operator=(const rb_tree& rhs) {
     if (this != &rhs) {
         clear();
 
         if (rhs.node_count_ != 0) {
-            root() = copy_from(rhs.root(), header_);
+            root() = copy_from(rhs.root(), header());
             leftmost() = rb_tree_min(root());
             rightmost() = rb_tree_max(root());
         }
@@ -1036,23 +1496,31 @@ operator=(const rb_tree& rhs) {
 }
 
 // 移动赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>&
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+rb_tree<T, Compare, Alloc, CountSubtree>&
+rb_tree<T, Compare, Alloc, CountSubtree>::
 operator=(rb_tree&& rhs) {
+    if (this == &rhs)
+        return *this;
     clear();
-    header_ = ccystl::move(rhs.header_);
-    node_count_ = rhs.node_count_;
     key_comp_ = rhs.key_comp_;
-    rhs.reset();
+    if (node_alloc_ == rhs.node_alloc_) {
+        steal(rhs);
+    }
+    else {
+        // 分配器不随移动赋值传播，不能直接接管 rhs 的节点
+        for (auto it = rhs.begin(); it != rhs.end(); ++it)
+            emplace_multi(ccystl::move(*const_cast<value_type*>(&*it)));
+        rhs.clear();
+    }
     return *this;
 }
 
 // 就地插入元素，键值允许重复
-template <class T, class Compare>
+template <class T, class Compare, class Alloc, bool CountSubtree>
 template <class... Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 emplace_multi(Args&&... args) {
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(ccystl::forward<Args>(args)...);
@@ -1061,10 +1529,10 @@ emplace_multi(Args&&... args) {
 }
 
 // 就地插入元素，键值不允许重复
-template <class T, class Compare>
+template <class T, class Compare, class Alloc, bool CountSubtree>
 template <class... Args>
-ccystl::pair<typename rb_tree<T, Compare>::iterator, bool>
-rb_tree<T, Compare>::
+ccystl::pair<typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator, bool>
+rb_tree<T, Compare, Alloc, CountSubtree>::
 emplace_unique(Args&&... args) {
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(ccystl::forward<Args>(args)...);
@@ -1078,15 +1546,15 @@ emplace_unique(Args&&... args) {
 }
 
 // 就地插入元素，键值允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template <class T, class Compare>
+template <class T, class Compare, class Alloc, bool CountSubtree>
 template <class... Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 emplace_multi_use_hint(iterator hint, Args&&... args) {
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(ccystl::forward<Args>(args)...);
     if (node_count_ == 0) {
-        return insert_node_at(header_, np, true);
+        return insert_node_at(header(), np, true);
     }
     key_type key = value_traits::get_key(np->value);
     if (hint == begin()) {
@@ -1113,15 +1581,15 @@ emplace_multi_use_hint(iterator hint, Args&&... args) {
 }
 
 // 就地插入元素，键值不允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template <class T, class Compare>
+template <class T, class Compare, class Alloc, bool CountSubtree>
 template <class... Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 emplace_unique_use_hint(iterator hint, Args&&... args) {
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     node_ptr np = create_node(ccystl::forward<Args>(args)...);
     if (node_count_ == 0) {
-        return insert_node_at(header_, np, true);
+        return insert_node_at(header(), np, true);
     }
     key_type key = value_traits::get_key(np->value);
     if (hint == begin()) {
@@ -1156,9 +1624,9 @@ emplace_unique_use_hint(iterator hint, Args&&... args) {
 }
 
 // 插入元素，节点键值允许重复
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 insert_multi(const value_type& value) {
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     auto res = get_insert_multi_pos(value_traits::get_key(value));
@@ -1166,9 +1634,9 @@ insert_multi(const value_type& value) {
 }
 
 // 插入新值，节点键值不允许重复，返回一个 pair，若插入成功，pair 的第二参数为 true，否则为 false
-template <class T, class Compare>
-ccystl::pair<typename rb_tree<T, Compare>::iterator, bool>
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+ccystl::pair<typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator, bool>
+rb_tree<T, Compare, Alloc, CountSubtree>::
 insert_unique(const value_type& value) {
     THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
     auto res = get_insert_unique_pos(value_traits::get_key(value));
@@ -1180,24 +1648,24 @@ insert_unique(const value_type& value) {
 }
 
 // 删除 hint 位置的节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 erase(iterator hint) {
-    auto node = hint.node->get_node_ptr();
+    auto node = as_node(hint.node);
     iterator next(node);
     ++next;
 
-    rb_tree_erase_rebalance(hint.node, root(), leftmost(), rightmost());
+    rb_tree_erase_rebalance(hint.node, root(), leftmost(), rightmost(), augment_type());
     destroy_node(node);
     --node_count_;
     return next;
 }
 
 // 删除键值等于 key 的元素，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::size_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
 erase_multi(const key_type& key) {
     auto p = equal_range_multi(key);
     size_type n = ccystl::distance(p.first, p.second);
@@ -1206,9 +1674,9 @@ erase_multi(const key_type& key) {
 }
 
 // 删除键值等于 key 的元素，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::size_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
 erase_unique(const key_type& key) {
     auto it = find(key);
     if (it != end()) {
@@ -1219,8 +1687,8 @@ erase_unique(const key_type& key) {
 }
 
 // 删除[first, last)区间内的元素
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
 erase(iterator first, iterator last) {
     if (first == begin() && last == end()) {
         clear();
@@ -1232,24 +1700,25 @@ erase(iterator first, iterator last) {
 }
 
 // 清空 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
 clear() {
     if (node_count_ != 0) {
         erase_since(root());
-        leftmost() = header_;
+        leftmost() = header();
         root() = nullptr;
-        rightmost() = header_;
+        rightmost() = header();
         node_count_ = 0;
     }
 }
 
 // 查找键值为 k 的节点，返回指向它的迭代器
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
-find(const key_type& key) {
-    auto y = header_; // 最后一个不小于 key 的节点
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+find(const K& key) {
+    auto y = header(); // 最后一个不小于 key 的节点
     auto x = root();
     while (x != nullptr) {
         if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key)) {
@@ -1265,11 +1734,12 @@ find(const key_type& key) {
     return (j == end() || key_comp_(key, value_traits::get_key(*j))) ? end() : j;
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
-find(const key_type& key) const {
-    auto y = header_; // 最后一个不小于 key 的节点
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::const_iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+find(const K& key) const {
+    auto y = header(); // 最后一个不小于 key 的节点
     auto x = root();
     while (x != nullptr) {
         if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key)) {
@@ -1286,11 +1756,12 @@ find(const key_type& key) const {
 }
 
 // 键值不小于 key 的第一个位置
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
-lower_bound(const key_type& key) {
-    auto y = header_;
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+lower_bound(const K& key) {
+    auto y = header();
     auto x = root();
     while (x != nullptr) {
         if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key)) {
@@ -1304,11 +1775,12 @@ lower_bound(const key_type& key) {
     return iterator(y);
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
-lower_bound(const key_type& key) const {
-    auto y = header_;
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::const_iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+lower_bound(const K& key) const {
+    auto y = header();
     auto x = root();
     while (x != nullptr) {
         if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key)) {
@@ -1323,11 +1795,12 @@ lower_bound(const key_type& key) const {
 }
 
 // 键值不小于 key 的最后一个位置
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
-upper_bound(const key_type& key) {
-    auto y = header_;
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+upper_bound(const K& key) {
+    auto y = header();
     auto x = root();
     while (x != nullptr) {
         if (key_comp_(key, value_traits::get_key(x->get_node_ptr()->value))) {
@@ -1341,11 +1814,12 @@ upper_bound(const key_type& key) {
     return iterator(y);
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
-upper_bound(const key_type& key) const {
-    auto y = header_;
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::const_iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+upper_bound(const K& key) const {
+    auto y = header();
     auto x = root();
     while (x != nullptr) {
         if (key_comp_(key, value_traits::get_key(x->get_node_ptr()->value))) {
@@ -1360,84 +1834,365 @@ upper_bound(const key_type& key) const {
 }
 
 // 交换 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
 swap(rb_tree& rhs) noexcept {
     if (this != &rhs) {
-        ccystl::swap(header_, rhs.header_);
+        // header 内嵌于容器中，交换其内容后需要让根节点重新指回各自的 header
+        ccystl::swap(header_node_.parent_ref(), rhs.header_node_.parent_ref());
+        ccystl::swap(header_node_.left, rhs.header_node_.left);
+        ccystl::swap(header_node_.right, rhs.header_node_.right);
         ccystl::swap(node_count_, rhs.node_count_);
+        relink_header();
+        rhs.relink_header();
         ccystl::swap(key_comp_, rhs.key_comp_);
+        ccystl::swap(node_alloc_, rhs.node_alloc_);
+    }
+}
+
+// 键值小于 key 的元素个数，沿 lower_bound 的查找路径累加向右走时越过的节点数
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::size_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
+rank(const K& key) const {
+    static_assert(CountSubtree, "rank requires an rb_tree with CountSubtree = true");
+    size_type r = 0;
+    auto x = root();
+    while (x != nullptr) {
+        if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key)) {
+            x = x->left;
+        }
+        else {
+            r += subtree_size(x->left) + 1;
+            x = x->right;
+        }
+    }
+    return r;
+}
+
+// 下标为 k 的元素
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+select(size_type k) {
+    return iterator(select_node(k));
+}
+
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::const_iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+select(size_type k) const {
+    return const_iterator(select_node(k));
+}
+
+// 从 position 向上走到根节点，累加每次从右子树上来时左边的节点数
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::size_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
+index_of(const_iterator position) const {
+    static_assert(CountSubtree, "index_of requires an rb_tree with CountSubtree = true");
+    base_ptr x = position.node;
+    if (x == header())
+        return node_count_;
+    size_type r = subtree_size(x->left);
+    while (x != root()) {
+        base_ptr p = x->get_parent();
+        if (x == p->right)
+            r += subtree_size(p->left) + 1;
+        x = p;
+    }
+    return r;
+}
+
+// 摘下 position 所指的节点，交给节点句柄
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::node_handle_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
+extract(iterator position) {
+    auto node = as_node(position.node);
+    rb_tree_erase_rebalance(position.node, root(), leftmost(), rightmost(), augment_type());
+    --node_count_;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->set_parent(nullptr);
+    return node_handle_type(node, node_alloc_);
+}
+
+// 摘下第一个键值等于 key 的节点，不存在时返回空句柄
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::node_handle_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
+extract(const key_type& key) {
+    auto it = lower_bound(key);
+    if (it == end() || key_comp_(key, value_traits::get_key(*it)))
+        return node_handle_type();
+    return extract(it);
+}
+
+// 插入节点句柄持有的节点，键值不允许重复，失败时节点留在返回值的 node 中
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::insert_return_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
+insert_unique(node_handle_type&& nh) {
+    if (nh.empty())
+        return insert_return_type{end(), false, node_handle_type()};
+    auto res = get_insert_unique_pos(value_traits::get_key(nh.node_->value));
+    if (!res.second)
+        return insert_return_type{iterator(res.first.first), false, ccystl::move(nh)};
+    return insert_return_type{insert_node_at(res.first.first, nh.release(), res.first.second),
+                              true, node_handle_type()};
+}
+
+// 插入节点句柄持有的节点，键值允许重复，句柄为空时返回 end()
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
+insert_multi(node_handle_type&& nh) {
+    if (nh.empty())
+        return end();
+    auto res = get_insert_multi_pos(value_traits::get_key(nh.node_->value));
+    return insert_node_at(res.first, nh.release(), res.second);
+}
+
+// 先在本树中确定插入位置，再从 source 摘下节点，比较器抛出异常时两棵树都保持不变
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Compare2>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+merge_unique(rb_tree<T, Compare2, Alloc, CountSubtree>& source) {
+    if (static_cast<void*>(&source) == static_cast<void*>(this))
+        return;
+    for (auto it = source.begin(); it != source.end();) {
+        auto cur = it++;
+        auto res = get_insert_unique_pos(value_traits::get_key(*cur));
+        if (res.second)
+            insert_node_at(res.first.first, source.extract(cur).release(), res.first.second);
+    }
+}
+
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Compare2>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+merge_multi(rb_tree<T, Compare2, Alloc, CountSubtree>& source) {
+    if (static_cast<void*>(&source) == static_cast<void*>(this))
+        return;
+    for (auto it = source.begin(); it != source.end();) {
+        auto cur = it++;
+        auto res = get_insert_multi_pos(value_traits::get_key(*cur));
+        insert_node_at(res.first, source.extract(cur).release(), res.second);
+    }
+}
+
+// 把键值不小于 key 的元素移到返回的树中
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+rb_tree<T, Compare, Alloc, CountSubtree>
+rb_tree<T, Compare, Alloc, CountSubtree>::
+split(const K& key) {
+    static_assert(CountSubtree, "split requires an rb_tree with CountSubtree = true");
+    rb_tree result(key_comp_, get_allocator());
+    if (node_count_ == 0)
+        return result;
+    // 比较器只在 rank 中调用，它抛出异常时两棵树都没有改变
+    const size_type n = node_count_;
+    const size_type left_count = rank(key);
+    subtree l, r;
+    split_at(detach(), left_count, l, r);
+    attach(l, left_count);
+    result.attach(r, n - left_count);
+    return result;
+}
+
+// 把 rhs 接到本树的最后：取出本树的最大节点，以它为中间节点 join 两棵树
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+join(rb_tree& rhs) {
+    if (this == &rhs || rhs.node_count_ == 0)
+        return;
+    if (node_count_ == 0) {
+        steal(rhs);
+        return;
+    }
+    const size_type n = node_count_ + rhs.node_count_;
+    base_ptr last;
+    subtree l = split_last(detach(), last);
+    attach(join_trees(l, last, rhs.detach()), n);
+}
+
+// 并集：以本树的根节点分割 rhs，左右两边分别求并集，再以根节点 join
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Policy>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+union_unique(rb_tree& rhs, const Policy& policy) {
+    if (this == &rhs || rhs.node_count_ == 0)
+        return;
+    if (node_count_ == 0) {
+        steal(rhs);
+        return;
+    }
+    if constexpr (!nothrow_compare) {
+        merge_sorted(rhs, merge_union);
+        return;
     }
+    const size_type n = node_count_ + rhs.node_count_;
+    node_list discard;
+    subtree t = union_trees(detach(), rhs.detach(), discard, policy.fork_depth(), policy);
+    attach(t, n - destroy_list(discard));
+}
+
+// 交集：以本树的根节点分割 rhs，根节点只在 rhs 中也有该键值时保留
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Policy>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+intersection_unique(rb_tree& rhs, const Policy& policy) {
+    if (this == &rhs)
+        return;
+    if constexpr (!nothrow_compare) {
+        merge_sorted(rhs, merge_intersection);
+        return;
+    }
+    const size_type n = node_count_ + rhs.node_count_;
+    node_list discard;
+    subtree t = intersection_trees(detach(), rhs.detach(), discard, policy.fork_depth(), policy);
+    attach(t, n - destroy_list(discard));
+}
+
+// 差集：以 rhs 的根节点分割本树，去掉与之相等的元素，左右两边分别求差集后直接连接
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Policy>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+difference_unique(rb_tree& rhs, const Policy& policy) {
+    if (this == &rhs) {
+        clear();
+        return;
+    }
+    if (rhs.node_count_ == 0)
+        return;
+    if constexpr (!nothrow_compare) {
+        merge_sorted(rhs, merge_difference);
+        return;
+    }
+    const size_type n = node_count_ + rhs.node_count_;
+    node_list discard;
+    subtree t = difference_trees(detach(), rhs.detach(), discard, policy.fork_depth(), policy);
+    attach(t, n - destroy_list(discard));
 }
 
 /*****************************************************************************************/
 // helper function
 
 // 创建一个结点
-template <class T, class Compare>
+template <class T, class Compare, class Alloc, bool CountSubtree>
 template <class... Args>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, Alloc, CountSubtree>::node_ptr
+rb_tree<T, Compare, Alloc, CountSubtree>::
 create_node(Args&&... args) {
-    auto tmp = node_allocator::allocate(1);
+    auto tmp = node_alloc_.allocate(1);
     try {
-        data_allocator::construct(ccystl::address_of(tmp->value), ccystl::forward<Args>(args)...);
+        data_allocator(node_alloc_).construct(ccystl::address_of(tmp->value), ccystl::forward<Args>(args)...);
         tmp->left = nullptr;
         tmp->right = nullptr;
-        tmp->parent = nullptr;
+        tmp->set_parent_color(nullptr, rb_tree_red);
     }
     catch (...) {
-        node_allocator::deallocate(tmp);
+        node_alloc_.deallocate(tmp);
         throw;
     }
     return tmp;
 }
 
 // 复制一个结点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::node_ptr
+rb_tree<T, Compare, Alloc, CountSubtree>::
 clone_node(base_ptr x) {
     node_ptr tmp = create_node(x->get_node_ptr()->value);
-    tmp->color = x->color;
+    tmp->set_color(x->get_color());
+    if constexpr (CountSubtree)
+        tmp->size = as_node(x)->size;
     tmp->left = nullptr;
     tmp->right = nullptr;
     return tmp;
 }
 
 // 销毁一个结点
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
 destroy_node(node_ptr p) {
-    data_allocator::destroy(&p->value);
-    node_allocator::deallocate(p);
+    data_allocator(node_alloc_).destroy(&p->value);
+    node_alloc_.deallocate(p);
+}
+
+// select_node 函数
+// 由根节点向下，按左子树的大小决定走向，k 不小于 size() 时返回 header
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::base_ptr
+rb_tree<T, Compare, Alloc, CountSubtree>::
+select_node(size_type k) const noexcept {
+    static_assert(CountSubtree, "select requires an rb_tree with CountSubtree = true");
+    if (k >= node_count_)
+        return header();
+    auto x = root();
+    while (true) {
+        const size_type left_size = subtree_size(x->left);
+        if (k < left_size) {
+            x = x->left;
+        }
+        else if (k == left_size) {
+            return x;
+        }
+        else {
+            k -= left_size + 1;
+            x = x->right;
+        }
+    }
 }
 
-// 初始化容器
-template <class T, class Compare>
-void rb_tree<T, Compare>::
-rb_tree_init() {
-    header_ = base_allocator::allocate(1);
-    header_->color = rb_tree_red; // header_ 节点颜色为红，与 root 区分
+// 初始化容器，header 内嵌于容器中，不分配任何内存
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+rb_tree_init() noexcept {
+    header()->set_parent_color(nullptr, rb_tree_red); // header 节点颜色为红，与 root 区分
     root() = nullptr;
-    leftmost() = header_;
-    rightmost() = header_;
+    leftmost() = header();
+    rightmost() = header();
     node_count_ = 0;
 }
 
-// reset 函数
-template <class T, class Compare>
-void rb_tree<T, Compare>::reset() {
-    header_ = nullptr;
-    node_count_ = 0;
+// 交换 header 的内容后修正指向 header 的指针
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+relink_header() noexcept {
+    if (node_count_ == 0) {
+        root() = nullptr;
+        leftmost() = header();
+        rightmost() = header();
+    }
+    else {
+        root()->set_parent(header());
+    }
+}
+
+// 接管 rhs 的所有节点，本树必须为空，完成后 rhs 为空树
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+steal(rb_tree& rhs) noexcept {
+    if (rhs.node_count_ == 0)
+        return;
+    root() = rhs.root();
+    leftmost() = rhs.leftmost();
+    rightmost() = rhs.rightmost();
+    node_count_ = rhs.node_count_;
+    root()->set_parent(header());
+    rhs.rb_tree_init();
 }
 
 // get_insert_multi_pos 函数
-template <class T, class Compare>
-ccystl::pair<typename rb_tree<T, Compare>::base_ptr, bool>
-rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+ccystl::pair<typename rb_tree<T, Compare, Alloc, CountSubtree>::base_ptr, bool>
+rb_tree<T, Compare, Alloc, CountSubtree>::get_insert_multi_pos(const key_type& key) {
     auto x = root();
-    auto y = header_;
+    auto y = header();
     bool add_to_left = true;
     while (x != nullptr) {
         y = x;
@@ -1448,14 +2203,14 @@ rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key) {
 }
 
 // get_insert_unique_pos 函数
-template <class T, class Compare>
-ccystl::pair<ccystl::pair<typename rb_tree<T, Compare>::base_ptr, bool>, bool>
-rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+ccystl::pair<ccystl::pair<typename rb_tree<T, Compare, Alloc, CountSubtree>::base_ptr, bool>, bool>
+rb_tree<T, Compare, Alloc, CountSubtree>::get_insert_unique_pos(const key_type& key) {
     // 返回一个 pair，第一个值为一个 pair，包含插入点的父节点和一个 bool 表示是否在左边插入，
     // 第二个值为一个 bool，表示是否插入成功
     auto x = root();
-    auto y = header_;
-    bool add_to_left = true; // 树为空时也在 header_ 左边插入
+    auto y = header();
+    bool add_to_left = true; // 树为空时也在 header 左边插入
     while (x != nullptr) {
         y = x;
         add_to_left = key_comp_(key, value_traits::get_key(x->get_node_ptr()->value));
@@ -1463,7 +2218,7 @@ rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key) {
     }
     iterator j = iterator(y); // 此时 y 为插入点的父节点
     if (add_to_left) {
-        if (y == header_ || j == begin()) {
+        if (y == header() || j == begin()) {
             // 如果树为空树或插入点在最左节点处，肯定可以插入新的节点
             return ccystl::make_pair(ccystl::make_pair(y, true), true);
         }
@@ -1476,20 +2231,20 @@ rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key) {
         // 表明新节点没有重复
         return ccystl::make_pair(ccystl::make_pair(y, add_to_left), true);
     }
-    // 进行至此，表示新节点与现有节点键值重复
-    return ccystl::make_pair(ccystl::make_pair(y, add_to_left), false);
+    // 进行至此，表示新节点与现有节点键值重复，返回重复的节点
+    return ccystl::make_pair(ccystl::make_pair(j.node, add_to_left), false);
 }
 
 // insert_value_at 函数
 // x 为插入点的父节点， value 为要插入的值，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 insert_value_at(base_ptr x, const value_type& value, bool add_to_left) {
     node_ptr node = create_node(value);
-    node->parent = x;
+    node->set_parent(x);
     auto base_node = node->get_base_ptr();
-    if (x == header_) {
+    if (x == header()) {
         root() = base_node;
         leftmost() = base_node;
         rightmost() = base_node;
@@ -1504,20 +2259,20 @@ insert_value_at(base_ptr x, const value_type& value, bool add_to_left) {
         if (rightmost() == x)
             rightmost() = base_node;
     }
-    rb_tree_insert_rebalance(base_node, root());
+    rb_tree_insert_rebalance(base_node, root(), augment_type());
     ++node_count_;
     return iterator(node);
 }
 
 // 在 x 节点处插入新的节点
 // x 为插入点的父节点， node 为要插入的节点，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 insert_node_at(base_ptr x, node_ptr node, bool add_to_left) {
-    node->parent = x;
+    node->set_parent(x);
     auto base_node = node->get_base_ptr();
-    if (x == header_) {
+    if (x == header()) {
         root() = base_node;
         leftmost() = base_node;
         rightmost() = base_node;
@@ -1532,15 +2287,15 @@ insert_node_at(base_ptr x, node_ptr node, bool add_to_left) {
         if (rightmost() == x)
             rightmost() = base_node;
     }
-    rb_tree_insert_rebalance(base_node, root());
+    rb_tree_insert_rebalance(base_node, root(), augment_type());
     ++node_count_;
     return iterator(node);
 }
 
 // 插入元素，键值允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 insert_multi_use_hint(iterator hint, key_type key, node_ptr node) {
     // 在 hint 附近寻找可插入的位置
     auto np = hint.node;
@@ -1562,9 +2317,9 @@ insert_multi_use_hint(iterator hint, key_type key, node_ptr node) {
 }
 
 // 插入元素，键值不允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::iterator
+rb_tree<T, Compare, Alloc, CountSubtree>::
 insert_unique_use_hint(iterator hint, key_type key, node_ptr node) {
     // 在 hint 附近寻找可插入的位置
     auto np = hint.node;
@@ -1591,11 +2346,11 @@ insert_unique_use_hint(iterator hint, key_type key, node_ptr node) {
 
 // copy_from 函数
 // 递归复制一颗树，节点从 x 开始，p 为 x 的父节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::base_ptr
-rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::base_ptr
+rb_tree<T, Compare, Alloc, CountSubtree>::copy_from(base_ptr x, base_ptr p) {
     auto top = clone_node(x);
-    top->parent = p;
+    top->set_parent(p);
     try {
         if (x->right)
             top->right = copy_from(x->right, top);
@@ -1604,7 +2359,7 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p) {
         while (x != nullptr) {
             auto y = clone_node(x);
             p->left = y;
-            y->parent = p;
+            y->set_parent(p);
             if (x->right)
                 y->right = copy_from(x->right, y);
             p = y;
@@ -1619,52 +2374,567 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p) {
 }
 
 // erase_since 函数
-// 从 x 节点开始删除该节点及其子树
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+// 从 x 节点开始删除该节点及其子树，返回删除的节点数
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::size_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
 erase_since(base_ptr x) {
+    size_type count = 0;
     while (x != nullptr) {
-        erase_since(x->right);
+        count += erase_since(x->right);
         auto y = x->left;
-        destroy_node(x->get_node_ptr());
+        destroy_node(as_node(x));
         x = y;
+        ++count;
+    }
+    return count;
+}
+
+// count_sorted 函数
+// 检查 [first, last) 是否按键值升序排列。有序时返回元素个数，unique 为 true 时返回不同键值的个数；
+// 无序或不是前向迭代器时返回 0，此时调用者逐个插入
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class ForwardIter>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::size_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
+count_sorted(ForwardIter first, ForwardIter last, bool unique) const {
+    if constexpr (!is_forward_iterator<ForwardIter>::value) {
+        return 0;
+    }
+    else {
+        if (first == last)
+            return 0;
+        size_type count = 1;
+        for (auto prev = first; ++first != last; prev = first) {
+            if (key_comp_(value_traits::get_key(*first), value_traits::get_key(*prev)))
+                return 0;
+            if (!unique || key_comp_(value_traits::get_key(*prev), value_traits::get_key(*first)))
+                ++count;
+        }
+        return count;
+    }
+}
+
+// build_sorted 函数
+// 由有序范围自底向上建立一棵完全平衡的树，共 n 个节点，代价为 O(n)，本树必须为空
+// 节点按中序依次分配，使用内存池类的分配器时相邻元素的节点在内存中也相邻
+// skip_equal 为 true 时等价键值只取第一个
+//
+// 左右子树的节点数至多相差一，所有空子节点的深度只差一层：
+// 前 red_depth 层是满的，全部涂黑，最下面不满的一层涂红，各路径的黑高相同
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class InputIterator>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+build_sorted(InputIterator first, InputIterator last, size_type n, bool skip_equal) {
+    size_type red_depth = 0; // floor(log2(n + 1))，即满层的层数
+    for (size_type m = n + 1; m > 1; m >>= 1)
+        ++red_depth;
+    root() = build_subtree(first, last, n, 0, red_depth, skip_equal);
+    root()->set_parent(header());
+    leftmost() = rb_tree_min(root());
+    rightmost() = rb_tree_max(root());
+    node_count_ = n;
+}
+
+// build_subtree 函数
+// 以 first 开始的 n 个元素建立子树，返回子树的根，first 前进到已使用的元素之后
+// 抛出异常时释放已建立的节点
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class InputIterator>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::base_ptr
+rb_tree<T, Compare, Alloc, CountSubtree>::
+build_subtree(InputIterator& first, InputIterator last, size_type n,
+              size_type depth, size_type red_depth, bool skip_equal) {
+    if (n == 0)
+        return nullptr;
+    const size_type left_count = (n - 1) / 2;
+    base_ptr left = build_subtree(first, last, left_count, depth + 1, red_depth, skip_equal);
+    node_ptr node;
+    try {
+        node = create_node(*first);
+    }
+    catch (...) {
+        erase_since(left);
+        throw;
+    }
+    node->set_color(depth == red_depth ? rb_tree_red : rb_tree_black);
+    if constexpr (CountSubtree)
+        node->size = n;
+    node->left = left;
+    if (left != nullptr)
+        left->set_parent(node);
+    ++first;
+    if (skip_equal) {
+        while (first != last && !key_comp_(value_traits::get_key(node->value), value_traits::get_key(*first)))
+            ++first;
+    }
+    try {
+        node->right = build_subtree(first, last, n - 1 - left_count, depth + 1, red_depth, skip_equal);
+    }
+    catch (...) {
+        erase_since(node);
+        throw;
+    }
+    if (node->right != nullptr)
+        node->right->set_parent(node);
+    return node;
+}
+
+// merge_sorted 函数
+// 比较器可能抛出异常时的集合运算：同时按顺序遍历两棵树，先决定每个节点的去留，
+// 保留的节点从缓冲区前端依次放起，丢弃的节点从后端放起，全部比较完成后才改动两棵树，
+// 因此比较器抛出异常时两棵树都不变；之后把保留的节点连成一棵平衡的树，释放丢弃的节点，代价为 O(m + n)
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+merge_sorted(rb_tree& rhs, merge_kind kind) {
+    const size_type total = node_count_ + rhs.node_count_;
+    if (total == 0)
+        return;
+    base_ptr_allocator alloc(node_alloc_);
+    base_ptr* nodes = alloc.allocate(total);
+    size_type kept = 0;
+    size_type dropped = total;
+    try {
+        iterator a = begin();
+        iterator b = rhs.begin();
+        while (a != end() && b != rhs.end()) {
+            const auto& a_key = value_traits::get_key(*a);
+            const auto& b_key = value_traits::get_key(*b);
+            if (key_comp_(a_key, b_key)) {
+                if (kind == merge_intersection)
+                    nodes[--dropped] = a.node;
+                else
+                    nodes[kept++] = a.node;
+                ++a;
+            }
+            else if (key_comp_(b_key, a_key)) {
+                if (kind == merge_union)
+                    nodes[kept++] = b.node;
+                else
+                    nodes[--dropped] = b.node;
+                ++b;
+            }
+            else {
+                if (kind == merge_difference)
+                    nodes[--dropped] = a.node;
+                else
+                    nodes[kept++] = a.node;
+                nodes[--dropped] = b.node;
+                ++a;
+                ++b;
+            }
+        }
+        for (; a != end(); ++a) {
+            if (kind == merge_intersection)
+                nodes[--dropped] = a.node;
+            else
+                nodes[kept++] = a.node;
+        }
+        for (; b != rhs.end(); ++b) {
+            if (kind == merge_union)
+                nodes[kept++] = b.node;
+            else
+                nodes[--dropped] = b.node;
+        }
+    }
+    catch (...) {
+        alloc.deallocate(nodes, total);
+        throw;
+    }
+    for (size_type i = dropped; i != total; ++i)
+        destroy_node(as_node(nodes[i]));
+    rhs.rb_tree_init();
+    rb_tree_init();
+    size_type red_depth = 0; // 与 build_sorted 相同
+    for (size_type m = kept + 1; m > 1; m >>= 1)
+        ++red_depth;
+    attach(subtree{link_sorted(nodes, kept, 0, red_depth), 0}, kept);
+    alloc.deallocate(nodes, total);
+}
+
+// link_sorted 函数
+// 把按中序排好的 n 个已有节点连成一棵完全平衡的树，返回子树的根，形状与着色同 build_sorted
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::base_ptr
+rb_tree<T, Compare, Alloc, CountSubtree>::
+link_sorted(base_ptr* nodes, size_type n, size_type depth, size_type red_depth) noexcept {
+    if (n == 0)
+        return nullptr;
+    const size_type left_count = (n - 1) / 2;
+    base_ptr node = nodes[left_count];
+    node->set_parent_color(nullptr, depth == red_depth ? rb_tree_red : rb_tree_black);
+    if constexpr (CountSubtree)
+        as_node(node)->size = n;
+    node->left = link_sorted(nodes, left_count, depth + 1, red_depth);
+    node->right = link_sorted(nodes + left_count + 1, n - 1 - left_count, depth + 1, red_depth);
+    if (node->left != nullptr)
+        node->left->set_parent(node);
+    if (node->right != nullptr)
+        node->right->set_parent(node);
+    return node;
+}
+
+// detach 函数
+// 把整棵树从 header 上取下，本树变为空树，返回取下的子树
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+detach() noexcept {
+    subtree t{root(), 0};
+    if (t.root != nullptr) {
+        t.root->set_parent(nullptr);
+        for (base_ptr x = t.root; x != nullptr; x = x->left) {
+            if (!rb_tree_is_red(x))
+                ++t.black_height;
+        }
+    }
+    rb_tree_init();
+    return t;
+}
+
+// attach 函数
+// 把一棵有 count 个节点的子树挂到本树的 header 上，本树必须为空
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+attach(subtree t, size_type count) noexcept {
+    if (t.root == nullptr)
+        return;
+    root() = t.root;
+    t.root->set_parent(header());
+    leftmost() = rb_tree_min(t.root);
+    rightmost() = rb_tree_max(t.root);
+    node_count_ = count;
+}
+
+// destroy_list 函数
+// 释放集合运算中丢弃的节点，返回释放的个数
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::size_type
+rb_tree<T, Compare, Alloc, CountSubtree>::
+destroy_list(node_list& list) noexcept {
+    size_type count = 0;
+    for (base_ptr x = list.head; x != nullptr;) {
+        base_ptr next = x->get_parent();
+        count += erase_since(x);
+        x = next;
+    }
+    list.head = list.tail = nullptr;
+    return count;
+}
+
+// child_subtree 函数
+// 把节点 x 作为一棵独立的子树，black_height 为它作为子节点时的黑高；根节点为红时涂黑，黑高加一
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+child_subtree(base_ptr x, size_type black_height) noexcept {
+    if (x == nullptr)
+        return subtree{nullptr, 0};
+    x->set_parent(nullptr);
+    if (rb_tree_is_red(x)) {
+        rb_tree_set_black(x);
+        ++black_height;
+    }
+    return subtree{x, black_height};
+}
+
+// join_trees 函数
+// l 的键值都小于 k，r 的键值都大于 k，把三者连成一棵树
+// 黑高不同时沿较高一棵的右（左）脊下降，找到黑高与较矮一棵相同的黑色节点，以红色的 k 连接两者，
+// 再按插入的方式消除连续的红色，代价为 O(|l 的黑高 - r 的黑高| + 1)
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+join_trees(subtree l, base_ptr k, subtree r) const noexcept {
+    if (l.black_height == r.black_height) {
+        k->set_parent_color(nullptr, rb_tree_black);
+        k->left = l.root;
+        k->right = r.root;
+        if (l.root != nullptr)
+            l.root->set_parent(k);
+        if (r.root != nullptr)
+            r.root->set_parent(k);
+        augment_type().changed(k, k);
+        return subtree{k, l.black_height + 1};
+    }
+    const bool left_taller = l.black_height > r.black_height;
+    subtree tall = left_taller ? l : r;
+    const size_type target = left_taller ? r.black_height : l.black_height;
+    base_ptr root = tall.root;
+    base_ptr parent = nullptr;
+    base_ptr x = root;
+    size_type height = tall.black_height;
+    while (height != target || (x != nullptr && rb_tree_is_red(x))) {
+        parent = x;
+        if (!rb_tree_is_red(x))
+            --height;
+        x = left_taller ? x->right : x->left;
+    }
+    k->set_parent_color(parent, rb_tree_red);
+    if (left_taller) {
+        k->left = x;
+        k->right = r.root;
+        parent->right = k;
+    }
+    else {
+        k->left = l.root;
+        k->right = x;
+        parent->left = k;
+    }
+    if (k->left != nullptr)
+        k->left->set_parent(k);
+    if (k->right != nullptr)
+        k->right->set_parent(k);
+    augment_type().changed(k, root);
+    const bool grew = rb_tree_insert_fixup(k, root, augment_type());
+    return subtree{root, tall.black_height + (grew ? 1 : 0)};
+}
+
+// 没有中间节点的 join：取出 l 的最大节点作为中间节点
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+join_trees(subtree l, subtree r) const noexcept {
+    if (l.root == nullptr)
+        return r;
+    if (r.root == nullptr)
+        return l;
+    base_ptr last;
+    l = split_last(l, last);
+    return join_trees(l, last, r);
+}
+
+// split_last 函数
+// 取出子树 t 的最大节点，放在 last 中，返回其余节点组成的子树
+template <class T, class Compare, class Alloc, bool CountSubtree>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+split_last(subtree t, base_ptr& last) const noexcept {
+    base_ptr x = t.root;
+    const size_type height = t.black_height - (rb_tree_is_red(x) ? 0 : 1);
+    subtree l = child_subtree(x->left, height);
+    if (x->right == nullptr) {
+        last = x;
+        return l;
+    }
+    subtree r = split_last(child_subtree(x->right, height), last);
+    return join_trees(l, x, r);
+}
+
+// split_tree 函数
+// 把子树 t 分为键值小于 key 的 l 与其余的 r，自顶向下递归后沿原路 join，代价为 O(log n)
+// take_equal 为 true 时键值等于 key 的节点（至多一个）单独放在 mid 中，否则放入 r，mid 为空
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class K>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+split_tree(subtree t, const K& key, bool take_equal, subtree& l, base_ptr& mid, subtree& r) const noexcept {
+    if (t.root == nullptr) {
+        l = r = subtree{nullptr, 0};
+        mid = nullptr;
+        return;
+    }
+    base_ptr x = t.root;
+    const size_type height = t.black_height - (rb_tree_is_red(x) ? 0 : 1);
+    subtree xl = child_subtree(x->left, height);
+    subtree xr = child_subtree(x->right, height);
+    const auto& x_key = value_traits::get_key(x->get_node_ptr()->value);
+    if (key_comp_(x_key, key)) {
+        // x 属于左边
+        subtree rl;
+        split_tree(xr, key, take_equal, rl, mid, r);
+        l = join_trees(xl, x, rl);
+    }
+    else if (take_equal && !key_comp_(key, x_key)) {
+        mid = x;
+        l = xl;
+        r = xr;
+    }
+    else {
+        // x 属于右边
+        subtree lr;
+        split_tree(xl, key, take_equal, l, mid, lr);
+        r = join_trees(lr, x, xr);
+    }
+}
+
+// split_at 函数
+// 按子树大小把子树 t 分为前 k 个节点组成的 l 与其余的 r，不调用比较器，代价为 O(log n)
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void rb_tree<T, Compare, Alloc, CountSubtree>::
+split_at(subtree t, size_type k, subtree& l, subtree& r) const noexcept {
+    if (t.root == nullptr) {
+        l = r = subtree{nullptr, 0};
+        return;
+    }
+    base_ptr x = t.root;
+    const size_type height = t.black_height - (rb_tree_is_red(x) ? 0 : 1);
+    const size_type left_size = subtree_size(x->left);
+    subtree xl = child_subtree(x->left, height);
+    subtree xr = child_subtree(x->right, height);
+    if (left_size < k) {
+        // x 属于左边
+        subtree rl;
+        split_at(xr, k - left_size - 1, rl, r);
+        l = join_trees(xl, x, rl);
+    }
+    else {
+        // x 属于右边
+        subtree lr;
+        split_at(xl, k, l, lr);
+        r = join_trees(lr, x, xr);
+    }
+}
+
+// union_trees 函数
+// 以 a 的根节点分割 b，两边的子问题互不相交，可以并行计算
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Policy>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+union_trees(subtree a, subtree b, node_list& discard, size_type depth, const Policy& policy) const noexcept {
+    if (a.root == nullptr)
+        return b;
+    if (b.root == nullptr)
+        return a;
+    base_ptr k = a.root;
+    const size_type height = a.black_height - (rb_tree_is_red(k) ? 0 : 1);
+    subtree al = child_subtree(k->left, height);
+    subtree ar = child_subtree(k->right, height);
+    subtree bl, br;
+    base_ptr dup;
+    split_tree(b, value_traits::get_key(k->get_node_ptr()->value), true, bl, dup, br);
+    if (dup != nullptr)
+        discard.push_node(dup);
+    const bool parallel = depth > 0 && ccystl::min(a.black_height, b.black_height) >= parallel_min_height;
+    const size_type next = depth > 0 ? depth - 1 : 0;
+    subtree l, r;
+    node_list right_discard;
+    auto left = [&] { l = union_trees(al, bl, discard, next, policy); };
+    auto right = [&] { r = union_trees(ar, br, right_discard, next, policy); };
+    if (parallel) {
+        policy.fork_join(left, right);
+    }
+    else {
+        left();
+        right();
+    }
+    discard.append(right_discard);
+    return join_trees(l, k, r);
+}
+
+// intersection_trees 函数
+// 以 a 的根节点分割 b，根节点在 b 中有相同的键值时保留，否则两边直接连接
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Policy>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+intersection_trees(subtree a, subtree b, node_list& discard, size_type depth, const Policy& policy) const noexcept {
+    if (a.root == nullptr || b.root == nullptr) {
+        discard.push_tree(a.root);
+        discard.push_tree(b.root);
+        return subtree{nullptr, 0};
+    }
+    base_ptr k = a.root;
+    const size_type height = a.black_height - (rb_tree_is_red(k) ? 0 : 1);
+    subtree al = child_subtree(k->left, height);
+    subtree ar = child_subtree(k->right, height);
+    subtree bl, br;
+    base_ptr dup;
+    split_tree(b, value_traits::get_key(k->get_node_ptr()->value), true, bl, dup, br);
+    const bool parallel = depth > 0 && ccystl::min(a.black_height, b.black_height) >= parallel_min_height;
+    const size_type next = depth > 0 ? depth - 1 : 0;
+    subtree l, r;
+    node_list right_discard;
+    auto left = [&] { l = intersection_trees(al, bl, discard, next, policy); };
+    auto right = [&] { r = intersection_trees(ar, br, right_discard, next, policy); };
+    if (parallel) {
+        policy.fork_join(left, right);
+    }
+    else {
+        left();
+        right();
+    }
+    discard.append(right_discard);
+    if (dup != nullptr) {
+        discard.push_node(dup);
+        return join_trees(l, k, r);
+    }
+    discard.push_node(k);
+    return join_trees(l, r);
+}
+
+// difference_trees 函数
+// 以 b 的根节点分割 a，去掉 a 中与之相等的节点，两边的差集直接连接
+template <class T, class Compare, class Alloc, bool CountSubtree>
+template <class Policy>
+typename rb_tree<T, Compare, Alloc, CountSubtree>::subtree
+rb_tree<T, Compare, Alloc, CountSubtree>::
+difference_trees(subtree a, subtree b, node_list& discard, size_type depth, const Policy& policy) const noexcept {
+    if (a.root == nullptr || b.root == nullptr) {
+        discard.push_tree(b.root);
+        return a;
+    }
+    base_ptr k = b.root;
+    const size_type height = b.black_height - (rb_tree_is_red(k) ? 0 : 1);
+    subtree bl = child_subtree(k->left, height);
+    subtree br = child_subtree(k->right, height);
+    subtree al, ar;
+    base_ptr dup;
+    split_tree(a, value_traits::get_key(k->get_node_ptr()->value), true, al, dup, ar);
+    discard.push_node(k);
+    if (dup != nullptr)
+        discard.push_node(dup);
+    const bool parallel = depth > 0 && ccystl::min(a.black_height, b.black_height) >= parallel_min_height;
+    const size_type next = depth > 0 ? depth - 1 : 0;
+    subtree l, r;
+    node_list right_discard;
+    auto left = [&] { l = difference_trees(al, bl, discard, next, policy); };
+    auto right = [&] { r = difference_trees(ar, br, right_discard, next, policy); };
+    if (parallel) {
+        policy.fork_join(left, right);
+    }
+    else {
+        left();
+        right();
     }
+    discard.append(right_discard);
+    return join_trees(l, r);
 }
 
 // 重载比较操作符
-template <class T, class Compare>
-bool operator==(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+bool operator==(const rb_tree<T, Compare, Alloc, CountSubtree>& lhs, const rb_tree<T, Compare, Alloc, CountSubtree>& rhs) {
     return lhs.size() == rhs.size() && ccystl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T, class Compare>
-bool operator<(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+bool operator<(const rb_tree<T, Compare, Alloc, CountSubtree>& lhs, const rb_tree<T, Compare, Alloc, CountSubtree>& rhs) {
     return ccystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T, class Compare>
-bool operator!=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+bool operator!=(const rb_tree<T, Compare, Alloc, CountSubtree>& lhs, const rb_tree<T, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs == rhs);
 }
 
-template <class T, class Compare>
-bool operator>(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+bool operator>(const rb_tree<T, Compare, Alloc, CountSubtree>& lhs, const rb_tree<T, Compare, Alloc, CountSubtree>& rhs) {
     return rhs < lhs;
 }
 
-template <class T, class Compare>
-bool operator<=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+bool operator<=(const rb_tree<T, Compare, Alloc, CountSubtree>& lhs, const rb_tree<T, Compare, Alloc, CountSubtree>& rhs) {
     return !(rhs < lhs);
 }
 
-template <class T, class Compare>
-bool operator>=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs) {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+bool operator>=(const rb_tree<T, Compare, Alloc, CountSubtree>& lhs, const rb_tree<T, Compare, Alloc, CountSubtree>& rhs) {
     return !(lhs < rhs);
 }
 
 // 重载 ccystl 的 swap
-template <class T, class Compare>
-void swap(rb_tree<T, Compare>& lhs, rb_tree<T, Compare>& rhs) noexcept {
+template <class T, class Compare, class Alloc, bool CountSubtree>
+void swap(rb_tree<T, Compare, Alloc, CountSubtree>& lhs, rb_tree<T, Compare, Alloc, CountSubtree>& rhs) noexcept {
     lhs.swap(rhs);
 }
 } // namespace ccystl
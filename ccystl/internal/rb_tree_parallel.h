@@ -0,0 +1,53 @@
+#ifndef CCYSTL_RB_TREE_PARALLEL_H_
+#define CCYSTL_RB_TREE_PARALLEL_H_
+
+// 这个头文件包含 rb_tree 集合运算的并行执行策略 rb_tree_parallel_policy
+// 传给 set / map / ranked_set / ranked_map 的 union_with、intersection_with、difference_with，
+// 递归中两个互不相交的较大子问题由 std::async 启动的线程与当前线程同时计算
+//
+// notes:
+//
+// 比较器会被多个线程同时调用，调用者须保证它可以并发调用，例如不修改任何状态
+// 比较器可能抛出异常时集合运算使用线性归并，本策略不起作用
+
+#include <cstddef>
+#include <future>
+#include <thread>
+
+namespace ccystl {
+
+struct rb_tree_parallel_policy {
+    size_t threads; // 同时计算的线程数上限，包括调用者所在的线程
+
+    // threads 为 0 时使用 std::thread::hardware_concurrency()
+    explicit rb_tree_parallel_policy(size_t n = 0) noexcept
+        : threads(n != 0 ? n : std::thread::hardware_concurrency()) {
+    }
+
+    // 每分叉一层线程数加倍，分叉 floor(log2(threads)) 层
+    size_t fork_depth() const noexcept {
+        size_t depth = 0;
+        for (size_t n = threads; n > 1; n >>= 1)
+            ++depth;
+        return depth;
+    }
+
+    // 把 f1 交给新线程，当前线程计算 f2，再等待 f1 完成；无法创建线程时依次计算
+    template <class F1, class F2>
+    void fork_join(F1&& f1, F2&& f2) const {
+        std::future<void> task;
+        try {
+            task = std::async(std::launch::async, f1);
+        }
+        catch (...) {
+            f1();
+            f2();
+            return;
+        }
+        f2();
+        task.get();
+    }
+};
+
+} // namespace ccystl
+#endif // !CCYSTL_RB_TREE_PARALLEL_H_
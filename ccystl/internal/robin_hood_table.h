@@ -0,0 +1,1125 @@
+#ifndef CCYSTL_ROBIN_HOOD_TABLE_H_
+#define CCYSTL_ROBIN_HOOD_TABLE_H_
+
+// 这个头文件包含了一个模板类 robin_hood_hashtable
+// robin_hood_hashtable : 开放寻址的 Robin Hood 哈希表，元素直接存放在连续的槽位数组中
+//
+// 设计：
+//   * 线性探测，每个槽位用一个字节记录元素离开其 bucket（home）的探测距离
+//   * 插入时若遇到探测距离比新元素短的元素（“富者”），新元素占据该位置，其后的元素整体后移一格，
+//     因此同一 bucket 的元素总是相邻，且按 bucket 递增排列
+//   * 查找遇到探测距离小于当前距离的槽位即可断定键值不存在
+//   * 删除时把之后不在 home 上的元素前移一格（backward shift），不留墓碑
+//   * bucket 数为 2 的幂次，槽位数组末尾另有 max_probe 个溢出槽位，探测不回绕到数组开头，
+//     最大负载因子缺省为 0.9
+//
+// 通过 unordered_set / unordered_map 的 bucket 策略参数传入 ht_robin_hood_policy 即可使用
+//
+// notes:
+//
+// 插入、删除或 rehash 会使所有迭代器、指针和引用失效；erase 返回下一个元素的迭代器，
+// 边遍历边删除时应写成 it = erase(it)
+// 没有节点，不支持节点句柄（extract / merge）与渐进式 rehash
+// 哈希函数使大量键值落在同一 bucket、超出探测距离上限时，插入抛出 length_error
+// 元素不可平凡重定位且移动构造可能抛出异常时，移动元素的过程中抛出异常会清空容器
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ccystl/allocator/allocator.h"
+#include "ccystl/allocator/memory.h"
+#include "ccystl/internal/hash_table.h"
+#include "ccystl/internal/hashtable_stats.h"
+#include "ccystl/utils/except_def.h"
+#include "ccystl/utils/type_traits.h"
+#include "ccystl/utils/utils.h"
+
+namespace ccystl {
+// 作为 unordered_set / unordered_map 的 bucket 策略参数时，底层改用 robin_hood_hashtable
+struct ht_robin_hood_policy { };
+
+// 槽位元数据：0 为空位，否则为探测距离加一
+typedef uint8_t rh_meta_type;
+
+constexpr rh_meta_type rh_meta_empty = 0;
+constexpr rh_meta_type rh_meta_sentinel = 1; // 元数据数组末尾的哨兵，迭代到此停止，查找到此必然结束
+
+template <class T, class Hash, class KeyEqual, class Alloc = ccystl::allocator<T>>
+class robin_hood_hashtable;
+
+// robin_hood_hashtable 的迭代器，同时指向元数据与对应的槽位
+template <class T, class Ref, class Ptr>
+struct rh_iterator : public iterator<forward_iterator_tag, T> {
+    typedef rh_iterator<T, T&, T*> iterator;
+    typedef rh_iterator<T, const T&, const T*> const_iterator;
+    typedef rh_iterator self;
+
+    typedef T value_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    rh_meta_type* meta; // 当前槽位的元数据
+    T* slot; // 当前槽位
+
+    rh_iterator() noexcept : meta(nullptr), slot(nullptr) { }
+
+    rh_iterator(rh_meta_type* m, T* s) noexcept : meta(m), slot(s) { }
+
+    rh_iterator(const iterator& rhs) noexcept : meta(rhs.meta), slot(rhs.slot) { }
+
+    reference operator*() const {
+        return *slot;
+    }
+
+    pointer operator->() const {
+        return slot;
+    }
+
+    self& operator++() {
+        ++meta;
+        ++slot;
+        skip_empty();
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const noexcept {
+        return meta == rhs.meta;
+    }
+
+    bool operator!=(const self& rhs) const noexcept {
+        return meta != rhs.meta;
+    }
+
+    // 跳过空位，停在下一个元素或末尾的哨兵上
+    void skip_empty() noexcept {
+        while (*meta == rh_meta_empty) {
+            ++meta;
+            ++slot;
+        }
+    }
+};
+
+// bucket 迭代器：同一 bucket 的元素相邻存放，探测距离依次加一
+template <class T, class Ref, class Ptr>
+struct rh_local_iterator : public iterator<forward_iterator_tag, T> {
+    typedef rh_local_iterator<T, T&, T*> local_iterator;
+    typedef rh_local_iterator<T, const T&, const T*> const_local_iterator;
+    typedef rh_local_iterator self;
+
+    typedef T value_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    rh_meta_type* meta; // 为空指针时表示 bucket 的末尾
+    T* slot;
+    unsigned dist; // 当前元素应有的元数据
+
+    rh_local_iterator() noexcept : meta(nullptr), slot(nullptr), dist(0) { }
+
+    rh_local_iterator(rh_meta_type* m, T* s, unsigned d) noexcept : meta(m), slot(s), dist(d) { }
+
+    rh_local_iterator(const local_iterator& rhs) noexcept
+        : meta(rhs.meta), slot(rhs.slot), dist(rhs.dist) { }
+
+    reference operator*() const {
+        return *slot;
+    }
+
+    pointer operator->() const {
+        return slot;
+    }
+
+    self& operator++() {
+        ++meta;
+        ++slot;
+        ++dist;
+        if (*meta != dist) {
+            meta = nullptr;
+            slot = nullptr;
+        }
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const noexcept {
+        return meta == rhs.meta;
+    }
+
+    bool operator!=(const self& rhs) const noexcept {
+        return meta != rhs.meta;
+    }
+};
+
+// 节点句柄的占位类型，只声明不定义：对 robin_hood_hashtable 调用 extract / merge 等接口时编译失败
+struct rh_node_handle;
+
+// 模板类 robin_hood_hashtable，键值不允许重复
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数，参数四代表分配器类型
+template <class T, class Hash, class KeyEqual, class Alloc>
+class robin_hood_hashtable {
+public:
+    // robin_hood_hashtable 的型别定义
+    typedef ht_value_traits<T> value_traits;
+    typedef typename value_traits::key_type key_type;
+    typedef typename value_traits::mapped_type mapped_type;
+    typedef typename value_traits::value_type value_type;
+    typedef Hash hasher;
+    typedef KeyEqual key_equal;
+
+    typedef Alloc allocator_type;
+    typedef typename Alloc::template rebind<T>::other data_allocator;
+    typedef typename Alloc::template rebind<rh_meta_type>::other meta_allocator;
+
+    typedef typename allocator_type::pointer pointer;
+    typedef typename allocator_type::const_pointer const_pointer;
+    typedef typename allocator_type::reference reference;
+    typedef typename allocator_type::const_reference const_reference;
+    typedef typename allocator_type::size_type size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef rh_iterator<T, T&, T*> iterator;
+    typedef rh_iterator<T, const T&, const T*> const_iterator;
+    typedef rh_local_iterator<T, T&, T*> local_iterator;
+    typedef rh_local_iterator<T, const T&, const T*> const_local_iterator;
+
+    typedef rh_node_handle node_handle_type;
+    typedef node_insert_return<iterator, node_handle_type> insert_return_type;
+
+    static constexpr size_type min_capacity = 16;
+
+    allocator_type get_allocator() const {
+        return allocator_type(data_alloc_);
+    }
+
+private:
+    // 移动元素时不会抛出异常
+    static constexpr bool nothrow_relocate =
+        is_trivially_relocatable_v<value_type> || std::is_nothrow_move_constructible_v<value_type>;
+
+    // 空表不分配任何空间，meta_ 与 slots_ 均为空
+    rh_meta_type* meta_ = nullptr; // 元数据数组，长度为 capacity_ + max_probe_ + 1，最后一个为哨兵
+    value_type* slots_ = nullptr; // 槽位数组，长度为 capacity_ + max_probe_
+    size_type capacity_ = 0; // bucket 数，为 0 或不小于 min_capacity 的 2 的幂次
+    size_type max_probe_ = 0; // 探测距离的上限，也是溢出槽位的个数
+    size_type size_ = 0; // 元素个数
+    size_type max_elements_ = 0; // 不触发 rehash 能容纳的元素个数
+    float mlf_ = 0.9f; // 最大负载因子
+    hasher hash_;
+    key_equal equal_;
+    [[no_unique_address]] data_allocator data_alloc_; // 槽位分配器，元数据的分配器由它转换得到
+    [[no_unique_address]] ht_stats_recorder<> stats_; // rehash 的历史记录，未定义 CCYSTL_HASHTABLE_STATS 时为空类
+
+public:
+    // 构造、复制、移动、析构函数
+    robin_hood_hashtable() = default;
+
+    explicit robin_hood_hashtable(size_type bucket_count,
+                                  const Hash& hash = Hash(),
+                                  const KeyEqual& equal = KeyEqual(),
+                                  const allocator_type& alloc = allocator_type())
+        : hash_(hash), equal_(equal), data_alloc_(alloc) {
+        if (bucket_count != 0)
+            resize(normalize_capacity(bucket_count));
+    }
+
+    robin_hood_hashtable(const robin_hood_hashtable& rhs)
+        : robin_hood_hashtable(rhs, rhs.get_allocator()) {
+    }
+
+    robin_hood_hashtable(const robin_hood_hashtable& rhs, const allocator_type& alloc)
+        : mlf_(rhs.mlf_), hash_(rhs.hash_), equal_(rhs.equal_), data_alloc_(alloc) {
+        copy_init(rhs);
+    }
+
+    robin_hood_hashtable(robin_hood_hashtable&& rhs) noexcept
+        : meta_(rhs.meta_), slots_(rhs.slots_), capacity_(rhs.capacity_),
+          max_probe_(rhs.max_probe_), size_(rhs.size_), max_elements_(rhs.max_elements_),
+          mlf_(rhs.mlf_), hash_(rhs.hash_), equal_(rhs.equal_), data_alloc_(rhs.data_alloc_),
+          stats_(ccystl::move(rhs.stats_)) {
+        rhs.reset();
+    }
+
+    robin_hood_hashtable& operator=(const robin_hood_hashtable& rhs);
+    robin_hood_hashtable& operator=(robin_hood_hashtable&& rhs) noexcept(std::is_empty_v<data_allocator>);
+
+    ~robin_hood_hashtable() {
+        destroy_slots();
+        deallocate_arrays(meta_, slots_, capacity_, max_probe_);
+    }
+
+    // 迭代器相关操作
+    iterator begin() noexcept {
+        if (size_ == 0)
+            return end();
+        iterator it(meta_, slots_);
+        it.skip_empty();
+        return it;
+    }
+
+    const_iterator begin() const noexcept {
+        return const_cast<robin_hood_hashtable*>(this)->begin();
+    }
+
+    iterator end() noexcept {
+        return iterator_at(slot_count());
+    }
+
+    const_iterator end() const noexcept {
+        return const_cast<robin_hood_hashtable*>(this)->end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // 容量相关操作
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept {
+        return size_;
+    }
+
+    size_type max_size() const noexcept {
+        return static_cast<size_type>(-1) / sizeof(value_type);
+    }
+
+    // 修改容器相关操作
+
+    // emplace / insert，键值不允许重复
+    // 先构造出元素再取键值查找，已存在时丢弃该元素
+    template <class... Args>
+    pair<iterator, bool> emplace_unique(Args&&... args);
+
+    template <class... Args>
+    iterator emplace_unique_use_hint(const_iterator /*hint*/, Args&&... args) {
+        return emplace_unique(ccystl::forward<Args>(args)...).first;
+    }
+
+    pair<iterator, bool> insert_unique(const value_type& value) {
+        return insert_key_first(value_traits::get_key(value), value);
+    }
+
+    pair<iterator, bool> insert_unique(value_type&& value) {
+        return insert_key_first(value_traits::get_key(value), ccystl::move(value));
+    }
+
+    // 开放寻址没有“不扩容插入”的必要，与 insert_unique 相同
+    pair<iterator, bool> insert_unique_noresize(const value_type& value) {
+        return insert_unique(value);
+    }
+
+    iterator insert_unique_use_hint(const_iterator /*hint*/, const value_type& value) {
+        return insert_unique(value).first;
+    }
+
+    iterator insert_unique_use_hint(const_iterator /*hint*/, value_type&& value) {
+        return insert_unique(ccystl::move(value)).first;
+    }
+
+    template <class InputIter>
+    void insert_unique(InputIter first, InputIter last) {
+        if constexpr (is_forward_iterator<InputIter>::value)
+            reserve(size_ + static_cast<size_type>(ccystl::distance(first, last)));
+        for (; first != last; ++first)
+            insert_unique(*first);
+    }
+
+    // erase / clear
+    iterator erase(const_iterator position);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase_unique(const key_type& key);
+
+    void clear() noexcept;
+
+    void swap(robin_hood_hashtable& rhs) noexcept;
+
+    // 查找相关操作
+    template <class K>
+    size_type count(const K& key) const {
+        return find_index(key, hash_of(key)) != slot_count() ? 1 : 0;
+    }
+
+    template <class K>
+    iterator find(const K& key) {
+        return iterator_at(find_index(key, hash_of(key)));
+    }
+
+    template <class K>
+    const_iterator find(const K& key) const {
+        return const_cast<robin_hood_hashtable*>(this)->find(key);
+    }
+
+    template <class K>
+    bool contains(const K& key) const {
+        return count(key) != 0;
+    }
+
+    template <class K>
+    pair<iterator, iterator> equal_range_unique(const K& key) {
+        iterator it = find(key);
+        iterator next = it;
+        return it == end() ? ccystl::make_pair(it, it) : ccystl::make_pair(it, ++next);
+    }
+
+    template <class K>
+    pair<const_iterator, const_iterator> equal_range_unique(const K& key) const {
+        auto p = const_cast<robin_hood_hashtable*>(this)->equal_range_unique(key);
+        return ccystl::make_pair(const_iterator(p.first), const_iterator(p.second));
+    }
+
+    // 批量查找，见 hashtable::find_batch
+    // 每轮先计算一批键值的 bucket 并预取元数据与槽位，再逐个探测
+    template <class ForwardIter, class OutputIter>
+    OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) {
+        lookup_batch(first, last, [&](size_type i) { *result++ = iterator_at(i); });
+        return result;
+    }
+
+    template <class ForwardIter, class OutputIter>
+    OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+        lookup_batch(first, last, [&](size_type i) {
+            *result++ = const_iterator(const_cast<robin_hood_hashtable*>(this)->iterator_at(i));
+        });
+        return result;
+    }
+
+    template <class ForwardIter, class OutputIter>
+    OutputIter contains_batch(ForwardIter first, ForwardIter last, OutputIter result) const {
+        lookup_batch(first, last, [&](size_type i) { *result++ = i != slot_count(); });
+        return result;
+    }
+
+    // bucket interface
+
+    local_iterator begin(size_type n) noexcept {
+        ccystl_DEBUG(n < capacity_);
+        return bucket_begin(n);
+    }
+
+    const_local_iterator begin(size_type n) const noexcept {
+        return const_cast<robin_hood_hashtable*>(this)->begin(n);
+    }
+
+    const_local_iterator cbegin(size_type n) const noexcept {
+        return begin(n);
+    }
+
+    local_iterator end(size_type n) noexcept {
+        ccystl_DEBUG(n < capacity_);
+        return local_iterator();
+    }
+
+    const_local_iterator end(size_type n) const noexcept {
+        ccystl_DEBUG(n < capacity_);
+        return const_local_iterator();
+    }
+
+    const_local_iterator cend(size_type n) const noexcept {
+        return end(n);
+    }
+
+    size_type bucket_count() const noexcept {
+        return capacity_;
+    }
+
+    size_type max_bucket_count() const noexcept {
+        return (static_cast<size_type>(-1) >> 1) + 1;
+    }
+
+    size_type bucket_size(size_type n) const noexcept;
+
+    template <class K>
+    size_type bucket(const K& key) const {
+        return home_of(hash_of(key));
+    }
+
+    // hash policy
+
+    float load_factor() const noexcept {
+        return capacity_ != 0 ? static_cast<float>(size_) / static_cast<float>(capacity_) : 0.0f;
+    }
+
+    float max_load_factor() const noexcept {
+        return mlf_;
+    }
+
+    // 超过 0.9 时按 0.9 处理，更高的负载会使探测距离急剧增长
+    void max_load_factor(float ml) {
+        THROW_OUT_OF_RANGE_IF(ml != ml || ml <= 0, "invalid hash load factor");
+        mlf_ = ml < 0.9f ? ml : 0.9f;
+        max_elements_ = max_elements_for(capacity_);
+    }
+
+    void rehash(size_type count);
+
+    void reserve(size_type count) {
+        if (count > max_elements_)
+            resize(capacity_for(count));
+    }
+
+    // 统计信息，见 hashtable_stats.h
+    // 链长统计的是各元素的探测长度，空位计入 empty_buckets（包括溢出槽位）
+    hashtable_stats stats() const;
+
+    void reset_stats() noexcept {
+        stats_.reset();
+    }
+
+    hasher hash_fcn() const {
+        return hash_;
+    }
+
+    key_equal key_eq() const {
+        return equal_;
+    }
+
+    // 元素个数相等且 lhs 的每个元素都能在 rhs 中找到相等的元素
+    bool equal_unique(const robin_hood_hashtable& rhs) const;
+
+private:
+    // helper functions
+
+    template <class K>
+    size_type hash_of(const K& key) const {
+        return ht_mix(hash_(key));
+    }
+
+    size_type home_of(size_type hash) const noexcept {
+        return hash & (capacity_ - 1);
+    }
+
+    // 槽位总数，包括溢出槽位
+    size_type slot_count() const noexcept {
+        return capacity_ + max_probe_;
+    }
+
+    iterator iterator_at(size_type i) noexcept {
+        return iterator(meta_ + i, slots_ + i);
+    }
+
+    size_type index_of(const_iterator it) const noexcept {
+        return static_cast<size_type>(it.meta - meta_);
+    }
+
+    // bucket 数的取值：不小于 n 的 2 的幂次，至少为 min_capacity
+    static size_type normalize_capacity(size_type n) noexcept {
+        return n <= min_capacity ? min_capacity : std::bit_ceil(n);
+    }
+
+    // bucket 数为 capacity 时的探测距离上限，随 bucket 数的对数增长
+    static size_type max_probe_for(size_type capacity) noexcept {
+        const size_type probe = static_cast<size_type>(std::bit_width(capacity)) * 4;
+        return probe < 128 ? probe : 128;
+    }
+
+    size_type max_elements_for(size_type capacity) const noexcept {
+        return static_cast<size_type>(static_cast<float>(capacity) * mlf_);
+    }
+
+    // 能容纳 n 个元素的最小 bucket 数
+    size_type capacity_for(size_type n) const noexcept {
+        return normalize_capacity(static_cast<size_type>(static_cast<float>(n) / mlf_) + 1);
+    }
+
+    template <class K>
+    size_type find_index(const K& key, size_type hash) const;
+    bool find_insert_pos(size_type hash, size_type& pos, size_type& empty, rh_meta_type& meta) const noexcept;
+    rh_meta_type prepare_insert(size_type hash, size_type& pos);
+
+    template <class... Args>
+    pair<iterator, bool> insert_key_first(const key_type& key, Args&&... args);
+
+    local_iterator bucket_begin(size_type n) noexcept;
+
+    template <class ForwardIter, class Function>
+    void lookup_batch(ForwardIter first, ForwardIter last, Function fn) const;
+
+    void relocate(size_type from, size_type to) noexcept(nothrow_relocate);
+    void shift_up(size_type pos, size_type empty);
+    void close_gap(size_type pos);
+    void erase_at(size_type i);
+
+    void resize(size_type new_capacity);
+    void grow();
+
+    void allocate_arrays(size_type capacity, size_type max_probe, rh_meta_type*& meta, value_type*& slots);
+    void deallocate_arrays(rh_meta_type* meta, value_type* slots, size_type capacity, size_type max_probe) noexcept;
+    void destroy_slots() noexcept;
+    void copy_init(const robin_hood_hashtable& rhs);
+    void reset() noexcept;
+};
+
+/*****************************************************************************************/
+
+// 复制赋值运算符
+template <class T, class Hash, class KeyEqual, class Alloc>
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>&
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+operator=(const robin_hood_hashtable& rhs) {
+    if (this != &rhs) {
+        robin_hood_hashtable tmp(rhs, get_allocator());
+        swap(tmp);
+    }
+    return *this;
+}
+
+// 移动赋值运算符
+template <class T, class Hash, class KeyEqual, class Alloc>
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>&
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+operator=(robin_hood_hashtable&& rhs) noexcept(std::is_empty_v<data_allocator>) {
+    if (this == &rhs)
+        return *this;
+    if (data_alloc_ == rhs.data_alloc_) {
+        robin_hood_hashtable tmp(ccystl::move(rhs));
+        swap(tmp);
+    }
+    else {
+        // 分配器不随移动赋值传播，逐个移动元素到使用本容器分配器的新表中
+        robin_hood_hashtable tmp(0, rhs.hash_, rhs.equal_, get_allocator());
+        tmp.max_load_factor(rhs.mlf_);
+        tmp.reserve(rhs.size_);
+        for (auto& value : rhs)
+            tmp.insert_unique(ccystl::move(value));
+        rhs.clear();
+        swap(tmp);
+    }
+    return *this;
+}
+
+// 就地构造元素，键值不允许重复
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+pair<typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+emplace_unique(Args&&... args) {
+    value_type tmp(ccystl::forward<Args>(args)...);
+    return insert_key_first(value_traits::get_key(tmp), ccystl::move(tmp));
+}
+
+// 先按键值查找，不存在时腾出新元素应在的槽位，再在其上构造元素
+// 元素可以不抛异常地移动时提供强异常安全保证
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+pair<typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+insert_key_first(const key_type& key, Args&&... args) {
+    const size_type hash = hash_of(key);
+    const size_type found = find_index(key, hash);
+    if (found != slot_count())
+        return ccystl::make_pair(iterator_at(found), false);
+    size_type pos = 0;
+    const rh_meta_type meta = prepare_insert(hash, pos);
+    try {
+        data_alloc_.construct(slots_ + pos, ccystl::forward<Args>(args)...);
+    }
+    catch (...) {
+        // 构造失败，把后移的元素移回原处
+        close_gap(pos);
+        throw;
+    }
+    meta_[pos] = meta;
+    ++size_;
+    return ccystl::make_pair(iterator_at(pos), true);
+}
+
+// 删除迭代器所指的元素，返回下一个元素的迭代器
+// 后面的元素前移后，原位置上的元素即是尚未访问过的下一个元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::iterator
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+erase(const_iterator position) {
+    const size_type i = index_of(position);
+    erase_at(i);
+    iterator next = iterator_at(i);
+    next.skip_empty();
+    return next;
+}
+
+// 删除 [first, last) 内的元素
+// 删除会使其后的元素前移，last 所指的位置可能改变，因此先数出要删除的个数
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::iterator
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+erase(const_iterator first, const_iterator last) {
+    if (first == cbegin() && last == cend()) {
+        clear();
+        return end();
+    }
+    size_type n = static_cast<size_type>(ccystl::distance(first, last));
+    iterator it = iterator_at(index_of(first));
+    for (; n != 0; --n)
+        it = erase(it);
+    return it;
+}
+
+// 删除键值为 key 的元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+erase_unique(const key_type& key) {
+    const size_type i = find_index(key, hash_of(key));
+    if (i == slot_count())
+        return 0;
+    erase_at(i);
+    return 1;
+}
+
+// 清空元素，保留槽位数组
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+clear() noexcept {
+    if (capacity_ == 0)
+        return;
+    destroy_slots();
+    std::memset(meta_, rh_meta_empty, slot_count());
+    size_ = 0;
+}
+
+// 交换 robin_hood_hashtable
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+swap(robin_hood_hashtable& rhs) noexcept {
+    if (this != &rhs) {
+        ccystl::swap(meta_, rhs.meta_);
+        ccystl::swap(slots_, rhs.slots_);
+        ccystl::swap(capacity_, rhs.capacity_);
+        ccystl::swap(max_probe_, rhs.max_probe_);
+        ccystl::swap(size_, rhs.size_);
+        ccystl::swap(max_elements_, rhs.max_elements_);
+        ccystl::swap(mlf_, rhs.mlf_);
+        ccystl::swap(hash_, rhs.hash_);
+        ccystl::swap(equal_, rhs.equal_);
+        ccystl::swap(data_alloc_, rhs.data_alloc_);
+        stats_.swap(rhs.stats_);
+    }
+}
+
+// 第 n 个 bucket 中的元素个数
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+bucket_size(size_type n) const noexcept {
+    size_type result = 0;
+    for (auto it = begin(n), last = end(n); it != last; ++it)
+        ++result;
+    return result;
+}
+
+// 统计信息：元数据即探测距离加一，恰为探测长度
+template <class T, class Hash, class KeyEqual, class Alloc>
+hashtable_stats robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+stats() const {
+    hashtable_stats s;
+    s.size = size_;
+    s.bucket_count = capacity_;
+    s.load_factor = load_factor();
+    s.max_load_factor = mlf_;
+    size_type total = 0;
+    for (size_type i = 0; i < slot_count(); ++i) {
+        if (meta_[i] == rh_meta_empty) {
+            ++s.empty_buckets;
+            continue;
+        }
+        s.add_chain(meta_[i]);
+        total += meta_[i];
+    }
+    s.average_chain_length = size_ != 0 ? static_cast<double>(total) / static_cast<double>(size_) : 0.0;
+    s.node_bytes = slot_count() * sizeof(value_type);
+    s.bucket_bytes = meta_ != nullptr ? (slot_count() + 1) * sizeof(rh_meta_type) : 0;
+    stats_.fill(s);
+    return s;
+}
+
+// 重新调整 bucket 数，使其不小于 count 且能容纳现有元素
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+rehash(size_type count) {
+    size_type new_capacity = size_ != 0 ? capacity_for(size_) : 0;
+    if (count != 0)
+        new_capacity = ccystl::max(new_capacity, normalize_capacity(count));
+    if (new_capacity != capacity_)
+        resize(new_capacity);
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+bool robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+equal_unique(const robin_hood_hashtable& rhs) const {
+    if (size_ != rhs.size_)
+        return false;
+    for (auto it = begin(), last = end(); it != last; ++it) {
+        auto res = rhs.find(value_traits::get_key(*it));
+        if (res == rhs.end() || !(*res == *it))
+            return false;
+    }
+    return true;
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 查找键值为 key 的元素所在的槽位，找不到时返回 slot_count()
+// 探测到探测距离小于当前距离的槽位（包括空位与哨兵）时，键值不可能在更后面
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class K>
+typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+find_index(const K& key, size_type hash) const {
+    if (size_ == 0)
+        return slot_count();
+    size_type i = home_of(hash);
+    for (unsigned d = 1; meta_[i] >= d; ++i, ++d) {
+        if (meta_[i] == d && equal_(value_traits::get_key(slots_[i]), key))
+            return i;
+    }
+    return slot_count();
+}
+
+// 为哈希值为 hash 的新元素找位置：pos 为它应在的槽位，empty 为从 pos 起的第一个空位，meta 为它的元数据
+// 新元素或被后移的元素超出探测距离上限时返回 false
+template <class T, class Hash, class KeyEqual, class Alloc>
+bool robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+find_insert_pos(size_type hash, size_type& pos, size_type& empty, rh_meta_type& meta) const noexcept {
+    size_type i = home_of(hash);
+    unsigned d = 1;
+    // 越过 bucket 不在新元素之后的元素
+    for (; meta_[i] >= d; ++i, ++d) { }
+    if (d > max_probe_ + 1)
+        return false;
+    pos = i;
+    meta = static_cast<rh_meta_type>(d);
+    // [pos, empty) 内的元素都要后移一格，已在上限的元素无法后移；最后一个槽位上的元素必在上限，不会越过哨兵
+    for (; meta_[i] != rh_meta_empty; ++i) {
+        if (meta_[i] == max_probe_ + 1)
+            return false;
+    }
+    empty = i;
+    return true;
+}
+
+// 为哈希值为 hash 的新元素腾出槽位 pos，必要时先 rehash，返回新元素的元数据
+// 返回后 pos 为未构造元素的空位，但其后的元素已经后移
+template <class T, class Hash, class KeyEqual, class Alloc>
+rh_meta_type robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+prepare_insert(size_type hash, size_type& pos) {
+    THROW_LENGTH_ERROR_IF(size_ == max_size(), "robin_hood_hashtable's size too big");
+    while (true) {
+        if (size_ < max_elements_) {
+            size_type empty = 0;
+            rh_meta_type meta = 0;
+            if (find_insert_pos(hash, pos, empty, meta)) {
+                shift_up(pos, empty);
+                return meta;
+            }
+            // 负载不高却超出探测距离上限，说明哈希函数让大量键值落在了相邻的 bucket 上，扩容也无济于事
+            THROW_LENGTH_ERROR_IF(size_ < max_elements_ / 2,
+                                  "robin_hood_hashtable's probe length too long, check the hash function");
+        }
+        grow();
+    }
+}
+
+// 第 n 个 bucket 的第一个元素：越过 bucket 在 n 之前的元素后，探测距离恰好吻合的元素即属于 n
+template <class T, class Hash, class KeyEqual, class Alloc>
+typename robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::local_iterator
+robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+bucket_begin(size_type n) noexcept {
+    if (size_ == 0)
+        return local_iterator();
+    size_type i = n;
+    unsigned d = 1;
+    for (; meta_[i] > d; ++i, ++d) { }
+    return meta_[i] == d ? local_iterator(meta_ + i, slots_ + i, d) : local_iterator();
+}
+
+// lookup_batch 函数
+// 对 [first, last) 中的每个键值，以找到的槽位（未找到时为 slot_count()）调用 fn
+template <class T, class Hash, class KeyEqual, class Alloc>
+template <class ForwardIter, class Function>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+lookup_batch(ForwardIter first, ForwardIter last, Function fn) const {
+    if (size_ == 0) {
+        for (; first != last; ++first)
+            fn(slot_count());
+        return;
+    }
+    size_type codes[ht_batch_size];
+    while (first != last) {
+        // 计算哈希值，预取起始槽位的元数据与元素
+        size_type n = 0;
+        for (auto it = first; n < ht_batch_size && it != last; ++n, ++it) {
+            codes[n] = hash_of(*it);
+            const size_type i = home_of(codes[n]);
+            ht_prefetch(meta_ + i);
+            ht_prefetch(slots_ + i);
+        }
+        for (size_type k = 0; k < n; ++k, ++first)
+            fn(find_index(*first, codes[k]));
+    }
+}
+
+// 把槽位 from 上的元素重定位到空槽位 to，不修改元数据
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+relocate(size_type from, size_type to) noexcept(nothrow_relocate) {
+    if constexpr (is_trivially_relocatable_v<value_type>) {
+        std::memcpy(static_cast<void*>(slots_ + to), static_cast<const void*>(slots_ + from),
+                    sizeof(value_type));
+    }
+    else {
+        data_alloc_.construct(slots_ + to, ccystl::move(slots_[from]));
+        data_alloc_.destroy(slots_ + from);
+    }
+}
+
+// 把 [pos, empty) 内的元素后移一格，空出 pos
+// 元数据始终与槽位是否持有元素一致，移动中途抛出异常时仍能正确清空容器
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+shift_up(size_type pos, size_type empty) {
+    size_type j = empty;
+    try {
+        for (; j != pos; --j) {
+            relocate(j - 1, j);
+            meta_[j] = static_cast<rh_meta_type>(meta_[j - 1] + 1);
+            meta_[j - 1] = rh_meta_empty;
+        }
+    }
+    catch (...) {
+        clear();
+        throw;
+    }
+}
+
+// 槽位 pos 为空位，把之后不在 home 上的元素依次前移一格
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+close_gap(size_type pos) {
+    size_type j = pos + 1;
+    try {
+        for (; meta_[j] > 1; ++j) {
+            relocate(j, j - 1);
+            meta_[j - 1] = static_cast<rh_meta_type>(meta_[j] - 1);
+            meta_[j] = rh_meta_empty;
+        }
+    }
+    catch (...) {
+        clear();
+        throw;
+    }
+}
+
+// 删除第 i 个槽位的元素，不留墓碑
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+erase_at(size_type i) {
+    data_alloc_.destroy(slots_ + i);
+    meta_[i] = rh_meta_empty;
+    --size_;
+    close_gap(i);
+}
+
+// 把所有元素重新放入 new_capacity 个 bucket 中
+// 旧表按槽位顺序逐个重定位；新表中某个元素超出探测距离上限时，新表再扩容一次后继续
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+resize(size_type new_capacity) {
+    stats_.record_rehash(size_, capacity_, new_capacity);
+    typename ht_stats_recorder<>::timer timer(stats_);
+    rh_meta_type* old_meta = meta_;
+    value_type* old_slots = slots_;
+    const size_type old_count = slot_count();
+    const size_type old_capacity = capacity_;
+    const size_type old_probe = max_probe_;
+
+    const size_type new_probe = max_probe_for(new_capacity);
+    rh_meta_type* new_meta = nullptr;
+    value_type* new_slots = nullptr;
+    allocate_arrays(new_capacity, new_probe, new_meta, new_slots);
+    meta_ = new_meta;
+    slots_ = new_slots;
+    capacity_ = new_capacity;
+    max_probe_ = new_probe;
+    max_elements_ = max_elements_for(new_capacity);
+    const size_type count = size_;
+    size_ = 0;
+
+    size_type i = 0;
+    try {
+        for (; i != old_count; ++i) {
+            if (old_meta[i] == rh_meta_empty)
+                continue;
+            const size_type hash = hash_of(value_traits::get_key(old_slots[i]));
+            size_type pos = 0, empty = 0;
+            rh_meta_type meta = 0;
+            while (!find_insert_pos(hash, pos, empty, meta))
+                grow();
+            shift_up(pos, empty);
+            if constexpr (is_trivially_relocatable_v<value_type>) {
+                std::memcpy(static_cast<void*>(slots_ + pos), static_cast<const void*>(old_slots + i),
+                            sizeof(value_type));
+            }
+            else {
+                data_alloc_.construct(slots_ + pos, ccystl::move(old_slots[i]));
+                data_alloc_.destroy(old_slots + i);
+            }
+            old_meta[i] = rh_meta_empty;
+            meta_[pos] = meta;
+            ++size_;
+        }
+    }
+    catch (...) {
+        // 哈希函数或不可平凡重定位的元素抛出异常：丢弃旧表中剩余的元素，新表清空
+        for (; i != old_count; ++i) {
+            if (old_meta[i] != rh_meta_empty)
+                data_alloc_.destroy(old_slots + i);
+        }
+        deallocate_arrays(old_meta, old_slots, old_capacity, old_probe);
+        clear();
+        throw;
+    }
+    deallocate_arrays(old_meta, old_slots, old_capacity, old_probe);
+    ccystl_DEBUG(size_ == count);
+    (void)count;
+}
+
+// 元素个数达到上限或探测距离超出上限时扩容
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+grow() {
+    resize(ccystl::max(capacity_ * 2, capacity_for(size_ + 1)));
+}
+
+// 分配元数据与槽位数组，元数据全部置为空位，末尾放置哨兵
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+allocate_arrays(size_type capacity, size_type max_probe, rh_meta_type*& meta, value_type*& slots) {
+    if (capacity == 0) {
+        meta = nullptr;
+        slots = nullptr;
+        return;
+    }
+    THROW_LENGTH_ERROR_IF(capacity > max_size() - max_probe, "robin_hood_hashtable's size too big");
+    const size_type count = capacity + max_probe;
+    meta_allocator meta_alloc(data_alloc_);
+    meta = meta_alloc.allocate(count + 1);
+    try {
+        slots = data_alloc_.allocate(count);
+    }
+    catch (...) {
+        meta_alloc.deallocate(meta, count + 1);
+        throw;
+    }
+    std::memset(meta, rh_meta_empty, count);
+    meta[count] = rh_meta_sentinel;
+}
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+deallocate_arrays(rh_meta_type* meta, value_type* slots, size_type capacity, size_type max_probe) noexcept {
+    if (capacity == 0)
+        return;
+    meta_allocator(data_alloc_).deallocate(meta, capacity + max_probe + 1);
+    data_alloc_.deallocate(slots, capacity + max_probe);
+}
+
+// 析构所有元素，不修改元数据
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+destroy_slots() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+        for (size_type i = 0, n = slot_count(); i != n; ++i) {
+            if (meta_[i] != rh_meta_empty)
+                data_alloc_.destroy(slots_ + i);
+        }
+    }
+}
+
+// 复制 rhs 的元数据，把元素复制到相同的槽位上，无需重新计算哈希值
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+copy_init(const robin_hood_hashtable& rhs) {
+    if (rhs.size_ == 0)
+        return;
+    allocate_arrays(rhs.capacity_, rhs.max_probe_, meta_, slots_);
+    capacity_ = rhs.capacity_;
+    max_probe_ = rhs.max_probe_;
+    const size_type count = slot_count();
+    size_type i = 0;
+    try {
+        for (; i != count; ++i) {
+            if (rhs.meta_[i] != rh_meta_empty)
+                data_alloc_.construct(slots_ + i, rhs.slots_[i]);
+        }
+    }
+    catch (...) {
+        while (i != 0) {
+            --i;
+            if (rhs.meta_[i] != rh_meta_empty)
+                data_alloc_.destroy(slots_ + i);
+        }
+        deallocate_arrays(meta_, slots_, capacity_, max_probe_);
+        reset();
+        throw;
+    }
+    std::memcpy(meta_, rhs.meta_, count + 1);
+    size_ = rhs.size_;
+    max_elements_ = rhs.max_elements_;
+}
+
+// 置为不持有任何空间的空表
+template <class T, class Hash, class KeyEqual, class Alloc>
+void robin_hood_hashtable<T, Hash, KeyEqual, Alloc>::
+reset() noexcept {
+    meta_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    max_probe_ = 0;
+    size_ = 0;
+    max_elements_ = 0;
+}
+
+// 重载 ccystl 的 swap
+template <class T, class Hash, class KeyEqual, class Alloc>
+void swap(robin_hood_hashtable<T, Hash, KeyEqual, Alloc>& lhs,
+          robin_hood_hashtable<T, Hash, KeyEqual, Alloc>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+// unordered_set / unordered_map 的底层哈希表：缺省为链式的 hashtable，
+// bucket 策略为 ht_robin_hood_policy 时为 robin_hood_hashtable
+template <class T, class Hash, class KeyEqual, class Alloc, class BucketPolicy>
+struct ht_table_selector {
+    typedef hashtable<T, Hash, KeyEqual, Alloc, BucketPolicy> type;
+};
+
+template <class T, class Hash, class KeyEqual, class Alloc>
+struct ht_table_selector<T, Hash, KeyEqual, Alloc, ht_robin_hood_policy> {
+    typedef robin_hood_hashtable<T, Hash, KeyEqual, Alloc> type;
+};
+} // namespace ccystl
+
+#endif // !CCYSTL_ROBIN_HOOD_TABLE_H_
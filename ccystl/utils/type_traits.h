@@ -35,6 +35,22 @@ struct is_pair : y_false_type { };
 
 template <class T1, class T2>
 struct is_pair<pair<T1, T2>> : y_true_type { };
+
+// type traits for relocation
+// 若移动构造一个 T 再析构源对象，与直接按字节拷贝源对象并不再析构它等价，则称 T 可平凡重定位。
+// 可平凡复制的类型都满足这一点；只持有指向堆内存指针的类型（如 vector、basic_string、
+// unique_ptr 风格的句柄）通常也满足，可以通过特化本模板声明。
+// 容器在扩容时会对可平凡重定位的元素直接 memcpy，并在分配器支持时使用 realloc 原地增长。
+// 注意：对象内部持有指向自身的指针的类型不可特化为 true。
+template <class T>
+struct is_trivially_relocatable : y_bool_constant<std::is_trivially_copyable_v<T>> { };
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template <class T1, class T2>
+struct is_trivially_relocatable<pair<T1, T2>>
+    : y_bool_constant<is_trivially_relocatable_v<T1> && is_trivially_relocatable_v<T2>> { };
 } // namespace ccystl
 
 #endif // !CCYSTL_TYPE_TRAITS_H_
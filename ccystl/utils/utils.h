@@ -352,7 +352,7 @@ struct pair {
      * @param other 另一个 pair 对象。
      */
     void swap(pair& other) noexcept {
-        if (this != other) {
+        if (this != &other) {
             ccystl::swap(first, other.first);
             ccystl::swap(second, other.second);
         }
@@ -472,6 +472,25 @@ template <class Ty1, class Ty2>
 pair<Ty1, Ty2> make_pair(Ty1&& first, Ty2&& second) {
     return pair<Ty1, Ty2>(ccystl::forward<Ty1>(first), ccystl::forward<Ty2>(second));
 }
+
+/**
+ * @brief 标签类型，表示传入的范围已按键值升序排列且没有重复的键值。
+ *
+ * 有序容器的构造与插入函数接受该标签时不再排序、去重，调用者须保证输入满足条件。
+ */
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+
+/**
+ * @brief 标签类型，表示传入的范围已按键值升序排列，可以有重复的键值。
+ */
+struct sorted_equivalent_t {
+    explicit sorted_equivalent_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};         ///< sorted_unique_t 的实例
+inline constexpr sorted_equivalent_t sorted_equivalent{}; ///< sorted_equivalent_t 的实例
 } // namespace ccystl
 
 #endif // !CCYSTL_UTILS_H_
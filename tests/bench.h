@@ -0,0 +1,34 @@
+#ifndef CCYSTL_TESTS_BENCH_H_
+#define CCYSTL_TESTS_BENCH_H_
+
+// 基准测试共用的计时工具，只依赖 std::chrono
+// 每个用例重复若干次取最短的一次，减少调度与缓存冷启动带来的波动
+
+#include <chrono>
+#include <cstdio>
+
+namespace bench {
+
+// 编译器无法看穿的写入，防止被测代码被整体优化掉
+inline volatile size_t sink = 0;
+
+template <class F>
+double best_ms(F&& f, int repeat = 5) {
+    double best = 1e300;
+    for (int i = 0; i < repeat; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto stop = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        if (ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+inline void report(const char* name, double ms) {
+    std::printf("  %-40s %10.2f ms\n", name, ms);
+}
+
+} // namespace bench
+#endif // !CCYSTL_TESTS_BENCH_H_
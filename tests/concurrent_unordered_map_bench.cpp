@@ -0,0 +1,103 @@
+// concurrent_unordered_map 与“一把互斥锁 + unordered_map”的多线程吞吐量对比
+// 预先放入一半的键值，再由 1 / 2 / 4 / 8 个线程分摊固定的操作总数，
+// 按比例混合查找与 insert_or_assign，报告每秒完成的操作数
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/container/unordered_container/concurrent_unordered_map.h"
+#include "ccystl/container/unordered_container/unordered_map.h"
+#include "bench.h"
+
+namespace {
+
+constexpr uint64_t kKeys = 1 << 20;
+constexpr uint64_t kOps = 4000000;
+
+// 以一把互斥锁保护 unordered_map，作为对照
+class locked_map {
+public:
+    bool find(uint64_t key, uint64_t& value) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+        value = it->second;
+        return true;
+    }
+
+    void insert_or_assign(uint64_t key, uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        map_[key] = value;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    ccystl::unordered_map<uint64_t, uint64_t> map_;
+};
+
+inline uint64_t next_random(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// 每个线程执行 kOps / threads 次操作，其中 write_percent% 为写操作
+template <class Map>
+double run(Map& map, int threads, unsigned write_percent) {
+    return bench::best_ms([&] {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&map, t, threads, write_percent] {
+                uint64_t state = 0x9e3779b97f4a7c15ULL * (t + 1);
+                uint64_t found = 0, value = 0;
+                for (uint64_t i = 0; i < kOps / threads; ++i) {
+                    const uint64_t r = next_random(state);
+                    const uint64_t key = r % kKeys;
+                    if ((r >> 40) % 100 < write_percent)
+                        map.insert_or_assign(key, i);
+                    else
+                        found += map.find(key, value);
+                }
+                bench::sink = bench::sink + found;
+            });
+        }
+        for (auto& th : pool)
+            th.join();
+    }, 3);
+}
+
+void report(const char* name, int threads, double ms) {
+    char label[64];
+    std::snprintf(label, sizeof(label), "%-28s %d threads", name, threads);
+    std::printf("  %-40s %10.2f ms %8.2f Mops/s\n", label, ms, kOps / ms / 1000.0);
+}
+
+} // namespace
+
+int main() {
+    std::printf("concurrent_unordered_map_bench, %llu ops, %llu keys, hardware_concurrency = %u\n",
+                static_cast<unsigned long long>(kOps), static_cast<unsigned long long>(kKeys),
+                std::thread::hardware_concurrency());
+    const unsigned writes[] = {10, 50};
+    const int threads[] = {1, 2, 4, 8};
+    for (unsigned w : writes) {
+        std::printf("%u%% insert_or_assign, %u%% find\n", w, 100 - w);
+        ccystl::concurrent_unordered_map<uint64_t, uint64_t> cmap;
+        locked_map lmap;
+        for (uint64_t k = 0; k < kKeys; k += 2) {
+            cmap.insert_or_assign(k, k);
+            lmap.insert_or_assign(k, k);
+        }
+        for (int n : threads) {
+            report("mutex + unordered_map", n, run(lmap, n, w));
+            report("concurrent_unordered_map", n, run(cmap, n, w));
+        }
+    }
+    return 0;
+}
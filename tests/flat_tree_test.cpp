@@ -0,0 +1,127 @@
+// flat_map / flat_set / flat_multimap / flat_multiset 成批插入的测试
+// 以 std::map 等为参照：插入的范围中有等价键值时，键值不允许重复的容器保留第一次出现的元素，
+// 允许重复的容器保持插入的次序，原有的元素排在新插入的等价元素前面
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "ccystl/container/associative_container/flat_map.h"
+#include "ccystl/container/associative_container/flat_set.h"
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (0)
+
+namespace {
+
+// 只比较 first 的比较器，使等价的元素仍能区分
+struct first_less {
+    bool operator()(const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) const {
+        return lhs.first < rhs.first;
+    }
+};
+
+std::vector<std::pair<int, int>> random_pairs(std::mt19937& rng, int n, int range) {
+    std::vector<std::pair<int, int>> v;
+    for (int i = 0; i < n; ++i)
+        v.emplace_back(static_cast<int>(rng() % range), i);
+    return v;
+}
+
+// flat_map 的元素类型为 ccystl::pair
+std::vector<ccystl::pair<int, int>> to_ccystl(const std::vector<std::pair<int, int>>& v) {
+    std::vector<ccystl::pair<int, int>> r;
+    for (const auto& p : v)
+        r.emplace_back(p.first, p.second);
+    return r;
+}
+
+template <class Flat, class Ref>
+void check_map(const Flat& flat, const Ref& ref) {
+    CHECK(flat.size() == ref.size());
+    auto it = flat.begin();
+    for (const auto& kv : ref) {
+        CHECK((*it).first == kv.first);
+        CHECK((*it).second == kv.second);
+        ++it;
+    }
+}
+
+template <class Flat, class Ref>
+void check_set(const Flat& flat, const Ref& ref) {
+    CHECK(flat.size() == ref.size());
+    auto it = flat.begin();
+    for (const auto& v : ref) {
+        CHECK(it->first == v.first);
+        CHECK(it->second == v.second);
+        ++it;
+    }
+}
+
+void test_flat_map(std::mt19937& rng) {
+    for (int round = 0; round < 50; ++round) {
+        const auto init = random_pairs(rng, 200, 150);
+        const auto more = random_pairs(rng, 400, 300);
+        const auto flat_init = to_ccystl(init);
+        const auto flat_more = to_ccystl(more);
+
+        ccystl::flat_map<int, int> flat(flat_init.begin(), flat_init.end());
+        std::map<int, int> ref(init.begin(), init.end());
+        check_map(flat, ref);
+
+        flat.insert(flat_more.begin(), flat_more.end());
+        ref.insert(more.begin(), more.end());
+        check_map(flat, ref);
+
+        ccystl::flat_multimap<int, int> mflat(flat_init.begin(), flat_init.end());
+        std::multimap<int, int> mref(init.begin(), init.end());
+        check_map(mflat, mref);
+
+        mflat.insert(flat_more.begin(), flat_more.end());
+        mref.insert(more.begin(), more.end());
+        check_map(mflat, mref);
+    }
+}
+
+void test_flat_set(std::mt19937& rng) {
+    typedef std::pair<int, int> value;
+    for (int round = 0; round < 50; ++round) {
+        const auto init = random_pairs(rng, 200, 150);
+        const auto more = random_pairs(rng, 400, 300);
+
+        ccystl::flat_set<value, first_less> flat(init.begin(), init.end());
+        std::set<value, first_less> ref(init.begin(), init.end());
+        check_set(flat, ref);
+
+        flat.insert(more.begin(), more.end());
+        ref.insert(more.begin(), more.end());
+        check_set(flat, ref);
+
+        ccystl::flat_multiset<value, first_less> mflat(init.begin(), init.end());
+        std::multiset<value, first_less> mref(init.begin(), init.end());
+        check_set(mflat, mref);
+
+        mflat.insert(more.begin(), more.end());
+        mref.insert(more.begin(), more.end());
+        check_set(mflat, mref);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(2024);
+    test_flat_map(rng);
+    test_flat_set(rng);
+    std::printf("flat_tree_test passed\n");
+    return 0;
+}
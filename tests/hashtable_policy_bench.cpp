@@ -0,0 +1,88 @@
+// hashtable 三种 bucket 策略的对比：ht_prime_policy（缺省）、ht_power2_policy、ht_fastrange_policy
+// 每种键值分布下分别计时：插入 N 个键值、查找 N 个存在的键值、查找 N 个不存在的键值
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/container/unordered_container/unordered_map.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t N = 1000000;
+
+template <class Policy>
+using table = ccystl::unordered_map<uint64_t, uint64_t, ccystl::hash<uint64_t>, ccystl::equal_to<uint64_t>,
+                                    ccystl::allocator<ccystl::pair<const uint64_t, uint64_t>>, Policy>;
+
+template <class Policy>
+void run(const char* policy, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& misses) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%-20s insert", policy);
+    bench::report(name, bench::best_ms([&] {
+        table<Policy> t;
+        for (auto k : keys)
+            t.emplace(k, k);
+        bench::sink = bench::sink + t.size();
+    }, 3));
+
+    table<Policy> t;
+    for (auto k : keys)
+        t.emplace(k, k);
+    std::snprintf(name, sizeof(name), "%-20s find hit", policy);
+    bench::report(name, bench::best_ms([&] {
+        size_t hit = 0;
+        for (auto k : keys)
+            hit += t.find(k) != t.end();
+        bench::sink = bench::sink + hit;
+    }, 3));
+    std::snprintf(name, sizeof(name), "%-20s find miss", policy);
+    bench::report(name, bench::best_ms([&] {
+        size_t hit = 0;
+        for (auto k : misses)
+            hit += t.find(k) != t.end();
+        bench::sink = bench::sink + hit;
+    }, 3));
+}
+
+void run_all(const char* dist, const std::vector<uint64_t>& keys, const std::vector<uint64_t>& misses) {
+    std::printf("%s\n", dist);
+    run<ccystl::ht_prime_policy>("prime", keys, misses);
+    run<ccystl::ht_power2_policy>("power2", keys, misses);
+    run<ccystl::ht_fastrange_policy>("fastrange", keys, misses);
+}
+
+} // namespace
+
+int main() {
+    std::printf("hashtable_policy_bench, N = %zu\n", N);
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> keys(N), misses(N);
+
+    // 随机键值：奇数为存在的键值，偶数为不存在的键值
+    for (size_t i = 0; i < N; ++i) {
+        keys[i] = rng() | 1;
+        misses[i] = rng() & ~uint64_t(1);
+    }
+    run_all("random keys", keys, misses);
+
+    // 连续整数，打乱次序后插入
+    for (size_t i = 0; i < N; ++i) {
+        keys[i] = i;
+        misses[i] = N + i;
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    run_all("sequential keys (shuffled)", keys, misses);
+
+    // 步长为 4096 的键值，低位全为 0，考验哈希值混合
+    for (size_t i = 0; i < N; ++i) {
+        keys[i] = i << 12;
+        misses[i] = (N + i) << 12;
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    run_all("strided keys (step 4096, shuffled)", keys, misses);
+    return 0;
+}
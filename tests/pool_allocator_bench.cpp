@@ -0,0 +1,99 @@
+// 节点式容器使用 pool_allocator 与 ccystl::allocator 的对比
+// 每个用例：插入 N 个随机键值、查找一遍、再全部删除，容器析构也计入时间
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "ccystl/functor/functional.h"
+#include "ccystl/allocator/pool_allocator.h"
+#include "ccystl/container/associative_container/map.h"
+#include "ccystl/container/associative_container/set.h"
+#include "ccystl/container/sequence_container/list.h"
+#include "ccystl/container/unordered_container/unordered_map.h"
+#include "bench.h"
+
+namespace {
+
+constexpr int N = 200000;
+
+template <class List>
+void run_list() {
+    List l;
+    for (int i = 0; i < N; ++i)
+        l.push_back(i);
+    // 隔一个删一个，使空闲链表与分配交错
+    auto it = l.begin();
+    while (it != l.end()) {
+        it = l.erase(it);
+        if (it != l.end())
+            ++it;
+    }
+    for (int i = 0; i < N / 2; ++i)
+        l.push_front(i);
+    bench::sink = bench::sink + l.size();
+}
+
+template <class Set>
+void run_set(const std::vector<int>& keys) {
+    Set s;
+    for (int k : keys)
+        s.insert(k);
+    size_t hit = 0;
+    for (int k : keys)
+        hit += s.count(k);
+    for (int k : keys)
+        s.erase(k);
+    bench::sink = bench::sink + hit;
+}
+
+template <class Map>
+void run_map(const std::vector<int>& keys) {
+    Map m;
+    for (int k : keys)
+        m[k] = k;
+    size_t hit = 0;
+    for (int k : keys)
+        hit += m.count(k);
+    for (int k : keys)
+        m.erase(k);
+    bench::sink = bench::sink + hit;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    std::vector<int> keys(N);
+    for (auto& k : keys)
+        k = static_cast<int>(rng());
+
+    typedef ccystl::pair<const int, int> value_type;
+
+    std::printf("pool_allocator_bench, N = %d\n", N);
+    bench::report("list           / allocator",
+                  bench::best_ms([] { run_list<ccystl::list<int>>(); }));
+    bench::report("list           / pool_allocator",
+                  bench::best_ms([] { run_list<ccystl::list<int, ccystl::pool_allocator<int>>>(); }));
+    bench::report("set            / allocator",
+                  bench::best_ms([&] { run_set<ccystl::set<int>>(keys); }));
+    bench::report("set            / pool_allocator",
+                  bench::best_ms([&] {
+                      run_set<ccystl::set<int, ccystl::less<int>, ccystl::pool_allocator<int>>>(keys);
+                  }));
+    bench::report("map            / allocator",
+                  bench::best_ms([&] { run_map<ccystl::map<int, int>>(keys); }));
+    bench::report("map            / pool_allocator",
+                  bench::best_ms([&] {
+                      run_map<ccystl::map<int, int, ccystl::less<int>,
+                                          ccystl::pool_allocator<value_type>>>(keys);
+                  }));
+    bench::report("unordered_map  / allocator",
+                  bench::best_ms([&] { run_map<ccystl::unordered_map<int, int>>(keys); }));
+    bench::report("unordered_map  / pool_allocator",
+                  bench::best_ms([&] {
+                      run_map<ccystl::unordered_map<int, int, ccystl::hash<int>, ccystl::equal_to<int>,
+                                                    ccystl::pool_allocator<value_type>>>(keys);
+                  }));
+    return 0;
+}
@@ -0,0 +1,58 @@
+// small_vector 与 vector 的对比
+// 反复构造短命的容器、压入 k 个元素、遍历求和后析构；small_vector 的内联容量为 8，
+// k 不超过 8 时走内联存储，超过 8 时重定位到堆上
+
+#include <cstdio>
+
+#include "ccystl/container/sequence_container/small_vector.h"
+#include "ccystl/container/sequence_container/vector.h"
+#include "bench.h"
+
+namespace {
+
+constexpr int kRounds = 1000000;
+constexpr size_t kInline = 8;
+
+template <class Vec>
+void run(int k) {
+    size_t sum = 0;
+    for (int r = 0; r < kRounds; ++r) {
+        Vec v;
+        for (int i = 0; i < k; ++i)
+            v.push_back(r + i);
+        for (auto x : v)
+            sum += static_cast<size_t>(x);
+    }
+    bench::sink = bench::sink + sum;
+}
+
+void run_reserved(int k) {
+    size_t sum = 0;
+    for (int r = 0; r < kRounds; ++r) {
+        ccystl::vector<int> v;
+        v.reserve(k);
+        for (int i = 0; i < k; ++i)
+            v.push_back(r + i);
+        for (auto x : v)
+            sum += static_cast<size_t>(x);
+    }
+    bench::sink = bench::sink + sum;
+}
+
+} // namespace
+
+int main() {
+    std::printf("small_vector_bench, %d rounds, inline capacity %zu\n", kRounds, kInline);
+    const int sizes[] = {2, 8, 9, 32};
+    for (int k : sizes) {
+        char name[64];
+        std::printf("k = %d%s\n", k, k <= static_cast<int>(kInline) ? " (inline)" : " (heap)");
+        std::snprintf(name, sizeof(name), "vector");
+        bench::report(name, bench::best_ms([k] { run<ccystl::vector<int>>(k); }));
+        std::snprintf(name, sizeof(name), "vector + reserve");
+        bench::report(name, bench::best_ms([k] { run_reserved(k); }));
+        std::snprintf(name, sizeof(name), "small_vector<int, %zu>", kInline);
+        bench::report(name, bench::best_ms([k] { run<ccystl::small_vector<int, kInline>>(k); }));
+    }
+    return 0;
+}